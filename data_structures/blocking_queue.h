@@ -0,0 +1,337 @@
+﻿/**
+ * @author Dreadblade- (https://github.com/Dreadblade-dev)
+ * Blocking queue
+ *
+ * A Queue guarded by a mutex for any number of producers and consumers.
+ * A consumer that finds the queue empty does not poll isEmpty() or sleep
+ * for a fixed time: it spins for a few microseconds on the item count,
+ * which is an atomic outside the mutex, and then parks on an event that
+ * the next enqueue signals (futex or its equivalent). A parked consumer
+ * costs nothing, and an enqueue pays for a system call only while some
+ * consumer is parked.
+ *
+ * dequeueFor() gives up after a timeout, drainUpTo() takes a whole batch
+ * under one lock. close() ends the queue: enqueues fail from then on,
+ * consumers take the items that are left and then stop waiting.
+ *
+ * Time complexity (insertion is amortized):
+ * ┌───────────┬──────────┬─────────────────┐
+ * │ Insertion │ Deletion │ Drain (n items) │
+ * │───────────┼──────────┼─────────────────│
+ * │    O(1)   │   O(1)   │      O(n)       │
+ * └───────────┴──────────┴─────────────────┘
+ *
+ * Source: https://en.wikipedia.org/wiki/Producer%E2%80%93consumer_problem
+ */
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include "queue.h"
+#include "parking.h"
+
+namespace blocking_queue
+{
+	struct constants
+	{
+		static const unsigned spins_before_parking = 1000;
+	};
+}
+
+template <class T, class Allocator = std::allocator<T>>
+class BlockingQueue
+{
+private:
+	using Clock = std::chrono::steady_clock;
+
+	Queue<T, Allocator> m_queue;
+	mutable std::mutex m_mutex;
+	std::atomic<std::size_t> m_size;
+	std::atomic<bool> m_closed;
+	parking::Event m_ready;
+
+	bool isReady() const noexcept;
+	bool waitReady(Clock::time_point deadline);
+	bool take(T& item);
+public:
+	explicit BlockingQueue(const Allocator& allocator = Allocator());
+	BlockingQueue(const BlockingQueue<T, Allocator>&) = delete;
+	BlockingQueue<T, Allocator>& operator=(const BlockingQueue<T, Allocator>&) = delete;
+	bool isEmpty() const noexcept;
+	bool isClosed() const noexcept;
+	std::size_t getSize() const noexcept;
+	Allocator getAllocator() const noexcept;
+
+	bool enqueue(const T& item);
+	bool enqueue(T&& item);
+	template <class... Args>
+	bool emplace(Args&&... args);
+	bool tryDequeue(T& item);
+	bool dequeue(T& item);
+	template <class Rep, class Period>
+	bool dequeueFor(T& item, const std::chrono::duration<Rep, Period>& timeout);
+	template <class OutputIterator>
+	std::size_t drainUpTo(std::size_t count, OutputIterator out);
+	void close();
+};
+
+/**
+ * Default constructor, creates open empty queue that takes its memory from @allocator
+ */
+template <class T, class Allocator>
+BlockingQueue<T, Allocator>::BlockingQueue(const Allocator& allocator)
+	: m_queue(allocator), m_size(0), m_closed(false)
+{
+
+}
+
+/**
+ * Returns @true if a consumer need not wait: there are items or the queue is closed
+ */
+template <class T, class Allocator>
+bool BlockingQueue<T, Allocator>::isReady() const noexcept
+{
+	return m_size.load(std::memory_order_acquire) > 0 || m_closed.load(std::memory_order_acquire);
+}
+
+/**
+ * Waits until the queue is ready, spinning shortly and then parking.
+ * Returns @false if @deadline passed first
+ */
+template <class T, class Allocator>
+bool BlockingQueue<T, Allocator>::waitReady(Clock::time_point deadline)
+{
+	const unsigned spins = parking::spinLimit(blocking_queue::constants::spins_before_parking);
+	for (unsigned spin = 0; spin < spins; ++spin)
+	{
+		if (isReady())
+			return true;
+		parking::pause();
+	}
+
+	for (;;)
+	{
+		const uint32_t token = m_ready.prepareWait();
+		if (isReady())
+			return true;
+
+		if (deadline == Clock::time_point::max())
+		{
+			m_ready.wait(token);
+			continue;
+		}
+
+		const Clock::time_point now = Clock::now();
+		if (now >= deadline)
+			return false;
+		m_ready.waitFor(token, deadline - now);
+	}
+}
+
+/**
+ * Moves the first item to @item if there is one, the caller does not hold the lock
+ */
+template <class T, class Allocator>
+bool BlockingQueue<T, Allocator>::take(T& item)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_queue.isEmpty())
+		return false;
+
+	item = m_queue.dequeue();
+	m_size.store(m_queue.getSize(), std::memory_order_release);
+	return true;
+}
+
+/**
+ * Returns @true if the queue is empty at the moment of the call
+ */
+template <class T, class Allocator>
+bool BlockingQueue<T, Allocator>::isEmpty() const noexcept
+{
+	return getSize() == 0;
+}
+
+/**
+ * Returns @true if the queue has been closed
+ */
+template <class T, class Allocator>
+bool BlockingQueue<T, Allocator>::isClosed() const noexcept
+{
+	return m_closed.load(std::memory_order_acquire);
+}
+
+/**
+ * Returns the number of items at the moment of the call
+ */
+template <class T, class Allocator>
+std::size_t BlockingQueue<T, Allocator>::getSize() const noexcept
+{
+	return m_size.load(std::memory_order_acquire);
+}
+
+/**
+ * Returns the allocator of the queue
+ */
+template <class T, class Allocator>
+Allocator BlockingQueue<T, Allocator>::getAllocator() const noexcept
+{
+	return m_queue.getAllocator();
+}
+
+/**
+ * Adds @item to the end of the queue and wakes the waiting consumers.
+ * Returns @false if the queue is closed
+ */
+template <class T, class Allocator>
+bool BlockingQueue<T, Allocator>::enqueue(const T& item)
+{
+	return emplace(item);
+}
+
+/**
+ * Moves @item to the end of the queue and wakes the waiting consumers.
+ * Returns @false if the queue is closed, @item is left untouched then
+ */
+template <class T, class Allocator>
+bool BlockingQueue<T, Allocator>::enqueue(T&& item)
+{
+	return emplace(std::move(item));
+}
+
+/**
+ * Constructs an item from @args at the end of the queue and wakes the
+ * waiting consumers. Returns @false if the queue is closed
+ */
+template <class T, class Allocator>
+template <class... Args>
+bool BlockingQueue<T, Allocator>::emplace(Args&&... args)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_closed.load(std::memory_order_relaxed))
+			return false;
+
+		m_queue.emplace(std::forward<Args>(args)...);
+		m_size.store(m_queue.getSize(), std::memory_order_release);
+	}
+
+	m_ready.notifyAll();
+	return true;
+}
+
+/**
+ * Moves the first item to @item and returns @true,
+ * returns @false at once if the queue is empty
+ */
+template <class T, class Allocator>
+bool BlockingQueue<T, Allocator>::tryDequeue(T& item)
+{
+	return take(item);
+}
+
+/**
+ * Moves the first item to @item, waits while the queue is empty.
+ * Returns @false only when the queue is closed and empty
+ */
+template <class T, class Allocator>
+bool BlockingQueue<T, Allocator>::dequeue(T& item)
+{
+	for (;;)
+	{
+		waitReady(Clock::time_point::max());
+		if (take(item))
+			return true;
+		if (isClosed())
+			return false;
+	}
+}
+
+/**
+ * Moves the first item to @item, waits at most @timeout while the queue is
+ * empty. Returns @false if the time ran out or the queue is closed and empty
+ */
+template <class T, class Allocator>
+template <class Rep, class Period>
+bool BlockingQueue<T, Allocator>::dequeueFor(T& item, const std::chrono::duration<Rep, Period>& timeout)
+{
+	// Very long timeouts wait without a limit instead of overflowing the deadline. The check
+	// runs in seconds of double, a coarse @timeout would overflow the clock's ticks first;
+	// anything beyond half the clock's range counts as very long, which covers the rounding
+	const Clock::time_point now = Clock::now();
+	const std::chrono::duration<double> range = Clock::time_point::max() - now;
+	const Clock::time_point deadline = (std::chrono::duration<double>(timeout) >= range / 2) ? Clock::time_point::max() :
+		now + std::chrono::duration_cast<Clock::duration>(timeout);
+
+	for (;;)
+	{
+		if (!waitReady(deadline))
+			return take(item);
+		if (take(item))
+			return true;
+		if (isClosed())
+			return false;
+	}
+}
+
+/**
+ * Moves up to @count first items to @out under one lock, waits while the
+ * queue is empty. Returns the number of items taken, 0 only when the queue
+ * is closed and empty (or @count is 0)
+ */
+template <class T, class Allocator>
+template <class OutputIterator>
+std::size_t BlockingQueue<T, Allocator>::drainUpTo(std::size_t count, OutputIterator out)
+{
+	if (count == 0)
+		return 0;
+
+	for (;;)
+	{
+		waitReady(Clock::time_point::max());
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			const std::size_t size = m_queue.getSize();
+			const std::size_t taken = (size < count) ? size : count;
+
+			for (std::size_t index = 0; index < taken; ++index, ++out)
+			{
+				*out = m_queue.dequeue();
+				m_size.store(m_queue.getSize(), std::memory_order_release);
+			}
+
+			if (taken > 0)
+				return taken;
+		}
+
+		if (isClosed())
+			return 0;
+	}
+}
+
+/**
+ * Closes the queue: no item can be added anymore and waiting consumers
+ * return once the items left are taken
+ */
+template <class T, class Allocator>
+void BlockingQueue<T, Allocator>::close()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_closed.store(true, std::memory_order_release);
+	}
+
+	m_ready.notifyAll();
+}
+
+#if DATA_STRUCTURES_PMR
+namespace pmr
+{
+	template <class T>
+	using BlockingQueue = ::BlockingQueue<T, std::pmr::polymorphic_allocator<T>>;
+}
+#endif
\ No newline at end of file
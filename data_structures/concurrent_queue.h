@@ -0,0 +1,508 @@
+﻿/**
+ * @author Dreadblade- (https://github.com/Dreadblade-dev)
+ * Unbounded concurrent queue
+ *
+ * Every producer thread gets its own sub-queue through a Producer handle,
+ * so producers never contend with each other and an enqueue is a plain
+ * write plus one release store. A sub-queue is a ring of linked blocks
+ * of fixed size: a full block is followed by the next one, nothing is
+ * ever reallocated or moved. Blocks the consumers have drained stay in
+ * the ring and are refilled by the producer, so once the ring is large
+ * enough for the backlog the queue allocates nothing.
+ *
+ * Consumers look for a non-empty sub-queue and take it over for the
+ * duration of one (bulk) dequeue; a consumer that finds a sub-queue
+ * taken moves on to the next one. The items of one producer come out
+ * in the order they were added, there is no order between producers.
+ *
+ * Time complexity (P - producers):
+ * ┌────────────────┬────────────────┐
+ * │   Insertion    │    Deletion    │
+ * ├────────────────┼────────────────┤
+ * │ O(1) amortized │      O(P)      │
+ * └────────────────┴────────────────┘
+ *
+ * Source: https://moodycamel.com/blog/2014/a-fast-general-purpose-lock-free-queue-for-c++
+ */
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include "memory_resource.h"
+
+namespace concurrent_queue
+{
+	struct constants
+	{
+		static const std::size_t block_size = 64;
+		static const std::size_t cache_line = 64;
+	};
+}
+
+template <class T, class Allocator = std::allocator<T>>
+class ConcurrentQueue
+{
+private:
+	struct Block
+	{
+		Block* next;
+		typename std::aligned_storage<sizeof(T), alignof(T)>::type items[concurrent_queue::constants::block_size];
+
+		T* item(std::size_t index) noexcept
+		{
+			return reinterpret_cast<T*>(&items[index]);
+		}
+	};
+
+	// Padded rather than aligned, the allocator need not support over-aligned types
+	struct SubQueue
+	{
+		// Written by the owning producer only
+		std::atomic<std::size_t> enqueued;
+		Block* tailBlock;
+		std::size_t tailIndex;
+		char producerPadding[concurrent_queue::constants::cache_line];
+
+		// Written by the consumer that holds @busy
+		std::atomic<std::size_t> dequeued;
+		std::atomic<Block*> frontBlock;
+		std::size_t frontIndex;
+		std::atomic<bool> busy;
+		char consumerPadding[concurrent_queue::constants::cache_line];
+
+		std::atomic<bool> owned;
+		SubQueue* next;
+
+		SubQueue(Block* block) noexcept
+			: enqueued(0), tailBlock(block), tailIndex(0), dequeued(0), frontBlock(block), frontIndex(0),
+			busy(false), owned(true), next(nullptr) {}
+	};
+
+	using BlockAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Block>;
+	using SubQueueAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<SubQueue>;
+
+	std::atomic<SubQueue*> m_subQueues;
+	std::atomic<std::size_t> m_subQueueCount;
+	Allocator m_allocator;
+	BlockAllocator m_blockAllocator;
+	SubQueueAllocator m_subQueueAllocator;
+
+	Block* allocateBlock();
+	SubQueue* acquireSubQueue();
+	void advanceTail(SubQueue& subQueue);
+	template <class OutputIterator>
+	std::size_t takeItems(SubQueue& subQueue, OutputIterator& out, std::size_t count);
+public:
+	class Producer
+	{
+	private:
+		ConcurrentQueue<T, Allocator>* m_queue;
+		SubQueue* m_subQueue;
+
+		friend class ConcurrentQueue<T, Allocator>;
+		Producer(ConcurrentQueue<T, Allocator>* queue, SubQueue* subQueue) noexcept : m_queue(queue), m_subQueue(subQueue) {}
+	public:
+		Producer(Producer&& producer) noexcept;
+		Producer& operator=(Producer&& producer) noexcept;
+		Producer(const Producer&) = delete;
+		Producer& operator=(const Producer&) = delete;
+		~Producer();
+
+		void enqueue(const T& item);
+		void enqueue(T&& item);
+		template <class... Args>
+		void emplace(Args&&... args);
+		template <class InputIterator>
+		void enqueueBulk(InputIterator first, std::size_t count);
+	};
+
+	explicit ConcurrentQueue(const Allocator& allocator = Allocator());
+	ConcurrentQueue(const ConcurrentQueue<T, Allocator>&) = delete;
+	ConcurrentQueue<T, Allocator>& operator=(const ConcurrentQueue<T, Allocator>&) = delete;
+	~ConcurrentQueue();
+	Producer makeProducer();
+	bool isEmpty() const noexcept;
+	std::size_t getSize() const noexcept;
+	Allocator getAllocator() const noexcept;
+	bool tryDequeue(T& item);
+	template <class OutputIterator>
+	std::size_t tryDequeueBulk(OutputIterator out, std::size_t count);
+};
+
+/**
+ * Default constructor, creates queue that takes its memory from @allocator.
+ * Nothing is allocated before the first producer
+ */
+template <class T, class Allocator>
+ConcurrentQueue<T, Allocator>::ConcurrentQueue(const Allocator& allocator)
+	: m_subQueues(nullptr), m_subQueueCount(0), m_allocator(allocator),
+	m_blockAllocator(allocator), m_subQueueAllocator(allocator)
+{
+
+}
+
+/**
+ * Destructor, no other thread may use the queue and no producer may be left
+ */
+template <class T, class Allocator>
+ConcurrentQueue<T, Allocator>::~ConcurrentQueue()
+{
+	SubQueue* subQueue = m_subQueues.load(std::memory_order_acquire);
+	while (subQueue != nullptr)
+	{
+		Block* block = subQueue->frontBlock.load(std::memory_order_relaxed);
+		std::size_t index = subQueue->frontIndex;
+		std::size_t left = subQueue->enqueued.load(std::memory_order_relaxed) - subQueue->dequeued.load(std::memory_order_relaxed);
+
+		for (; left > 0; --left, ++index)
+		{
+			if (index == concurrent_queue::constants::block_size)
+			{
+				block = block->next;
+				index = 0;
+			}
+			std::allocator_traits<Allocator>::destroy(m_allocator, block->item(index));
+		}
+
+		// The blocks form a ring
+		Block* const first = block;
+		do
+		{
+			Block* next = block->next;
+			std::allocator_traits<BlockAllocator>::deallocate(m_blockAllocator, block, 1);
+			block = next;
+		} while (block != first);
+
+		SubQueue* next = subQueue->next;
+		std::allocator_traits<SubQueueAllocator>::destroy(m_subQueueAllocator, subQueue);
+		std::allocator_traits<SubQueueAllocator>::deallocate(m_subQueueAllocator, subQueue, 1);
+		subQueue = next;
+	}
+}
+
+template <class T, class Allocator>
+typename ConcurrentQueue<T, Allocator>::Block* ConcurrentQueue<T, Allocator>::allocateBlock()
+{
+	Block* block = std::allocator_traits<BlockAllocator>::allocate(m_blockAllocator, 1);
+	block->next = block;
+	return block;
+}
+
+/**
+ * Returns a sub-queue for a new producer: one a finished producer has left
+ * (with its items and blocks) or a new one
+ */
+template <class T, class Allocator>
+typename ConcurrentQueue<T, Allocator>::SubQueue* ConcurrentQueue<T, Allocator>::acquireSubQueue()
+{
+	for (SubQueue* subQueue = m_subQueues.load(std::memory_order_acquire); subQueue != nullptr; subQueue = subQueue->next)
+	{
+		bool owned = false;
+		if (!subQueue->owned.load(std::memory_order_relaxed) &&
+			subQueue->owned.compare_exchange_strong(owned, true, std::memory_order_acquire, std::memory_order_relaxed))
+			return subQueue;
+	}
+
+	Block* block = allocateBlock();
+	SubQueue* subQueue;
+	try
+	{
+		subQueue = std::allocator_traits<SubQueueAllocator>::allocate(m_subQueueAllocator, 1);
+	}
+	catch (...)
+	{
+		std::allocator_traits<BlockAllocator>::deallocate(m_blockAllocator, block, 1);
+		throw;
+	}
+	std::allocator_traits<SubQueueAllocator>::construct(m_subQueueAllocator, subQueue, block);
+
+	subQueue->next = m_subQueues.load(std::memory_order_relaxed);
+	while (!m_subQueues.compare_exchange_weak(subQueue->next, subQueue, std::memory_order_release, std::memory_order_relaxed))
+	{
+	}
+	m_subQueueCount.fetch_add(1, std::memory_order_relaxed);
+
+	return subQueue;
+}
+
+/**
+ * Returns a handle for the calling thread to add items. A handle must be used
+ * by one thread at a time and destroyed before the queue
+ */
+template <class T, class Allocator>
+typename ConcurrentQueue<T, Allocator>::Producer ConcurrentQueue<T, Allocator>::makeProducer()
+{
+	return Producer(this, acquireSubQueue());
+}
+
+/**
+ * Moves the producer to the next block of its ring when the tail block is full.
+ * A block is reused unless the consumers still read it, then a new one is linked in
+ */
+template <class T, class Allocator>
+void ConcurrentQueue<T, Allocator>::advanceTail(SubQueue& subQueue)
+{
+	Block* next = subQueue.tailBlock->next;
+
+	if (next == subQueue.frontBlock.load(std::memory_order_acquire))
+	{
+		Block* block = allocateBlock();
+		block->next = next;
+		subQueue.tailBlock->next = block;
+		next = block;
+	}
+
+	subQueue.tailBlock = next;
+	subQueue.tailIndex = 0;
+}
+
+/**
+ * Moves up to @count items of @subQueue to @out, the caller holds the sub-queue.
+ * Returns the number of items taken
+ */
+template <class T, class Allocator>
+template <class OutputIterator>
+std::size_t ConcurrentQueue<T, Allocator>::takeItems(SubQueue& subQueue, OutputIterator& out, std::size_t count)
+{
+	const std::size_t dequeued = subQueue.dequeued.load(std::memory_order_relaxed);
+	const std::size_t ready = subQueue.enqueued.load(std::memory_order_acquire) - dequeued;
+	const std::size_t taken = (ready < count) ? ready : count;
+
+	Block* block = subQueue.frontBlock.load(std::memory_order_relaxed);
+	std::size_t index = subQueue.frontIndex;
+	std::size_t moved = 0;
+
+	try
+	{
+		for (; moved < taken; ++moved, ++index, ++out)
+		{
+			// The producer has linked the next block before it published items in it
+			if (index == concurrent_queue::constants::block_size)
+			{
+				block = block->next;
+				index = 0;
+				subQueue.frontBlock.store(block, std::memory_order_release);
+			}
+
+			*out = std::move(*block->item(index));
+			std::allocator_traits<Allocator>::destroy(m_allocator, block->item(index));
+		}
+	}
+	catch (...)
+	{
+		// The item that failed to move stays at the front
+		subQueue.frontIndex = index;
+		subQueue.dequeued.store(dequeued + moved, std::memory_order_release);
+		throw;
+	}
+
+	subQueue.frontIndex = index;
+	subQueue.dequeued.store(dequeued + taken, std::memory_order_release);
+	return taken;
+}
+
+/**
+ * Returns @true if the queue is empty at the moment of the call
+ */
+template <class T, class Allocator>
+bool ConcurrentQueue<T, Allocator>::isEmpty() const noexcept
+{
+	return getSize() == 0;
+}
+
+/**
+ * Returns the number of items, sub-queue by sub-queue, so it is only
+ * exact while no thread uses the queue
+ */
+template <class T, class Allocator>
+std::size_t ConcurrentQueue<T, Allocator>::getSize() const noexcept
+{
+	std::size_t size = 0;
+	for (SubQueue* subQueue = m_subQueues.load(std::memory_order_acquire); subQueue != nullptr; subQueue = subQueue->next)
+	{
+		// The dequeued count is loaded first, so it never is ahead of the enqueued one
+		const std::size_t dequeued = subQueue->dequeued.load(std::memory_order_acquire);
+		size += subQueue->enqueued.load(std::memory_order_acquire) - dequeued;
+	}
+
+	return size;
+}
+
+/**
+ * Returns the allocator of the queue
+ */
+template <class T, class Allocator>
+Allocator ConcurrentQueue<T, Allocator>::getAllocator() const noexcept
+{
+	return m_allocator;
+}
+
+/**
+ * Moves an item to @item and returns @true, returns @false if the queue is empty
+ */
+template <class T, class Allocator>
+bool ConcurrentQueue<T, Allocator>::tryDequeue(T& item)
+{
+	return tryDequeueBulk(&item, 1) == 1;
+}
+
+/**
+ * Moves up to @count items to @out, taking whole runs from each sub-queue.
+ * Returns the number of items taken, 0 if the queue is empty
+ */
+template <class T, class Allocator>
+template <class OutputIterator>
+std::size_t ConcurrentQueue<T, Allocator>::tryDequeueBulk(OutputIterator out, std::size_t count)
+{
+	// Every call of a thread starts at another sub-queue, so no producer is left behind
+	static thread_local std::size_t rotation = 0;
+	const std::size_t subQueueCount = m_subQueueCount.load(std::memory_order_relaxed);
+	SubQueue* const first = m_subQueues.load(std::memory_order_acquire);
+	if (first == nullptr || count == 0)
+		return 0;
+
+	// The count is raised after a new sub-queue is linked in, so it may lag behind
+	SubQueue* start = first;
+	for (std::size_t skip = rotation++ % (subQueueCount + 1); skip > 0 && start->next != nullptr; --skip)
+		start = start->next;
+
+	std::size_t taken = 0;
+	for (;;)
+	{
+		bool contended = false;
+		SubQueue* subQueue = start;
+
+		do
+		{
+			// Sub-queues that look empty are skipped without writing to them
+			if (subQueue->enqueued.load(std::memory_order_relaxed) != subQueue->dequeued.load(std::memory_order_relaxed))
+			{
+				if (subQueue->busy.exchange(true, std::memory_order_acquire))
+					contended = true;
+				else
+				{
+					try
+					{
+						taken += takeItems(*subQueue, out, count - taken);
+					}
+					catch (...)
+					{
+						subQueue->busy.store(false, std::memory_order_release);
+						throw;
+					}
+					subQueue->busy.store(false, std::memory_order_release);
+				}
+			}
+
+			subQueue = (subQueue->next != nullptr) ? subQueue->next : first;
+		} while (subQueue != start && taken < count);
+
+		// A sub-queue held by another consumer may still have items
+		if (taken > 0 || !contended)
+			return taken;
+	}
+}
+
+template <class T, class Allocator>
+ConcurrentQueue<T, Allocator>::Producer::Producer(Producer&& producer) noexcept
+	: m_queue(producer.m_queue), m_subQueue(producer.m_subQueue)
+{
+	producer.m_subQueue = nullptr;
+}
+
+template <class T, class Allocator>
+typename ConcurrentQueue<T, Allocator>::Producer& ConcurrentQueue<T, Allocator>::Producer::operator=(Producer&& producer) noexcept
+{
+	std::swap(m_queue, producer.m_queue);
+	std::swap(m_subQueue, producer.m_subQueue);
+	return *this;
+}
+
+/**
+ * Destructor, leaves the sub-queue with its items to the next producer
+ */
+template <class T, class Allocator>
+ConcurrentQueue<T, Allocator>::Producer::~Producer()
+{
+	if (m_subQueue != nullptr)
+		m_subQueue->owned.store(false, std::memory_order_release);
+}
+
+/**
+ * Adds @item to the end of the producer's sub-queue
+ */
+template <class T, class Allocator>
+void ConcurrentQueue<T, Allocator>::Producer::enqueue(const T& item)
+{
+	emplace(item);
+}
+
+/**
+ * Moves @item to the end of the producer's sub-queue
+ */
+template <class T, class Allocator>
+void ConcurrentQueue<T, Allocator>::Producer::enqueue(T&& item)
+{
+	emplace(std::move(item));
+}
+
+/**
+ * Constructs an item from @args at the end of the producer's sub-queue
+ */
+template <class T, class Allocator>
+template <class... Args>
+void ConcurrentQueue<T, Allocator>::Producer::emplace(Args&&... args)
+{
+	SubQueue& subQueue = *m_subQueue;
+	if (subQueue.tailIndex == concurrent_queue::constants::block_size)
+		m_queue->advanceTail(subQueue);
+
+	std::allocator_traits<Allocator>::construct(m_queue->m_allocator,
+		subQueue.tailBlock->item(subQueue.tailIndex), std::forward<Args>(args)...);
+	++subQueue.tailIndex;
+	subQueue.enqueued.store(subQueue.enqueued.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+/**
+ * Adds @count items read from @first and publishes them at once
+ */
+template <class T, class Allocator>
+template <class InputIterator>
+void ConcurrentQueue<T, Allocator>::Producer::enqueueBulk(InputIterator first, std::size_t count)
+{
+	SubQueue& subQueue = *m_subQueue;
+	const std::size_t enqueued = subQueue.enqueued.load(std::memory_order_relaxed);
+	std::size_t added = 0;
+
+	try
+	{
+		for (; added < count; ++added, ++first)
+		{
+			if (subQueue.tailIndex == concurrent_queue::constants::block_size)
+				m_queue->advanceTail(subQueue);
+
+			std::allocator_traits<Allocator>::construct(m_queue->m_allocator,
+				subQueue.tailBlock->item(subQueue.tailIndex), *first);
+			++subQueue.tailIndex;
+		}
+	}
+	catch (...)
+	{
+		// The items constructed before the failure stay in the queue
+		subQueue.enqueued.store(enqueued + added, std::memory_order_release);
+		throw;
+	}
+
+	subQueue.enqueued.store(enqueued + count, std::memory_order_release);
+}
+
+#if DATA_STRUCTURES_PMR
+namespace pmr
+{
+	template <class T>
+	using ConcurrentQueue = ::ConcurrentQueue<T, std::pmr::polymorphic_allocator<T>>;
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,282 @@
+﻿/**
+ * @author Dreadblade- (https://github.com/Dreadblade-dev)
+ * Lock-free concurrent stack
+ *
+ * Treiber stack: the items are linked nodes and the top of the stack is
+ * one atomic pointer, push and pop replace it with compare-and-swap.
+ * Popped nodes are reclaimed with hazard pointers, which also protects
+ * the compare-and-swap from the ABA problem.
+ *
+ * Under contention every thread fights for the same pointer. A thread
+ * whose compare-and-swap failed tries the elimination array instead:
+ * a push parks its node in a random slot for a moment and a pop that
+ * finds it there takes it, so the pair completes without touching
+ * the top of the stack at all.
+ *
+ * Time complexity:
+ * ┌───────────┬──────────┐
+ * │ Insertion │ Deletion │
+ * │───────────┼──────────│
+ * │    O(1)   │   O(1)   │
+ * └───────────┴──────────┘
+ * (plus retries under contention, lock-free)
+ *
+ * Source: https://en.wikipedia.org/wiki/Treiber_stack
+ */
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <utility>
+#include "exceptions.h"
+#include "hazard_pointer.h"
+
+namespace concurrent_stack
+{
+	struct constants
+	{
+		static const std::size_t elimination_slots = 16;
+		static const unsigned elimination_spins = 128;
+		static const std::size_t cache_line = 64;
+	};
+
+	/**
+	 * Returns a random slot of the elimination array (xorshift per thread)
+	 */
+	inline std::size_t randomSlot() noexcept
+	{
+		static thread_local uint32_t state = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(&state) >> 4) | 1;
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return state % constants::elimination_slots;
+	}
+
+	struct alignas(constants::cache_line) Slot
+	{
+		std::atomic<void*> offer;
+	};
+}
+
+template <class T>
+class ConcurrentStack
+{
+private:
+	struct Node
+	{
+		T data;
+		Node* next;
+
+		template <class... Args>
+		Node(Args&&... args) : data(std::forward<Args>(args)...), next(nullptr) {}
+	};
+
+	alignas(concurrent_stack::constants::cache_line) std::atomic<Node*> m_head;
+	concurrent_stack::Slot m_slots[concurrent_stack::constants::elimination_slots];
+
+	static void* taken() noexcept;
+	void push(Node* node);
+	bool eliminatePush(Node* node);
+	bool eliminatePop(T& item);
+public:
+	ConcurrentStack() noexcept;
+	ConcurrentStack(const ConcurrentStack<T>&) = delete;
+	ConcurrentStack<T>& operator=(const ConcurrentStack<T>&) = delete;
+	~ConcurrentStack();
+	bool isEmpty() const noexcept;
+	void push_back(const T& item);
+	void push_back(T&& item);
+	template <class... Args>
+	void emplace_back(Args&&... args);
+	bool tryPop(T& item);
+	T pop();
+};
+
+/**
+ * Default constructor, creates empty stack
+ */
+template <class T>
+ConcurrentStack<T>::ConcurrentStack() noexcept : m_head(nullptr)
+{
+	for (concurrent_stack::Slot& slot : m_slots)
+		slot.offer.store(nullptr, std::memory_order_relaxed);
+}
+
+/**
+ * Destructor, no other thread may use the stack anymore
+ */
+template <class T>
+ConcurrentStack<T>::~ConcurrentStack()
+{
+	Node* node = m_head.load(std::memory_order_acquire);
+	while (node != nullptr)
+	{
+		Node* next = node->next;
+		delete node;
+		node = next;
+	}
+}
+
+/**
+ * Marks an elimination slot whose node was taken by a pop
+ */
+template <class T>
+void* ConcurrentStack<T>::taken() noexcept
+{
+	static char marker;
+	return &marker;
+}
+
+/**
+ * Returns @true if the stack is empty at the moment of the call
+ */
+template <class T>
+bool ConcurrentStack<T>::isEmpty() const noexcept
+{
+	return m_head.load(std::memory_order_acquire) == nullptr;
+}
+
+/**
+ * Adds an @item to the stack
+ */
+template <class T>
+void ConcurrentStack<T>::push_back(const T& item)
+{
+	push(new Node(item));
+}
+
+/**
+ * Moves an @item to the stack
+ */
+template <class T>
+void ConcurrentStack<T>::push_back(T&& item)
+{
+	push(new Node(std::move(item)));
+}
+
+/**
+ * Constructs an item from @args on top of the stack
+ */
+template <class T>
+template <class... Args>
+void ConcurrentStack<T>::emplace_back(Args&&... args)
+{
+	push(new Node(std::forward<Args>(args)...));
+}
+
+template <class T>
+void ConcurrentStack<T>::push(Node* node)
+{
+	Node* head = m_head.load(std::memory_order_relaxed);
+
+	for (;;)
+	{
+		node->next = head;
+		if (m_head.compare_exchange_weak(head, node, std::memory_order_release, std::memory_order_relaxed))
+			return;
+
+		if (eliminatePush(node))
+			return;
+
+		head = m_head.load(std::memory_order_relaxed);
+	}
+}
+
+/**
+ * Offers @node in a random elimination slot for a short while.
+ * Returns @true if a pop took it
+ */
+template <class T>
+bool ConcurrentStack<T>::eliminatePush(Node* node)
+{
+	std::atomic<void*>& offer = m_slots[concurrent_stack::randomSlot()].offer;
+
+	void* expected = nullptr;
+	if (!offer.compare_exchange_strong(expected, node, std::memory_order_release, std::memory_order_relaxed))
+		return false;
+
+	for (unsigned spin = 0; spin < concurrent_stack::constants::elimination_spins; ++spin)
+	{
+		if (offer.load(std::memory_order_acquire) == taken())
+		{
+			offer.store(nullptr, std::memory_order_relaxed);
+			return true;
+		}
+	}
+
+	// Withdraw the offer, unless a pop took the node in the meantime
+	expected = node;
+	if (offer.compare_exchange_strong(expected, nullptr, std::memory_order_relaxed))
+		return false;
+
+	offer.store(nullptr, std::memory_order_relaxed);
+	return true;
+}
+
+/**
+ * Takes a node offered by a concurrent push, if there is one in a random slot
+ */
+template <class T>
+bool ConcurrentStack<T>::eliminatePop(T& item)
+{
+	std::atomic<void*>& offer = m_slots[concurrent_stack::randomSlot()].offer;
+
+	void* node = offer.load(std::memory_order_acquire);
+	if (node == nullptr || node == taken())
+		return false;
+
+	if (!offer.compare_exchange_strong(node, taken(), std::memory_order_acquire, std::memory_order_relaxed))
+		return false;
+
+	// The node never was in the stack, no other thread can see it
+	Node* offered = static_cast<Node*>(node);
+	item = std::move(offered->data);
+	delete offered;
+	return true;
+}
+
+/**
+ * Moves the last added item to @item and returns @true,
+ * returns @false if the stack is empty
+ */
+template <class T>
+bool ConcurrentStack<T>::tryPop(T& item)
+{
+	for (;;)
+	{
+		Node* head = hazard_pointer::protect(m_head, 0);
+		if (head == nullptr)
+		{
+			hazard_pointer::clear(0);
+			return eliminatePop(item);
+		}
+
+		Node* next = head->next;
+		if (m_head.compare_exchange_strong(head, next, std::memory_order_acquire, std::memory_order_relaxed))
+		{
+			hazard_pointer::clear(0);
+			item = std::move(head->data);
+			hazard_pointer::retire(head);
+			return true;
+		}
+
+		if (eliminatePop(item))
+		{
+			hazard_pointer::clear(0);
+			return true;
+		}
+	}
+}
+
+/**
+ * Deletes the last added item from the stack and returns it
+ */
+template <class T>
+T ConcurrentStack<T>::pop()
+{
+	T item;
+	if (!tryPop(item))
+		throw StackEmptyException();
+
+	return item;
+}
\ No newline at end of file
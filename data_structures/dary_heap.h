@@ -0,0 +1,442 @@
+﻿/**
+ * @author Dreadblade- (https://github.com/Dreadblade-dev)
+ * d-ary heap with handles
+ *
+ * A priority queue kept as an implicit heap in one array: the children
+ * of position i are the @Arity positions starting at Arity * i + 1, so
+ * the top is the smallest item by @Compare. With four or eight children
+ * the heap is two or three times flatter than a binary one, and the
+ * children that pop() compares are neighbours in memory, mostly on a
+ * single cache line. Sifting moves a hole instead of swapping items.
+ *
+ * push() returns a handle that stays attached to the item while it is in
+ * the heap. An index map from handles to array positions lets
+ * decreaseKey() and erase() find the item in O(1) before sifting it,
+ * as Dijkstra's and Prim's algorithms and timer schedulers need.
+ * Handles of popped or erased items are reused.
+ *
+ * A range is turned into a heap in O(n) by sifting down from the last
+ * parent (Floyd's method).
+ *
+ * Time complexity (d - arity):
+ * ┌───────────┬──────────────┬──────────────┬──────────────┬───────────┐
+ * │    Top    │     Push     │     Pop      │ Decrease key │  Heapify  │
+ * ├───────────┼──────────────┼──────────────┼──────────────┼───────────┤
+ * │   O(1)    │ O(log_d(n))  │ O(d log_d n) │ O(log_d(n))  │   O(n)    │
+ * └───────────┴──────────────┴──────────────┴──────────────┴───────────┘
+ *
+ * Source: https://en.wikipedia.org/wiki/D-ary_heap
+ */
+
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "exceptions.h"
+#include "memory_resource.h"
+
+namespace dary_heap
+{
+	struct constants
+	{
+		static const std::size_t npos = static_cast<std::size_t>(-1);
+	};
+}
+
+template <class T, std::size_t Arity = 4, class Compare = std::less<T>, class Allocator = std::allocator<T>>
+class DaryHeap
+{
+	static_assert(Arity >= 2, "A heap needs at least two children per node");
+public:
+	using Handle = std::size_t;
+private:
+	struct Entry
+	{
+		T item;
+		Handle handle;
+
+		template <class... Args>
+		Entry(Handle handle, Args&&... args) : item(std::forward<Args>(args)...), handle(handle) {}
+	};
+
+	using EntryAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Entry>;
+	using IndexAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<std::size_t>;
+
+	std::vector<Entry, EntryAllocator> m_entries;
+	// Position of every handle in @m_entries, npos for free handles
+	std::vector<std::size_t, IndexAllocator> m_positions;
+	std::vector<Handle, IndexAllocator> m_freeHandles;
+	Compare m_compare;
+
+	Handle newHandle();
+	void place(Entry&& entry, std::size_t position);
+	void siftUp(std::size_t position);
+	void siftDown(std::size_t position);
+	std::size_t positionOf(Handle handle) const;
+	T removeAt(std::size_t position);
+public:
+	explicit DaryHeap(const Compare& compare = Compare(), const Allocator& allocator = Allocator());
+	template <class InputIterator>
+	DaryHeap(InputIterator first, InputIterator last, const Compare& compare = Compare(), const Allocator& allocator = Allocator());
+
+	bool isEmpty() const noexcept;
+	std::size_t getSize() const noexcept;
+	void clear() noexcept;
+	void reserve(std::size_t capacity);
+
+	Handle push(const T& item);
+	Handle push(T&& item);
+	template <class... Args>
+	Handle emplace(Args&&... args);
+	const T& top() const;
+	Handle topHandle() const;
+	T pop();
+
+	bool contains(Handle handle) const noexcept;
+	const T& get(Handle handle) const;
+	void decreaseKey(Handle handle, const T& item);
+	void decreaseKey(Handle handle, T&& item);
+	void update(Handle handle, const T& item);
+	T erase(Handle handle);
+};
+
+/**
+ * Default constructor, creates empty heap ordered by @compare
+ */
+template <class T, std::size_t Arity, class Compare, class Allocator>
+DaryHeap<T, Arity, Compare, Allocator>::DaryHeap(const Compare& compare, const Allocator& allocator)
+	: m_entries(EntryAllocator(allocator)), m_positions(IndexAllocator(allocator)),
+	m_freeHandles(IndexAllocator(allocator)), m_compare(compare)
+{
+
+}
+
+/**
+ * Creates heap of the items from @first to @last in linear time.
+ * The items get the handles 0, 1, 2... in the order of the range
+ */
+template <class T, std::size_t Arity, class Compare, class Allocator>
+template <class InputIterator>
+DaryHeap<T, Arity, Compare, Allocator>::DaryHeap(InputIterator first, InputIterator last, const Compare& compare, const Allocator& allocator)
+	: DaryHeap(compare, allocator)
+{
+	for (; first != last; ++first)
+	{
+		m_entries.emplace_back(m_entries.size(), *first);
+		m_positions.push_back(m_positions.size());
+	}
+
+	const std::size_t size = m_entries.size();
+	if (size < 2)
+		return;
+
+	// Floyd: every parent from the last one up to the root is sifted down
+	for (std::size_t parent = (size - 2) / Arity + 1; parent > 0; --parent)
+		siftDown(parent - 1);
+}
+
+/**
+ * Returns @true if the heap is empty
+ */
+template <class T, std::size_t Arity, class Compare, class Allocator>
+bool DaryHeap<T, Arity, Compare, Allocator>::isEmpty() const noexcept
+{
+	return m_entries.empty();
+}
+
+/**
+ * Returns heap size
+ */
+template <class T, std::size_t Arity, class Compare, class Allocator>
+std::size_t DaryHeap<T, Arity, Compare, Allocator>::getSize() const noexcept
+{
+	return m_entries.size();
+}
+
+/**
+ * Clears the heap, every handle becomes invalid
+ */
+template <class T, std::size_t Arity, class Compare, class Allocator>
+void DaryHeap<T, Arity, Compare, Allocator>::clear() noexcept
+{
+	m_entries.clear();
+	m_positions.clear();
+	m_freeHandles.clear();
+}
+
+/**
+ * Reserves memory for @capacity items, so pushes up to it do not reallocate
+ */
+template <class T, std::size_t Arity, class Compare, class Allocator>
+void DaryHeap<T, Arity, Compare, Allocator>::reserve(std::size_t capacity)
+{
+	m_entries.reserve(capacity);
+	m_positions.reserve(capacity);
+}
+
+template <class T, std::size_t Arity, class Compare, class Allocator>
+typename DaryHeap<T, Arity, Compare, Allocator>::Handle DaryHeap<T, Arity, Compare, Allocator>::newHandle()
+{
+	if (!m_freeHandles.empty())
+	{
+		const Handle handle = m_freeHandles.back();
+		m_freeHandles.pop_back();
+		return handle;
+	}
+
+	m_positions.push_back(std::size_t(dary_heap::constants::npos));
+	return m_positions.size() - 1;
+}
+
+/**
+ * Moves @entry into the hole at @position and records its position
+ */
+template <class T, std::size_t Arity, class Compare, class Allocator>
+void DaryHeap<T, Arity, Compare, Allocator>::place(Entry&& entry, std::size_t position)
+{
+	m_positions[entry.handle] = position;
+	m_entries[position] = std::move(entry);
+}
+
+/**
+ * Moves the entry at @position up while it is smaller than its parent
+ */
+template <class T, std::size_t Arity, class Compare, class Allocator>
+void DaryHeap<T, Arity, Compare, Allocator>::siftUp(std::size_t position)
+{
+	Entry entry = std::move(m_entries[position]);
+
+	while (position > 0)
+	{
+		const std::size_t parent = (position - 1) / Arity;
+		if (!m_compare(entry.item, m_entries[parent].item))
+			break;
+
+		place(std::move(m_entries[parent]), position);
+		position = parent;
+	}
+
+	place(std::move(entry), position);
+}
+
+/**
+ * Moves the entry at @position down while one of its children is smaller
+ */
+template <class T, std::size_t Arity, class Compare, class Allocator>
+void DaryHeap<T, Arity, Compare, Allocator>::siftDown(std::size_t position)
+{
+	const std::size_t size = m_entries.size();
+	Entry entry = std::move(m_entries[position]);
+
+	for (;;)
+	{
+		const std::size_t first = Arity * position + 1;
+		if (first >= size)
+			break;
+
+		// The children are adjacent, the smallest of them is found in one pass
+		const std::size_t last = (first + Arity < size) ? first + Arity : size;
+		std::size_t smallest = first;
+		for (std::size_t child = first + 1; child < last; ++child)
+			if (m_compare(m_entries[child].item, m_entries[smallest].item))
+				smallest = child;
+
+		if (!m_compare(m_entries[smallest].item, entry.item))
+			break;
+
+		place(std::move(m_entries[smallest]), position);
+		position = smallest;
+	}
+
+	place(std::move(entry), position);
+}
+
+/**
+ * Returns the array position of the item with @handle
+ */
+template <class T, std::size_t Arity, class Compare, class Allocator>
+std::size_t DaryHeap<T, Arity, Compare, Allocator>::positionOf(Handle handle) const
+{
+	if (!contains(handle))
+		throw std::out_of_range("DaryHeap: the handle is not in the heap");
+
+	return m_positions[handle];
+}
+
+/**
+ * Removes the entry at @position and returns its item, the last entry fills its place
+ */
+template <class T, std::size_t Arity, class Compare, class Allocator>
+T DaryHeap<T, Arity, Compare, Allocator>::removeAt(std::size_t position)
+{
+	T item = std::move(m_entries[position].item);
+	m_positions[m_entries[position].handle] = dary_heap::constants::npos;
+	m_freeHandles.push_back(m_entries[position].handle);
+
+	const std::size_t last = m_entries.size() - 1;
+	if (position != last)
+	{
+		const bool smaller = m_compare(m_entries[last].item, item);
+		place(std::move(m_entries[last]), position);
+		m_entries.pop_back();
+
+		if (smaller)
+			siftUp(position);
+		else
+			siftDown(position);
+		return item;
+	}
+
+	m_entries.pop_back();
+	return item;
+}
+
+/**
+ * Adds @item to the heap and returns its handle
+ */
+template <class T, std::size_t Arity, class Compare, class Allocator>
+typename DaryHeap<T, Arity, Compare, Allocator>::Handle DaryHeap<T, Arity, Compare, Allocator>::push(const T& item)
+{
+	return emplace(item);
+}
+
+/**
+ * Moves @item to the heap and returns its handle
+ */
+template <class T, std::size_t Arity, class Compare, class Allocator>
+typename DaryHeap<T, Arity, Compare, Allocator>::Handle DaryHeap<T, Arity, Compare, Allocator>::push(T&& item)
+{
+	return emplace(std::move(item));
+}
+
+/**
+ * Constructs an item from @args in the heap and returns its handle
+ */
+template <class T, std::size_t Arity, class Compare, class Allocator>
+template <class... Args>
+typename DaryHeap<T, Arity, Compare, Allocator>::Handle DaryHeap<T, Arity, Compare, Allocator>::emplace(Args&&... args)
+{
+	const Handle handle = newHandle();
+	try
+	{
+		m_entries.emplace_back(handle, std::forward<Args>(args)...);
+	}
+	catch (...)
+	{
+		m_freeHandles.push_back(handle);
+		throw;
+	}
+
+	siftUp(m_entries.size() - 1);
+	return handle;
+}
+
+/**
+ * Returns the smallest item
+ */
+template <class T, std::size_t Arity, class Compare, class Allocator>
+const T& DaryHeap<T, Arity, Compare, Allocator>::top() const
+{
+	if (isEmpty())
+		throw HeapEmptyException();
+
+	return m_entries.front().item;
+}
+
+/**
+ * Returns the handle of the smallest item
+ */
+template <class T, std::size_t Arity, class Compare, class Allocator>
+typename DaryHeap<T, Arity, Compare, Allocator>::Handle DaryHeap<T, Arity, Compare, Allocator>::topHandle() const
+{
+	if (isEmpty())
+		throw HeapEmptyException();
+
+	return m_entries.front().handle;
+}
+
+/**
+ * Removes the smallest item from the heap and returns it
+ */
+template <class T, std::size_t Arity, class Compare, class Allocator>
+T DaryHeap<T, Arity, Compare, Allocator>::pop()
+{
+	if (isEmpty())
+		throw HeapEmptyException();
+
+	return removeAt(0);
+}
+
+/**
+ * Returns @true if the item with @handle is in the heap
+ */
+template <class T, std::size_t Arity, class Compare, class Allocator>
+bool DaryHeap<T, Arity, Compare, Allocator>::contains(Handle handle) const noexcept
+{
+	return handle < m_positions.size() && m_positions[handle] != dary_heap::constants::npos;
+}
+
+/**
+ * Returns the item with @handle
+ */
+template <class T, std::size_t Arity, class Compare, class Allocator>
+const T& DaryHeap<T, Arity, Compare, Allocator>::get(Handle handle) const
+{
+	return m_entries[positionOf(handle)].item;
+}
+
+/**
+ * Replaces the item with @handle by @item, which must not be greater
+ */
+template <class T, std::size_t Arity, class Compare, class Allocator>
+void DaryHeap<T, Arity, Compare, Allocator>::decreaseKey(Handle handle, const T& item)
+{
+	const std::size_t position = positionOf(handle);
+	m_entries[position].item = item;
+	siftUp(position);
+}
+
+template <class T, std::size_t Arity, class Compare, class Allocator>
+void DaryHeap<T, Arity, Compare, Allocator>::decreaseKey(Handle handle, T&& item)
+{
+	const std::size_t position = positionOf(handle);
+	m_entries[position].item = std::move(item);
+	siftUp(position);
+}
+
+/**
+ * Replaces the item with @handle by @item, which may be smaller or greater
+ */
+template <class T, std::size_t Arity, class Compare, class Allocator>
+void DaryHeap<T, Arity, Compare, Allocator>::update(Handle handle, const T& item)
+{
+	const std::size_t position = positionOf(handle);
+	const bool smaller = m_compare(item, m_entries[position].item);
+	m_entries[position].item = item;
+
+	if (smaller)
+		siftUp(position);
+	else
+		siftDown(position);
+}
+
+/**
+ * Removes the item with @handle from the heap and returns it
+ */
+template <class T, std::size_t Arity, class Compare, class Allocator>
+T DaryHeap<T, Arity, Compare, Allocator>::erase(Handle handle)
+{
+	return removeAt(positionOf(handle));
+}
+
+#if DATA_STRUCTURES_PMR
+namespace pmr
+{
+	template <class T, std::size_t Arity = 4, class Compare = std::less<T>>
+	using DaryHeap = ::DaryHeap<T, Arity, Compare, std::pmr::polymorphic_allocator<T>>;
+}
+#endif
\ No newline at end of file
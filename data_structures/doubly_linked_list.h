@@ -13,6 +13,8 @@
  * point to some kind of terminator, typically a sentinel node or null,
  * to facilitate traversal of the list.
  *
+ * The nodes are allocated with @Allocator, pmr::DoublyLinkedList takes a memory resource.
+ *
  * Time complexity:
  * ┌───────────────┬───────────┬──────────┐
  * │	    	   │ Insertion │ Deletion │
@@ -29,50 +31,66 @@
 
 #pragma once
 #include <iostream>
+#include <memory>
+#include <type_traits>
 #include "exceptions.h"
+#include "memory_resource.h"
 
-template <class T>
+template <class T, class Allocator = std::allocator<T>>
 class DoublyLinkedList
 {
 private:
-	template <class T>
 	struct Node
 	{
-		Node<T>* prev;
+		Node* prev;
 		T data;
-		Node<T>* next;
+		Node* next;
+
+		Node(const T& item) : prev(nullptr), data(item), next(nullptr) {}
 	};
+
+	using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+	using NodeTraits = std::allocator_traits<NodeAllocator>;
 	
-	Node<T>* m_head;
-	Node<T>* m_tail;
+	Node* m_head;
+	Node* m_tail;
+	NodeAllocator m_allocator;
+
+	Node* createNode(const T& item);
+	void destroyNode(Node* node) noexcept;
+	void copyNodes(const DoublyLinkedList<T, Allocator>& list);
 
 public:
-	DoublyLinkedList();
-	DoublyLinkedList(DoublyLinkedList<T>& list);
-	DoublyLinkedList(DoublyLinkedList<T>&& list) noexcept;
+	explicit DoublyLinkedList(const Allocator& allocator = Allocator());
+	DoublyLinkedList(const DoublyLinkedList<T, Allocator>& list);
+	DoublyLinkedList(DoublyLinkedList<T, Allocator>&& list) noexcept;
 	~DoublyLinkedList();
 	bool isEmpty() const noexcept;
 	bool contains(const T& item) const noexcept;
 	void clear() noexcept;
 	void remove(const T& item); 
-	void insertAtStart(const T& item) noexcept;
-	void insertAtEnd(const T& item) noexcept;
+	void insertAtStart(const T& item);
+	void insertAtEnd(const T& item);
 	void insertAfter(const T& itemBefore, const T& item);
 	void insertBefore(const T& itemAfter, const T& item);
 	void deleteAtStart();
 	void deleteAtEnd();
 	void reverse();
+	Allocator getAllocator() const noexcept;
 
-	DoublyLinkedList<T>& operator=(const DoublyLinkedList<T>& list);
-	DoublyLinkedList<T>& operator=(DoublyLinkedList<T>&& list) noexcept;
+	DoublyLinkedList<T, Allocator>& operator=(const DoublyLinkedList<T, Allocator>& list);
+	DoublyLinkedList<T, Allocator>& operator=(DoublyLinkedList<T, Allocator>&& list) noexcept(std::is_empty<Allocator>::value);
 
-	friend void swap(DoublyLinkedList<T>& l, DoublyLinkedList<T>& r) noexcept
+	/**
+	 * Swaps the nodes, the allocators of @l and @r must compare equal
+	 */
+	friend void swap(DoublyLinkedList<T, Allocator>& l, DoublyLinkedList<T, Allocator>& r) noexcept
 	{
 		std::swap(l.m_head, r.m_head);
 		std::swap(l.m_tail, r.m_tail);
 	}
 	
-	friend std::ostream& operator<<(std::ostream& out, DoublyLinkedList<T>& list)
+	friend std::ostream& operator<<(std::ostream& out, DoublyLinkedList<T, Allocator>& list)
 	{
 		if (list.isEmpty())
 			throw ListEmptyException();
@@ -89,10 +107,11 @@ public:
 };
 
 /**
- * Default constructor, creates empty list
+ * Default constructor, creates empty list that takes its nodes from @allocator
  */
-template <class T>
-DoublyLinkedList<T>::DoublyLinkedList(): m_head(nullptr), m_tail(nullptr)
+template <class T, class Allocator>
+DoublyLinkedList<T, Allocator>::DoublyLinkedList(const Allocator& allocator)
+	: m_head(nullptr), m_tail(nullptr), m_allocator(allocator)
 {
 
 }
@@ -100,43 +119,19 @@ DoublyLinkedList<T>::DoublyLinkedList(): m_head(nullptr), m_tail(nullptr)
 /**
  * Copy assignment constructor
  */
-template <class T>
-DoublyLinkedList<T>::DoublyLinkedList(DoublyLinkedList<T>& list)
+template <class T, class Allocator>
+DoublyLinkedList<T, Allocator>::DoublyLinkedList(const DoublyLinkedList<T, Allocator>& list)
+	: m_head(nullptr), m_tail(nullptr), m_allocator(NodeTraits::select_on_container_copy_construction(list.m_allocator))
 {
-	if (list.isEmpty())
-	{
-		m_head = nullptr;
-		m_tail = nullptr;
-		return;
-	}
-
-	auto currentNode = new Node<T>;
-	auto nodeToCopy = list.m_head;
-
-	currentNode->prev = nullptr;
-	currentNode->data = nodeToCopy->data;
-	m_head = currentNode;
-
-	nodeToCopy = nodeToCopy->next;
-
-	while (nodeToCopy != nullptr)
-	{
-		currentNode->next = new Node<T>;
-		currentNode->next->prev = currentNode;
-		currentNode = currentNode->next;
-		currentNode->data = nodeToCopy->data;
-
-		nodeToCopy = nodeToCopy->next;
-	}
-	currentNode->next = nullptr;
-	m_tail = currentNode;
+	copyNodes(list);
 }
 
 /**
  * Move assignment constructor
  */
-template <class T>
-DoublyLinkedList<T>::DoublyLinkedList(DoublyLinkedList<T>&& list) noexcept
+template <class T, class Allocator>
+DoublyLinkedList<T, Allocator>::DoublyLinkedList(DoublyLinkedList<T, Allocator>&& list) noexcept
+	: m_head(nullptr), m_tail(nullptr), m_allocator(std::move(list.m_allocator))
 {
 	swap(*this, list);
 }
@@ -144,8 +139,8 @@ DoublyLinkedList<T>::DoublyLinkedList(DoublyLinkedList<T>&& list) noexcept
 /**
  * Destructor
  */
-template <class T>
-DoublyLinkedList<T>::~DoublyLinkedList()
+template <class T, class Allocator>
+DoublyLinkedList<T, Allocator>::~DoublyLinkedList()
 {
 	if (isEmpty())
 		return;
@@ -154,17 +149,68 @@ DoublyLinkedList<T>::~DoublyLinkedList()
 	while (currentNode->next != nullptr)
 	{
 		currentNode = currentNode->next;
-		delete currentNode->prev;
+		destroyNode(currentNode->prev);
 	}
 
-	delete currentNode;
+	destroyNode(currentNode);
+}
+
+/**
+ * Allocates a node holding a copy of @item
+ */
+template <class T, class Allocator>
+typename DoublyLinkedList<T, Allocator>::Node* DoublyLinkedList<T, Allocator>::createNode(const T& item)
+{
+	Node* node = NodeTraits::allocate(m_allocator, 1);
+
+	try
+	{
+		NodeTraits::construct(m_allocator, node, item);
+	}
+	catch (...)
+	{
+		NodeTraits::deallocate(m_allocator, node, 1);
+		throw;
+	}
+
+	return node;
+}
+
+template <class T, class Allocator>
+void DoublyLinkedList<T, Allocator>::destroyNode(Node* node) noexcept
+{
+	NodeTraits::destroy(m_allocator, node);
+	NodeTraits::deallocate(m_allocator, node, 1);
+}
+
+/**
+ * Appends copies of the nodes of @list to the empty list
+ */
+template <class T, class Allocator>
+void DoublyLinkedList<T, Allocator>::copyNodes(const DoublyLinkedList<T, Allocator>& list)
+{
+	auto nodeToCopy = list.m_head;
+
+	try
+	{
+		while (nodeToCopy != nullptr)
+		{
+			insertAtEnd(nodeToCopy->data);
+			nodeToCopy = nodeToCopy->next;
+		}
+	}
+	catch (...)
+	{
+		clear();
+		throw;
+	}
 }
 
 /**
  * Returns @true if the list is empty
  */
-template <class T>
-bool DoublyLinkedList<T>::isEmpty() const noexcept
+template <class T, class Allocator>
+bool DoublyLinkedList<T, Allocator>::isEmpty() const noexcept
 {
 	return (m_head == nullptr);
 }
@@ -172,8 +218,8 @@ bool DoublyLinkedList<T>::isEmpty() const noexcept
 /**
  * Returns @true if the list contains @item
  */
-template <class T>
-bool DoublyLinkedList<T>::contains(const T& item) const noexcept
+template <class T, class Allocator>
+bool DoublyLinkedList<T, Allocator>::contains(const T& item) const noexcept
 {
 	if (isEmpty())
 		return false;
@@ -193,8 +239,8 @@ bool DoublyLinkedList<T>::contains(const T& item) const noexcept
 /**
  * Clears the list
  */
-template <class T>
-void DoublyLinkedList<T>::clear() noexcept
+template <class T, class Allocator>
+void DoublyLinkedList<T, Allocator>::clear() noexcept
 {
 	if (isEmpty())
 		return;
@@ -203,10 +249,10 @@ void DoublyLinkedList<T>::clear() noexcept
 	while (currentNode->next != nullptr)
 	{
 		currentNode = currentNode->next;
-		delete currentNode->prev;
+		destroyNode(currentNode->prev);
 	}
 
-	delete currentNode;
+	destroyNode(currentNode);
 	
 	m_head = nullptr;
 	m_tail = nullptr;
@@ -215,8 +261,8 @@ void DoublyLinkedList<T>::clear() noexcept
 /**
  * Removes a node with @item from the list
  */
-template <class T>
-void DoublyLinkedList<T>::remove(const T& item)
+template <class T, class Allocator>
+void DoublyLinkedList<T, Allocator>::remove(const T& item)
 {
 	if (isEmpty())
 		throw ListEmptyException();
@@ -230,21 +276,26 @@ void DoublyLinkedList<T>::remove(const T& item)
 			{
 				if (m_head->next == nullptr)
 				{
-					delete m_head;
+					destroyNode(m_head);
 					m_head = nullptr;
+					m_tail = nullptr;
 					return;
 				}
 				auto head = m_head;
 				m_head = m_head->next;
-				delete head;
+				destroyNode(head);
 				m_head->prev = nullptr;
+				if (m_head == m_tail)
+					m_tail = nullptr;
 				return;
 			}
 			if (currentNode == m_tail)
 			{
 				m_tail = m_tail->prev;
-				delete m_tail->next;
+				destroyNode(m_tail->next);
 				m_tail->next = nullptr;
+				if (m_tail == m_head)
+					m_tail = nullptr;
 				return;
 			}
 			if (currentNode->prev != nullptr)
@@ -253,7 +304,7 @@ void DoublyLinkedList<T>::remove(const T& item)
 			if(currentNode->next != nullptr)
 				currentNode->next->prev = currentNode->prev;
 			
-			delete currentNode;
+			destroyNode(currentNode);
 			return;
 		}
 		currentNode = currentNode->next;
@@ -263,17 +314,18 @@ void DoublyLinkedList<T>::remove(const T& item)
 /**
  * Inserts a new node with @item at the start
  */
-template <class T>
-void DoublyLinkedList<T>::insertAtStart(const T& item) noexcept
+template <class T, class Allocator>
+void DoublyLinkedList<T, Allocator>::insertAtStart(const T& item)
 {
 	if (!isEmpty())
 	{
-		auto newHead = new Node<T>;
+		auto newHead = createNode(item);
 		newHead->prev = nullptr;
 		newHead->next = m_head;
-		newHead->data = item;
 
 		m_head->prev = newHead;
+		if (m_tail == nullptr)
+			m_tail = m_head;
 		
 		m_head = newHead;
 		return;
@@ -281,25 +333,23 @@ void DoublyLinkedList<T>::insertAtStart(const T& item) noexcept
 	
 	if (isEmpty())
 	{
-		m_head = new Node<T>;
+		m_head = createNode(item);
 		m_head->prev = nullptr;
 		m_head->next = nullptr;
-		m_head->data = item;
 	}
 }
 
 /**
  * Inserts a new node with @item at the end
  */
-template <class T>
-void DoublyLinkedList<T>::insertAtEnd(const T& item) noexcept
+template <class T, class Allocator>
+void DoublyLinkedList<T, Allocator>::insertAtEnd(const T& item)
 {
 	if (m_tail != nullptr)
 	{
-		auto newTail = new Node<T>;
+		auto newTail = createNode(item);
 		newTail->prev = m_tail;
 		newTail->next = nullptr;
-		newTail->data = item;
 		m_tail->next = newTail;
 
 		m_tail = newTail;
@@ -308,28 +358,26 @@ void DoublyLinkedList<T>::insertAtEnd(const T& item) noexcept
 	
 	if (m_tail == nullptr && m_head != nullptr)
 	{
-		m_tail = new Node<T>;
+		m_tail = createNode(item);
 		m_tail->prev = m_head;
 		m_tail->next = nullptr;
-		m_tail->data = item;
 		m_head->next = m_tail;
 		return;
 	}
 	
 	if (isEmpty())
 	{
-		m_head = new Node<T>;
+		m_head = createNode(item);
 		m_head->prev = nullptr;
 		m_head->next = nullptr;
-		m_head->data = item;
 	}
 }
 
 /**
  * Inserts a new node with @item after node with data @itemBefore
  */
-template <class T>
-void DoublyLinkedList<T>::insertAfter(const T& itemBefore, const T& item)
+template <class T, class Allocator>
+void DoublyLinkedList<T, Allocator>::insertAfter(const T& itemBefore, const T& item)
 {
 	if (isEmpty())
 		throw ListEmptyException();
@@ -345,8 +393,7 @@ void DoublyLinkedList<T>::insertAfter(const T& itemBefore, const T& item)
 					insertAtEnd(item);
 				else
 				{
-					auto nodeToInsert = new Node<T>;
-					nodeToInsert->data = item;
+					auto nodeToInsert = createNode(item);
 					nodeToInsert->prev = m_head;
 					nodeToInsert->next = m_head->next;
 					m_head->next->prev = nodeToInsert;
@@ -361,8 +408,7 @@ void DoublyLinkedList<T>::insertAfter(const T& itemBefore, const T& item)
 				return;
 			}
 
-			auto nodeToInsert = new Node<T>;
-			nodeToInsert->data = item;
+			auto nodeToInsert = createNode(item);
 			nodeToInsert->prev = currentNode;
 			nodeToInsert->next = currentNode->next;
 			currentNode->next->prev = nodeToInsert;
@@ -375,8 +421,8 @@ void DoublyLinkedList<T>::insertAfter(const T& itemBefore, const T& item)
 /**
  * Inserts a new node with @item before node with data @itemAfter
  */
-template <class T>
-void DoublyLinkedList<T>::insertBefore(const T& itemAfter, const T& item)
+template <class T, class Allocator>
+void DoublyLinkedList<T, Allocator>::insertBefore(const T& itemAfter, const T& item)
 {
 	if (isEmpty())
 		throw ListEmptyException();
@@ -386,8 +432,7 @@ void DoublyLinkedList<T>::insertBefore(const T& itemAfter, const T& item)
 	{
 		if (currentNode->data == itemAfter)
 		{
-			auto nodeToInsert = new Node<T>;
-			nodeToInsert->data = item;
+			auto nodeToInsert = createNode(item);
 			nodeToInsert->next = currentNode;
 			
 
@@ -412,8 +457,8 @@ void DoublyLinkedList<T>::insertBefore(const T& itemAfter, const T& item)
 /**
  * Deletes the node at the start of the list
  */
-template <class T>
-void DoublyLinkedList<T>::deleteAtStart()
+template <class T, class Allocator>
+void DoublyLinkedList<T, Allocator>::deleteAtStart()
 {
 	if (isEmpty())
 		throw ListEmptyException();
@@ -421,21 +466,24 @@ void DoublyLinkedList<T>::deleteAtStart()
 	if (m_tail != nullptr && m_head != nullptr && m_head != m_tail)
 	{
 		m_head = m_head->next;
-		delete m_head->prev;
+		destroyNode(m_head->prev);
 		m_head->prev = nullptr;
+		if (m_head == m_tail)
+			m_tail = nullptr;
 	}
 	else
 	{
-		delete m_head;
+		destroyNode(m_head);
 		m_head = nullptr;
+		m_tail = nullptr;
 	}
 }
 
 /**
  * Deletes the node at the end of the list
  */
-template <class T>
-void DoublyLinkedList<T>::deleteAtEnd()
+template <class T, class Allocator>
+void DoublyLinkedList<T, Allocator>::deleteAtEnd()
 {
 	if (isEmpty())
 		throw ListEmptyException();
@@ -444,20 +492,20 @@ void DoublyLinkedList<T>::deleteAtEnd()
 	{
 		if (m_tail->prev == m_head)
 		{
-			delete m_tail;
+			destroyNode(m_tail);
 			m_tail = nullptr;
 			m_head->next = nullptr;
 		}
 		else
 		{
 			m_tail = m_tail->prev;
-			delete m_tail->next;
+			destroyNode(m_tail->next);
 			m_tail->next = nullptr;
 		}
 	}
 	else
 	{
-		delete m_head;
+		destroyNode(m_head);
 		m_head = nullptr;
 	}
 	
@@ -466,8 +514,8 @@ void DoublyLinkedList<T>::deleteAtEnd()
 /**
  * Reverses the list
  */
-template <class T>
-void DoublyLinkedList<T>::reverse()
+template <class T, class Allocator>
+void DoublyLinkedList<T, Allocator>::reverse()
 {
 	if (isEmpty())
 		throw ListEmptyException();
@@ -486,54 +534,55 @@ void DoublyLinkedList<T>::reverse()
 }
 
 /**
- * Copy assignment operator
+ * Returns the allocator of the list
  */
-template <class T>
-DoublyLinkedList<T>& DoublyLinkedList<T>::operator=(const DoublyLinkedList<T>& list)
+template <class T, class Allocator>
+Allocator DoublyLinkedList<T, Allocator>::getAllocator() const noexcept
 {
-	if (this == &list)
-		return *this;
+	return Allocator(m_allocator);
+}
 
-	if (list.isEmpty())
-	{
-		m_head = nullptr;
-		m_tail = nullptr;
+/**
+ * Copy assignment operator, the list keeps its allocator
+ */
+template <class T, class Allocator>
+DoublyLinkedList<T, Allocator>& DoublyLinkedList<T, Allocator>::operator=(const DoublyLinkedList<T, Allocator>& list)
+{
+	if (this == &list)
 		return *this;
-	}
-
-	auto currentNode = new Node<T>;
-	auto nodeToCopy = list.m_head;
-
-	currentNode->prev = nullptr;
-	currentNode->data = nodeToCopy->data;
-	m_head = currentNode;
 
-	nodeToCopy = nodeToCopy->next;
-
-	while (nodeToCopy != nullptr)
-	{
-		currentNode->next = new Node<T>;
-		currentNode->next->prev = currentNode;
-		currentNode = currentNode->next;
-		currentNode->data = nodeToCopy->data;
-
-		nodeToCopy = nodeToCopy->next;
-	}
-	currentNode->next = nullptr;
-	m_tail = currentNode;
+	clear();
+	copyNodes(list);
 	
 	return *this;
 }
 
 /**
- * Move assignment operator
+ * Move assignment operator. The nodes of @list are taken over when
+ * both allocators are equal, otherwise they are copied
  */
-template <class T>
-DoublyLinkedList<T>& DoublyLinkedList<T>::operator=(DoublyLinkedList<T>&& list) noexcept
+template <class T, class Allocator>
+DoublyLinkedList<T, Allocator>& DoublyLinkedList<T, Allocator>::operator=(DoublyLinkedList<T, Allocator>&& list)
+	noexcept(std::is_empty<Allocator>::value)
 {
 	if (this == &list)
 		return *this;
 
+	if (!(m_allocator == list.m_allocator))
+	{
+		*this = static_cast<const DoublyLinkedList<T, Allocator>&>(list);
+		list.clear();
+		return *this;
+	}
+
 	swap(*this, list);
 	return *this;
-}
\ No newline at end of file
+}
+
+#if DATA_STRUCTURES_PMR
+namespace pmr
+{
+	template <class T>
+	using DoublyLinkedList = ::DoublyLinkedList<T, std::pmr::polymorphic_allocator<T>>;
+}
+#endif
\ No newline at end of file
@@ -13,7 +13,7 @@ public:
 class ListEmptyException : public std::exception
 {
 public:
-	const char* what() const override
+	const char* what() const noexcept override
 	{
 		return "List is empty";
 	}
@@ -26,4 +26,13 @@ public:
 	{
 		return "Queue is empty";
 	}
+};
+
+class HeapEmptyException : public std::exception
+{
+public:
+	const char* what() const noexcept override
+	{
+		return "Heap is empty";
+	}
 };
\ No newline at end of file
@@ -0,0 +1,254 @@
+﻿/**
+ * @author Dreadblade- (https://github.com/Dreadblade-dev)
+ * Hazard pointers
+ *
+ * Lock-free containers cannot free a node as soon as it is unlinked:
+ * another thread may have loaded its address a moment earlier and be
+ * about to read it. Before dereferencing a shared node a thread
+ * publishes its address in one of its hazard slots; an unlinked node is
+ * retired instead of deleted, and retired nodes are freed in batches,
+ * skipping every node that some thread still has in a hazard slot.
+ *
+ * A protected node cannot be freed and reused, which also rules out the
+ * ABA problem of compare-and-swap on its address.
+ *
+ * Every thread owns one record of the process-wide domain for its whole
+ * lifetime; records of finished threads are reused by new ones.
+ *
+ * Time complexity (R - retired nodes of a thread, H - hazard slots of all threads):
+ * ┌────────────────┬────────────────┬────────────────┐
+ * │    Protect     │     Retire     │      Scan      │
+ * ├────────────────┼────────────────┼────────────────┤
+ * │      O(1)      │ O(1) amortized │  O(R log H)    │
+ * └────────────────┴────────────────┴────────────────┘
+ *
+ * Source: https://en.wikipedia.org/wiki/Hazard_pointer
+ */
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace hazard_pointer
+{
+	struct constants
+	{
+		static const std::size_t slots_per_thread = 2;
+		static const std::size_t min_scan_threshold = 64;
+	};
+
+	struct Retired
+	{
+		void* pointer;
+		void (*deleter)(void*);
+	};
+
+	struct Record
+	{
+		std::atomic<void*> hazards[constants::slots_per_thread];
+		std::atomic<bool> active;
+		// Written once before the record is published
+		Record* next;
+		// Only touched by the thread that owns the record
+		std::vector<Retired> retired;
+
+		Record() : active(true), next(nullptr)
+		{
+			for (std::atomic<void*>& hazard : hazards)
+				hazard.store(nullptr, std::memory_order_relaxed);
+		}
+	};
+
+	class Domain
+	{
+	private:
+		std::atomic<Record*> m_records;
+		std::atomic<std::size_t> m_recordCount;
+	public:
+		Domain() noexcept : m_records(nullptr), m_recordCount(0) {}
+		Domain(const Domain&) = delete;
+		Domain& operator=(const Domain&) = delete;
+
+		/**
+		 * Frees the records and everything still retired, no thread may use the domain anymore
+		 */
+		~Domain()
+		{
+			Record* record = m_records.load(std::memory_order_acquire);
+			while (record != nullptr)
+			{
+				Record* next = record->next;
+				for (const Retired& retired : record->retired)
+					retired.deleter(retired.pointer);
+
+				delete record;
+				record = next;
+			}
+		}
+
+		/**
+		 * Returns a record for the calling thread, an inactive one is reused
+		 */
+		Record* acquire()
+		{
+			for (Record* record = m_records.load(std::memory_order_acquire); record != nullptr; record = record->next)
+			{
+				bool active = false;
+				if (!record->active.load(std::memory_order_relaxed) &&
+					record->active.compare_exchange_strong(active, true, std::memory_order_acquire))
+					return record;
+			}
+
+			Record* record = new Record();
+			Record* head = m_records.load(std::memory_order_relaxed);
+			do
+			{
+				record->next = head;
+			} while (!m_records.compare_exchange_weak(head, record, std::memory_order_release, std::memory_order_relaxed));
+
+			m_recordCount.fetch_add(1, std::memory_order_relaxed);
+			return record;
+		}
+
+		/**
+		 * Gives @record back, its retired nodes wait for the next owner
+		 */
+		void release(Record* record) noexcept
+		{
+			for (std::atomic<void*>& hazard : record->hazards)
+				hazard.store(nullptr, std::memory_order_release);
+
+			record->active.store(false, std::memory_order_release);
+		}
+
+		/**
+		 * Frees the retired nodes of @owner that no thread protects
+		 */
+		void scan(Record* owner)
+		{
+			std::vector<void*> hazards;
+			hazards.reserve(m_recordCount.load(std::memory_order_relaxed) * constants::slots_per_thread);
+
+			for (Record* record = m_records.load(std::memory_order_acquire); record != nullptr; record = record->next)
+				for (std::atomic<void*>& hazard : record->hazards)
+				{
+					void* pointer = hazard.load(std::memory_order_seq_cst);
+					if (pointer != nullptr)
+						hazards.push_back(pointer);
+				}
+
+			std::sort(hazards.begin(), hazards.end());
+
+			std::vector<Retired>& retired = owner->retired;
+			std::size_t kept = 0;
+			for (std::size_t count = 0; count < retired.size(); ++count)
+			{
+				if (std::binary_search(hazards.begin(), hazards.end(), retired[count].pointer))
+					retired[kept++] = retired[count];
+				else
+					retired[count].deleter(retired[count].pointer);
+			}
+
+			retired.resize(kept);
+		}
+
+		/**
+		 * Returns how many retired nodes a record collects before scanning,
+		 * proportional to the number of hazard slots so a scan frees most of them
+		 */
+		std::size_t scanThreshold() const noexcept
+		{
+			const std::size_t slots = 2 * m_recordCount.load(std::memory_order_relaxed) * constants::slots_per_thread;
+			return (slots > constants::min_scan_threshold) ? slots : std::size_t(constants::min_scan_threshold);
+		}
+	};
+
+	inline Domain& defaultDomain()
+	{
+		static Domain domain;
+		return domain;
+	}
+
+	/**
+	 * Owns the record of one thread and returns it when the thread exits
+	 */
+	class ThreadRecord
+	{
+	private:
+		Domain& m_domain;
+		Record* m_record;
+	public:
+		explicit ThreadRecord(Domain& domain) : m_domain(domain), m_record(domain.acquire()) {}
+		ThreadRecord(const ThreadRecord&) = delete;
+		ThreadRecord& operator=(const ThreadRecord&) = delete;
+
+		~ThreadRecord()
+		{
+			for (std::atomic<void*>& hazard : m_record->hazards)
+				hazard.store(nullptr, std::memory_order_release);
+
+			m_domain.scan(m_record);
+			m_domain.release(m_record);
+		}
+
+		Record* get() const noexcept
+		{
+			return m_record;
+		}
+	};
+
+	inline Record* threadRecord()
+	{
+		// The domain is created first, so it outlives every thread record
+		static thread_local ThreadRecord record(defaultDomain());
+		return record.get();
+	}
+
+	/**
+	 * Loads @source and publishes it in hazard @slot of the calling thread.
+	 * The returned node stays valid until the slot is cleared
+	 */
+	template <class T>
+	T* protect(const std::atomic<T*>& source, std::size_t slot)
+	{
+		std::atomic<void*>& hazard = threadRecord()->hazards[slot];
+		T* pointer = source.load(std::memory_order_relaxed);
+
+		for (;;)
+		{
+			hazard.store(pointer, std::memory_order_seq_cst);
+			T* current = source.load(std::memory_order_seq_cst);
+			if (current == pointer)
+				return pointer;
+
+			pointer = current;
+		}
+	}
+
+	inline void clear(std::size_t slot) noexcept
+	{
+		threadRecord()->hazards[slot].store(nullptr, std::memory_order_release);
+	}
+
+	template <class T>
+	void deleteNode(void* pointer)
+	{
+		delete static_cast<T*>(pointer);
+	}
+
+	/**
+	 * Hands an unlinked @node over for deletion once no thread protects it
+	 */
+	template <class T>
+	void retire(T* node)
+	{
+		Record* record = threadRecord();
+		record->retired.push_back(Retired{ node, &deleteNode<T> });
+
+		Domain& domain = defaultDomain();
+		if (record->retired.size() >= domain.scanThreshold())
+			domain.scan(record);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,440 @@
+﻿/**
+ * @author Dreadblade- (https://github.com/Dreadblade-dev)
+ * Memory resources for the containers
+ *
+ * Every container takes an allocator as its last template parameter.
+ * With C++17 the containers have std::pmr aliases (pmr::Stack<T> and so on)
+ * and the resources below are std::pmr::memory_resource objects; with C++14
+ * ResourceAllocator<T> plays the part of std::pmr::polymorphic_allocator.
+ *
+ * MonotonicArena hands out memory by bumping a pointer through chunks that
+ * double in size and ignores deallocation. Everything allocated for the
+ * containers of one request is freed at once by release() or the
+ * destructor, without visiting the nodes.
+ *
+ * HugePageResource maps memory in 2 MiB pages (MAP_HUGETLB or transparent
+ * huge pages on Linux, large pages on Windows), best used as the upstream
+ * of an arena, so the containers touch fewer TLB entries.
+ *
+ * Time complexity:
+ * ┌────────────────┬────────────────┬────────────────┐
+ * │   Allocation   │  Deallocation  │    Release     │
+ * ├────────────────┼────────────────┼────────────────┤
+ * │ O(1) amortized │      O(1)      │ O(log(bytes))  │
+ * └────────────────┴────────────────┴────────────────┘
+ *
+ * Source: https://en.cppreference.com/w/cpp/memory/monotonic_buffer_resource
+ */
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+
+#if defined(__has_include)
+#if __has_include(<memory_resource>) && ((defined(_MSVC_LANG) && _MSVC_LANG >= 201703L) || __cplusplus >= 201703L)
+#define DATA_STRUCTURES_PMR 1
+#include <memory_resource>
+#endif
+#endif
+
+#ifndef DATA_STRUCTURES_PMR
+#define DATA_STRUCTURES_PMR 0
+#endif
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#elif defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+namespace memory
+{
+	struct constants
+	{
+		static const std::size_t default_chunk_size = 64 * 1024;
+		static const std::size_t huge_page_size = 2 * 1024 * 1024;
+		static const std::size_t max_alignment = alignof(std::max_align_t);
+	};
+
+#if DATA_STRUCTURES_PMR
+	using MemoryResource = std::pmr::memory_resource;
+
+	inline MemoryResource* newDeleteResource() noexcept
+	{
+		return std::pmr::new_delete_resource();
+	}
+#else
+	/**
+	 * The interface of std::pmr::memory_resource for C++14
+	 */
+	class MemoryResource
+	{
+	public:
+		virtual ~MemoryResource() = default;
+
+		void* allocate(std::size_t bytes, std::size_t alignment = constants::max_alignment)
+		{
+			return do_allocate(bytes, alignment);
+		}
+
+		void deallocate(void* pointer, std::size_t bytes, std::size_t alignment = constants::max_alignment)
+		{
+			do_deallocate(pointer, bytes, alignment);
+		}
+
+		bool is_equal(const MemoryResource& other) const noexcept
+		{
+			return do_is_equal(other);
+		}
+	private:
+		virtual void* do_allocate(std::size_t bytes, std::size_t alignment) = 0;
+		virtual void do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) = 0;
+		virtual bool do_is_equal(const MemoryResource& other) const noexcept = 0;
+	};
+
+	/**
+	 * Global operator new and delete. Without aligned new in C++14
+	 * alignments above max_align_t are not supported
+	 */
+	class NewDeleteResource : public MemoryResource
+	{
+	private:
+		void* do_allocate(std::size_t bytes, std::size_t alignment) override
+		{
+			if (alignment > constants::max_alignment)
+				throw std::bad_alloc();
+
+			return ::operator new(bytes);
+		}
+
+		void do_deallocate(void* pointer, std::size_t, std::size_t) override
+		{
+			::operator delete(pointer);
+		}
+
+		bool do_is_equal(const MemoryResource& other) const noexcept override
+		{
+			return this == &other;
+		}
+	};
+
+	inline MemoryResource* newDeleteResource() noexcept
+	{
+		static NewDeleteResource resource;
+		return &resource;
+	}
+#endif
+
+	inline std::size_t roundUp(std::size_t value, std::size_t multiple) noexcept
+	{
+		return (value + multiple - 1) / multiple * multiple;
+	}
+}
+
+/**
+ * Allocator that forwards to a memory resource, usable as the allocator
+ * of every container. The containers do not take the allocator over on
+ * copy or move assignment, like std::pmr::polymorphic_allocator
+ */
+template <class T>
+class ResourceAllocator
+{
+private:
+	memory::MemoryResource* m_resource;
+public:
+	using value_type = T;
+
+	ResourceAllocator() noexcept : m_resource(memory::newDeleteResource()) {}
+	ResourceAllocator(memory::MemoryResource* resource) noexcept : m_resource(resource) {}
+	template <class U>
+	ResourceAllocator(const ResourceAllocator<U>& other) noexcept : m_resource(other.getResource()) {}
+
+	T* allocate(std::size_t count)
+	{
+		if (count > std::numeric_limits<std::size_t>::max() / sizeof(T))
+			throw std::bad_alloc();
+
+		return static_cast<T*>(m_resource->allocate(count * sizeof(T), alignof(T)));
+	}
+
+	void deallocate(T* pointer, std::size_t count) noexcept
+	{
+		m_resource->deallocate(pointer, count * sizeof(T), alignof(T));
+	}
+
+	memory::MemoryResource* getResource() const noexcept
+	{
+		return m_resource;
+	}
+};
+
+template <class T, class U>
+bool operator==(const ResourceAllocator<T>& l, const ResourceAllocator<U>& r) noexcept
+{
+	return l.getResource() == r.getResource() || l.getResource()->is_equal(*r.getResource());
+}
+
+template <class T, class U>
+bool operator!=(const ResourceAllocator<T>& l, const ResourceAllocator<U>& r) noexcept
+{
+	return !(l == r);
+}
+
+/**
+ * Bump allocator over chunks taken from an upstream resource.
+ * Not thread-safe, one arena serves one request
+ */
+class MonotonicArena : public memory::MemoryResource
+{
+private:
+	struct Chunk
+	{
+		Chunk* previous;
+		std::size_t size;
+	};
+
+	memory::MemoryResource* m_upstream;
+	Chunk* m_chunks;
+	char* m_current;
+	char* m_end;
+	std::size_t m_nextChunkSize;
+	std::size_t m_sizeInBytes;
+
+	void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+	void do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) override;
+	bool do_is_equal(const memory::MemoryResource& other) const noexcept override;
+public:
+	explicit MonotonicArena(std::size_t chunkSize = memory::constants::default_chunk_size,
+		memory::MemoryResource* upstream = memory::newDeleteResource()) noexcept;
+	MonotonicArena(const MonotonicArena&) = delete;
+	MonotonicArena& operator=(const MonotonicArena&) = delete;
+	~MonotonicArena();
+	void release() noexcept;
+	std::size_t getSizeInBytes() const noexcept;
+};
+
+/**
+ * Creates an empty arena, the first chunk of @chunkSize bytes is taken
+ * from @upstream on the first allocation
+ */
+inline MonotonicArena::MonotonicArena(std::size_t chunkSize, memory::MemoryResource* upstream) noexcept
+	: m_upstream(upstream), m_chunks(nullptr), m_current(nullptr), m_end(nullptr),
+	m_nextChunkSize(chunkSize > sizeof(Chunk) ? chunkSize : sizeof(Chunk) + 1), m_sizeInBytes(0)
+{
+}
+
+/**
+ * Destructor, returns every chunk to the upstream resource
+ */
+inline MonotonicArena::~MonotonicArena()
+{
+	release();
+}
+
+/**
+ * Returns @bytes aligned to @alignment from the current chunk,
+ * a chunk twice as large as the previous one is started when it is full
+ */
+inline void* MonotonicArena::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+	const uintptr_t current = reinterpret_cast<uintptr_t>(m_current);
+	const uintptr_t aligned = (current + alignment - 1) & ~uintptr_t(alignment - 1);
+
+	if (m_current != nullptr && aligned + bytes <= reinterpret_cast<uintptr_t>(m_end))
+	{
+		m_current = reinterpret_cast<char*>(aligned + bytes);
+		return reinterpret_cast<void*>(aligned);
+	}
+
+	// Room for the header and for aligning the start of the block
+	const std::size_t needed = sizeof(Chunk) + bytes + alignment;
+	std::size_t size = m_nextChunkSize;
+	while (size < needed)
+		size *= 2;
+
+	Chunk* chunk = static_cast<Chunk*>(m_upstream->allocate(size, memory::constants::max_alignment));
+	chunk->previous = m_chunks;
+	chunk->size = size;
+	m_chunks = chunk;
+	m_sizeInBytes += size;
+	m_nextChunkSize = size * 2;
+
+	const uintptr_t start = reinterpret_cast<uintptr_t>(chunk + 1);
+	const uintptr_t block = (start + alignment - 1) & ~uintptr_t(alignment - 1);
+	m_current = reinterpret_cast<char*>(block + bytes);
+	m_end = reinterpret_cast<char*>(chunk) + size;
+
+	return reinterpret_cast<void*>(block);
+}
+
+/**
+ * Memory is only given back by release()
+ */
+inline void MonotonicArena::do_deallocate(void*, std::size_t, std::size_t)
+{
+}
+
+inline bool MonotonicArena::do_is_equal(const memory::MemoryResource& other) const noexcept
+{
+	return this == &other;
+}
+
+/**
+ * Frees everything allocated from the arena at once. The containers
+ * using it must not be touched afterwards except to be discarded
+ */
+inline void MonotonicArena::release() noexcept
+{
+	while (m_chunks != nullptr)
+	{
+		Chunk* previous = m_chunks->previous;
+		m_upstream->deallocate(m_chunks, m_chunks->size, memory::constants::max_alignment);
+		m_chunks = previous;
+	}
+
+	m_current = nullptr;
+	m_end = nullptr;
+	m_sizeInBytes = 0;
+}
+
+/**
+ * Returns the memory taken from the upstream resource
+ */
+inline std::size_t MonotonicArena::getSizeInBytes() const noexcept
+{
+	return m_sizeInBytes;
+}
+
+/**
+ * Maps memory in huge pages, every allocation is rounded up to whole
+ * 2 MiB pages. Falls back to normal pages when the system has none to give
+ */
+class HugePageResource : public memory::MemoryResource
+{
+private:
+	std::atomic<std::size_t> m_mappedBytes;
+	std::atomic<std::size_t> m_hugePageBytes;
+
+	void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+	void do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) override;
+	bool do_is_equal(const memory::MemoryResource& other) const noexcept override;
+public:
+	HugePageResource() noexcept;
+	HugePageResource(const HugePageResource&) = delete;
+	HugePageResource& operator=(const HugePageResource&) = delete;
+	std::size_t getMappedBytes() const noexcept;
+	std::size_t getHugePageBytes() const noexcept;
+};
+
+inline HugePageResource::HugePageResource() noexcept : m_mappedBytes(0), m_hugePageBytes(0)
+{
+}
+
+/**
+ * Maps @bytes rounded up to whole huge pages, aligned to a huge page
+ */
+inline void* HugePageResource::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+	using constants = memory::constants;
+
+	if (alignment > constants::huge_page_size)
+		throw std::bad_alloc();
+
+	const std::size_t size = memory::roundUp(bytes == 0 ? 1 : bytes, constants::huge_page_size);
+
+#if defined(__linux__)
+	void* pointer = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+	if (pointer != MAP_FAILED)
+	{
+		m_hugePageBytes += size;
+		m_mappedBytes += size;
+		return pointer;
+	}
+
+	// No reserved huge pages: map an aligned range and ask for transparent huge pages
+	char* mapping = static_cast<char*>(mmap(nullptr, size + constants::huge_page_size, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+	if (mapping == MAP_FAILED)
+		throw std::bad_alloc();
+
+	const std::size_t head = memory::roundUp(reinterpret_cast<uintptr_t>(mapping), constants::huge_page_size) -
+		reinterpret_cast<uintptr_t>(mapping);
+	if (head > 0)
+		munmap(mapping, head);
+	munmap(mapping + head + size, constants::huge_page_size - head);
+
+	madvise(mapping + head, size, MADV_HUGEPAGE);
+	m_mappedBytes += size;
+	return mapping + head;
+#elif defined(_WIN32)
+	// Large pages need the SeLockMemoryPrivilege
+	const std::size_t largePage = GetLargePageMinimum();
+	if (largePage != 0)
+	{
+		void* pointer = VirtualAlloc(nullptr, memory::roundUp(size, largePage),
+			MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+		if (pointer != nullptr)
+		{
+			m_hugePageBytes += size;
+			m_mappedBytes += size;
+			return pointer;
+		}
+	}
+
+	void* pointer = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+	if (pointer == nullptr)
+		throw std::bad_alloc();
+
+	m_mappedBytes += size;
+	return pointer;
+#else
+	m_mappedBytes += size;
+	return memory::newDeleteResource()->allocate(size, alignment);
+#endif
+}
+
+/**
+ * Unmaps the pages of an allocation of @bytes
+ */
+inline void HugePageResource::do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment)
+{
+	const std::size_t size = memory::roundUp(bytes == 0 ? 1 : bytes, memory::constants::huge_page_size);
+	m_mappedBytes -= size;
+
+#if defined(__linux__)
+	munmap(pointer, size);
+#elif defined(_WIN32)
+	VirtualFree(pointer, 0, MEM_RELEASE);
+#else
+	memory::newDeleteResource()->deallocate(pointer, size, alignment);
+#endif
+	(void)alignment;
+}
+
+inline bool HugePageResource::do_is_equal(const memory::MemoryResource& other) const noexcept
+{
+	return this == &other;
+}
+
+/**
+ * Returns the bytes currently mapped
+ */
+inline std::size_t HugePageResource::getMappedBytes() const noexcept
+{
+	return m_mappedBytes;
+}
+
+/**
+ * Returns the bytes ever mapped in reserved huge pages
+ * (transparent huge pages are not counted, the kernel decides on those)
+ */
+inline std::size_t HugePageResource::getHugePageBytes() const noexcept
+{
+	return m_hugePageBytes;
+}
\ No newline at end of file
@@ -0,0 +1,393 @@
+﻿/**
+ * @author Dreadblade- (https://github.com/Dreadblade-dev)
+ * Bounded multi-producer multi-consumer queue
+ *
+ * A ring of slots, each with its own sequence number (Vyukov's bounded
+ * queue). A slot whose sequence equals a producer's ticket is free for
+ * that ticket, one that equals the ticket plus one holds an item for the
+ * consumer with that ticket. Producers and consumers claim their ticket
+ * with one compare-and-swap on the tail or the head and then own the
+ * slot; the sequence store that follows hands it over to the other side.
+ * No locks are taken and threads do not wait for each other unless the
+ * queue is full or empty.
+ *
+ * Every slot takes a whole cache line, so threads working on
+ * neighbouring slots do not invalidate each other's lines.
+ *
+ * enqueue() and dequeue() block on a full or empty queue: they park the
+ * thread on an event (futex or atomic wait) that the other side only
+ * signals while somebody is parked.
+ *
+ * Time complexity (lock-free):
+ * ┌───────────┬──────────┐
+ * │ Insertion │ Deletion │
+ * │───────────┼──────────│
+ * │    O(1)   │   O(1)   │
+ * └───────────┴──────────┘
+ *
+ * Source: https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+ */
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "parking.h"
+#include "memory_resource.h"
+
+namespace mpmc_queue
+{
+	struct constants
+	{
+		static const std::size_t cache_line = 64;
+		static const unsigned spins_before_parking = 64;
+	};
+
+	template <class T>
+	struct alignas(constants::cache_line) Slot
+	{
+		std::atomic<std::size_t> sequence;
+		typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+		T* item() noexcept
+		{
+			return reinterpret_cast<T*>(&storage);
+		}
+	};
+}
+
+template <class T, class Allocator = std::allocator<T>>
+class MpmcQueue
+{
+private:
+	using Slot = mpmc_queue::Slot<T>;
+	// The allocator sees plain cache-line-sized chunks, it need not support over-aligned types
+	using Line = typename std::aligned_storage<mpmc_queue::constants::cache_line, alignof(std::max_align_t)>::type;
+	using LineAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Line>;
+
+	alignas(mpmc_queue::constants::cache_line) std::atomic<std::size_t> m_tail;
+	alignas(mpmc_queue::constants::cache_line) std::atomic<std::size_t> m_head;
+
+	// Read-only after construction
+	alignas(mpmc_queue::constants::cache_line) Slot* m_slots;
+	Line* m_allocation;
+	std::size_t m_capacity;
+	Allocator m_allocator;
+	LineAllocator m_lineAllocator;
+
+	alignas(mpmc_queue::constants::cache_line) parking::Event m_notFull;
+	alignas(mpmc_queue::constants::cache_line) parking::Event m_notEmpty;
+
+	template <class... Args>
+	bool push(std::true_type, Args&&... args);
+	template <class... Args>
+	bool push(std::false_type, Args&&... args);
+	Slot* claimTail() noexcept;
+	std::size_t lineCount() const noexcept;
+public:
+	explicit MpmcQueue(std::size_t capacity, const Allocator& allocator = Allocator());
+	MpmcQueue(const MpmcQueue<T, Allocator>&) = delete;
+	MpmcQueue<T, Allocator>& operator=(const MpmcQueue<T, Allocator>&) = delete;
+	~MpmcQueue();
+	bool isEmpty() const noexcept;
+	std::size_t getSize() const noexcept;
+	std::size_t getCapacity() const noexcept;
+	Allocator getAllocator() const noexcept;
+
+	bool tryEnqueue(const T& item);
+	bool tryEnqueue(T&& item);
+	template <class... Args>
+	bool tryEmplace(Args&&... args);
+	bool tryDequeue(T& item);
+
+	void enqueue(const T& item);
+	void enqueue(T&& item);
+	template <class... Args>
+	void emplace(Args&&... args);
+	T dequeue();
+};
+
+/**
+ * Creates queue for at least @capacity items (at least two),
+ * rounded up to a power of two
+ */
+template <class T, class Allocator>
+MpmcQueue<T, Allocator>::MpmcQueue(std::size_t capacity, const Allocator& allocator)
+	: m_tail(0), m_head(0), m_slots(nullptr), m_allocation(nullptr), m_capacity(2),
+	m_allocator(allocator), m_lineAllocator(allocator)
+{
+	static_assert(std::is_nothrow_move_constructible<T>::value, "MpmcQueue requires items that move without throwing");
+
+	while (m_capacity < capacity)
+		m_capacity <<= 1;
+
+	// One spare slot to start the ring on a cache line
+	m_allocation = std::allocator_traits<LineAllocator>::allocate(m_lineAllocator, lineCount());
+	const uintptr_t address = reinterpret_cast<uintptr_t>(m_allocation);
+	const uintptr_t aligned = (address + mpmc_queue::constants::cache_line - 1) & ~uintptr_t(mpmc_queue::constants::cache_line - 1);
+	m_slots = reinterpret_cast<Slot*>(aligned);
+
+	for (std::size_t index = 0; index < m_capacity; ++index)
+	{
+		::new (static_cast<void*>(m_slots + index)) Slot;
+		m_slots[index].sequence.store(index, std::memory_order_relaxed);
+	}
+}
+
+/**
+ * Destructor, no other thread may use the queue anymore
+ */
+template <class T, class Allocator>
+MpmcQueue<T, Allocator>::~MpmcQueue()
+{
+	const std::size_t tail = m_tail.load(std::memory_order_acquire);
+	for (std::size_t head = m_head.load(std::memory_order_acquire); head != tail; ++head)
+		std::allocator_traits<Allocator>::destroy(m_allocator, m_slots[head & (m_capacity - 1)].item());
+
+	std::allocator_traits<LineAllocator>::deallocate(m_lineAllocator, m_allocation, lineCount());
+}
+
+/**
+ * Returns the number of cache lines allocated for the slots
+ */
+template <class T, class Allocator>
+std::size_t MpmcQueue<T, Allocator>::lineCount() const noexcept
+{
+	return (m_capacity + 1) * sizeof(Slot) / sizeof(Line);
+}
+
+/**
+ * Returns @true if the queue is empty at the moment of the call
+ */
+template <class T, class Allocator>
+bool MpmcQueue<T, Allocator>::isEmpty() const noexcept
+{
+	return getSize() == 0;
+}
+
+/**
+ * Returns the number of claimed slots at the moment of the call,
+ * items that are still being added or removed are counted
+ */
+template <class T, class Allocator>
+std::size_t MpmcQueue<T, Allocator>::getSize() const noexcept
+{
+	const std::size_t head = m_head.load(std::memory_order_acquire);
+	const std::size_t tail = m_tail.load(std::memory_order_acquire);
+	return (tail > head) ? tail - head : 0;
+}
+
+/**
+ * Returns queue capacity, always a power of two
+ */
+template <class T, class Allocator>
+std::size_t MpmcQueue<T, Allocator>::getCapacity() const noexcept
+{
+	return m_capacity;
+}
+
+/**
+ * Returns the allocator of the queue
+ */
+template <class T, class Allocator>
+Allocator MpmcQueue<T, Allocator>::getAllocator() const noexcept
+{
+	return m_allocator;
+}
+
+/**
+ * Claims the slot at the tail, returns nullptr if the queue is full
+ */
+template <class T, class Allocator>
+typename MpmcQueue<T, Allocator>::Slot* MpmcQueue<T, Allocator>::claimTail() noexcept
+{
+	std::size_t tail = m_tail.load(std::memory_order_relaxed);
+
+	for (;;)
+	{
+		Slot* slot = &m_slots[tail & (m_capacity - 1)];
+		const std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+		const intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(tail);
+
+		if (difference == 0)
+		{
+			if (m_tail.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed))
+				return slot;
+		}
+		else if (difference < 0)
+			return nullptr;
+		else
+			tail = m_tail.load(std::memory_order_relaxed);
+	}
+}
+
+/**
+ * Constructs the item in the claimed slot, the constructor from @args cannot throw
+ */
+template <class T, class Allocator>
+template <class... Args>
+bool MpmcQueue<T, Allocator>::push(std::true_type, Args&&... args)
+{
+	Slot* slot = claimTail();
+	if (slot == nullptr)
+		return false;
+
+	std::allocator_traits<Allocator>::construct(m_allocator, slot->item(), std::forward<Args>(args)...);
+	slot->sequence.store(slot->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	m_notEmpty.notifyAll();
+	return true;
+}
+
+/**
+ * Constructs the item before claiming a slot, a claimed slot cannot be given back
+ * if the constructor throws
+ */
+template <class T, class Allocator>
+template <class... Args>
+bool MpmcQueue<T, Allocator>::push(std::false_type, Args&&... args)
+{
+	T item(std::forward<Args>(args)...);
+	return push(std::true_type(), std::move(item));
+}
+
+/**
+ * Adds @item to the end of the queue. Returns @false if the queue is full
+ */
+template <class T, class Allocator>
+bool MpmcQueue<T, Allocator>::tryEnqueue(const T& item)
+{
+	return tryEmplace(item);
+}
+
+/**
+ * Moves @item to the end of the queue. Returns @false if the queue is full,
+ * @item is left untouched then
+ */
+template <class T, class Allocator>
+bool MpmcQueue<T, Allocator>::tryEnqueue(T&& item)
+{
+	return tryEmplace(std::move(item));
+}
+
+/**
+ * Constructs an item from @args at the end of the queue.
+ * Returns @false if the queue is full
+ */
+template <class T, class Allocator>
+template <class... Args>
+bool MpmcQueue<T, Allocator>::tryEmplace(Args&&... args)
+{
+	return push(std::is_nothrow_constructible<T, Args&&...>(), std::forward<Args>(args)...);
+}
+
+/**
+ * Moves the first item to @item and returns @true,
+ * returns @false if the queue is empty
+ */
+template <class T, class Allocator>
+bool MpmcQueue<T, Allocator>::tryDequeue(T& item)
+{
+	std::size_t head = m_head.load(std::memory_order_relaxed);
+	Slot* slot;
+
+	for (;;)
+	{
+		slot = &m_slots[head & (m_capacity - 1)];
+		const std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+		const intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(head + 1);
+
+		if (difference == 0)
+		{
+			if (m_head.compare_exchange_weak(head, head + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if (difference < 0)
+			return false;
+		else
+			head = m_head.load(std::memory_order_relaxed);
+	}
+
+	item = std::move(*slot->item());
+	std::allocator_traits<Allocator>::destroy(m_allocator, slot->item());
+
+	// The slot is free for the producer one lap later
+	slot->sequence.store(head + m_capacity, std::memory_order_release);
+	m_notFull.notifyAll();
+	return true;
+}
+
+/**
+ * Adds @item to the end of the queue, waits while the queue is full
+ */
+template <class T, class Allocator>
+void MpmcQueue<T, Allocator>::enqueue(const T& item)
+{
+	emplace(item);
+}
+
+/**
+ * Moves @item to the end of the queue, waits while the queue is full
+ */
+template <class T, class Allocator>
+void MpmcQueue<T, Allocator>::enqueue(T&& item)
+{
+	emplace(std::move(item));
+}
+
+/**
+ * Constructs an item from @args at the end of the queue, waits while the queue is full
+ */
+template <class T, class Allocator>
+template <class... Args>
+void MpmcQueue<T, Allocator>::emplace(Args&&... args)
+{
+	// Built once up front, a failed attempt must not consume @args
+	T item(std::forward<Args>(args)...);
+
+	for (unsigned spin = 0; spin < mpmc_queue::constants::spins_before_parking; ++spin)
+		if (tryEnqueue(std::move(item)))
+			return;
+
+	for (;;)
+	{
+		const uint32_t token = m_notFull.prepareWait();
+		if (tryEnqueue(std::move(item)))
+			return;
+
+		m_notFull.wait(token);
+	}
+}
+
+/**
+ * Removes the first item from the queue and returns it, waits while the queue is empty
+ */
+template <class T, class Allocator>
+T MpmcQueue<T, Allocator>::dequeue()
+{
+	T item;
+
+	for (unsigned spin = 0; spin < mpmc_queue::constants::spins_before_parking; ++spin)
+		if (tryDequeue(item))
+			return item;
+
+	for (;;)
+	{
+		const uint32_t token = m_notEmpty.prepareWait();
+		if (tryDequeue(item))
+			return item;
+
+		m_notEmpty.wait(token);
+	}
+}
+
+#if DATA_STRUCTURES_PMR
+namespace pmr
+{
+	template <class T>
+	using MpmcQueue = ::MpmcQueue<T, std::pmr::polymorphic_allocator<T>>;
+}
+#endif
\ No newline at end of file
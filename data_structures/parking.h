@@ -0,0 +1,191 @@
+﻿/**
+ * @author Dreadblade- (https://github.com/Dreadblade-dev)
+ * Parking of threads that wait for a condition
+ *
+ * Blocking operations of the concurrent containers retry their
+ * non-blocking counterpart and park the thread in between. An Event is
+ * a 32-bit epoch counter whose lowest bit says that somebody waits:
+ * a waiter sets the bit, checks its condition once more, and sleeps only
+ * while the epoch is unchanged. notifyAll() bumps the epoch, which clears
+ * the bit, and wakes the sleepers. Until a thread waits again every
+ * further notification costs a single load and no system call, even
+ * while the woken threads have not run yet.
+ *
+ * The thread sleeps in the kernel on the address of the epoch: futex on
+ * Linux, WaitOnAddress on Windows and a condition variable anywhere else
+ * (std::atomic::wait cannot time out). Waiters that expect the condition
+ * to change within microseconds spin with pause() first; on a single CPU
+ * spinLimit() turns the spinning off, it would only delay the thread
+ * that changes the condition.
+ *
+ * Time complexity:
+ * ┌────────────────┬────────────────┐
+ * │      Wait      │     Notify     │
+ * ├────────────────┼────────────────┤
+ * │      O(1)      │      O(1)      │
+ * └────────────────┴────────────────┘
+ *
+ * Source: https://en.wikipedia.org/wiki/Futex
+ */
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+#if defined(__linux__)
+#define DATA_STRUCTURES_FUTEX 1
+#include <climits>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#define DATA_STRUCTURES_FUTEX 1
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#pragma comment(lib, "Synchronization.lib")
+#else
+#define DATA_STRUCTURES_FUTEX 0
+#include <condition_variable>
+#include <mutex>
+#endif
+
+namespace parking
+{
+	/**
+	 * Tells the CPU that the thread spins, so it yields resources to the other hyper-thread
+	 */
+	inline void pause() noexcept
+	{
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+		_mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+		__asm__ __volatile__("yield");
+#endif
+	}
+
+	/**
+	 * Returns @spins, or 0 when the process has only one CPU
+	 */
+	inline unsigned spinLimit(unsigned spins) noexcept
+	{
+		static const bool multicore = std::thread::hardware_concurrency() > 1;
+		return multicore ? spins : 0;
+	}
+
+	class Event
+	{
+	private:
+		std::atomic<uint32_t> m_epoch;
+#if !DATA_STRUCTURES_FUTEX
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+#endif
+
+		/**
+		 * Sleeps while the epoch equals @token, at most @timeout (negative - no limit).
+		 * May return spuriously
+		 */
+		void sleep(uint32_t token, std::chrono::nanoseconds timeout) noexcept
+		{
+#if defined(__linux__)
+			static_assert(sizeof(m_epoch) == sizeof(uint32_t), "futex needs a plain 32-bit word");
+			struct timespec relative;
+			struct timespec* limit = nullptr;
+			if (timeout.count() >= 0)
+			{
+				relative.tv_sec = static_cast<time_t>(timeout.count() / 1000000000);
+				relative.tv_nsec = static_cast<long>(timeout.count() % 1000000000);
+				limit = &relative;
+			}
+			syscall(SYS_futex, reinterpret_cast<uint32_t*>(&m_epoch), FUTEX_WAIT_PRIVATE, token, limit, nullptr, 0);
+#elif defined(_WIN32)
+			DWORD milliseconds = INFINITE;
+			if (timeout.count() >= 0)
+			{
+				const long long rounded = (timeout.count() + 999999) / 1000000;
+				milliseconds = (rounded < INFINITE) ? static_cast<DWORD>(rounded) : INFINITE - 1;
+			}
+			WaitOnAddress(&m_epoch, &token, sizeof(token), milliseconds);
+#else
+			std::unique_lock<std::mutex> lock(m_mutex);
+			auto changed = [this, token]() { return m_epoch.load(std::memory_order_acquire) != token; };
+			if (timeout.count() >= 0)
+				m_condition.wait_for(lock, timeout, changed);
+			else
+				m_condition.wait(lock, changed);
+#endif
+		}
+
+		void wakeAll() noexcept
+		{
+#if defined(__linux__)
+			syscall(SYS_futex, reinterpret_cast<uint32_t*>(&m_epoch), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#elif defined(_WIN32)
+			WakeByAddressAll(&m_epoch);
+#else
+			// Taking the mutex orders the epoch change before a waiter's check
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+			}
+			m_condition.notify_all();
+#endif
+		}
+	public:
+		Event() noexcept : m_epoch(0) {}
+		Event(const Event&) = delete;
+		Event& operator=(const Event&) = delete;
+
+		/**
+		 * Announces a waiter and returns the token for wait(). The caller
+		 * checks its condition after this and calls wait() only if it still
+		 * has to wait
+		 */
+		uint32_t prepareWait() noexcept
+		{
+			const uint32_t token = m_epoch.fetch_or(1, std::memory_order_seq_cst) | 1;
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			return token;
+		}
+
+		/**
+		 * Parks the thread until a notification after prepareWait() returned @token,
+		 * may return spuriously
+		 */
+		void wait(uint32_t token) noexcept
+		{
+			sleep(token, std::chrono::nanoseconds(-1));
+		}
+
+		/**
+		 * Same as wait(), but parks the thread for @timeout at most
+		 */
+		void waitFor(uint32_t token, std::chrono::nanoseconds timeout) noexcept
+		{
+			sleep(token, (timeout.count() < 0) ? std::chrono::nanoseconds(0) : timeout);
+		}
+
+		/**
+		 * Wakes every parked thread, the condition must have changed before the call
+		 */
+		void notifyAll() noexcept
+		{
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			uint32_t epoch = m_epoch.load(std::memory_order_relaxed);
+			if ((epoch & 1) == 0)
+				return;
+
+			// A failed exchange means another notification has just woken everybody
+			if (m_epoch.compare_exchange_strong(epoch, epoch + 1, std::memory_order_release, std::memory_order_relaxed))
+				wakeAll();
+		}
+	};
+}
\ No newline at end of file
@@ -14,7 +14,12 @@
  * head or front of the queue, analogously to the words
  * used when people line up to wait for goods or services.
  *
- * Time complexity:
+ * The items are stored in a circular buffer whose capacity is a power of
+ * two, so a position wraps around with a mask. A full buffer doubles and
+ * the items are moved to the start of the new one (memcpy for trivially
+ * copyable items); no operation ever moves items between two stacks.
+ *
+ * Time complexity (insertion at the end is amortized):
  * ┌──────────────┬───────────┬──────────┐
  * │			  │ Insertion │ Deletion │
  * │──────────────┼───────────┼──────────│
@@ -22,48 +27,77 @@
  * │──────────────┼───────────┼──────────│
  * │  At the end  │    O(1)   │   O(1)	 │
  * └──────────────┴───────────┴──────────┘
- * Source: https://en.wikipedia.org/wiki/Queue_(abstract_data_type)
+ * Source: https://en.wikipedia.org/wiki/Circular_buffer
  */
 
 #pragma once
+#include <memory>
+#include <type_traits>
+#include <utility>
 #include "stack.h"
 #include "exceptions.h"
+#include "memory_resource.h"
 
-template <class T>
+template <class T, class Allocator = std::allocator<T>>
 class Queue
 {
 private:
-	Stack<T> m_front;
-	Stack<T> m_back;
-	
+	T* m_data;
+	std::size_t m_capacity;
+	std::size_t m_head;
+	std::size_t m_size;
+	Allocator m_allocator;
+	struct constants
+	{
+		static const std::size_t default_capacity = 16;
+	};
+
+	std::size_t position(std::size_t index) const noexcept;
+	T* copyItems(const Queue<T, Allocator>& queue);
+	T* moveItems(Queue<T, Allocator>& queue);
+	void grow(T* data, std::size_t capacity);
 public:
-	Queue();
-	Queue(const Queue<T>& queue);
-	Queue(Queue<T>&& queue) noexcept;
+	explicit Queue(const Allocator& allocator = Allocator());
+	Queue(const Queue<T, Allocator>& queue);
+	Queue(Queue<T, Allocator>&& queue) noexcept;
 	~Queue();
 	bool isEmpty() const noexcept;
 	void clear() noexcept;
-	void enqueue(const T& item) noexcept;
+	void enqueue(const T& item);
+	void enqueue(T&& item);
+	template <class... Args>
+	T& emplace(Args&&... args);
 	T dequeue();
-	T front();
-	T back();
+	T& front();
+	const T& front() const;
+	T& back();
+	const T& back() const;
 	std::size_t getSize() const noexcept;
+	std::size_t getCapacity() const noexcept;
+	Allocator getAllocator() const noexcept;
 	
-	Queue<T>& operator=(const Queue<T>& queue);
-	Queue<T>& operator=(Queue<T>&& queue) noexcept;
+	Queue<T, Allocator>& operator=(const Queue<T, Allocator>& queue);
+	Queue<T, Allocator>& operator=(Queue<T, Allocator>&& queue) noexcept(std::is_empty<Allocator>::value);
 
-	friend void swap(Queue<T>& l, Queue<T>& r) noexcept
+	/**
+	 * Swaps the items, the allocators of @l and @r must compare equal
+	 */
+	friend void swap(Queue<T, Allocator>& l, Queue<T, Allocator>& r) noexcept
 	{
-		std::swap(l.m_front, r.m_front);
-		std::swap(l.m_back, r.m_back);
+		std::swap(l.m_data, r.m_data);
+		std::swap(l.m_capacity, r.m_capacity);
+		std::swap(l.m_head, r.m_head);
+		std::swap(l.m_size, r.m_size);
 	}
 };
 
 /**
- * Default constructor, creates queue
+ * Default constructor, creates queue that takes its memory from @allocator.
+ * Nothing is allocated before the first item
  */
-template <class T>
-Queue<T>::Queue() : m_front(), m_back()
+template <class T, class Allocator>
+Queue<T, Allocator>::Queue(const Allocator& allocator)
+	: m_data(nullptr), m_capacity(0), m_head(0), m_size(0), m_allocator(allocator)
 {
 	
 }
@@ -71,18 +105,22 @@ Queue<T>::Queue() : m_front(), m_back()
 /**
  * Copy assignment constructor
  */
-template <class T>
-Queue<T>::Queue(const Queue<T>& queue)
+template <class T, class Allocator>
+Queue<T, Allocator>::Queue(const Queue<T, Allocator>& queue)
+	: m_data(nullptr), m_capacity(0), m_head(0), m_size(0),
+	m_allocator(std::allocator_traits<Allocator>::select_on_container_copy_construction(queue.m_allocator))
 {
-	m_front = queue.m_front;
-	m_back = queue.m_back;
+	m_data = copyItems(queue);
+	m_capacity = queue.m_capacity;
+	m_size = queue.m_size;
 }
 
 /**
  * Move assignment constructor
  */
-template <class T>
-Queue<T>::Queue(Queue<T>&& queue) noexcept
+template <class T, class Allocator>
+Queue<T, Allocator>::Queue(Queue<T, Allocator>&& queue) noexcept
+	: m_data(nullptr), m_capacity(0), m_head(0), m_size(0), m_allocator(std::move(queue.m_allocator))
 {
 	swap(*this, queue);
 }
@@ -90,143 +128,342 @@ Queue<T>::Queue(Queue<T>&& queue) noexcept
 /**
  * Destructor
  */
-template <class T>
-Queue<T>::~Queue()
+template <class T, class Allocator>
+Queue<T, Allocator>::~Queue()
+{
+	clear();
+}
+
+/**
+ * Returns the buffer position of the item @index places behind the front
+ */
+template <class T, class Allocator>
+std::size_t Queue<T, Allocator>::position(std::size_t index) const noexcept
+{
+	return (m_head + index) & (m_capacity - 1);
+}
+
+/**
+ * Copies the items of @queue to the start of a new buffer of the same capacity
+ */
+template <class T, class Allocator>
+T* Queue<T, Allocator>::copyItems(const Queue<T, Allocator>& queue)
+{
+	T* data = stack::allocate<T>(m_allocator, queue.m_capacity);
+
+	// The items wrap around at most once: [head, capacity) and [0, rest)
+	const std::size_t first = (queue.m_size < queue.m_capacity - queue.m_head) ? queue.m_size : queue.m_capacity - queue.m_head;
+
+	try
+	{
+		stack::copy(m_allocator, queue.m_data + queue.m_head, first, data);
+		try
+		{
+			stack::copy(m_allocator, queue.m_data, queue.m_size - first, data + first);
+		}
+		catch (...)
+		{
+			stack::destroy(m_allocator, data, first);
+			throw;
+		}
+	}
+	catch (...)
+	{
+		stack::deallocate(m_allocator, data, queue.m_capacity);
+		throw;
+	}
+
+	return data;
+}
+
+/**
+ * Moves the items of @queue to the start of a new buffer of the same capacity,
+ * constructed with this allocator. @queue keeps its moved-from items for the
+ * caller to clear, and all of its items if a copy throws
+ */
+template <class T, class Allocator>
+T* Queue<T, Allocator>::moveItems(Queue<T, Allocator>& queue)
+{
+	T* data = stack::allocate<T>(m_allocator, queue.m_capacity);
+	const std::size_t first = (queue.m_size < queue.m_capacity - queue.m_head) ? queue.m_size : queue.m_capacity - queue.m_head;
+
+	try
+	{
+		stack::moveConstruct(m_allocator, queue.m_data + queue.m_head, first, data);
+		try
+		{
+			stack::moveConstruct(m_allocator, queue.m_data, queue.m_size - first, data + first);
+		}
+		catch (...)
+		{
+			stack::destroy(m_allocator, data, first);
+			throw;
+		}
+	}
+	catch (...)
+	{
+		stack::deallocate(m_allocator, data, queue.m_capacity);
+		throw;
+	}
+
+	return data;
+}
+
+/**
+ * Moves the items to the start of the new buffer @data of @capacity.
+ * If a copy throws, the queue keeps its items and @data is left raw
+ */
+template <class T, class Allocator>
+void Queue<T, Allocator>::grow(T* data, std::size_t capacity)
 {
-	m_front.clear();
-	m_back.clear();
+	const std::size_t first = (m_size < m_capacity - m_head) ? m_size : m_capacity - m_head;
+
+	// Both parts are moved before any original is destroyed
+	stack::moveConstruct(m_allocator, m_data + m_head, first, data);
+	try
+	{
+		stack::moveConstruct(m_allocator, m_data, m_size - first, data + first);
+	}
+	catch (...)
+	{
+		stack::destroy(m_allocator, data, first);
+		throw;
+	}
+
+	stack::destroy(m_allocator, m_data + m_head, first);
+	stack::destroy(m_allocator, m_data, m_size - first);
+	stack::deallocate(m_allocator, m_data, m_capacity);
+
+	m_data = data;
+	m_capacity = capacity;
+	m_head = 0;
 }
 
 /**
  * Returns @true if the queue is empty
  */
-template <class T>
-bool Queue<T>::isEmpty() const noexcept
+template <class T, class Allocator>
+bool Queue<T, Allocator>::isEmpty() const noexcept
 {
-	return (m_front.isEmpty() && m_back.isEmpty());
+	return (m_size == 0);
 }
 
 /**
  * Clears the queue
  */
-template <class T>
-void Queue<T>::clear() noexcept
+template <class T, class Allocator>
+void Queue<T, Allocator>::clear() noexcept
 {
-	if (isEmpty())
-		return;
-	
-	m_front.clear();
-	m_back.clear();
+	const std::size_t first = (m_size < m_capacity - m_head) ? m_size : m_capacity - m_head;
+
+	stack::destroy(m_allocator, m_data + m_head, first);
+	stack::destroy(m_allocator, m_data, m_size - first);
+	stack::deallocate(m_allocator, m_data, m_capacity);
+
+	m_data = nullptr;
+	m_capacity = 0;
+	m_head = 0;
+	m_size = 0;
 }
 
 /**
  * Adds @item to the end of the queue
  */
-template <class T>
-void Queue<T>::enqueue(const T& item) noexcept
+template <class T, class Allocator>
+void Queue<T, Allocator>::enqueue(const T& item)
 {
-	m_back.push_back(item);
+	emplace(item);
 }
 
 /**
- * Removes the first item from the queue and returns it
+ * Moves @item to the end of the queue
  */
-template <class T>
-T Queue<T>::dequeue()
+template <class T, class Allocator>
+void Queue<T, Allocator>::enqueue(T&& item)
 {
-	if (m_front.isEmpty() && m_back.isEmpty())
-		throw QueueEmptyException();
+	emplace(std::move(item));
+}
 
-	if (m_front.isEmpty())
+/**
+ * Constructs an item from @args at the end of the queue and returns it.
+ * A full queue doubles its capacity
+ */
+template <class T, class Allocator>
+template <class... Args>
+T& Queue<T, Allocator>::emplace(Args&&... args)
+{
+	if (m_size < m_capacity)
 	{
-		if (m_back.getSize() > 1)
-		{
-			while (m_back.getSize() != 1)
-				m_front.push_back(m_back.pop());
-		}
-		
-		if (m_back.getSize() == 1)
-			m_front.push_back(m_back.pop());
+		T* item = m_data + position(m_size);
+		std::allocator_traits<Allocator>::construct(m_allocator, item, std::forward<Args>(args)...);
+		++m_size;
+		return *item;
+	}
+
+	const std::size_t capacity = (m_capacity == 0) ? std::size_t(constants::default_capacity) : m_capacity * 2;
+	T* data = stack::allocate<T>(m_allocator, capacity);
+
+	// The new item is constructed first, @args may refer to an item of the old buffer
+	try
+	{
+		std::allocator_traits<Allocator>::construct(m_allocator, data + m_size, std::forward<Args>(args)...);
+	}
+	catch (...)
+	{
+		stack::deallocate(m_allocator, data, capacity);
+		throw;
 	}
 
-	return m_front.pop();
+	try
+	{
+		grow(data, capacity);
+	}
+	catch (...)
+	{
+		stack::destroy(m_allocator, data + m_size, 1);
+		stack::deallocate(m_allocator, data, capacity);
+		throw;
+	}
+	return m_data[m_size++];
+}
+
+/**
+ * Removes the first item from the queue and returns it
+ */
+template <class T, class Allocator>
+T Queue<T, Allocator>::dequeue()
+{
+	if (isEmpty())
+		throw QueueEmptyException();
+
+	T item = std::move(m_data[m_head]);
+	stack::destroy(m_allocator, m_data + m_head, 1);
+	m_head = position(1);
+	--m_size;
+
+	return item;
 }
 
 /**
  * Returns the first item from the queue 
  */
-template <class T>
-T Queue<T>::front()
+template <class T, class Allocator>
+T& Queue<T, Allocator>::front()
 {
-	if (m_front.isEmpty() && m_back.isEmpty())
+	if (isEmpty())
 		throw QueueEmptyException();
 
-	if (m_front.isEmpty())
-	{
-		if (m_back.getSize() > 1)
-		{
-			while (m_back.getSize() != 1)
-				m_front.push_back(m_back.pop());
-		}
+	return m_data[m_head];
+}
 
-		if (m_back.getSize() == 1)
-			m_front.push_back(m_back.pop());
-	}
+template <class T, class Allocator>
+const T& Queue<T, Allocator>::front() const
+{
+	if (isEmpty())
+		throw QueueEmptyException();
 
-	return m_front.peek();
+	return m_data[m_head];
 }
 
 /**
  * Returns the last item from the queue 
  */
-template <class T>
-T Queue<T>::back()
+template <class T, class Allocator>
+T& Queue<T, Allocator>::back()
 {
-	if (m_front.isEmpty() && m_back.isEmpty())
+	if (isEmpty())
 		throw QueueEmptyException();
 
-	if (m_back.isEmpty())
-	{
-		while (!m_front.isEmpty())
-			m_back.push_back(m_front.pop());
-	}
+	return m_data[position(m_size - 1)];
+}
+
+template <class T, class Allocator>
+const T& Queue<T, Allocator>::back() const
+{
+	if (isEmpty())
+		throw QueueEmptyException();
 
-	return m_back.peek();
+	return m_data[position(m_size - 1)];
 }
 
 /**
  * Returns queue size
  */
-template <class T>
-std::size_t Queue<T>::getSize() const noexcept
+template <class T, class Allocator>
+std::size_t Queue<T, Allocator>::getSize() const noexcept
+{
+	return m_size;
+}
+
+/**
+ * Returns queue capacity, always a power of two or 0
+ */
+template <class T, class Allocator>
+std::size_t Queue<T, Allocator>::getCapacity() const noexcept
+{
+	return m_capacity;
+}
+
+/**
+ * Returns the allocator of the queue
+ */
+template <class T, class Allocator>
+Allocator Queue<T, Allocator>::getAllocator() const noexcept
 {
-	return m_front.getSize() + m_back.getSize();
+	return m_allocator;
 }
 
 /**
- * Copy assignment operator
+ * Copy assignment operator, the queue keeps its allocator
  */
-template <class T>
-Queue<T>& Queue<T>::operator=(const Queue<T>& queue)
+template <class T, class Allocator>
+Queue<T, Allocator>& Queue<T, Allocator>::operator=(const Queue<T, Allocator>& queue)
 {
 	if (this == &queue)
 		return *this;
-	
-	m_front = queue.m_front;
-	m_back = queue.m_back;
+
+	T* data = copyItems(queue);
+	clear();
+	m_data = data;
+	m_capacity = queue.m_capacity;
+	m_size = queue.m_size;
 
 	return *this;
 }
 
 /**
- * Move assignment operator
+ * Move assignment operator. The buffer of @queue is taken over when
+ * both allocators are equal, otherwise the items are moved one by one
  */
-template <class T>
-Queue<T>& Queue<T>::operator=(Queue<T>&& queue) noexcept
+template <class T, class Allocator>
+Queue<T, Allocator>& Queue<T, Allocator>::operator=(Queue<T, Allocator>&& queue) noexcept(std::is_empty<Allocator>::value)
 {
 	if (this == &queue)
 		return *this;
 
+	if (!(m_allocator == queue.m_allocator))
+	{
+		T* data = moveItems(queue);
+
+		clear();
+		m_data = data;
+		m_capacity = queue.m_capacity;
+		m_size = queue.m_size;
+
+		// The originals are destroyed by the allocator that built them
+		queue.clear();
+		return *this;
+	}
+
+	clear();
 	swap(*this, queue);
 	return *this;
-}
\ No newline at end of file
+}
+
+#if DATA_STRUCTURES_PMR
+namespace pmr
+{
+	template <class T>
+	using Queue = ::Queue<T, std::pmr::polymorphic_allocator<T>>;
+}
+#endif
\ No newline at end of file
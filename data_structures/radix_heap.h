@@ -0,0 +1,260 @@
+﻿/**
+ * @author Dreadblade- (https://github.com/Dreadblade-dev)
+ * Radix heap
+ *
+ * A priority queue for unsigned integer keys that never go below the
+ * last popped key, as in Dijkstra's algorithm and event simulation with
+ * integer times. Instead of comparing keys it puts an item into bucket
+ * number b, where b is the bit width of key XOR last popped key: bucket 0
+ * holds the keys equal to the last one, bucket b the keys that first
+ * differ from it in bit b - 1. When bucket 0 runs out, the first
+ * non-empty bucket is scanned for its smallest key, which becomes the new
+ * last key, and its items are spread over the lower buckets. Every item
+ * moves down at most once per bit, so pushes and pops cost O(log C)
+ * amortized, C being the largest key, and all the work is sequential
+ * scans of arrays.
+ *
+ * Pushing a key smaller than the last popped one throws
+ * std::invalid_argument. Items with equal keys come out in no particular
+ * order.
+ *
+ * Time complexity (w - bit width of the key, amortized):
+ * ┌───────────┬──────────┬──────────┐
+ * │    Top    │   Push   │   Pop    │
+ * ├───────────┼──────────┼──────────┤
+ * │   O(w)    │   O(1)   │   O(w)   │
+ * └───────────┴──────────┴──────────┘
+ *
+ * Source: https://en.wikipedia.org/wiki/Radix_heap
+ */
+
+#pragma once
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "exceptions.h"
+#include "memory_resource.h"
+
+namespace radix_heap
+{
+	/**
+	 * Returns the number of significant bits of @value, 0 for 0
+	 */
+	inline std::size_t bitWidth(unsigned long long value) noexcept
+	{
+#if defined(__GNUC__)
+		return value == 0 ? 0 : std::numeric_limits<unsigned long long>::digits - __builtin_clzll(value);
+#else
+		std::size_t width = 0;
+		for (; value != 0; value >>= 1)
+			++width;
+		return width;
+#endif
+	}
+}
+
+template <class Key, class Value, class Allocator = std::allocator<std::pair<Key, Value>>>
+class RadixHeap
+{
+	static_assert(std::is_integral<Key>::value && std::is_unsigned<Key>::value, "RadixHeap needs unsigned integer keys");
+public:
+	using Item = std::pair<Key, Value>;
+private:
+	using ItemAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Item>;
+	using Bucket = std::vector<Item, ItemAllocator>;
+	using Buckets = std::array<Bucket, std::numeric_limits<Key>::digits + 1>;
+
+	// Bucket b holds the keys whose XOR with the last key is b bits wide
+	Buckets m_buckets;
+	Key m_last;
+	std::size_t m_size;
+
+	template <std::size_t... Indices>
+	RadixHeap(const Allocator& allocator, std::index_sequence<Indices...>);
+	std::size_t bucketOf(Key key) const noexcept;
+	void refill();
+public:
+	explicit RadixHeap(const Allocator& allocator = Allocator());
+
+	bool isEmpty() const noexcept;
+	std::size_t getSize() const noexcept;
+	Key getLastKey() const noexcept;
+	void clear() noexcept;
+
+	void push(Key key, const Value& value);
+	void push(Key key, Value&& value);
+	template <class... Args>
+	void emplace(Key key, Args&&... args);
+	const Item& top();
+	Item pop();
+};
+
+/**
+ * Default constructor, creates empty heap whose last key is 0
+ */
+template <class Key, class Value, class Allocator>
+RadixHeap<Key, Value, Allocator>::RadixHeap(const Allocator& allocator)
+	: RadixHeap(allocator, std::make_index_sequence<std::tuple_size<Buckets>::value>())
+{
+
+}
+
+/**
+ * Gives every bucket a copy of @allocator
+ */
+template <class Key, class Value, class Allocator>
+template <std::size_t... Indices>
+RadixHeap<Key, Value, Allocator>::RadixHeap(const Allocator& allocator, std::index_sequence<Indices...>)
+	: m_buckets{ { (static_cast<void>(Indices), Bucket(ItemAllocator(allocator)))... } }, m_last(0), m_size(0)
+{
+
+}
+
+/**
+ * Returns the bucket for @key relative to the last popped key
+ */
+template <class Key, class Value, class Allocator>
+std::size_t RadixHeap<Key, Value, Allocator>::bucketOf(Key key) const noexcept
+{
+	return radix_heap::bitWidth(static_cast<unsigned long long>(key ^ m_last));
+}
+
+/**
+ * Makes bucket 0 non-empty: the smallest key of the first non-empty bucket
+ * becomes the last key and the bucket is spread over the lower ones
+ */
+template <class Key, class Value, class Allocator>
+void RadixHeap<Key, Value, Allocator>::refill()
+{
+	if (!m_buckets[0].empty())
+		return;
+
+	std::size_t index = 1;
+	while (m_buckets[index].empty())
+		++index;
+
+	Bucket& bucket = m_buckets[index];
+	Key smallest = bucket.front().first;
+	for (const Item& item : bucket)
+		if (item.first < smallest)
+			smallest = item.first;
+
+	// Every key of the bucket now differs from the last key in a lower bit
+	m_last = smallest;
+	for (Item& item : bucket)
+		m_buckets[bucketOf(item.first)].push_back(std::move(item));
+	bucket.clear();
+}
+
+/**
+ * Returns @true if the heap is empty
+ */
+template <class Key, class Value, class Allocator>
+bool RadixHeap<Key, Value, Allocator>::isEmpty() const noexcept
+{
+	return m_size == 0;
+}
+
+/**
+ * Returns heap size
+ */
+template <class Key, class Value, class Allocator>
+std::size_t RadixHeap<Key, Value, Allocator>::getSize() const noexcept
+{
+	return m_size;
+}
+
+/**
+ * Returns the last popped key, no smaller key can be pushed
+ */
+template <class Key, class Value, class Allocator>
+Key RadixHeap<Key, Value, Allocator>::getLastKey() const noexcept
+{
+	return m_last;
+}
+
+/**
+ * Clears the heap and resets the last key to 0, the buckets keep their memory
+ */
+template <class Key, class Value, class Allocator>
+void RadixHeap<Key, Value, Allocator>::clear() noexcept
+{
+	for (Bucket& bucket : m_buckets)
+		bucket.clear();
+	m_last = 0;
+	m_size = 0;
+}
+
+/**
+ * Adds @value with @key, which must not be less than the last popped key
+ */
+template <class Key, class Value, class Allocator>
+void RadixHeap<Key, Value, Allocator>::push(Key key, const Value& value)
+{
+	emplace(key, value);
+}
+
+template <class Key, class Value, class Allocator>
+void RadixHeap<Key, Value, Allocator>::push(Key key, Value&& value)
+{
+	emplace(key, std::move(value));
+}
+
+/**
+ * Constructs a value from @args with @key, which must not be less than the last popped key
+ */
+template <class Key, class Value, class Allocator>
+template <class... Args>
+void RadixHeap<Key, Value, Allocator>::emplace(Key key, Args&&... args)
+{
+	if (key < m_last)
+		throw std::invalid_argument("RadixHeap: the key is less than the last popped key");
+
+	m_buckets[bucketOf(key)].emplace_back(std::piecewise_construct, std::forward_as_tuple(key),
+		std::forward_as_tuple(std::forward<Args>(args)...));
+	++m_size;
+}
+
+/**
+ * Returns the item with the smallest key. Not const: the buckets are
+ * rearranged to bring the item forward
+ */
+template <class Key, class Value, class Allocator>
+const typename RadixHeap<Key, Value, Allocator>::Item& RadixHeap<Key, Value, Allocator>::top()
+{
+	if (isEmpty())
+		throw HeapEmptyException();
+
+	refill();
+	return m_buckets[0].back();
+}
+
+/**
+ * Removes the item with the smallest key from the heap and returns it
+ */
+template <class Key, class Value, class Allocator>
+typename RadixHeap<Key, Value, Allocator>::Item RadixHeap<Key, Value, Allocator>::pop()
+{
+	if (isEmpty())
+		throw HeapEmptyException();
+
+	refill();
+	Item item = std::move(m_buckets[0].back());
+	m_buckets[0].pop_back();
+	--m_size;
+	return item;
+}
+
+#if DATA_STRUCTURES_PMR
+namespace pmr
+{
+	template <class Key, class Value>
+	using RadixHeap = ::RadixHeap<Key, Value, std::pmr::polymorphic_allocator<std::pair<Key, Value>>>;
+}
+#endif
\ No newline at end of file
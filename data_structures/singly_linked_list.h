@@ -13,6 +13,8 @@
  * In its most basic form, each node contains: data, and a reference
  * (in other words, a link) to the next node in the sequence.
  * 
+ * The nodes are allocated with @Allocator, pmr::SinglyLinkedList takes a memory resource.
+ * 
  * Time complexity:
  * ┌───────────────┬───────────┬──────────┐
  * │	    	   │ Insertion │ Deletion │
@@ -29,43 +31,59 @@
 
 #pragma once
 #include <iostream>
+#include <memory>
+#include <type_traits>
 #include "exceptions.h"
+#include "memory_resource.h"
 
-template <class T>
+template <class T, class Allocator = std::allocator<T>>
 class SinglyLinkedList
 {
 private:
-	template <class T>
 	struct Node
 	{
-		Node<T>* next;
+		Node* next;
 		T data;
+
+		Node(const T& item) : next(nullptr), data(item) {}
 	};
+
+	using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+	using NodeTraits = std::allocator_traits<NodeAllocator>;
 	
-	Node<T>* m_head;
+	Node* m_head;
+	NodeAllocator m_allocator;
+
+	Node* createNode(const T& item);
+	void destroyNode(Node* node) noexcept;
+	void copyNodes(const SinglyLinkedList<T, Allocator>& list);
 public:
-	SinglyLinkedList();
-	SinglyLinkedList(SinglyLinkedList<T>& list);
-	SinglyLinkedList(SinglyLinkedList<T>&& list) noexcept;
+	explicit SinglyLinkedList(const Allocator& allocator = Allocator());
+	SinglyLinkedList(const SinglyLinkedList<T, Allocator>& list);
+	SinglyLinkedList(SinglyLinkedList<T, Allocator>&& list) noexcept;
 	~SinglyLinkedList();
 	bool isEmpty() const noexcept;
 	bool contains(const T& item) const noexcept;
 	void clear() noexcept;
 	void remove(const T& item);
-	void insertAtStart(const T& item) noexcept;
-	void insertAtEnd(const T& item) noexcept;
+	void insertAtStart(const T& item);
+	void insertAtEnd(const T& item);
 	void deleteAtStart();
 	void deleteAtEnd();
+	Allocator getAllocator() const noexcept;
 
-	SinglyLinkedList<T>& operator=(const SinglyLinkedList& list);
-	SinglyLinkedList<T>& operator=(SinglyLinkedList<T>&& list) noexcept;
+	SinglyLinkedList<T, Allocator>& operator=(const SinglyLinkedList<T, Allocator>& list);
+	SinglyLinkedList<T, Allocator>& operator=(SinglyLinkedList<T, Allocator>&& list) noexcept(std::is_empty<Allocator>::value);
 
-	friend void swap(SinglyLinkedList<T>& l, SinglyLinkedList<T>& r) noexcept
+	/**
+	 * Swaps the nodes, the allocators of @l and @r must compare equal
+	 */
+	friend void swap(SinglyLinkedList<T, Allocator>& l, SinglyLinkedList<T, Allocator>& r) noexcept
 	{
 		std::swap(l.m_head, r.m_head);
 	}
 	
-	friend std::ostream& operator<<(std::ostream& out, SinglyLinkedList<T>& list)
+	friend std::ostream& operator<<(std::ostream& out, SinglyLinkedList<T, Allocator>& list)
 	{
 		if (list.isEmpty())
 			throw ListEmptyException();
@@ -84,10 +102,10 @@ public:
 };
 
 /**
- * Default constructor, creates empty list
+ * Default constructor, creates empty list that takes its nodes from @allocator
  */
-template <class T>
-SinglyLinkedList<T>::SinglyLinkedList(): m_head(nullptr)
+template <class T, class Allocator>
+SinglyLinkedList<T, Allocator>::SinglyLinkedList(const Allocator& allocator) : m_head(nullptr), m_allocator(allocator)
 {
 
 }
@@ -95,41 +113,19 @@ SinglyLinkedList<T>::SinglyLinkedList(): m_head(nullptr)
 /**
  * Copy constructor
  */
-template <class T>
-SinglyLinkedList<T>::SinglyLinkedList(SinglyLinkedList& list)
+template <class T, class Allocator>
+SinglyLinkedList<T, Allocator>::SinglyLinkedList(const SinglyLinkedList<T, Allocator>& list)
+	: m_head(nullptr), m_allocator(NodeTraits::select_on_container_copy_construction(list.m_allocator))
 {
-	if (list.isEmpty())
-	{
-		m_head = nullptr;
-		return;
-	}
-	
-	auto currentNode = new Node<T>;
-	auto prevNode = currentNode;
-	auto nodeToCopy = list.m_head;
-
-	m_head = currentNode;
-	
-	currentNode->data = nodeToCopy->data;
-	prevNode->next = currentNode;
-	nodeToCopy = nodeToCopy->next;
-	
-	while (nodeToCopy != nullptr)
-	{
-		currentNode = new Node<T>;
-		currentNode->data = nodeToCopy->data;
-		prevNode->next = currentNode;
-		prevNode = currentNode;
-		nodeToCopy = nodeToCopy->next;
-	}
-	currentNode->next = nullptr;
+	copyNodes(list);
 }
 
 /**
  * Move assignment constructor
  */
-template <class T>
-SinglyLinkedList<T>::SinglyLinkedList(SinglyLinkedList<T>&& list) noexcept
+template <class T, class Allocator>
+SinglyLinkedList<T, Allocator>::SinglyLinkedList(SinglyLinkedList<T, Allocator>&& list) noexcept
+	: m_head(nullptr), m_allocator(std::move(list.m_allocator))
 {
 	swap(*this, list);
 }
@@ -137,29 +133,75 @@ SinglyLinkedList<T>::SinglyLinkedList(SinglyLinkedList<T>&& list) noexcept
 /**
  * Destructor
  */
-template <class T>
-SinglyLinkedList<T>::~SinglyLinkedList()
+template <class T, class Allocator>
+SinglyLinkedList<T, Allocator>::~SinglyLinkedList()
 {
-	if (!isEmpty())
+	clear();
+}
+
+/**
+ * Allocates a node holding a copy of @item
+ */
+template <class T, class Allocator>
+typename SinglyLinkedList<T, Allocator>::Node* SinglyLinkedList<T, Allocator>::createNode(const T& item)
+{
+	Node* node = NodeTraits::allocate(m_allocator, 1);
+
+	try
 	{
-		auto currentNode = m_head;
-		auto nodeToDelete = m_head;
-		
-		while (currentNode->next != nullptr)
+		NodeTraits::construct(m_allocator, node, item);
+	}
+	catch (...)
+	{
+		NodeTraits::deallocate(m_allocator, node, 1);
+		throw;
+	}
+
+	return node;
+}
+
+template <class T, class Allocator>
+void SinglyLinkedList<T, Allocator>::destroyNode(Node* node) noexcept
+{
+	NodeTraits::destroy(m_allocator, node);
+	NodeTraits::deallocate(m_allocator, node, 1);
+}
+
+/**
+ * Appends copies of the nodes of @list to the empty list
+ */
+template <class T, class Allocator>
+void SinglyLinkedList<T, Allocator>::copyNodes(const SinglyLinkedList<T, Allocator>& list)
+{
+	Node* prevNode = nullptr;
+	auto nodeToCopy = list.m_head;
+
+	try
+	{
+		while (nodeToCopy != nullptr)
 		{
-			currentNode = currentNode->next;
-			delete nodeToDelete;
-			nodeToDelete = currentNode;
+			auto currentNode = createNode(nodeToCopy->data);
+			if (prevNode == nullptr)
+				m_head = currentNode;
+			else
+				prevNode->next = currentNode;
+
+			prevNode = currentNode;
+			nodeToCopy = nodeToCopy->next;
 		}
-		delete currentNode;
+	}
+	catch (...)
+	{
+		clear();
+		throw;
 	}
 }
 
 /**
  * Returns @true if the list is empty
  */
-template <class T>
-bool SinglyLinkedList<T>::isEmpty() const noexcept
+template <class T, class Allocator>
+bool SinglyLinkedList<T, Allocator>::isEmpty() const noexcept
 {
 	return (m_head == nullptr);
 }
@@ -167,8 +209,8 @@ bool SinglyLinkedList<T>::isEmpty() const noexcept
 /**
  * Returns @true if the list contains @item
  */
-template <class T>
-bool SinglyLinkedList<T>::contains(const T& item) const noexcept
+template <class T, class Allocator>
+bool SinglyLinkedList<T, Allocator>::contains(const T& item) const noexcept
 {
 	if (isEmpty())
 		return false;
@@ -193,21 +235,17 @@ bool SinglyLinkedList<T>::contains(const T& item) const noexcept
 /**
  * Clears the list
  */
-template <class T>
-void SinglyLinkedList<T>::clear() noexcept
+template <class T, class Allocator>
+void SinglyLinkedList<T, Allocator>::clear() noexcept
 {
-	if (isEmpty())
-		return;
-
 	auto currentNode = m_head;
-	auto nodeToDelete = m_head;
 
-	do
+	while (currentNode != nullptr)
 	{
+		auto nodeToDelete = currentNode;
 		currentNode = currentNode->next;
-		delete nodeToDelete;
-		nodeToDelete = currentNode;
-	} while (currentNode->next != nullptr);
+		destroyNode(nodeToDelete);
+	}
 
 	m_head = nullptr;
 }
@@ -215,8 +253,8 @@ void SinglyLinkedList<T>::clear() noexcept
 /**
  * Removes a node with @item from the list
  */
-template <class T>
-void SinglyLinkedList<T>::remove(const T& item)
+template <class T, class Allocator>
+void SinglyLinkedList<T, Allocator>::remove(const T& item)
 {
 	if (isEmpty())
 		throw ListEmptyException();
@@ -233,7 +271,7 @@ void SinglyLinkedList<T>::remove(const T& item)
 			else
 				nodeToChangeNext->next = nodeToRemove->next;
 			
-			delete nodeToRemove;
+			destroyNode(nodeToRemove);
 			return;
 		}
 		nodeToChangeNext = nodeToRemove;
@@ -244,49 +282,35 @@ void SinglyLinkedList<T>::remove(const T& item)
 	{
 		if (nodeToRemove == m_head && m_head->next == nullptr)
 		{
-			delete m_head;
+			destroyNode(m_head);
 			m_head = nullptr;
 			return;
 		}
 		nodeToChangeNext->next = nullptr;
-		delete nodeToRemove;
+		destroyNode(nodeToRemove);
 	}
 }
 
 /**
  * Inserts a new node with @item at the start
  */
-template <class T>
-void SinglyLinkedList<T>::insertAtStart(const T& item) noexcept
+template <class T, class Allocator>
+void SinglyLinkedList<T, Allocator>::insertAtStart(const T& item)
 {
-	if (!isEmpty())
-	{
-		auto head = new Node<T>;
-		head->data = item;
-		head->next = m_head;
-		m_head = head;
-	}
-	
-	if (isEmpty())
-	{
-		auto head = new Node<T>;
-		head->data = item;
-		head->next = nullptr;
-		m_head = head;
-	}
+	auto head = createNode(item);
+	head->next = m_head;
+	m_head = head;
 }
 
 /**
  * Inserts a new node with @item at the end
  */
-template <class T>
-void SinglyLinkedList<T>::insertAtEnd(const T& item) noexcept
+template <class T, class Allocator>
+void SinglyLinkedList<T, Allocator>::insertAtEnd(const T& item)
 {
 	if (!isEmpty())
 	{
-		auto tail = new Node<T>;
-		tail->data = item;
-		tail->next = nullptr;
+		auto tail = createNode(item);
 
 		auto currentNode = m_head;
 		while (currentNode->next != nullptr)
@@ -301,29 +325,29 @@ void SinglyLinkedList<T>::insertAtEnd(const T& item) noexcept
 /**
  * Deletes the node at the start of the list
  */
-template <class T>
-void SinglyLinkedList<T>::deleteAtStart()
+template <class T, class Allocator>
+void SinglyLinkedList<T, Allocator>::deleteAtStart()
 {
 	if (isEmpty())
 		throw ListEmptyException();
 
 	auto tmp = m_head->next;
-	delete m_head;
+	destroyNode(m_head);
 	m_head = tmp;
 }
 
 /**
  * Deletes the node at the end of the list
  */
-template <class T>
-void SinglyLinkedList<T>::deleteAtEnd()
+template <class T, class Allocator>
+void SinglyLinkedList<T, Allocator>::deleteAtEnd()
 {
 	if (isEmpty())
 		throw ListEmptyException();
 
 	if (m_head->next == nullptr)
 	{
-		delete m_head;
+		destroyNode(m_head);
 		m_head = nullptr;
 		return;
 	}
@@ -332,57 +356,60 @@ void SinglyLinkedList<T>::deleteAtEnd()
 	while (currentNode->next->next != nullptr)
 		currentNode = currentNode->next;
 
-	delete currentNode->next;
+	destroyNode(currentNode->next);
 	currentNode->next = nullptr;
 }
 
 /**
- * Copy assignment operator
+ * Returns the allocator of the list
  */
-template <class T>
-SinglyLinkedList<T>& SinglyLinkedList<T>::operator=(const SinglyLinkedList& list)
+template <class T, class Allocator>
+Allocator SinglyLinkedList<T, Allocator>::getAllocator() const noexcept
 {
-	if (this == &list)
-		return *this;
+	return Allocator(m_allocator);
+}
 
-	if (list.isEmpty())
-	{
-		m_head = nullptr;
+/**
+ * Copy assignment operator, the list keeps its allocator
+ */
+template <class T, class Allocator>
+SinglyLinkedList<T, Allocator>& SinglyLinkedList<T, Allocator>::operator=(const SinglyLinkedList<T, Allocator>& list)
+{
+	if (this == &list)
 		return *this;
-	}
 
-	auto currentNode = new Node<T>;
-	auto prevNode = currentNode;
-	auto nodeToCopy = list.m_head;
-
-	m_head = currentNode;
-
-	currentNode->data = nodeToCopy->data;
-	prevNode->next = currentNode;
-	nodeToCopy = nodeToCopy->next;
-
-	while (nodeToCopy != nullptr)
-	{
-		currentNode = new Node<T>;
-		currentNode->data = nodeToCopy->data;
-		prevNode->next = currentNode;
-		prevNode = currentNode;
-		nodeToCopy = nodeToCopy->next;
-	}
-	currentNode->next = nullptr;
+	clear();
+	copyNodes(list);
 
 	return *this;
 }
 
 /**
- * Move assignment operator
+ * Move assignment operator. The nodes of @list are taken over when
+ * both allocators are equal, otherwise they are copied
  */
-template <class T>
-SinglyLinkedList<T>& SinglyLinkedList<T>::operator=(SinglyLinkedList<T>&& list) noexcept
+template <class T, class Allocator>
+SinglyLinkedList<T, Allocator>& SinglyLinkedList<T, Allocator>::operator=(SinglyLinkedList<T, Allocator>&& list)
+	noexcept(std::is_empty<Allocator>::value)
 {
 	if (this == &list)
 		return *this;
 
+	if (!(m_allocator == list.m_allocator))
+	{
+		*this = static_cast<const SinglyLinkedList<T, Allocator>&>(list);
+		list.clear();
+		return *this;
+	}
+
 	swap(*this, list);
 	return *this;
-}
\ No newline at end of file
+}
+
+#if DATA_STRUCTURES_PMR
+namespace pmr
+{
+	template <class T>
+	using SinglyLinkedList = ::SinglyLinkedList<T, std::pmr::polymorphic_allocator<T>>;
+}
+#endif
\ No newline at end of file
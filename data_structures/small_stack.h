@@ -0,0 +1,408 @@
+﻿/**
+ * @author Dreadblade- (https://github.com/Dreadblade-dev)
+ * Stack with inline storage (small buffer optimization)
+ *
+ * The first N items are kept in a buffer inside the object, so a stack
+ * that never holds more than N items never touches the heap. On overflow
+ * the items move to heap storage that grows geometrically like Stack;
+ * when the stack drains below N again they move back into the buffer.
+ * The heap storage comes from @Allocator.
+ *
+ * Time complexity (amortized):
+ * ┌───────────┬──────────┐
+ * │ Insertion │ Deletion │
+ * │───────────┼──────────│
+ * │    O(1)   │   O(1)   │
+ * └───────────┴──────────┘
+ *
+ * Source: https://en.wikipedia.org/wiki/Stack_(abstract_data_type)
+ */
+
+#pragma once
+#include <type_traits>
+#include <utility>
+#include "exceptions.h"
+#include "stack.h"
+
+template <class T, std::size_t N = 16, class Allocator = std::allocator<T>>
+class SmallStack
+{
+private:
+	typename std::aligned_storage<sizeof(T) * N, alignof(T)>::type m_buffer;
+	std::size_t m_capacity;
+	std::size_t m_size;
+	T* m_data;
+	Allocator m_allocator;
+	struct constants
+	{
+		static const std::size_t growth_factor = 2;
+	};
+
+	T* buffer() noexcept;
+	void moveFrom(SmallStack<T, N, Allocator>& s);
+public:
+	explicit SmallStack(const Allocator& allocator = Allocator()) noexcept;
+	SmallStack(const SmallStack<T, N, Allocator>& s);
+	SmallStack(SmallStack<T, N, Allocator>&& s) noexcept(std::is_nothrow_move_constructible<T>::value);
+	~SmallStack();
+	bool isEmpty() const noexcept;
+	bool isInline() const noexcept;
+	void clear() noexcept;
+	void reallocate(std::size_t capacity);
+	void push_back(const T& item);
+	void push_back(T&& item);
+	template <class... Args>
+	T& emplace_back(Args&&... args);
+	T pop();
+	T peek();
+	std::size_t getSize() const noexcept;
+	std::size_t getCapacity() const noexcept;
+	Allocator getAllocator() const noexcept;
+
+	SmallStack& operator=(const SmallStack<T, N, Allocator>& s);
+	SmallStack& operator=(SmallStack<T, N, Allocator>&& s)
+		noexcept(std::is_nothrow_move_constructible<T>::value && std::is_empty<Allocator>::value);
+
+	friend void swap(SmallStack<T, N, Allocator>& l, SmallStack<T, N, Allocator>& r)
+	{
+		SmallStack<T, N, Allocator> tmp(std::move(l));
+		l = std::move(r);
+		r = std::move(tmp);
+	}
+};
+
+/**
+ * Default constructor, the stack starts in the inline buffer.
+ * Spilled items are stored in memory from @allocator
+ */
+template <class T, std::size_t N, class Allocator>
+SmallStack<T, N, Allocator>::SmallStack(const Allocator& allocator) noexcept
+	: m_capacity(N), m_size(0), m_allocator(allocator)
+{
+	static_assert(N > 0, "SmallStack requires inline capacity");
+	m_data = buffer();
+}
+
+/**
+ * Copy constructor, the copy is inline if the items fit in the buffer
+ */
+template <class T, std::size_t N, class Allocator>
+SmallStack<T, N, Allocator>::SmallStack(const SmallStack<T, N, Allocator>& s)
+	: SmallStack(std::allocator_traits<Allocator>::select_on_container_copy_construction(s.m_allocator))
+{
+	if (s.m_size > N)
+	{
+		m_data = stack::allocate<T>(m_allocator, s.m_size);
+		m_capacity = s.m_size;
+	}
+
+	try
+	{
+		stack::copy(m_allocator, s.m_data, s.m_size, m_data);
+	}
+	catch (...)
+	{
+		if (!isInline())
+			stack::deallocate(m_allocator, m_data, m_capacity);
+		throw;
+	}
+
+	m_size = s.m_size;
+}
+
+/**
+ * Move constructor. Heap storage is taken over, inline items are moved one by one
+ */
+template <class T, std::size_t N, class Allocator>
+SmallStack<T, N, Allocator>::SmallStack(SmallStack<T, N, Allocator>&& s) noexcept(std::is_nothrow_move_constructible<T>::value)
+	: SmallStack(s.m_allocator)
+{
+	moveFrom(s);
+}
+
+/**
+ * Destructor
+ */
+template <class T, std::size_t N, class Allocator>
+SmallStack<T, N, Allocator>::~SmallStack()
+{
+	clear();
+}
+
+template <class T, std::size_t N, class Allocator>
+T* SmallStack<T, N, Allocator>::buffer() noexcept
+{
+	return reinterpret_cast<T*>(&m_buffer);
+}
+
+/**
+ * Takes the items of @s, which is left empty and inline. The stack must be empty and inline
+ */
+template <class T, std::size_t N, class Allocator>
+void SmallStack<T, N, Allocator>::moveFrom(SmallStack<T, N, Allocator>& s)
+{
+	if (!s.isInline() && m_allocator == s.m_allocator)
+	{
+		m_data = s.m_data;
+		m_capacity = s.m_capacity;
+		m_size = s.m_size;
+		s.m_data = s.buffer();
+		s.m_capacity = N;
+		s.m_size = 0;
+		return;
+	}
+
+	// Inline items and items from another allocator are moved one by one
+	if (s.m_size > N)
+	{
+		m_data = stack::allocate<T>(m_allocator, s.m_capacity);
+		m_capacity = s.m_capacity;
+	}
+
+	try
+	{
+		stack::relocate(m_allocator, s.m_data, s.m_size, m_data);
+	}
+	catch (...)
+	{
+		clear();
+		throw;
+	}
+	m_size = s.m_size;
+	s.m_size = 0;
+	s.clear();
+}
+
+/**
+ * Returns @true if the stack is empty
+ */
+template <class T, std::size_t N, class Allocator>
+bool SmallStack<T, N, Allocator>::isEmpty() const noexcept
+{
+	return (m_size == 0);
+}
+
+/**
+ * Returns @true if the items are stored in the inline buffer
+ */
+template <class T, std::size_t N, class Allocator>
+bool SmallStack<T, N, Allocator>::isInline() const noexcept
+{
+	return m_data == reinterpret_cast<const T*>(&m_buffer);
+}
+
+/**
+ * Clears the stack and returns it to the inline buffer
+ */
+template <class T, std::size_t N, class Allocator>
+void SmallStack<T, N, Allocator>::clear() noexcept
+{
+	stack::destroy(m_allocator, m_data, m_size);
+	if (!isInline())
+		stack::deallocate(m_allocator, m_data, m_capacity);
+
+	m_data = buffer();
+	m_capacity = N;
+	m_size = 0;
+}
+
+/**
+ * Reallocates memory for data without data loss. A @capacity up to N
+ * moves the items back into the inline buffer, items that do not fit are destroyed
+ */
+template <class T, std::size_t N, class Allocator>
+void SmallStack<T, N, Allocator>::reallocate(std::size_t capacity)
+{
+	if (capacity < N)
+		capacity = N;
+	if (m_capacity == capacity)
+		return;
+
+	T* data = (capacity == N) ? buffer() : stack::allocate<T>(m_allocator, capacity);
+
+	if (m_size > capacity)
+	{
+		stack::destroy(m_allocator, m_data + capacity, m_size - capacity);
+		m_size = capacity;
+	}
+
+	try
+	{
+		stack::relocate(m_allocator, m_data, m_size, data);
+	}
+	catch (...)
+	{
+		if (data != buffer())
+			stack::deallocate(m_allocator, data, capacity);
+		throw;
+	}
+	if (!isInline())
+		stack::deallocate(m_allocator, m_data, m_capacity);
+
+	m_capacity = capacity;
+	m_data = data;
+}
+
+/**
+ * Adds an @item to the stack
+ */
+template <class T, std::size_t N, class Allocator>
+void SmallStack<T, N, Allocator>::push_back(const T& item)
+{
+	emplace_back(item);
+}
+
+/**
+ * Moves an @item to the stack
+ */
+template <class T, std::size_t N, class Allocator>
+void SmallStack<T, N, Allocator>::push_back(T&& item)
+{
+	emplace_back(std::move(item));
+}
+
+/**
+ * Constructs an item from @args on top of the stack and returns it.
+ * A full stack spills to the heap
+ */
+template <class T, std::size_t N, class Allocator>
+template <class... Args>
+T& SmallStack<T, N, Allocator>::emplace_back(Args&&... args)
+{
+	if (m_size < m_capacity)
+	{
+		std::allocator_traits<Allocator>::construct(m_allocator, m_data + m_size, std::forward<Args>(args)...);
+		return m_data[m_size++];
+	}
+
+	const std::size_t capacity = m_capacity * constants::growth_factor;
+	T* data = stack::allocate<T>(m_allocator, capacity);
+
+	// The new item is constructed first, @args may refer to an item of the old storage
+	try
+	{
+		std::allocator_traits<Allocator>::construct(m_allocator, data + m_size, std::forward<Args>(args)...);
+	}
+	catch (...)
+	{
+		stack::deallocate(m_allocator, data, capacity);
+		throw;
+	}
+
+	try
+	{
+		stack::relocate(m_allocator, m_data, m_size, data);
+	}
+	catch (...)
+	{
+		stack::destroy(m_allocator, data + m_size, 1);
+		stack::deallocate(m_allocator, data, capacity);
+		throw;
+	}
+	if (!isInline())
+		stack::deallocate(m_allocator, m_data, m_capacity);
+
+	m_capacity = capacity;
+	m_data = data;
+	return m_data[m_size++];
+}
+
+/**
+ * Deletes the last added item from the stack and returns it.
+ * Heap storage is halved when capacity is four times the size
+ */
+template <class T, std::size_t N, class Allocator>
+T SmallStack<T, N, Allocator>::pop()
+{
+	if (isEmpty())
+		throw StackEmptyException();
+
+	T tmp = std::move(m_data[m_size - 1]);
+	--m_size;
+	stack::destroy(m_allocator, m_data + m_size, 1);
+
+	if (!isInline() && m_size < m_capacity / 4)
+	{
+		reallocate(m_capacity / 2);
+	}
+
+	return tmp;
+}
+
+/**
+ * Returns the last added item from the stack
+ */
+template <class T, std::size_t N, class Allocator>
+T SmallStack<T, N, Allocator>::peek()
+{
+	if (isEmpty())
+		throw StackEmptyException();
+
+	return m_data[m_size - 1];
+}
+
+/**
+ * Returns stack size
+ */
+template <class T, std::size_t N, class Allocator>
+std::size_t SmallStack<T, N, Allocator>::getSize() const noexcept
+{
+	return m_size;
+}
+
+/**
+ * Returns stack capacity, N while the stack is inline
+ */
+template <class T, std::size_t N, class Allocator>
+std::size_t SmallStack<T, N, Allocator>::getCapacity() const noexcept
+{
+	return m_capacity;
+}
+
+/**
+ * Returns the allocator of the spilled items
+ */
+template <class T, std::size_t N, class Allocator>
+Allocator SmallStack<T, N, Allocator>::getAllocator() const noexcept
+{
+	return m_allocator;
+}
+
+/**
+ * Copy assignment operator, the stack keeps its allocator
+ */
+template <class T, std::size_t N, class Allocator>
+SmallStack<T, N, Allocator>& SmallStack<T, N, Allocator>::operator=(const SmallStack<T, N, Allocator>& s)
+{
+	if (this == &s)
+		return *this;
+
+	SmallStack<T, N, Allocator> copy(s);
+	clear();
+	moveFrom(copy);
+
+	return *this;
+}
+
+/**
+ * Move assignment operator
+ */
+template <class T, std::size_t N, class Allocator>
+SmallStack<T, N, Allocator>& SmallStack<T, N, Allocator>::operator=(SmallStack<T, N, Allocator>&& s)
+	noexcept(std::is_nothrow_move_constructible<T>::value && std::is_empty<Allocator>::value)
+{
+	if (this == &s)
+		return *this;
+
+	clear();
+	moveFrom(s);
+	return *this;
+}
+
+#if DATA_STRUCTURES_PMR
+namespace pmr
+{
+	template <class T, std::size_t N = 16>
+	using SmallStack = ::SmallStack<T, N, std::pmr::polymorphic_allocator<T>>;
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,319 @@
+﻿/**
+ * @author Dreadblade- (https://github.com/Dreadblade-dev)
+ * Single-producer single-consumer queue
+ *
+ * A bounded ring buffer shared by exactly one producer thread and exactly
+ * one consumer thread. The producer only writes the tail index and the
+ * consumer only writes the head index, so neither needs a lock or a
+ * compare-and-swap: an item is published by one release store.
+ *
+ * The two indices live on separate cache lines. Each side also keeps
+ * a private copy of the other side's index and reloads the shared one
+ * only when its copy says the buffer is full (or empty), so in the steady
+ * state a cache line moves between the cores once per batch of items
+ * rather than once per item. tryPushN and tryPopN move whole batches
+ * with a single store.
+ *
+ * The indices run freely and are masked by the capacity, a power of two,
+ * so every slot of the buffer is used.
+ *
+ * Time complexity (wait-free):
+ * ┌───────────┬──────────┐
+ * │ Insertion │ Deletion │
+ * │───────────┼──────────│
+ * │    O(1)   │   O(1)   │
+ * └───────────┴──────────┘
+ *
+ * Source: https://en.wikipedia.org/wiki/Circular_buffer
+ */
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include "stack.h"
+#include "memory_resource.h"
+
+namespace spsc_queue
+{
+	struct constants
+	{
+		static const std::size_t cache_line = 64;
+	};
+
+	/**
+	 * Returns the smallest power of two not less than @value (at least 1)
+	 */
+	inline std::size_t roundUpToPowerOfTwo(std::size_t value) noexcept
+	{
+		std::size_t power = 1;
+		while (power < value)
+			power <<= 1;
+
+		return power;
+	}
+}
+
+template <class T, class Allocator = std::allocator<T>>
+class SpscQueue
+{
+private:
+	// Written by the producer only
+	alignas(spsc_queue::constants::cache_line) std::atomic<std::size_t> m_tail;
+	std::size_t m_cachedHead;
+
+	// Written by the consumer only
+	alignas(spsc_queue::constants::cache_line) std::atomic<std::size_t> m_head;
+	std::size_t m_cachedTail;
+
+	// Read-only after construction
+	alignas(spsc_queue::constants::cache_line) T* m_data;
+	std::size_t m_capacity;
+	Allocator m_allocator;
+
+	std::size_t freeSlots(std::size_t tail, std::size_t wanted) noexcept;
+	std::size_t readySlots(std::size_t head, std::size_t wanted) noexcept;
+public:
+	explicit SpscQueue(std::size_t capacity, const Allocator& allocator = Allocator());
+	SpscQueue(const SpscQueue<T, Allocator>&) = delete;
+	SpscQueue<T, Allocator>& operator=(const SpscQueue<T, Allocator>&) = delete;
+	~SpscQueue();
+	bool isEmpty() const noexcept;
+	std::size_t getSize() const noexcept;
+	std::size_t getCapacity() const noexcept;
+	Allocator getAllocator() const noexcept;
+
+	// Producer side
+	bool tryEnqueue(const T& item);
+	bool tryEnqueue(T&& item);
+	template <class... Args>
+	bool tryEmplace(Args&&... args);
+	template <class InputIterator>
+	std::size_t tryPushN(InputIterator first, std::size_t count);
+
+	// Consumer side
+	bool tryDequeue(T& item);
+	template <class OutputIterator>
+	std::size_t tryPopN(OutputIterator out, std::size_t count);
+};
+
+/**
+ * Creates queue for at least @capacity items, rounded up to a power of two.
+ * The whole buffer is allocated here, the queue never reallocates
+ */
+template <class T, class Allocator>
+SpscQueue<T, Allocator>::SpscQueue(std::size_t capacity, const Allocator& allocator)
+	: m_tail(0), m_cachedHead(0), m_head(0), m_cachedTail(0), m_data(nullptr),
+	m_capacity(spsc_queue::roundUpToPowerOfTwo(capacity)), m_allocator(allocator)
+{
+	m_data = stack::allocate<T>(m_allocator, m_capacity);
+}
+
+/**
+ * Destructor, neither thread may use the queue anymore
+ */
+template <class T, class Allocator>
+SpscQueue<T, Allocator>::~SpscQueue()
+{
+	const std::size_t tail = m_tail.load(std::memory_order_acquire);
+	for (std::size_t head = m_head.load(std::memory_order_acquire); head != tail; ++head)
+		stack::destroy(m_allocator, m_data + (head & (m_capacity - 1)), 1);
+
+	stack::deallocate(m_allocator, m_data, m_capacity);
+}
+
+/**
+ * Returns the number of free slots for the producer, at most @wanted.
+ * The consumer's index is reloaded only when the cached one shows too few
+ */
+template <class T, class Allocator>
+std::size_t SpscQueue<T, Allocator>::freeSlots(std::size_t tail, std::size_t wanted) noexcept
+{
+	std::size_t free = m_capacity - (tail - m_cachedHead);
+	if (free < wanted)
+	{
+		m_cachedHead = m_head.load(std::memory_order_acquire);
+		free = m_capacity - (tail - m_cachedHead);
+	}
+
+	return (free < wanted) ? free : wanted;
+}
+
+/**
+ * Returns the number of items ready for the consumer, at most @wanted.
+ * The producer's index is reloaded only when the cached one shows too few
+ */
+template <class T, class Allocator>
+std::size_t SpscQueue<T, Allocator>::readySlots(std::size_t head, std::size_t wanted) noexcept
+{
+	std::size_t ready = m_cachedTail - head;
+	if (ready < wanted)
+	{
+		m_cachedTail = m_tail.load(std::memory_order_acquire);
+		ready = m_cachedTail - head;
+	}
+
+	return (ready < wanted) ? ready : wanted;
+}
+
+/**
+ * Returns @true if the queue is empty at the moment of the call
+ */
+template <class T, class Allocator>
+bool SpscQueue<T, Allocator>::isEmpty() const noexcept
+{
+	return getSize() == 0;
+}
+
+/**
+ * Returns the number of items at the moment of the call
+ */
+template <class T, class Allocator>
+std::size_t SpscQueue<T, Allocator>::getSize() const noexcept
+{
+	// The head is loaded first, so it never is ahead of the tail
+	const std::size_t head = m_head.load(std::memory_order_acquire);
+	const std::size_t tail = m_tail.load(std::memory_order_acquire);
+	return tail - head;
+}
+
+/**
+ * Returns queue capacity, always a power of two
+ */
+template <class T, class Allocator>
+std::size_t SpscQueue<T, Allocator>::getCapacity() const noexcept
+{
+	return m_capacity;
+}
+
+/**
+ * Returns the allocator of the queue
+ */
+template <class T, class Allocator>
+Allocator SpscQueue<T, Allocator>::getAllocator() const noexcept
+{
+	return m_allocator;
+}
+
+/**
+ * Adds @item to the end of the queue. Returns @false if the queue is full
+ */
+template <class T, class Allocator>
+bool SpscQueue<T, Allocator>::tryEnqueue(const T& item)
+{
+	return tryEmplace(item);
+}
+
+/**
+ * Moves @item to the end of the queue. Returns @false if the queue is full,
+ * @item is left untouched then
+ */
+template <class T, class Allocator>
+bool SpscQueue<T, Allocator>::tryEnqueue(T&& item)
+{
+	return tryEmplace(std::move(item));
+}
+
+/**
+ * Constructs an item from @args at the end of the queue.
+ * Returns @false if the queue is full
+ */
+template <class T, class Allocator>
+template <class... Args>
+bool SpscQueue<T, Allocator>::tryEmplace(Args&&... args)
+{
+	const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+	if (freeSlots(tail, 1) == 0)
+		return false;
+
+	std::allocator_traits<Allocator>::construct(m_allocator, m_data + (tail & (m_capacity - 1)), std::forward<Args>(args)...);
+	m_tail.store(tail + 1, std::memory_order_release);
+	return true;
+}
+
+/**
+ * Adds up to @count items read from @first and publishes them at once.
+ * Returns the number of items added, less than @count if the queue filled up
+ */
+template <class T, class Allocator>
+template <class InputIterator>
+std::size_t SpscQueue<T, Allocator>::tryPushN(InputIterator first, std::size_t count)
+{
+	const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+	const std::size_t pushed = freeSlots(tail, count);
+
+	std::size_t index = 0;
+	try
+	{
+		for (; index < pushed; ++index, ++first)
+			std::allocator_traits<Allocator>::construct(m_allocator, m_data + ((tail + index) & (m_capacity - 1)), *first);
+	}
+	catch (...)
+	{
+		// The items constructed before the failure stay in the queue
+		m_tail.store(tail + index, std::memory_order_release);
+		throw;
+	}
+
+	m_tail.store(tail + pushed, std::memory_order_release);
+	return pushed;
+}
+
+/**
+ * Moves the first item to @item and returns @true,
+ * returns @false if the queue is empty
+ */
+template <class T, class Allocator>
+bool SpscQueue<T, Allocator>::tryDequeue(T& item)
+{
+	const std::size_t head = m_head.load(std::memory_order_relaxed);
+	if (readySlots(head, 1) == 0)
+		return false;
+
+	T* slot = m_data + (head & (m_capacity - 1));
+	item = std::move(*slot);
+	stack::destroy(m_allocator, slot, 1);
+	m_head.store(head + 1, std::memory_order_release);
+	return true;
+}
+
+/**
+ * Moves up to @count first items to @out and frees their slots at once.
+ * Returns the number of items taken, less than @count if the queue ran empty
+ */
+template <class T, class Allocator>
+template <class OutputIterator>
+std::size_t SpscQueue<T, Allocator>::tryPopN(OutputIterator out, std::size_t count)
+{
+	const std::size_t head = m_head.load(std::memory_order_relaxed);
+	const std::size_t popped = readySlots(head, count);
+
+	std::size_t index = 0;
+	try
+	{
+		for (; index < popped; ++index, ++out)
+		{
+			T* slot = m_data + ((head + index) & (m_capacity - 1));
+			*out = std::move(*slot);
+			stack::destroy(m_allocator, slot, 1);
+		}
+	}
+	catch (...)
+	{
+		// The item that failed to move stays at the front
+		m_head.store(head + index, std::memory_order_release);
+		throw;
+	}
+
+	m_head.store(head + popped, std::memory_order_release);
+	return popped;
+}
+
+#if DATA_STRUCTURES_PMR
+namespace pmr
+{
+	template <class T>
+	using SpscQueue = ::SpscQueue<T, std::pmr::polymorphic_allocator<T>>;
+}
+#endif
\ No newline at end of file
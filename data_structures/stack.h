@@ -11,7 +11,13 @@
  * LIFO (last in, first out). Additionally, a peek operation may give access to the
  * top without modifying the stack.
  *
- * Time complexity:
+ * The items live in raw storage and are constructed in place. A full stack doubles
+ * its capacity and a stack filled to less than a quarter halves it, so a push or
+ * a pop moves O(1) items on average and alternating pushes and pops at a boundary
+ * never reallocate twice in a row. Trivially copyable items are relocated with memcpy.
+ * The storage comes from @Allocator, pmr::Stack takes a memory resource.
+ *
+ * Time complexity (amortized):
  * ┌───────────┬──────────┐
  * │ Insertion │ Deletion │
  * │───────────┼──────────│
@@ -24,39 +30,174 @@
  */
 
 #pragma once
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
 #include "exceptions.h"
+#include "memory_resource.h"
+
+namespace stack
+{
+	template <class T, class Allocator>
+	T* allocate(Allocator& allocator, std::size_t capacity)
+	{
+		if (capacity == 0)
+			return nullptr;
+
+		return std::allocator_traits<Allocator>::allocate(allocator, capacity);
+	}
+
+	template <class T, class Allocator>
+	void deallocate(Allocator& allocator, T* data, std::size_t capacity) noexcept
+	{
+		if (data != nullptr)
+			std::allocator_traits<Allocator>::deallocate(allocator, data, capacity);
+	}
+
+	template <class T, class Allocator>
+	void destroy(Allocator&, T*, std::size_t, std::true_type) noexcept
+	{
+	}
+
+	template <class T, class Allocator>
+	void destroy(Allocator& allocator, T* data, std::size_t size, std::false_type) noexcept
+	{
+		for (std::size_t count = 0; count < size; ++count)
+			std::allocator_traits<Allocator>::destroy(allocator, data + count);
+	}
+
+	/**
+	 * Destroys @size items starting at @data, trivial items are left as they are
+	 */
+	template <class T, class Allocator>
+	void destroy(Allocator& allocator, T* data, std::size_t size) noexcept
+	{
+		destroy(allocator, data, size, std::is_trivially_destructible<T>());
+	}
+
+	/**
+	 * Move-constructs @size items from @from in the raw storage @to, items
+	 * whose move may throw are copied. If one throws, the items constructed
+	 * so far are destroyed and @from keeps all of its items
+	 */
+	template <class T, class Allocator>
+	void moveConstruct(Allocator& allocator, T* from, std::size_t size, T* to)
+	{
+		std::size_t count = 0;
+		try
+		{
+			for (; count < size; ++count)
+				std::allocator_traits<Allocator>::construct(allocator, to + count, std::move_if_noexcept(from[count]));
+		}
+		catch (...)
+		{
+			destroy(allocator, to, count);
+			throw;
+		}
+	}
+
+	template <class T, class Allocator>
+	void relocate(Allocator&, T* from, std::size_t size, T* to, std::true_type) noexcept
+	{
+		if (size > 0)
+			std::memcpy(static_cast<void*>(to), static_cast<const void*>(from), size * sizeof(T));
+	}
+
+	template <class T, class Allocator>
+	void relocate(Allocator& allocator, T* from, std::size_t size, T* to, std::false_type)
+	{
+		moveConstruct(allocator, from, size, to);
+		destroy(allocator, from, size);
+	}
+
+	/**
+	 * Moves @size items from @from to the raw storage @to and destroys the originals.
+	 * If a copy throws, @to is left raw and @from keeps all of its items
+	 */
+	template <class T, class Allocator>
+	void relocate(Allocator& allocator, T* from, std::size_t size, T* to)
+	{
+		relocate(allocator, from, size, to, std::is_trivially_copyable<T>());
+	}
+
+	template <class T, class Allocator>
+	void copy(Allocator&, const T* from, std::size_t size, T* to, std::true_type) noexcept
+	{
+		if (size > 0)
+			std::memcpy(static_cast<void*>(to), static_cast<const void*>(from), size * sizeof(T));
+	}
+
+	template <class T, class Allocator>
+	void copy(Allocator& allocator, const T* from, std::size_t size, T* to, std::false_type)
+	{
+		std::size_t count = 0;
+		try
+		{
+			for (; count < size; ++count)
+				std::allocator_traits<Allocator>::construct(allocator, to + count, from[count]);
+		}
+		catch (...)
+		{
+			destroy(allocator, to, count);
+			throw;
+		}
+	}
+
+	/**
+	 * Copy-constructs @size items from @from in the raw storage @to.
+	 * If a copy throws, the items constructed so far are destroyed
+	 */
+	template <class T, class Allocator>
+	void copy(Allocator& allocator, const T* from, std::size_t size, T* to)
+	{
+		copy(allocator, from, size, to, std::is_trivially_copyable<T>());
+	}
+}
 
-template <class T>
+template <class T, class Allocator = std::allocator<T>>
 class Stack
 {
 private:
 	std::size_t m_capacity;
 	std::size_t m_size;
 	T* m_data;
+	Allocator m_allocator;
 	struct constants
 	{
 		static const std::size_t default_capacity = 16;
-		static const std::size_t extended_capacity = 16;
+		static const std::size_t growth_factor = 2;
 	};
+
+	T* moveItems(Stack<T, Allocator>& s);
 public:
-	Stack(std::size_t capacity = constants::default_capacity);
-	Stack(Stack<T>& s);
-	Stack(Stack<T>&& s) noexcept;
+	Stack(std::size_t capacity = constants::default_capacity, const Allocator& allocator = Allocator());
+	explicit Stack(const Allocator& allocator);
+	Stack(const Stack<T, Allocator>& s);
+	Stack(Stack<T, Allocator>&& s) noexcept;
 	~Stack();
 	bool isEmpty() const noexcept;
 	void clear() noexcept;
-	void reallocate(std::size_t capacity) noexcept;
-	void push_back(const T& item) noexcept;
+	void reallocate(std::size_t capacity);
+	void push_back(const T& item);
+	void push_back(T&& item);
+	template <class... Args>
+	T& emplace_back(Args&&... args);
 	T pop();
 	T peek();
 	std::size_t getSize() const noexcept;
 	std::size_t getCapacity() const noexcept;
+	Allocator getAllocator() const noexcept;
 	
-	Stack& operator=(const Stack<T>& s) noexcept;
-	Stack& operator=(Stack<T>&& s) noexcept;
+	Stack& operator=(const Stack<T, Allocator>& s);
+	Stack& operator=(Stack<T, Allocator>&& s) noexcept(std::is_empty<Allocator>::value);
 
-	friend void swap(Stack<T>& l, Stack<T>& r) noexcept
+	/**
+	 * Swaps the items, the allocators of @l and @r must compare equal
+	 */
+	friend void swap(Stack<T, Allocator>& l, Stack<T, Allocator>& r) noexcept
 	{
 		std::swap(l.m_capacity, r.m_capacity);
 		std::swap(l.m_size, r.m_size);
@@ -67,33 +208,49 @@ public:
 /** 
  * Default constructor
  */
-template <class T>
-Stack<T>::Stack(std::size_t capacity) : m_capacity(capacity), m_size(0)
+template <class T, class Allocator>
+Stack<T, Allocator>::Stack(std::size_t capacity, const Allocator& allocator)
+	: m_capacity(capacity), m_size(0), m_allocator(allocator)
+{
+	m_data = stack::allocate<T>(m_allocator, capacity);
+}
+
+/**
+ * Creates a stack of default capacity that takes its memory from @allocator
+ */
+template <class T, class Allocator>
+Stack<T, Allocator>::Stack(const Allocator& allocator) : Stack(constants::default_capacity, allocator)
 {
-	m_data = new T[capacity];
 }
 
 /**
  * Copy constructor
  */
-template <class T>
-Stack<T>::Stack(Stack<T>& s)
+template <class T, class Allocator>
+Stack<T, Allocator>::Stack(const Stack<T, Allocator>& s) : m_capacity(s.m_capacity), m_size(0),
+	m_allocator(std::allocator_traits<Allocator>::select_on_container_copy_construction(s.m_allocator))
 {
-	m_size = s.m_size;
-	m_capacity = s.m_capacity;
-	m_data = new T[m_capacity];
+	m_data = stack::allocate<T>(m_allocator, m_capacity);
 
-	for (std::size_t count = 0; count < m_size; ++count)
+	try
 	{
-		m_data[count] = s.m_data[count];
+		stack::copy(m_allocator, s.m_data, s.m_size, m_data);
 	}
+	catch (...)
+	{
+		stack::deallocate(m_allocator, m_data, m_capacity);
+		throw;
+	}
+
+	m_size = s.m_size;
 }
 
 /**
  * Move assignment constructor
  */
-template <class T>
-Stack<T>::Stack(Stack<T>&& s) noexcept
+template <class T, class Allocator>
+Stack<T, Allocator>::Stack(Stack<T, Allocator>&& s) noexcept
+	: m_capacity(0), m_size(0), m_data(nullptr), m_allocator(std::move(s.m_allocator))
 {
 	swap(*this, s);
 }
@@ -101,17 +258,40 @@ Stack<T>::Stack(Stack<T>&& s) noexcept
 /**
  * Destructor
  */
-template <class T>
-Stack<T>::~Stack()
+template <class T, class Allocator>
+Stack<T, Allocator>::~Stack()
 {
-	delete[] m_data;
+	stack::destroy(m_allocator, m_data, m_size);
+	stack::deallocate(m_allocator, m_data, m_capacity);
+}
+
+/**
+ * Moves the items of @s to new storage of the same capacity from this allocator.
+ * @s keeps its items if a copy throws
+ */
+template <class T, class Allocator>
+T* Stack<T, Allocator>::moveItems(Stack<T, Allocator>& s)
+{
+	T* data = stack::allocate<T>(m_allocator, s.m_capacity);
+
+	try
+	{
+		stack::relocate(m_allocator, s.m_data, s.m_size, data);
+	}
+	catch (...)
+	{
+		stack::deallocate(m_allocator, data, s.m_capacity);
+		throw;
+	}
+
+	return data;
 }
 
 /**
  * Returns @true if the stack is empty
  */
-template <class T>
-bool Stack<T>::isEmpty() const noexcept
+template <class T, class Allocator>
+bool Stack<T, Allocator>::isEmpty() const noexcept
 {
 	return (m_size == 0);
 }
@@ -119,84 +299,129 @@ bool Stack<T>::isEmpty() const noexcept
 /**
  * Clears the stack
  */
-template <class T>
-void Stack<T>::clear() noexcept
+template <class T, class Allocator>
+void Stack<T, Allocator>::clear() noexcept
 {
-	delete[] m_data;
+	stack::destroy(m_allocator, m_data, m_size);
+	stack::deallocate(m_allocator, m_data, m_capacity);
 	m_data = nullptr;
 	m_size = 0;
 	m_capacity = 0;
 }
 
 /**
- * Reallocates memory for data without data loss
+ * Reallocates memory for data without data loss.
+ * Items that do not fit in the new @capacity are destroyed
  */
-template <class T>
-void Stack<T>::reallocate(std::size_t capacity) noexcept
+template <class T, class Allocator>
+void Stack<T, Allocator>::reallocate(std::size_t capacity)
 {
 	if (m_capacity == capacity)
 		return;
 
-	if (m_data == nullptr)
+	T* data = stack::allocate<T>(m_allocator, capacity);
+
+	if (m_size > capacity)
 	{
-		m_data = new T[capacity];
-		m_capacity = capacity;
+		stack::destroy(m_allocator, m_data + capacity, m_size - capacity);
+		m_size = capacity;
 	}
-	else
-	{
-		T* data = new T[capacity];
 
-		if (m_capacity < capacity)
-		{
-			for (std::size_t count = 0; count < m_capacity; ++count)
-			{
-				data[count] = m_data[count];
-			}
-		}
-		else
-			if (m_capacity > capacity)
-			{
-				if (m_size > capacity)
-					m_size = capacity;
-				for (std::size_t count = 0; count < capacity; ++count)
-				{
-					data[count] = m_data[count];
-				}
-			}
-
-
-		m_capacity = capacity;
-		delete[] m_data;
-		m_data = data;
+	try
+	{
+		stack::relocate(m_allocator, m_data, m_size, data);
+	}
+	catch (...)
+	{
+		stack::deallocate(m_allocator, data, capacity);
+		throw;
 	}
+	stack::deallocate(m_allocator, m_data, m_capacity);
+
+	m_capacity = capacity;
+	m_data = data;
 }
 
 /**
  * Adds an @item to the stack
  */
-template <class T>
-void Stack<T>::push_back(const T& item) noexcept
+template <class T, class Allocator>
+void Stack<T, Allocator>::push_back(const T& item)
 {
-	if ((m_size + 1) == m_capacity || m_size == m_capacity)
-		reallocate(m_capacity + constants::extended_capacity);
-	m_data[m_size] = item;
-	++m_size;
+	emplace_back(item);
+}
+
+/**
+ * Moves an @item to the stack
+ */
+template <class T, class Allocator>
+void Stack<T, Allocator>::push_back(T&& item)
+{
+	emplace_back(std::move(item));
+}
+
+/**
+ * Constructs an item from @args on top of the stack and returns it.
+ * A full stack grows by growth_factor
+ */
+template <class T, class Allocator>
+template <class... Args>
+T& Stack<T, Allocator>::emplace_back(Args&&... args)
+{
+	if (m_size < m_capacity)
+	{
+		std::allocator_traits<Allocator>::construct(m_allocator, m_data + m_size, std::forward<Args>(args)...);
+		return m_data[m_size++];
+	}
+
+	const std::size_t capacity = (m_capacity == 0) ? std::size_t(constants::default_capacity)
+		: m_capacity * constants::growth_factor;
+	T* data = stack::allocate<T>(m_allocator, capacity);
+
+	// The new item is constructed first, @args may refer to an item of the old storage
+	try
+	{
+		std::allocator_traits<Allocator>::construct(m_allocator, data + m_size, std::forward<Args>(args)...);
+	}
+	catch (...)
+	{
+		stack::deallocate(m_allocator, data, capacity);
+		throw;
+	}
+
+	try
+	{
+		stack::relocate(m_allocator, m_data, m_size, data);
+	}
+	catch (...)
+	{
+		stack::destroy(m_allocator, data + m_size, 1);
+		stack::deallocate(m_allocator, data, capacity);
+		throw;
+	}
+	stack::deallocate(m_allocator, m_data, m_capacity);
+
+	m_capacity = capacity;
+	m_data = data;
+	return m_data[m_size++];
 }
 
 /**
  * Deletes the last added item from the stack and returns it
  * Makes auto reallocate when capacity is four times the size
  */
-template <class T>
-T Stack<T>::pop()
+template <class T, class Allocator>
+T Stack<T, Allocator>::pop()
 {
 	if (isEmpty())
 		throw StackEmptyException();
 
-	T tmp = m_data[m_size - 1];
+	T tmp = std::move(m_data[m_size - 1]);
 	--m_size;
+	stack::destroy(m_allocator, m_data + m_size, 1);
 
-	if (m_size < m_capacity / 4)
+	// Never shrinks below the default capacity, small stacks would reallocate on every other push
+	if (m_size < m_capacity / 4 && m_capacity / 2 >= constants::default_capacity)
 	{
 		reallocate(m_capacity / 2);
 	}
@@ -207,8 +432,8 @@ T Stack<T>::pop()
 /**
  * Returns the last added item from the stack
  */
-template <class T>
-T Stack<T>::peek()
+template <class T, class Allocator>
+T Stack<T, Allocator>::peek()
 {
 	if (isEmpty())
 		throw StackEmptyException();
@@ -219,8 +444,8 @@ T Stack<T>::peek()
 /**
  * Returns stack size
  */
-template <class T>
-std::size_t Stack<T>::getSize() const noexcept
+template <class T, class Allocator>
+std::size_t Stack<T, Allocator>::getSize() const noexcept
 {
 	return m_size;
 }
@@ -228,43 +453,83 @@ std::size_t Stack<T>::getSize() const noexcept
 /**
  * Returns stack capacity
  */
-template <class T>
-std::size_t Stack<T>::getCapacity() const noexcept
+template <class T, class Allocator>
+std::size_t Stack<T, Allocator>::getCapacity() const noexcept
 {
 	return m_capacity;
 }
 
 /**
- * Copy assignment operator
+ * Returns the allocator of the stack
  */
-template <class T>
-Stack<T>& Stack<T>::operator=(const Stack<T>& s) noexcept
+template <class T, class Allocator>
+Allocator Stack<T, Allocator>::getAllocator() const noexcept
+{
+	return m_allocator;
+}
+
+/**
+ * Copy assignment operator, the stack keeps its allocator
+ */
+template <class T, class Allocator>
+Stack<T, Allocator>& Stack<T, Allocator>::operator=(const Stack<T, Allocator>& s)
 {
 	if (this == &s)
 		return *this;
 
-	this->clear();
-	m_capacity = s.m_capacity;
-	m_size = s.m_size;
+	T* data = stack::allocate<T>(m_allocator, s.m_capacity);
 
-	m_data = new T[m_capacity];
-	for (std::size_t count = 0; count < m_size; ++count)
+	try
 	{
-		m_data[count] = s.m_data[count];
+		stack::copy(m_allocator, s.m_data, s.m_size, data);
 	}
+	catch (...)
+	{
+		stack::deallocate(m_allocator, data, s.m_capacity);
+		throw;
+	}
+
+	clear();
+	m_data = data;
+	m_capacity = s.m_capacity;
+	m_size = s.m_size;
 
 	return *this;
 }
 
 /**
- * Move assignment operator
+ * Move assignment operator. The storage of @s is taken over when
+ * both allocators are equal, otherwise the items are moved one by one
  */
-template <class T>
-Stack<T>& Stack<T>::operator=(Stack<T>&& s) noexcept
+template <class T, class Allocator>
+Stack<T, Allocator>& Stack<T, Allocator>::operator=(Stack<T, Allocator>&& s) noexcept(std::is_empty<Allocator>::value)
 {
 	if (this == &s)
 		return *this;
 
+	if (!(m_allocator == s.m_allocator))
+	{
+		T* data = moveItems(s);
+
+		clear();
+		m_data = data;
+		m_capacity = s.m_capacity;
+		m_size = s.m_size;
+
+		s.m_size = 0;
+		s.clear();
+		return *this;
+	}
+
+	clear();
 	swap(*this, s);
 	return *this;
-}
\ No newline at end of file
+}
+
+#if DATA_STRUCTURES_PMR
+namespace pmr
+{
+	template <class T>
+	using Stack = ::Stack<T, std::pmr::polymorphic_allocator<T>>;
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,213 @@
+#include "../blocking_queue.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace BlockingQueueTest
+{
+	TEST(BlockingQueueTest, BlockingQueueCreatesEmpty)
+	{
+		BlockingQueue<int> queue;
+		int item = 0;
+		EXPECT_TRUE(queue.isEmpty());
+		EXPECT_FALSE(queue.isClosed());
+		EXPECT_FALSE(queue.tryDequeue(item));
+
+		const auto start = std::chrono::steady_clock::now();
+		EXPECT_FALSE(queue.dequeueFor(item, std::chrono::milliseconds(20)));
+		EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+	}
+
+	TEST(BlockingQueueTest, BlockingQueueIsFifo)
+	{
+		BlockingQueue<int> queue;
+		for (int i = 0; i < 100; i++)
+			EXPECT_TRUE(queue.enqueue(i));
+		EXPECT_EQ(queue.getSize(), 100);
+
+		int item = 0;
+		for (int i = 0; i < 100; i += 2)
+		{
+			ASSERT_TRUE(queue.tryDequeue(item));
+			EXPECT_EQ(item, i);
+			ASSERT_TRUE(queue.dequeue(item));
+			EXPECT_EQ(item, i + 1);
+		}
+		EXPECT_TRUE(queue.isEmpty());
+
+		BlockingQueue<std::unique_ptr<int>> pointers;
+		pointers.emplace(new int(7));
+		std::unique_ptr<int> pointer;
+		ASSERT_TRUE(pointers.dequeueFor(pointer, std::chrono::hours(1000000)));
+		EXPECT_EQ(*pointer, 7);
+	}
+
+	TEST(BlockingQueueTest, BlockingQueueWakesConsumer)
+	{
+		BlockingQueue<int> queue;
+
+		std::thread producer([&]()
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			queue.enqueue(1);
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			queue.enqueue(2);
+		});
+
+		int item = 0;
+		ASSERT_TRUE(queue.dequeue(item));
+		EXPECT_EQ(item, 1);
+		ASSERT_TRUE(queue.dequeueFor(item, std::chrono::seconds(10)));
+		EXPECT_EQ(item, 2);
+		producer.join();
+	}
+
+	TEST(BlockingQueueTest, BlockingQueueWaitsForMaxTimeout)
+	{
+		BlockingQueue<int> queue;
+
+		std::thread producer([&]()
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			queue.enqueue(1);
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			queue.enqueue(2);
+		});
+
+		// Both are far beyond what the clock's nanoseconds can hold
+		int item = 0;
+		ASSERT_TRUE(queue.dequeueFor(item, std::chrono::seconds::max()));
+		EXPECT_EQ(item, 1);
+		ASSERT_TRUE(queue.dequeueFor(item, std::chrono::hours(24 * 365 * 1000)));
+		EXPECT_EQ(item, 2);
+		producer.join();
+	}
+
+	TEST(BlockingQueueTest, BlockingQueueDrainsBatches)
+	{
+		BlockingQueue<int> queue;
+		for (int i = 0; i < 10; i++)
+			queue.enqueue(i);
+
+		std::vector<int> items;
+		EXPECT_EQ(queue.drainUpTo(4, std::back_inserter(items)), 4);
+		EXPECT_EQ(queue.drainUpTo(100, std::back_inserter(items)), 6);
+		EXPECT_EQ(queue.drainUpTo(0, std::back_inserter(items)), 0);
+		ASSERT_EQ(items.size(), 10);
+		for (int i = 0; i < 10; i++)
+			EXPECT_EQ(items[i], i);
+
+		// Waits for the first item
+		std::thread producer([&]()
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			queue.enqueue(10);
+		});
+		EXPECT_EQ(queue.drainUpTo(100, std::back_inserter(items)), 1);
+		EXPECT_EQ(items.back(), 10);
+		producer.join();
+	}
+
+	TEST(BlockingQueueTest, BlockingQueueCloses)
+	{
+		BlockingQueue<int> queue;
+		std::vector<std::thread> consumers;
+		std::atomic<int> stopped(0);
+
+		for (int i = 0; i < 4; i++)
+		{
+			consumers.emplace_back([&]()
+			{
+				int item;
+				EXPECT_FALSE(queue.dequeue(item));
+				stopped.fetch_add(1);
+			});
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		queue.close();
+		for (std::thread& consumer : consumers)
+			consumer.join();
+		EXPECT_EQ(stopped.load(), 4);
+
+		EXPECT_TRUE(queue.isClosed());
+		EXPECT_FALSE(queue.enqueue(1));
+		int item = 0;
+		EXPECT_FALSE(queue.dequeueFor(item, std::chrono::seconds(10)));
+		EXPECT_EQ(queue.drainUpTo(10, &item), 0);
+
+		// The items added before closing are still taken
+		BlockingQueue<int> rest;
+		rest.enqueue(1);
+		rest.enqueue(2);
+		rest.close();
+		ASSERT_TRUE(rest.dequeue(item));
+		EXPECT_EQ(item, 1);
+		ASSERT_TRUE(rest.dequeue(item));
+		EXPECT_EQ(item, 2);
+		EXPECT_FALSE(rest.dequeue(item));
+	}
+
+	TEST(BlockingQueueTest, BlockingQueueManyThreads)
+	{
+		const int producerCount = 4;
+		const int consumerCount = 4;
+		const int itemsPerProducer = 20000;
+		BlockingQueue<int> queue;
+		std::vector<std::atomic<int>> seen(producerCount * itemsPerProducer);
+		for (std::atomic<int>& count : seen)
+			count.store(0);
+
+		std::vector<std::thread> producers;
+		for (int producer = 0; producer < producerCount; producer++)
+		{
+			producers.emplace_back([&, producer]()
+			{
+				for (int i = 0; i < itemsPerProducer; i++)
+					queue.enqueue(producer * itemsPerProducer + i);
+			});
+		}
+
+		// Consumers run until the queue is closed and drained
+		std::vector<std::thread> consumers;
+		for (int consumer = 0; consumer < consumerCount; consumer++)
+		{
+			consumers.emplace_back([&, consumer]()
+			{
+				int batch[16];
+				int item;
+				for (;;)
+				{
+					if (consumer % 2 == 0)
+					{
+						const std::size_t taken = queue.drainUpTo(16, batch);
+						if (taken == 0)
+							return;
+						for (std::size_t i = 0; i < taken; i++)
+							seen[batch[i]].fetch_add(1);
+					}
+					else
+					{
+						if (!queue.dequeue(item))
+							return;
+						seen[item].fetch_add(1);
+					}
+				}
+			});
+		}
+
+		for (std::thread& producer : producers)
+			producer.join();
+		queue.close();
+		for (std::thread& consumer : consumers)
+			consumer.join();
+
+		EXPECT_TRUE(queue.isEmpty());
+		for (std::atomic<int>& count : seen)
+			ASSERT_EQ(count.load(), 1);
+	}
+}
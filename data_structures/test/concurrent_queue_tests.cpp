@@ -0,0 +1,221 @@
+#include "../concurrent_queue.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace ConcurrentQueueTest
+{
+	class CountingResource : public memory::MemoryResource
+	{
+	public:
+		std::size_t allocations = 0;
+		std::size_t liveBytes = 0;
+	private:
+		void* do_allocate(std::size_t bytes, std::size_t alignment) override
+		{
+			++allocations;
+			liveBytes += bytes;
+			return memory::newDeleteResource()->allocate(bytes, alignment);
+		}
+
+		void do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) override
+		{
+			liveBytes -= bytes;
+			memory::newDeleteResource()->deallocate(pointer, bytes, alignment);
+		}
+
+		bool do_is_equal(const memory::MemoryResource& other) const noexcept override
+		{
+			return this == &other;
+		}
+	};
+
+	TEST(ConcurrentQueueTest, ConcurrentQueueCreatesEmpty)
+	{
+		ConcurrentQueue<int> queue;
+		int item = 0;
+		EXPECT_TRUE(queue.isEmpty());
+		EXPECT_FALSE(queue.tryDequeue(item));
+
+		ConcurrentQueue<int>::Producer producer = queue.makeProducer();
+		EXPECT_TRUE(queue.isEmpty());
+		EXPECT_FALSE(queue.tryDequeue(item));
+	}
+
+	TEST(ConcurrentQueueTest, ConcurrentQueueKeepsProducerOrder)
+	{
+		ConcurrentQueue<int> queue;
+		ConcurrentQueue<int>::Producer first = queue.makeProducer();
+		ConcurrentQueue<int>::Producer second = queue.makeProducer();
+
+		for (int i = 0; i < 1000; i++)
+		{
+			first.enqueue(i);
+			second.enqueue(10000 + i);
+		}
+		EXPECT_EQ(queue.getSize(), 2000);
+
+		int nextFirst = 0;
+		int nextSecond = 10000;
+		int item = 0;
+		while (queue.tryDequeue(item))
+		{
+			if (item < 10000)
+				ASSERT_EQ(item, nextFirst++);
+			else
+				ASSERT_EQ(item, nextSecond++);
+		}
+
+		EXPECT_EQ(nextFirst, 1000);
+		EXPECT_EQ(nextSecond, 11000);
+		EXPECT_TRUE(queue.isEmpty());
+	}
+
+	TEST(ConcurrentQueueTest, ConcurrentQueueBulk)
+	{
+		ConcurrentQueue<int> queue;
+		ConcurrentQueue<int>::Producer producer = queue.makeProducer();
+		std::vector<int> input(150);
+		for (int i = 0; i < 150; i++)
+			input[i] = i;
+
+		producer.enqueueBulk(input.begin(), input.size());
+		producer.enqueueBulk(input.begin(), 50);
+
+		std::vector<int> output;
+		EXPECT_EQ(queue.tryDequeueBulk(std::back_inserter(output), 120), 120);
+		EXPECT_EQ(queue.tryDequeueBulk(std::back_inserter(output), 1000), 80);
+		EXPECT_EQ(queue.tryDequeueBulk(std::back_inserter(output), 1000), 0);
+
+		ASSERT_EQ(output.size(), 200);
+		for (int i = 0; i < 200; i++)
+			ASSERT_EQ(output[i], i % 150);
+	}
+
+	TEST(ConcurrentQueueTest, ConcurrentQueueRecyclesBlocks)
+	{
+		CountingResource resource;
+		{
+			ConcurrentQueue<int, ResourceAllocator<int>> queue(&resource);
+			ConcurrentQueue<int, ResourceAllocator<int>>::Producer producer = queue.makeProducer();
+			std::vector<int> items(200);
+
+			// The ring grows to the largest backlog (at every offset within a block) and then is reused
+			for (int round = 0; round < 16; round++)
+			{
+				producer.enqueueBulk(items.begin(), items.size());
+				EXPECT_EQ(queue.tryDequeueBulk(items.begin(), items.size()), items.size());
+			}
+			const std::size_t allocations = resource.allocations;
+
+			for (int round = 0; round < 1000; round++)
+			{
+				producer.enqueueBulk(items.begin(), items.size());
+				ASSERT_EQ(queue.tryDequeueBulk(items.begin(), items.size()), items.size());
+			}
+			EXPECT_EQ(resource.allocations, allocations);
+
+			// A finished producer leaves its sub-queue to the next one
+			{
+				ConcurrentQueue<int, ResourceAllocator<int>>::Producer moved(std::move(producer));
+			}
+			ConcurrentQueue<int, ResourceAllocator<int>>::Producer next = queue.makeProducer();
+			next.enqueue(1);
+			EXPECT_EQ(resource.allocations, allocations);
+		}
+		EXPECT_EQ(resource.liveBytes, 0);
+	}
+
+	TEST(ConcurrentQueueTest, ConcurrentQueueDestroysLeftItems)
+	{
+		std::shared_ptr<int> counter(new int(0));
+		{
+			ConcurrentQueue<std::shared_ptr<int>> queue;
+			ConcurrentQueue<std::shared_ptr<int>>::Producer producer = queue.makeProducer();
+			for (int i = 0; i < 100; i++)
+				producer.enqueue(counter);
+
+			std::shared_ptr<int> item;
+			for (int i = 0; i < 70; i++)
+				ASSERT_TRUE(queue.tryDequeue(item));
+			item.reset();
+			EXPECT_EQ(counter.use_count(), 31);
+		}
+		EXPECT_EQ(counter.use_count(), 1);
+
+		ConcurrentQueue<std::unique_ptr<int>> queue;
+		ConcurrentQueue<std::unique_ptr<int>>::Producer producer = queue.makeProducer();
+		producer.enqueue(std::unique_ptr<int>(new int(1)));
+		producer.emplace(new int(2));
+		std::unique_ptr<int> item;
+		ASSERT_TRUE(queue.tryDequeue(item));
+		EXPECT_EQ(*item, 1);
+	}
+
+	TEST(ConcurrentQueueTest, ConcurrentQueueManyThreads)
+	{
+		const int producerCount = 4;
+		const int consumerCount = 4;
+		const int itemsPerProducer = 50000;
+		ConcurrentQueue<int> queue;
+		std::vector<std::atomic<int>> seen(producerCount * itemsPerProducer);
+		for (std::atomic<int>& count : seen)
+			count.store(0);
+
+		std::vector<std::thread> threads;
+		for (int producer = 0; producer < producerCount; producer++)
+		{
+			threads.emplace_back([&, producer]()
+			{
+				ConcurrentQueue<int>::Producer handle = queue.makeProducer();
+				int batch[16];
+				for (int i = 0; i < itemsPerProducer; i += 16)
+				{
+					for (int j = 0; j < 16; j++)
+						batch[j] = producer * itemsPerProducer + i + j;
+
+					if (producer % 2 == 0)
+						handle.enqueueBulk(batch, 16);
+					else
+						for (int j = 0; j < 16; j++)
+							handle.enqueue(batch[j]);
+				}
+			});
+		}
+
+		std::atomic<int> left(producerCount * itemsPerProducer);
+		for (int consumer = 0; consumer < consumerCount; consumer++)
+		{
+			threads.emplace_back([&]()
+			{
+				// Every consumer sees the items of one producer in order
+				std::vector<int> last(producerCount, -1);
+				int batch[32];
+				while (left.load() > 0)
+				{
+					const std::size_t taken = queue.tryDequeueBulk(batch, 32);
+					for (std::size_t i = 0; i < taken; i++)
+					{
+						const int producer = batch[i] / itemsPerProducer;
+						EXPECT_GT(batch[i], last[producer]);
+						last[producer] = batch[i];
+						seen[batch[i]].fetch_add(1);
+					}
+					left.fetch_sub(static_cast<int>(taken));
+					if (taken == 0)
+						std::this_thread::yield();
+				}
+			});
+		}
+
+		for (std::thread& thread : threads)
+			thread.join();
+
+		EXPECT_TRUE(queue.isEmpty());
+		for (std::atomic<int>& count : seen)
+			ASSERT_EQ(count.load(), 1);
+	}
+}
@@ -0,0 +1,94 @@
+#include "../concurrent_stack.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace ConcurrentStackTest
+{
+	TEST(ConcurrentStackTest, ConcurrentStackCreatesEmpty)
+	{
+		ConcurrentStack<int> stack;
+		int item = 0;
+		EXPECT_TRUE(stack.isEmpty());
+		EXPECT_FALSE(stack.tryPop(item));
+		EXPECT_THROW(stack.pop(), StackEmptyException);
+	}
+
+	TEST(ConcurrentStackTest, ConcurrentStackIsLifo)
+	{
+		ConcurrentStack<int> stack;
+		for (int i = 0; i < 1000; i++)
+		{
+			stack.push_back(i);
+		}
+
+		for (int i = 999; i >= 0; i--)
+		{
+			ASSERT_EQ(stack.pop(), i);
+		}
+		EXPECT_TRUE(stack.isEmpty());
+	}
+
+	TEST(ConcurrentStackTest, ConcurrentStackMoveOnlyItems)
+	{
+		ConcurrentStack<std::unique_ptr<int>> stack;
+		stack.push_back(std::unique_ptr<int>(new int(1)));
+		stack.emplace_back(new int(2));
+
+		std::unique_ptr<int> item;
+		ASSERT_TRUE(stack.tryPop(item));
+		EXPECT_EQ(*item, 2);
+		ASSERT_TRUE(stack.tryPop(item));
+		EXPECT_EQ(*item, 1);
+		EXPECT_FALSE(stack.tryPop(item));
+	}
+
+	TEST(ConcurrentStackTest, ConcurrentStackManyThreads)
+	{
+		const int threadCount = 8;
+		const int itemsPerThread = 20000;
+		ConcurrentStack<int> stack;
+		std::vector<std::atomic<int>> seen(threadCount * itemsPerThread);
+		for (std::atomic<int>& count : seen)
+			count.store(0);
+
+		// Every thread pushes its own items and pops as many, in bursts
+		std::vector<std::thread> threads;
+		for (int thread = 0; thread < threadCount; thread++)
+		{
+			threads.emplace_back([&, thread]()
+			{
+				int popped = 0;
+				for (int i = 0; i < itemsPerThread; i++)
+				{
+					stack.push_back(thread * itemsPerThread + i);
+					int item;
+					if (i % 3 != 0 && stack.tryPop(item))
+					{
+						seen[item].fetch_add(1);
+						++popped;
+					}
+				}
+
+				int item;
+				while (popped < itemsPerThread)
+				{
+					if (stack.tryPop(item))
+					{
+						seen[item].fetch_add(1);
+						++popped;
+					}
+				}
+			});
+		}
+
+		for (std::thread& thread : threads)
+			thread.join();
+
+		EXPECT_TRUE(stack.isEmpty());
+		for (std::atomic<int>& count : seen)
+			ASSERT_EQ(count.load(), 1);
+	}
+}
@@ -0,0 +1,205 @@
+#include "../dary_heap.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace DaryHeapTest
+{
+	TEST(DaryHeapTest, DaryHeapCreatesEmpty)
+	{
+		DaryHeap<int> heap;
+		EXPECT_TRUE(heap.isEmpty());
+		EXPECT_EQ(heap.getSize(), 0);
+		EXPECT_THROW(heap.top(), HeapEmptyException);
+		EXPECT_THROW(heap.pop(), HeapEmptyException);
+	}
+
+	TEST(DaryHeapTest, DaryHeapPopsInOrder)
+	{
+		std::mt19937 random(7);
+		std::vector<int> items(5000);
+		for (int& item : items)
+			item = static_cast<int>(random() % 1000);
+
+		DaryHeap<int> fourAry;
+		DaryHeap<int, 8> eightAry;
+		DaryHeap<int, 2, std::greater<int>> binaryMax;
+		for (int item : items)
+		{
+			fourAry.push(item);
+			eightAry.push(item);
+			binaryMax.push(item);
+		}
+		EXPECT_EQ(fourAry.getSize(), items.size());
+
+		std::sort(items.begin(), items.end());
+		for (std::size_t i = 0; i < items.size(); i++)
+		{
+			ASSERT_EQ(fourAry.top(), items[i]);
+			ASSERT_EQ(fourAry.pop(), items[i]);
+			ASSERT_EQ(eightAry.pop(), items[i]);
+			ASSERT_EQ(binaryMax.pop(), items[items.size() - 1 - i]);
+		}
+		EXPECT_TRUE(fourAry.isEmpty());
+	}
+
+	TEST(DaryHeapTest, DaryHeapHeapifiesRange)
+	{
+		for (int size = 0; size < 40; size++)
+		{
+			std::vector<int> items(size);
+			for (int i = 0; i < size; i++)
+				items[i] = (i * 17) % 23;
+
+			DaryHeap<int> heap(items.begin(), items.end());
+			ASSERT_EQ(heap.getSize(), items.size());
+
+			// The handles follow the order of the range
+			for (int i = 0; i < size; i++)
+				ASSERT_EQ(heap.get(i), items[i]);
+
+			std::sort(items.begin(), items.end());
+			for (int item : items)
+				ASSERT_EQ(heap.pop(), item);
+		}
+	}
+
+	TEST(DaryHeapTest, DaryHeapHandles)
+	{
+		DaryHeap<int> heap;
+		const DaryHeap<int>::Handle ten = heap.push(10);
+		const DaryHeap<int>::Handle twenty = heap.push(20);
+		const DaryHeap<int>::Handle thirty = heap.push(30);
+		EXPECT_EQ(heap.topHandle(), ten);
+
+		heap.decreaseKey(thirty, 5);
+		EXPECT_EQ(heap.topHandle(), thirty);
+		EXPECT_EQ(heap.get(thirty), 5);
+
+		heap.update(thirty, 25);
+		EXPECT_EQ(heap.topHandle(), ten);
+
+		EXPECT_EQ(heap.erase(ten), 10);
+		EXPECT_FALSE(heap.contains(ten));
+		EXPECT_THROW(heap.erase(ten), std::out_of_range);
+		EXPECT_THROW(heap.decreaseKey(ten, 1), std::out_of_range);
+		EXPECT_THROW(heap.get(100), std::out_of_range);
+
+		// The freed handle is given to the next item
+		EXPECT_EQ(heap.push(1), ten);
+		EXPECT_EQ(heap.pop(), 1);
+		EXPECT_EQ(heap.pop(), 20);
+		EXPECT_EQ(heap.pop(), 25);
+		EXPECT_FALSE(heap.contains(twenty));
+		EXPECT_TRUE(heap.isEmpty());
+	}
+
+	TEST(DaryHeapTest, DaryHeapRandomOperations)
+	{
+		std::mt19937 random(11);
+		DaryHeap<int, 4> heap;
+		std::vector<std::pair<int, DaryHeap<int>::Handle>> reference;
+
+		for (int step = 0; step < 20000; step++)
+		{
+			const unsigned operation = random() % 4;
+			if (operation < 2 || reference.empty())
+			{
+				const int item = static_cast<int>(random() % 100000);
+				reference.emplace_back(item, heap.push(item));
+			}
+			else if (operation == 2)
+			{
+				std::pair<int, DaryHeap<int>::Handle>& entry = reference[random() % reference.size()];
+				entry.first -= static_cast<int>(random() % 1000);
+				heap.decreaseKey(entry.second, entry.first);
+			}
+			else
+			{
+				const std::size_t index = random() % reference.size();
+				ASSERT_EQ(heap.erase(reference[index].second), reference[index].first);
+				reference[index] = reference.back();
+				reference.pop_back();
+			}
+
+			ASSERT_EQ(heap.getSize(), reference.size());
+			if (!reference.empty())
+			{
+				ASSERT_EQ(heap.top(), std::min_element(reference.begin(), reference.end())->first);
+			}
+		}
+	}
+
+	TEST(DaryHeapTest, DaryHeapShortestPaths)
+	{
+		// Dijkstra on a grid, where a step right costs 1 and a step down costs 2
+		const int width = 30;
+		const int height = 20;
+		const int unreached = 1 << 30;
+		std::vector<int> distances(width * height, unreached);
+		std::vector<DaryHeap<std::pair<int, int>>::Handle> handles(width * height);
+		std::vector<bool> queued(width * height, false);
+		DaryHeap<std::pair<int, int>> heap;
+
+		distances[0] = 0;
+		handles[0] = heap.push(std::make_pair(0, 0));
+		queued[0] = true;
+		while (!heap.isEmpty())
+		{
+			const std::pair<int, int> current = heap.pop();
+			queued[current.second] = false;
+
+			const int x = current.second % width;
+			const int y = current.second / width;
+			const std::pair<int, int> edges[] = { { x + 1 < width ? current.second + 1 : -1, 1 },
+				{ y + 1 < height ? current.second + width : -1, 2 } };
+			for (const std::pair<int, int>& edge : edges)
+			{
+				if (edge.first < 0 || current.first + edge.second >= distances[edge.first])
+					continue;
+
+				distances[edge.first] = current.first + edge.second;
+				if (queued[edge.first])
+					heap.decreaseKey(handles[edge.first], std::make_pair(distances[edge.first], edge.first));
+				else
+					handles[edge.first] = heap.push(std::make_pair(distances[edge.first], edge.first));
+				queued[edge.first] = true;
+			}
+		}
+
+		for (int y = 0; y < height; y++)
+			for (int x = 0; x < width; x++)
+				ASSERT_EQ(distances[y * width + x], x + 2 * y);
+	}
+
+	TEST(DaryHeapTest, DaryHeapMoveOnlyItems)
+	{
+		auto less = [](const std::unique_ptr<int>& l, const std::unique_ptr<int>& r) { return *l < *r; };
+		DaryHeap<std::unique_ptr<int>, 4, decltype(less)> heap(less);
+		for (int i = 10; i > 0; i--)
+			heap.emplace(new int(i));
+
+		const DaryHeap<std::unique_ptr<int>, 4, decltype(less)>::Handle handle = heap.push(std::unique_ptr<int>(new int(20)));
+		heap.decreaseKey(handle, std::unique_ptr<int>(new int(0)));
+		EXPECT_EQ(*heap.pop(), 0);
+		for (int i = 1; i <= 10; i++)
+			EXPECT_EQ(*heap.pop(), i);
+	}
+
+	TEST(DaryHeapTest, DaryHeapTakesAllocator)
+	{
+		MonotonicArena arena;
+		{
+			DaryHeap<int, 4, std::less<int>, ResourceAllocator<int>> heap(std::less<int>(), &arena);
+			for (int i = 0; i < 1000; i++)
+				heap.push(1000 - i);
+			EXPECT_EQ(heap.pop(), 1);
+		}
+		EXPECT_GT(arena.getSizeInBytes(), 0u);
+	}
+}
@@ -317,4 +317,54 @@ namespace DoublyLinkedListTest
 		list1 = list;
 		EXPECT_TRUE(list1.contains(128));
 	}
+
+	TEST(DoublyLinkedListTest, DoublyLinkedListMixedEnds)
+	{
+		DoublyLinkedList<int16_t> list;
+		list.insertAtEnd(2);
+		list.insertAtStart(1);
+		list.insertAtEnd(3);
+		EXPECT_TRUE(list.contains(1));
+		EXPECT_TRUE(list.contains(2));
+		EXPECT_TRUE(list.contains(3));
+
+		list.deleteAtStart();
+		list.deleteAtStart();
+		list.deleteAtStart();
+		EXPECT_TRUE(list.isEmpty());
+
+		list.insertAtStart(4);
+		list.remove(4);
+		list.insertAtEnd(5);
+		list.insertAtEnd(6);
+		EXPECT_TRUE(list.contains(5));
+		EXPECT_TRUE(list.contains(6));
+		EXPECT_FALSE(list.contains(4));
+	}
+
+	TEST(DoublyLinkedListTest, DoublyLinkedListShrinksToOneNode)
+	{
+		DoublyLinkedList<int16_t> list;
+		list.insertAtEnd(1);
+		list.insertAtEnd(2);
+		list.deleteAtStart();
+		list.deleteAtEnd();
+		EXPECT_TRUE(list.isEmpty());
+
+		list.insertAtEnd(1);
+		list.insertAtStart(0);
+		list.remove(0);
+		list.deleteAtEnd();
+		EXPECT_TRUE(list.isEmpty());
+
+		list.insertAtEnd(1);
+		list.insertAtEnd(2);
+		list.remove(2);
+		list.insertAtEnd(3);
+		EXPECT_TRUE(list.contains(1));
+		EXPECT_TRUE(list.contains(3));
+		list.deleteAtEnd();
+		list.deleteAtEnd();
+		EXPECT_TRUE(list.isEmpty());
+	}
 }
\ No newline at end of file
@@ -0,0 +1,262 @@
+#include "../memory_resource.h"
+#include "../doubly_linked_list.h"
+#include "../queue.h"
+#include "../singly_linked_list.h"
+#include "../small_stack.h"
+#include "../stack.h"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+
+namespace MemoryResourceTest
+{
+	// Forwards to operator new and counts what is still allocated
+	class CountingResource : public memory::MemoryResource
+	{
+	public:
+		std::size_t allocations = 0;
+		std::size_t liveBytes = 0;
+	private:
+		void* do_allocate(std::size_t bytes, std::size_t alignment) override
+		{
+			++allocations;
+			liveBytes += bytes;
+			return memory::newDeleteResource()->allocate(bytes, alignment);
+		}
+
+		void do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) override
+		{
+			liveBytes -= bytes;
+			memory::newDeleteResource()->deallocate(pointer, bytes, alignment);
+		}
+
+		bool do_is_equal(const memory::MemoryResource& other) const noexcept override
+		{
+			return this == &other;
+		}
+	};
+
+	TEST(MemoryResourceTest, MonotonicArenaAllocates)
+	{
+		CountingResource upstream;
+		MonotonicArena arena(1024, &upstream);
+		EXPECT_EQ(arena.getSizeInBytes(), 0);
+
+		const std::size_t alignments[] = { 1, 2, 8, 16, 64, 4096 };
+		for (int round = 0; round < 1000; ++round)
+		{
+			const std::size_t alignment = alignments[round % 6];
+			void* pointer = arena.allocate(round % 100 + 1, alignment);
+			ASSERT_EQ(reinterpret_cast<uintptr_t>(pointer) % alignment, 0u);
+			std::memset(pointer, 0xab, round % 100 + 1);
+		}
+
+		// The chunks double, so there are only a few of them
+		EXPECT_LT(upstream.allocations, 20u);
+		EXPECT_EQ(arena.getSizeInBytes(), upstream.liveBytes);
+
+		arena.release();
+		EXPECT_EQ(upstream.liveBytes, 0);
+		EXPECT_EQ(arena.getSizeInBytes(), 0);
+
+		// Larger than a chunk
+		void* pointer = arena.allocate(1 << 20);
+		std::memset(pointer, 0, 1 << 20);
+		EXPECT_GE(arena.getSizeInBytes(), std::size_t(1) << 20);
+	}
+
+	TEST(MemoryResourceTest, ContainersUseAllocator)
+	{
+		CountingResource resource;
+		{
+			Stack<std::string, ResourceAllocator<std::string>> stack(&resource);
+			Queue<int, ResourceAllocator<int>> queue(&resource);
+			SinglyLinkedList<int, ResourceAllocator<int>> singly(&resource);
+			DoublyLinkedList<int, ResourceAllocator<int>> doubly(&resource);
+			SmallStack<int, 4, ResourceAllocator<int>> small(&resource);
+
+			for (int i = 0; i < 100; ++i)
+			{
+				stack.push_back(std::to_string(i));
+				queue.enqueue(i);
+				singly.insertAtEnd(i);
+				doubly.insertAtEnd(i);
+				small.push_back(i);
+			}
+
+			EXPECT_EQ(stack.peek(), "99");
+			EXPECT_EQ(queue.dequeue(), 0);
+			EXPECT_TRUE(singly.contains(50));
+			EXPECT_TRUE(doubly.contains(50));
+			EXPECT_EQ(small.pop(), 99);
+			EXPECT_GT(resource.liveBytes, 0u);
+
+			// Copies keep the allocator of the source
+			Stack<std::string, ResourceAllocator<std::string>> stackCopy(stack);
+			DoublyLinkedList<int, ResourceAllocator<int>> doublyCopy(doubly);
+			EXPECT_EQ(stackCopy.getAllocator(), stack.getAllocator());
+			EXPECT_EQ(doublyCopy.getAllocator().getResource(), &resource);
+		}
+
+		EXPECT_EQ(resource.liveBytes, 0);
+	}
+
+	TEST(MemoryResourceTest, MoveBetweenResources)
+	{
+		MonotonicArena first;
+		MonotonicArena second;
+
+		SinglyLinkedList<int, ResourceAllocator<int>> list(&first);
+		SinglyLinkedList<int, ResourceAllocator<int>> other(&second);
+		Stack<int, ResourceAllocator<int>> stack(&first);
+		Stack<int, ResourceAllocator<int>> otherStack(&second);
+		for (int i = 0; i < 10; ++i)
+		{
+			list.insertAtEnd(i);
+			stack.push_back(i);
+		}
+
+		// The allocators differ, the items are copied into the second arena
+		other = std::move(list);
+		otherStack = std::move(stack);
+		EXPECT_TRUE(list.isEmpty());
+		EXPECT_TRUE(stack.isEmpty());
+		EXPECT_TRUE(other.contains(9));
+		EXPECT_EQ(otherStack.pop(), 9);
+		EXPECT_EQ(other.getAllocator().getResource(), &second);
+
+		first.release();
+		EXPECT_TRUE(other.contains(0));
+	}
+
+	TEST(MemoryResourceTest, MoveOnlyItemsBetweenResources)
+	{
+		MonotonicArena first;
+		MonotonicArena second;
+
+		Stack<std::unique_ptr<int>, ResourceAllocator<std::unique_ptr<int>>> stack(&first);
+		Stack<std::unique_ptr<int>, ResourceAllocator<std::unique_ptr<int>>> other(&second);
+		for (int i = 0; i < 10; ++i)
+		{
+			stack.emplace_back(new int(i));
+		}
+
+		other = std::move(stack);
+		EXPECT_TRUE(stack.isEmpty());
+		EXPECT_EQ(*other.pop(), 9);
+
+		Queue<std::unique_ptr<int>, ResourceAllocator<std::unique_ptr<int>>> queue(&first);
+		Queue<std::unique_ptr<int>, ResourceAllocator<std::unique_ptr<int>>> otherQueue(&second);
+		for (int i = 0; i < 20; ++i)
+		{
+			queue.emplace(new int(i));
+			if (i % 2 == 0)
+				queue.dequeue();
+		}
+
+		otherQueue = std::move(queue);
+		EXPECT_TRUE(queue.isEmpty());
+		EXPECT_EQ(otherQueue.getSize(), 10);
+		EXPECT_EQ(*otherQueue.front(), 10);
+		EXPECT_EQ(*otherQueue.back(), 19);
+	}
+
+	TEST(MemoryResourceTest, HugePageResourceMaps)
+	{
+		HugePageResource pages;
+		const std::size_t hugePage = 2 * 1024 * 1024;
+
+		void* pointer = pages.allocate(3 * 1024 * 1024);
+		EXPECT_EQ(reinterpret_cast<uintptr_t>(pointer) % hugePage, 0u);
+		EXPECT_EQ(pages.getMappedBytes(), 2 * hugePage);
+		std::memset(pointer, 1, 3 * 1024 * 1024);
+
+		pages.deallocate(pointer, 3 * 1024 * 1024);
+		EXPECT_EQ(pages.getMappedBytes(), 0);
+
+		// Huge pages as the chunks of an arena
+		{
+			MonotonicArena arena(hugePage, &pages);
+			DoublyLinkedList<int, ResourceAllocator<int>> list(&arena);
+			for (int i = 0; i < 10000; ++i)
+			{
+				list.insertAtStart(i);
+			}
+			EXPECT_TRUE(list.contains(5000));
+			EXPECT_GT(pages.getMappedBytes(), 0u);
+		}
+		EXPECT_EQ(pages.getMappedBytes(), 0);
+	}
+
+#if DATA_STRUCTURES_PMR
+	TEST(MemoryResourceTest, PmrAliases)
+	{
+		MonotonicArena arena;
+
+		pmr::Stack<int> stack(&arena);
+		pmr::Queue<int> queue(&arena);
+		pmr::SinglyLinkedList<int> singly(&arena);
+		pmr::DoublyLinkedList<int> doubly(&arena);
+		for (int i = 0; i < 100; ++i)
+		{
+			stack.push_back(i);
+			queue.enqueue(i);
+			singly.insertAtStart(i);
+			doubly.insertAtStart(i);
+		}
+
+		EXPECT_EQ(stack.pop(), 99);
+		EXPECT_EQ(queue.dequeue(), 0);
+		EXPECT_TRUE(singly.contains(42));
+		EXPECT_TRUE(doubly.contains(42));
+		EXPECT_EQ(stack.getAllocator().resource(), &arena);
+		EXPECT_GT(arena.getSizeInBytes(), 0u);
+	}
+
+	TEST(MemoryResourceTest, PmrSmallStackConstructsWithResource)
+	{
+		MonotonicArena arena;
+
+		// Inline items and spilled items both get their strings from the arena
+		pmr::SmallStack<std::pmr::string, 2> stack(&arena);
+		for (int i = 0; i < 10; ++i)
+			stack.emplace_back(40, static_cast<char>('a' + i));
+
+		EXPECT_EQ(stack.pop().get_allocator().resource(), &arena);
+		stack.reallocate(2);
+		EXPECT_EQ(stack.pop().get_allocator().resource(), &arena);
+
+		pmr::SmallStack<std::pmr::string, 2> inlineStack(&arena);
+		inlineStack.emplace_back(40, 'x');
+		EXPECT_EQ(inlineStack.pop().get_allocator().resource(), &arena);
+	}
+
+	TEST(MemoryResourceTest, PmrQueueMovesItemsBetweenResources)
+	{
+		MonotonicArena first;
+		MonotonicArena second;
+
+		pmr::Queue<std::pmr::string> queue(&first);
+		pmr::Queue<std::pmr::string> other(&second);
+		for (int i = 0; i < 20; ++i)
+		{
+			queue.emplace(std::string(40, static_cast<char>('a' + i)));
+			if (i % 2 == 0)
+				queue.dequeue();
+		}
+
+		// The strings are rebuilt with the second arena and outlive the first
+		other = std::move(queue);
+		EXPECT_TRUE(queue.isEmpty());
+		first.release();
+
+		ASSERT_EQ(other.getSize(), 10);
+		EXPECT_EQ(other.front().get_allocator().resource(), &second);
+		EXPECT_EQ(other.back().get_allocator().resource(), &second);
+		EXPECT_EQ(std::string(other.front().c_str()), std::string(40, 'k'));
+		EXPECT_EQ(std::string(other.back().c_str()), std::string(40, 't'));
+	}
+#endif
+}
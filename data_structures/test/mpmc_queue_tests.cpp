@@ -0,0 +1,204 @@
+#include "../mpmc_queue.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace MpmcQueueTest
+{
+	class AlignmentResource : public memory::MemoryResource
+	{
+	public:
+		std::size_t largestAlignment = 0;
+		std::size_t liveBytes = 0;
+	private:
+		void* do_allocate(std::size_t bytes, std::size_t alignment) override
+		{
+			if (alignment > largestAlignment)
+				largestAlignment = alignment;
+			liveBytes += bytes;
+			return memory::newDeleteResource()->allocate(bytes, alignment);
+		}
+
+		void do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) override
+		{
+			liveBytes -= bytes;
+			memory::newDeleteResource()->deallocate(pointer, bytes, alignment);
+		}
+
+		bool do_is_equal(const memory::MemoryResource& other) const noexcept override
+		{
+			return this == &other;
+		}
+	};
+
+	TEST(MpmcQueueTest, MpmcQueueCreatesEmpty)
+	{
+		MpmcQueue<int> queue(100);
+		int item = 0;
+		EXPECT_TRUE(queue.isEmpty());
+		EXPECT_EQ(queue.getCapacity(), 128);
+		EXPECT_FALSE(queue.tryDequeue(item));
+		EXPECT_EQ(MpmcQueue<int>(0).getCapacity(), 2);
+	}
+
+	TEST(MpmcQueueTest, MpmcQueueIsFifo)
+	{
+		MpmcQueue<int> queue(16);
+		int item = 0;
+
+		// Several laps around the ring
+		for (int round = 0; round < 100; round++)
+		{
+			for (int i = 0; i < 16; i++)
+				ASSERT_TRUE(queue.tryEnqueue(round * 16 + i));
+
+			EXPECT_FALSE(queue.tryEnqueue(-1));
+			EXPECT_EQ(queue.getSize(), 16);
+
+			for (int i = 0; i < 16; i++)
+			{
+				ASSERT_TRUE(queue.tryDequeue(item));
+				ASSERT_EQ(item, round * 16 + i);
+			}
+			EXPECT_FALSE(queue.tryDequeue(item));
+		}
+	}
+
+	TEST(MpmcQueueTest, MpmcQueueItemsWithResources)
+	{
+		MpmcQueue<std::unique_ptr<int>> queue(4);
+		EXPECT_TRUE(queue.tryEnqueue(std::unique_ptr<int>(new int(1))));
+		EXPECT_TRUE(queue.tryEmplace(new int(2)));
+		queue.emplace(new int(3));
+		EXPECT_EQ(*queue.dequeue(), 1);
+
+		std::shared_ptr<int> counter(new int(0));
+		{
+			MpmcQueue<std::shared_ptr<int>> shared(4);
+			shared.enqueue(counter);
+			shared.enqueue(counter);
+			EXPECT_EQ(counter.use_count(), 3);
+		}
+		EXPECT_EQ(counter.use_count(), 1);
+
+		// Copying a string may throw, the item is built before a slot is claimed
+		MpmcQueue<std::string> strings(2);
+		const std::string text(100, 'x');
+		EXPECT_TRUE(strings.tryEnqueue(text));
+		EXPECT_TRUE(strings.tryEmplace(3, 'y'));
+		EXPECT_FALSE(strings.tryEnqueue(text));
+		EXPECT_EQ(strings.dequeue(), text);
+		EXPECT_EQ(strings.dequeue(), "yyy");
+	}
+
+	TEST(MpmcQueueTest, MpmcQueueTakesAllocator)
+	{
+		AlignmentResource resource;
+		{
+			MpmcQueue<int, ResourceAllocator<int>> queue(8, &resource);
+			for (int i = 0; i < 8; i++)
+				EXPECT_TRUE(queue.tryEnqueue(i));
+			for (int i = 0; i < 8; i++)
+				EXPECT_EQ(queue.dequeue(), i);
+			EXPECT_GT(resource.liveBytes, 0u);
+		}
+
+		// The slots are aligned to cache lines, the allocator is asked for no more than max_align_t
+		EXPECT_LE(resource.largestAlignment, alignof(std::max_align_t));
+		EXPECT_EQ(resource.liveBytes, 0u);
+	}
+
+	TEST(MpmcQueueTest, MpmcQueueBlocksUntilReady)
+	{
+		MpmcQueue<int> queue(2);
+		std::atomic<bool> consumed(false);
+
+		std::thread consumer([&]()
+		{
+			// Gives the producer time to fill the queue and park
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			consumed.store(true);
+			for (int i = 0; i < 3; i++)
+				EXPECT_EQ(queue.dequeue(), i);
+		});
+
+		// The third item waits for the consumer, then the consumer waits for an item
+		queue.enqueue(0);
+		queue.enqueue(1);
+		queue.enqueue(2);
+		EXPECT_TRUE(consumed.load());
+		consumer.join();
+
+		std::thread producer([&]()
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			queue.enqueue(42);
+		});
+		EXPECT_EQ(queue.dequeue(), 42);
+		producer.join();
+	}
+
+	TEST(MpmcQueueTest, MpmcQueueManyThreads)
+	{
+		const int producerCount = 4;
+		const int consumerCount = 4;
+		const int itemsPerProducer = 25000;
+		MpmcQueue<int> queue(64);
+		std::vector<std::atomic<int>> seen(producerCount * itemsPerProducer);
+		for (std::atomic<int>& count : seen)
+			count.store(0);
+
+		// Half of the threads use the blocking calls, half retry the non-blocking ones
+		std::vector<std::thread> threads;
+		for (int producer = 0; producer < producerCount; producer++)
+		{
+			threads.emplace_back([&, producer]()
+			{
+				for (int i = 0; i < itemsPerProducer; i++)
+				{
+					const int item = producer * itemsPerProducer + i;
+					if (producer % 2 == 0)
+						queue.enqueue(item);
+					else
+						while (!queue.tryEnqueue(item))
+							std::this_thread::yield();
+				}
+			});
+		}
+
+		// The non-blocking consumers share a budget, so every blocking one gets its share
+		std::atomic<int> budget(itemsPerProducer * (consumerCount / 2));
+		for (int consumer = 0; consumer < consumerCount; consumer++)
+		{
+			threads.emplace_back([&, consumer]()
+			{
+				if (consumer % 2 == 0)
+				{
+					for (int i = 0; i < itemsPerProducer; i++)
+						seen[queue.dequeue()].fetch_add(1);
+					return;
+				}
+
+				int item;
+				while (budget.fetch_sub(1) > 0)
+				{
+					while (!queue.tryDequeue(item))
+						std::this_thread::yield();
+					seen[item].fetch_add(1);
+				}
+			});
+		}
+
+		for (std::thread& thread : threads)
+			thread.join();
+
+		EXPECT_TRUE(queue.isEmpty());
+		for (std::atomic<int>& count : seen)
+			ASSERT_EQ(count.load(), 1);
+	}
+}
@@ -1,5 +1,8 @@
 #include "../queue.h"
 #include "gtest/gtest.h"
+#include <memory>
+#include <stdexcept>
+#include <string>
 
 namespace QueueTest
 {
@@ -107,4 +110,122 @@ namespace QueueTest
 		Queue<int16_t> queue2 = queue;
 		EXPECT_EQ(queue.dequeue(), 256);
 	}
+
+	TEST(QueueTest, QueueWrapsAround)
+	{
+		Queue<int> queue;
+		int next = 0;
+		int expected = 0;
+
+		// The front moves through the buffer while the queue grows past several capacities
+		for (int round = 0; round < 1000; ++round)
+		{
+			for (int i = 0; i < 3; ++i)
+				queue.enqueue(next++);
+			for (int i = 0; i < 2; ++i)
+				ASSERT_EQ(queue.dequeue(), expected++);
+
+			ASSERT_EQ(queue.front(), expected);
+			ASSERT_EQ(queue.back(), next - 1);
+		}
+
+		EXPECT_EQ(queue.getSize(), 1000);
+		EXPECT_EQ(queue.getCapacity(), 1024);
+
+		Queue<int> copy(queue);
+		while (!queue.isEmpty())
+			ASSERT_EQ(queue.dequeue(), copy.dequeue());
+	}
+
+	TEST(QueueTest, QueuePeeksByReference)
+	{
+		Queue<std::string> queue;
+		queue.enqueue("first");
+		queue.emplace(3, 'x');
+
+		queue.front() += "!";
+		queue.back() = "last";
+
+		const Queue<std::string>& view = queue;
+		EXPECT_EQ(view.front(), "first!");
+		EXPECT_EQ(view.back(), "last");
+		EXPECT_THROW(Queue<std::string>().front(), QueueEmptyException);
+		EXPECT_THROW(Queue<std::string>().back(), QueueEmptyException);
+	}
+
+	TEST(QueueTest, QueueMoveOnlyItems)
+	{
+		Queue<std::unique_ptr<int>> queue;
+		for (int i = 0; i < 100; ++i)
+			queue.enqueue(std::unique_ptr<int>(new int(i)));
+
+		for (int i = 0; i < 100; ++i)
+			EXPECT_EQ(*queue.dequeue(), i);
+
+		Queue<std::unique_ptr<int>> moved;
+		queue.emplace(new int(7));
+		moved = std::move(queue);
+		EXPECT_TRUE(queue.isEmpty());
+		EXPECT_EQ(*moved.front(), 7);
+	}
+
+	TEST(QueueTest, QueueEnqueueOwnItem)
+	{
+		Queue<std::string> queue;
+		queue.enqueue("item");
+
+		// The argument lives in the buffer that is reallocated
+		for (int i = 0; i < 40; ++i)
+			queue.enqueue(queue.front());
+
+		EXPECT_EQ(queue.getSize(), 41);
+		EXPECT_EQ(queue.back(), "item");
+	}
+
+	// Throws from the copy that brings the countdown to zero, the move may throw too so growing copies
+	struct ThrowingCopy
+	{
+		static int alive;
+		static int copiesLeft;
+		int value;
+
+		ThrowingCopy(int v) : value(v) { ++alive; }
+		ThrowingCopy(const ThrowingCopy& other) : value(other.value)
+		{
+			if (--copiesLeft == 0)
+				throw std::runtime_error("copy");
+			++alive;
+		}
+		ThrowingCopy(ThrowingCopy&& other) : ThrowingCopy(static_cast<const ThrowingCopy&>(other)) {}
+		~ThrowingCopy() { --alive; }
+	};
+
+	int ThrowingCopy::alive = 0;
+	int ThrowingCopy::copiesLeft = 0;
+
+	TEST(QueueTest, QueueThrowingCopy)
+	{
+		{
+			Queue<ThrowingCopy> queue;
+			for (int i = 0; i < 24; ++i)
+				queue.emplace(i);
+			for (int i = 0; i < 8; ++i)
+				queue.dequeue();
+			for (int i = 24; i < 40; ++i)
+				queue.emplace(i);
+			EXPECT_EQ(queue.getCapacity(), 32);
+
+			// The items wrap around, a copy throws in the second part after the first is moved
+			ThrowingCopy::copiesLeft = 28;
+			EXPECT_THROW(queue.emplace(40), std::runtime_error);
+			EXPECT_EQ(ThrowingCopy::alive, 32);
+			EXPECT_EQ(queue.getSize(), 32);
+
+			ThrowingCopy::copiesLeft = 0;
+			queue.emplace(40);
+			for (int i = 8; i <= 40; ++i)
+				ASSERT_EQ(queue.dequeue().value, i);
+		}
+		EXPECT_EQ(ThrowingCopy::alive, 0);
+	}
 }
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include "../radix_heap.h"
+#include "../dary_heap.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace RadixHeapTest
+{
+	TEST(RadixHeapTest, RadixHeapCreatesEmpty)
+	{
+		RadixHeap<unsigned, int> heap;
+		EXPECT_TRUE(heap.isEmpty());
+		EXPECT_EQ(heap.getSize(), 0);
+		EXPECT_EQ(heap.getLastKey(), 0u);
+		EXPECT_THROW(heap.top(), HeapEmptyException);
+		EXPECT_THROW(heap.pop(), HeapEmptyException);
+	}
+
+	TEST(RadixHeapTest, RadixHeapPopsInOrder)
+	{
+		std::mt19937_64 random(3);
+		std::vector<uint64_t> keys(5000);
+		for (uint64_t& key : keys)
+			key = random() >> (random() % 64);
+
+		RadixHeap<uint64_t, std::size_t> heap;
+		for (std::size_t i = 0; i < keys.size(); i++)
+			heap.push(keys[i], i);
+		EXPECT_EQ(heap.getSize(), keys.size());
+
+		std::vector<uint64_t> sorted(keys);
+		std::sort(sorted.begin(), sorted.end());
+		for (uint64_t key : sorted)
+		{
+			ASSERT_EQ(heap.top().first, key);
+			const std::pair<uint64_t, std::size_t> item = heap.pop();
+			ASSERT_EQ(item.first, key);
+			ASSERT_EQ(keys[item.second], key);
+		}
+		EXPECT_TRUE(heap.isEmpty());
+	}
+
+	TEST(RadixHeapTest, RadixHeapMonotoneKeys)
+	{
+		std::mt19937 random(5);
+		RadixHeap<uint16_t, int> heap;
+		DaryHeap<uint16_t> reference;
+
+		// Pushes and pops interleave, every push is at least the last popped key
+		for (int step = 0; step < 20000; step++)
+		{
+			if (random() % 3 != 0 || reference.isEmpty())
+			{
+				const uint16_t key = static_cast<uint16_t>(heap.getLastKey() + random() % 500);
+				heap.push(key, step);
+				reference.push(key);
+			}
+			else
+			{
+				ASSERT_EQ(heap.pop().first, reference.pop());
+			}
+			ASSERT_EQ(heap.getSize(), reference.getSize());
+		}
+	}
+
+	TEST(RadixHeapTest, RadixHeapRejectsSmallerKeys)
+	{
+		RadixHeap<unsigned, int> heap;
+		heap.push(10, 1);
+		heap.push(20, 2);
+		EXPECT_EQ(heap.pop().second, 1);
+
+		EXPECT_THROW(heap.push(9, 3), std::invalid_argument);
+		heap.push(10, 4);
+		EXPECT_EQ(heap.getSize(), 2);
+		EXPECT_EQ(heap.pop().second, 4);
+		EXPECT_EQ(heap.pop().second, 2);
+
+		heap.clear();
+		EXPECT_EQ(heap.getLastKey(), 0u);
+		heap.push(0, 5);
+		EXPECT_EQ(heap.pop().second, 5);
+	}
+
+	TEST(RadixHeapTest, RadixHeapMoveOnlyValues)
+	{
+		RadixHeap<unsigned long, std::unique_ptr<int>> heap;
+		heap.emplace(7, new int(7));
+		heap.push(3, std::unique_ptr<int>(new int(3)));
+		EXPECT_EQ(*heap.pop().second, 3);
+		EXPECT_EQ(*heap.pop().second, 7);
+	}
+
+	TEST(RadixHeapTest, RadixHeapTakesAllocator)
+	{
+		MonotonicArena arena;
+		{
+			RadixHeap<unsigned, int, ResourceAllocator<std::pair<unsigned, int>>> heap(&arena);
+			for (unsigned i = 0; i < 1000; i++)
+				heap.push(1000 - i, static_cast<int>(i));
+			EXPECT_EQ(heap.pop().first, 1u);
+		}
+		EXPECT_GT(arena.getSizeInBytes(), 0u);
+	}
+}
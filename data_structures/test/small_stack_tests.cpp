@@ -0,0 +1,189 @@
+#include "../small_stack.h"
+#include <gtest/gtest.h>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace SmallStackTest
+{
+	TEST(SmallStackTest, SmallStackCreatesEmpty)
+	{
+		SmallStack<int16_t, 8> stack;
+		EXPECT_EQ(stack.getSize(), 0);
+		EXPECT_EQ(stack.getCapacity(), 8);
+		EXPECT_TRUE(stack.isEmpty());
+		EXPECT_TRUE(stack.isInline());
+		EXPECT_THROW(stack.pop(), StackEmptyException);
+		EXPECT_THROW(stack.peek(), StackEmptyException);
+	}
+
+	TEST(SmallStackTest, SmallStackSpillsToHeap)
+	{
+		SmallStack<int, 8> stack;
+		for (int i = 0; i < 8; i++)
+		{
+			stack.push_back(i);
+		}
+		EXPECT_TRUE(stack.isInline());
+		EXPECT_EQ(stack.getCapacity(), 8);
+
+		stack.push_back(8);
+		EXPECT_FALSE(stack.isInline());
+		EXPECT_EQ(stack.getCapacity(), 16);
+
+		for (int i = 9; i < 100; i++)
+		{
+			stack.push_back(i);
+		}
+
+		for (int i = 99; i >= 0; i--)
+		{
+			ASSERT_EQ(stack.pop(), i);
+		}
+
+		// Draining the stack moves the items back into the buffer
+		EXPECT_TRUE(stack.isInline());
+		EXPECT_TRUE(stack.isEmpty());
+	}
+
+	TEST(SmallStackTest, SmallStackClears)
+	{
+		SmallStack<std::string, 4> stack;
+		for (int i = 0; i < 64; i++)
+		{
+			stack.push_back(std::to_string(i));
+		}
+
+		stack.clear();
+		EXPECT_TRUE(stack.isEmpty());
+		EXPECT_TRUE(stack.isInline());
+		EXPECT_EQ(stack.getCapacity(), 4);
+
+		stack.emplace_back(2, 'x');
+		EXPECT_EQ(stack.peek(), "xx");
+	}
+
+	TEST(SmallStackTest, SmallStackReallocate)
+	{
+		SmallStack<int, 4> stack;
+		for (int i = 0; i < 32; i++)
+		{
+			stack.push_back(i);
+		}
+
+		stack.reallocate(256);
+		EXPECT_EQ(stack.getCapacity(), 256);
+		EXPECT_EQ(stack.getSize(), 32);
+
+		stack.reallocate(2);
+		EXPECT_TRUE(stack.isInline());
+		EXPECT_EQ(stack.getCapacity(), 4);
+		EXPECT_EQ(stack.getSize(), 4);
+		EXPECT_EQ(stack.peek(), 3);
+	}
+
+	TEST(SmallStackTest, SmallStackCopyAndMove)
+	{
+		SmallStack<std::string, 4> inlineStack;
+		SmallStack<std::string, 4> heapStack;
+		for (int i = 0; i < 3; i++)
+		{
+			inlineStack.push_back(std::to_string(i));
+		}
+		for (int i = 0; i < 20; i++)
+		{
+			heapStack.push_back(std::to_string(i));
+		}
+
+		SmallStack<std::string, 4> copy(heapStack);
+		EXPECT_EQ(copy.getSize(), 20);
+		EXPECT_EQ(copy.peek(), "19");
+
+		copy = inlineStack;
+		EXPECT_TRUE(copy.isInline());
+		EXPECT_EQ(copy.peek(), "2");
+
+		SmallStack<std::string, 4> moved(std::move(heapStack));
+		EXPECT_EQ(moved.getSize(), 20);
+		EXPECT_TRUE(heapStack.isEmpty());
+
+		moved = std::move(inlineStack);
+		EXPECT_TRUE(moved.isInline());
+		EXPECT_EQ(moved.getSize(), 3);
+		EXPECT_TRUE(inlineStack.isEmpty());
+
+		swap(moved, copy);
+		EXPECT_EQ(moved.pop(), "2");
+		EXPECT_EQ(copy.pop(), "2");
+	}
+
+	TEST(SmallStackTest, SmallStackMoveOnlyItems)
+	{
+		SmallStack<std::unique_ptr<int>, 2> stack;
+
+		for (int i = 0; i < 10; i++)
+		{
+			stack.push_back(std::unique_ptr<int>(new int(i)));
+		}
+
+		for (int i = 9; i >= 0; i--)
+		{
+			EXPECT_EQ(*stack.pop(), i);
+		}
+	}
+
+	// Throws from the copy that brings the countdown to zero, the move may throw too so spilling copies
+	struct ThrowingCopy
+	{
+		static int alive;
+		static int copiesLeft;
+		int value;
+
+		ThrowingCopy(int v) : value(v) { ++alive; }
+		ThrowingCopy(const ThrowingCopy& other) : value(other.value)
+		{
+			if (--copiesLeft == 0)
+				throw std::runtime_error("copy");
+			++alive;
+		}
+		ThrowingCopy(ThrowingCopy&& other) : ThrowingCopy(static_cast<const ThrowingCopy&>(other)) {}
+		~ThrowingCopy() { --alive; }
+	};
+
+	int ThrowingCopy::alive = 0;
+	int ThrowingCopy::copiesLeft = 0;
+
+	TEST(SmallStackTest, SmallStackThrowingCopy)
+	{
+		{
+			SmallStack<ThrowingCopy, 4> stack;
+			for (int i = 0; i < 4; i++)
+			{
+				stack.emplace_back(i);
+			}
+
+			// Spilling to the heap builds the new item, then the third moved item throws
+			ThrowingCopy::copiesLeft = 3;
+			EXPECT_THROW(stack.emplace_back(4), std::runtime_error);
+			EXPECT_EQ(ThrowingCopy::alive, 4);
+			EXPECT_TRUE(stack.isInline());
+
+			ThrowingCopy::copiesLeft = 0;
+			for (int i = 4; i < 8; i++)
+			{
+				stack.emplace_back(i);
+			}
+
+			ThrowingCopy::copiesLeft = 2;
+			EXPECT_THROW(stack.reallocate(64), std::runtime_error);
+			EXPECT_EQ(ThrowingCopy::alive, 8);
+
+			ThrowingCopy::copiesLeft = 0;
+			for (int i = 7; i >= 0; i--)
+			{
+				ASSERT_EQ(stack.pop().value, i);
+			}
+		}
+		EXPECT_EQ(ThrowingCopy::alive, 0);
+	}
+}
@@ -0,0 +1,138 @@
+#include "../spsc_queue.h"
+#include <gtest/gtest.h>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace SpscQueueTest
+{
+	TEST(SpscQueueTest, SpscQueueCreatesEmpty)
+	{
+		SpscQueue<int> queue(100);
+		int item = 0;
+		EXPECT_TRUE(queue.isEmpty());
+		EXPECT_EQ(queue.getSize(), 0);
+		EXPECT_EQ(queue.getCapacity(), 128);
+		EXPECT_FALSE(queue.tryDequeue(item));
+	}
+
+	TEST(SpscQueueTest, SpscQueueFillsUp)
+	{
+		SpscQueue<int> queue(8);
+		for (int i = 0; i < 8; i++)
+			EXPECT_TRUE(queue.tryEnqueue(i));
+
+		EXPECT_FALSE(queue.tryEnqueue(8));
+		EXPECT_EQ(queue.getSize(), 8);
+
+		int item = 0;
+		ASSERT_TRUE(queue.tryDequeue(item));
+		EXPECT_EQ(item, 0);
+		EXPECT_TRUE(queue.tryEnqueue(8));
+
+		for (int i = 1; i <= 8; i++)
+		{
+			ASSERT_TRUE(queue.tryDequeue(item));
+			EXPECT_EQ(item, i);
+		}
+		EXPECT_TRUE(queue.isEmpty());
+	}
+
+	TEST(SpscQueueTest, SpscQueueBulkWrapsAround)
+	{
+		SpscQueue<int> queue(16);
+		std::vector<int> input(10);
+		std::vector<int> output;
+		int next = 0;
+
+		for (int round = 0; round < 100; round++)
+		{
+			for (int& item : input)
+				item = next++;
+
+			ASSERT_EQ(queue.tryPushN(input.begin(), input.size()), input.size());
+			ASSERT_EQ(queue.tryPopN(std::back_inserter(output), 7), 7);
+			ASSERT_EQ(queue.tryPopN(std::back_inserter(output), 3), 3);
+		}
+
+		// Only the free slots are filled and only the present items are taken
+		for (int& item : input)
+			item = next++;
+		EXPECT_EQ(queue.tryPushN(input.begin(), input.size()), 10);
+		for (int& item : input)
+			item = next++;
+		EXPECT_EQ(queue.tryPushN(input.begin(), input.size()), 6);
+		EXPECT_EQ(queue.tryPopN(std::back_inserter(output), 100), 16);
+
+		ASSERT_EQ(output.size(), 1016);
+		for (int i = 0; i < 1016; i++)
+			ASSERT_EQ(output[i], i);
+	}
+
+	TEST(SpscQueueTest, SpscQueueMoveOnlyItems)
+	{
+		SpscQueue<std::unique_ptr<int>> queue(4);
+		EXPECT_TRUE(queue.tryEnqueue(std::unique_ptr<int>(new int(1))));
+		EXPECT_TRUE(queue.tryEmplace(new int(2)));
+
+		std::unique_ptr<int> item;
+		ASSERT_TRUE(queue.tryDequeue(item));
+		EXPECT_EQ(*item, 1);
+
+		std::vector<std::unique_ptr<int>> items(3);
+		EXPECT_EQ(queue.tryPopN(items.begin(), 3), 1);
+		EXPECT_EQ(*items[0], 2);
+	}
+
+	TEST(SpscQueueTest, SpscQueueDestroysLeftItems)
+	{
+		std::shared_ptr<int> counter(new int(0));
+		{
+			SpscQueue<std::shared_ptr<int>> queue(4);
+			for (int i = 0; i < 4; i++)
+				queue.tryEnqueue(counter);
+			EXPECT_EQ(counter.use_count(), 5);
+		}
+		EXPECT_EQ(counter.use_count(), 1);
+	}
+
+	TEST(SpscQueueTest, SpscQueueTwoThreads)
+	{
+		const int itemCount = 200000;
+		SpscQueue<int> queue(1024);
+
+		std::thread producer([&]()
+		{
+			int buffer[32];
+			int next = 0;
+			while (next < itemCount)
+			{
+				if (next % 3 == 0)
+				{
+					if (queue.tryEnqueue(next))
+						++next;
+					continue;
+				}
+
+				const int count = (itemCount - next < 32) ? itemCount - next : 32;
+				for (int i = 0; i < count; i++)
+					buffer[i] = next + i;
+				next += static_cast<int>(queue.tryPushN(buffer, count));
+			}
+		});
+
+		int expected = 0;
+		int buffer[64];
+		while (expected < itemCount)
+		{
+			const std::size_t popped = queue.tryPopN(buffer, 64);
+			for (std::size_t i = 0; i < popped; i++)
+				ASSERT_EQ(buffer[i], expected++);
+		}
+
+		producer.join();
+		EXPECT_TRUE(queue.isEmpty());
+	}
+}
@@ -1,5 +1,8 @@
 #include "../stack.h"
 #include <gtest/gtest.h>
+#include <memory>
+#include <stdexcept>
+#include <string>
 
 namespace StackTest
 {
@@ -39,7 +42,7 @@ namespace StackTest
 		stack.push_back(1);
 		EXPECT_EQ(stack.getSize(), 32);
 		stack.push_back(1);
-		EXPECT_EQ(stack.getCapacity(), 48);
+		EXPECT_EQ(stack.getCapacity(), 64);
 	}
 
 	TEST(StackTest, StackReallocateExpand)
@@ -152,4 +155,160 @@ namespace StackTest
 		EXPECT_EQ(stack3.getCapacity(), stack1.getCapacity());
 		EXPECT_EQ(stack3.peek(), stack1.peek());
 	}
+
+	// Counts live instances to check that every constructed item is destroyed exactly once
+	struct Tracked
+	{
+		static int alive;
+		int value;
+
+		Tracked(int v) : value(v) { ++alive; }
+		Tracked(const Tracked& other) : value(other.value) { ++alive; }
+		Tracked(Tracked&& other) noexcept : value(other.value) { ++alive; }
+		~Tracked() { --alive; }
+		Tracked& operator=(const Tracked& other) = default;
+	};
+
+	int Tracked::alive = 0;
+
+	TEST(StackTest, StackGeometricGrowth)
+	{
+		Stack<int> stack;
+		std::size_t reallocations = 0;
+		std::size_t capacity = stack.getCapacity();
+
+		for (int i = 0; i < 100000; i++)
+		{
+			stack.push_back(i);
+			if (stack.getCapacity() != capacity)
+			{
+				capacity = stack.getCapacity();
+				++reallocations;
+			}
+		}
+
+		EXPECT_EQ(reallocations, 13);
+		EXPECT_EQ(stack.getCapacity(), 131072);
+
+		for (int i = 99999; i >= 0; i--)
+		{
+			ASSERT_EQ(stack.pop(), i);
+		}
+
+		// Shrinking stops at the default capacity
+		EXPECT_EQ(stack.getCapacity(), 16);
+	}
+
+	TEST(StackTest, StackMoveOnlyItems)
+	{
+		Stack<std::unique_ptr<int>> stack;
+
+		for (int i = 0; i < 100; i++)
+		{
+			stack.push_back(std::unique_ptr<int>(new int(i)));
+		}
+		stack.emplace_back(new int(100));
+
+		for (int i = 100; i >= 0; i--)
+		{
+			EXPECT_EQ(*stack.pop(), i);
+		}
+	}
+
+	TEST(StackTest, StackEmplaceBack)
+	{
+		Stack<std::string> stack;
+
+		EXPECT_EQ(stack.emplace_back(3, 'a'), "aaa");
+		for (int i = 0; i < 40; i++)
+		{
+			// The argument refers to the top item while the stack grows
+			stack.push_back(stack.emplace_back(std::to_string(i)));
+		}
+
+		EXPECT_EQ(stack.getSize(), 81);
+		EXPECT_EQ(stack.pop(), "39");
+		EXPECT_EQ(stack.pop(), "39");
+	}
+
+	TEST(StackTest, StackDestroysItems)
+	{
+		{
+			Stack<Tracked> stack;
+			for (int i = 0; i < 1000; i++)
+			{
+				stack.emplace_back(i);
+			}
+			EXPECT_EQ(Tracked::alive, 1000);
+
+			for (int i = 0; i < 900; i++)
+			{
+				stack.pop();
+			}
+			EXPECT_EQ(Tracked::alive, 100);
+
+			Stack<Tracked> copy(stack);
+			EXPECT_EQ(Tracked::alive, 200);
+
+			stack.reallocate(10);
+			EXPECT_EQ(Tracked::alive, 110);
+			EXPECT_EQ(stack.peek().value, 9);
+		}
+		EXPECT_EQ(Tracked::alive, 0);
+	}
+
+	// Throws from the copy that brings the countdown to zero, the move may throw too so reallocation copies
+	struct ThrowingCopy
+	{
+		static int alive;
+		static int copiesLeft;
+		int value;
+
+		ThrowingCopy(int v) : value(v) { ++alive; }
+		ThrowingCopy(const ThrowingCopy& other) : value(other.value)
+		{
+			if (--copiesLeft == 0)
+				throw std::runtime_error("copy");
+			++alive;
+		}
+		ThrowingCopy(ThrowingCopy&& other) : ThrowingCopy(static_cast<const ThrowingCopy&>(other)) {}
+		~ThrowingCopy() { --alive; }
+	};
+
+	int ThrowingCopy::alive = 0;
+	int ThrowingCopy::copiesLeft = 0;
+
+	TEST(StackTest, StackThrowingCopy)
+	{
+		{
+			Stack<ThrowingCopy> stack;
+			for (int i = 0; i < 16; i++)
+			{
+				stack.emplace_back(i);
+			}
+
+			// The new item is built, then the fifth relocated item throws
+			ThrowingCopy::copiesLeft = 5;
+			EXPECT_THROW(stack.emplace_back(16), std::runtime_error);
+			EXPECT_EQ(ThrowingCopy::alive, 16);
+			EXPECT_EQ(stack.getSize(), 16);
+			EXPECT_EQ(stack.getCapacity(), 16);
+
+			ThrowingCopy::copiesLeft = 3;
+			EXPECT_THROW(stack.reallocate(64), std::runtime_error);
+			EXPECT_EQ(ThrowingCopy::alive, 16);
+
+			ThrowingCopy::copiesLeft = 10;
+			EXPECT_THROW(Stack<ThrowingCopy> copy(stack), std::runtime_error);
+			EXPECT_EQ(ThrowingCopy::alive, 16);
+
+			ThrowingCopy::copiesLeft = 0;
+			stack.emplace_back(16);
+			for (int i = 16; i >= 0; i--)
+			{
+				ASSERT_EQ(stack.pop().value, i);
+			}
+		}
+		EXPECT_EQ(ThrowingCopy::alive, 0);
+	}
 }
\ No newline at end of file
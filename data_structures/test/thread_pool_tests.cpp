@@ -0,0 +1,187 @@
+#include "../thread_pool.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ThreadPoolTest
+{
+	long long fibonacci(ThreadPool& pool, int n)
+	{
+		if (n < 12)
+			return n < 2 ? n : fibonacci(pool, n - 1) + fibonacci(pool, n - 2);
+
+		long long left = 0;
+		ThreadPool::TaskGroup group(pool);
+		group.run([&]() { left = fibonacci(pool, n - 1); });
+		const long long right = fibonacci(pool, n - 2);
+		group.wait();
+		return left + right;
+	}
+
+	TEST(ThreadPoolTest, ThreadPoolThreadCount)
+	{
+		ThreadPool inline_(0);
+		EXPECT_EQ(inline_.getThreadCount(), 0);
+
+		ThreadPool pool(3);
+		EXPECT_EQ(pool.getThreadCount(), 3);
+		EXPECT_EQ(ThreadPool().getThreadCount(), thread_pool::defaultThreadCount());
+	}
+
+	TEST(ThreadPoolTest, ThreadPoolRunsTaskGroup)
+	{
+		for (std::size_t threads : { 0, 1, 4 })
+		{
+			ThreadPool pool(threads);
+			std::atomic<int> done(0);
+			ThreadPool::TaskGroup group(pool);
+			for (int i = 0; i < 1000; i++)
+				group.run([&done]() { done.fetch_add(1); });
+			group.wait();
+			EXPECT_EQ(done.load(), 1000);
+
+			// A waited group can be used again
+			group.run([&done]() { done.fetch_add(1); });
+			group.wait();
+			EXPECT_EQ(done.load(), 1001);
+		}
+	}
+
+	TEST(ThreadPoolTest, ThreadPoolRunsOnCallerWithoutWorkers)
+	{
+		ThreadPool pool(0);
+		const std::thread::id caller = std::this_thread::get_id();
+		std::vector<std::thread::id> threads(100);
+
+		pool.parallelFor(0, 100, 1, [&threads](int index) { threads[index] = std::this_thread::get_id(); });
+		for (const std::thread::id& thread : threads)
+			EXPECT_EQ(thread, caller);
+	}
+
+	TEST(ThreadPoolTest, ThreadPoolNestedGroups)
+	{
+		for (std::size_t threads : { 0, 2, 4 })
+		{
+			ThreadPool pool(threads);
+			EXPECT_EQ(fibonacci(pool, 25), 75025);
+		}
+	}
+
+	TEST(ThreadPoolTest, ThreadPoolRethrowsTaskException)
+	{
+		ThreadPool pool(2);
+		ThreadPool::TaskGroup group(pool);
+		std::atomic<int> done(0);
+		for (int i = 0; i < 100; i++)
+		{
+			group.run([i, &done]()
+			{
+				if (i == 42)
+					throw std::runtime_error("task failed");
+				done.fetch_add(1);
+			});
+		}
+
+		EXPECT_THROW(group.wait(), std::runtime_error);
+		EXPECT_EQ(done.load(), 99);
+		EXPECT_NO_THROW(group.wait());
+
+		EXPECT_THROW(pool.parallelFor(0, 1000, 10, [](int index)
+		{
+			if (index == 500)
+				throw std::out_of_range("index");
+		}), std::out_of_range);
+	}
+
+	TEST(ThreadPoolTest, ThreadPoolParallelForVisitsEveryIndexOnce)
+	{
+		for (std::size_t threads : { 0, 1, 4 })
+		{
+			ThreadPool pool(threads);
+			for (int grain : { 1, 7, 1000, 5000 })
+			{
+				std::vector<std::atomic<int>> visits(3001);
+				for (std::atomic<int>& count : visits)
+					count.store(0);
+
+				pool.parallelFor(-1000, 2001, grain, [&visits](int index) { visits[index + 1000].fetch_add(1); });
+				for (std::atomic<int>& count : visits)
+					ASSERT_EQ(count.load(), 1);
+			}
+
+			// Empty ranges call nothing
+			pool.parallelFor(5, 5, 1, [](int) { FAIL(); });
+			pool.parallelFor(std::size_t(5), std::size_t(0), std::size_t(1), [](std::size_t) { FAIL(); });
+		}
+	}
+
+	TEST(ThreadPoolTest, ThreadPoolParallelReduceIsDeterministic)
+	{
+		auto map = [](std::size_t index) { return 1.0 / static_cast<double>(index + 1); };
+		auto add = [](double l, double r) { return l + r; };
+
+		ThreadPool sequential(0);
+		const double expected = sequential.parallelReduce(std::size_t(0), std::size_t(100000), std::size_t(256), 0.0, map, add);
+		EXPECT_NEAR(expected, 12.0901, 1e-4);
+
+		// Floating point sums are bitwise equal for any number of threads
+		for (std::size_t threads : { 1, 2, 4 })
+		{
+			ThreadPool pool(threads);
+			for (int run = 0; run < 5; run++)
+				ASSERT_EQ(pool.parallelReduce(std::size_t(0), std::size_t(100000), std::size_t(256), 0.0, map, add), expected);
+		}
+
+		// Chunks are combined from left to right
+		ThreadPool pool(4);
+		const std::string letters = pool.parallelReduce(0, 26, 3, std::string(),
+			[](int index) { return std::string(1, static_cast<char>('a' + index)); },
+			[](std::string l, const std::string& r) { return l + r; });
+		EXPECT_EQ(letters, "abcdefghijklmnopqrstuvwxyz");
+		EXPECT_EQ(pool.parallelReduce(3, 3, 1, 7, [](int) { return 0; }, add), 7);
+	}
+
+	TEST(ThreadPoolTest, ThreadPoolCountsPrimes)
+	{
+		// A segmented sieve whose segments run as tasks
+		const uint32_t limit = 1000000;
+		const uint32_t segment = 32768;
+		std::vector<uint32_t> small;
+		for (uint32_t candidate = 2; candidate * candidate < limit; candidate++)
+		{
+			bool prime = true;
+			for (uint32_t divisor = 2; divisor * divisor <= candidate && prime; divisor++)
+				prime = candidate % divisor != 0;
+			if (prime)
+				small.push_back(candidate);
+		}
+
+		ThreadPool pool(4);
+		const uint32_t segments = (limit + segment - 1) / segment;
+		const std::size_t primes = pool.parallelReduce(uint32_t(0), segments, uint32_t(1), std::size_t(0), [&](uint32_t index)
+		{
+			const uint32_t low = index * segment;
+			const uint32_t high = (low + segment < limit) ? low + segment : limit;
+			std::vector<bool> composite(high - low, false);
+			for (uint32_t prime : small)
+			{
+				uint32_t first = (low + prime - 1) / prime * prime;
+				if (first < prime * prime)
+					first = prime * prime;
+				for (uint32_t multiple = first; multiple < high; multiple += prime)
+					composite[multiple - low] = true;
+			}
+
+			std::size_t count = 0;
+			for (uint32_t number = (low < 2) ? 2 : low; number < high; number++)
+				count += composite[number - low] ? 0 : 1;
+			return count;
+		}, [](std::size_t l, std::size_t r) { return l + r; });
+
+		EXPECT_EQ(primes, 78498);
+	}
+}
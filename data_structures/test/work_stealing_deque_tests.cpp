@@ -0,0 +1,153 @@
+#include "../work_stealing_deque.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace WorkStealingDequeTest
+{
+	TEST(WorkStealingDequeTest, WorkStealingDequeCreatesEmpty)
+	{
+		WorkStealingDeque<int> deque(10);
+		int item = 0;
+		EXPECT_TRUE(deque.isEmpty());
+		EXPECT_EQ(deque.getSize(), 0);
+		EXPECT_EQ(deque.getCapacity(), 16);
+		EXPECT_FALSE(deque.pop(item));
+		EXPECT_FALSE(deque.steal(item));
+	}
+
+	TEST(WorkStealingDequeTest, WorkStealingDequeOwnerPopsNewestThiefStealsOldest)
+	{
+		WorkStealingDeque<int> deque;
+		for (int i = 0; i < 10; i++)
+			deque.push(i);
+		EXPECT_EQ(deque.getSize(), 10);
+
+		int item = -1;
+		ASSERT_TRUE(deque.pop(item));
+		EXPECT_EQ(item, 9);
+		ASSERT_TRUE(deque.steal(item));
+		EXPECT_EQ(item, 0);
+		ASSERT_TRUE(deque.steal(item));
+		EXPECT_EQ(item, 1);
+		ASSERT_TRUE(deque.pop(item));
+		EXPECT_EQ(item, 8);
+		EXPECT_EQ(deque.getSize(), 6);
+
+		while (deque.pop(item))
+		{
+		}
+		EXPECT_EQ(item, 2);
+		EXPECT_TRUE(deque.isEmpty());
+		EXPECT_FALSE(deque.steal(item));
+	}
+
+	TEST(WorkStealingDequeTest, WorkStealingDequeGrows)
+	{
+		WorkStealingDeque<int> deque(4);
+		int item = 0;
+
+		// The ring wraps around before it grows
+		for (int i = 0; i < 3; i++)
+		{
+			deque.push(i);
+			ASSERT_TRUE(deque.steal(item));
+		}
+
+		for (int i = 0; i < 1000; i++)
+			deque.push(i);
+		EXPECT_EQ(deque.getSize(), 1000);
+		EXPECT_GE(deque.getCapacity(), 1000);
+
+		for (int i = 0; i < 500; i++)
+		{
+			ASSERT_TRUE(deque.steal(item));
+			ASSERT_EQ(item, i);
+		}
+		for (int i = 999; i >= 500; i--)
+		{
+			ASSERT_TRUE(deque.pop(item));
+			ASSERT_EQ(item, i);
+		}
+		EXPECT_TRUE(deque.isEmpty());
+	}
+
+	TEST(WorkStealingDequeTest, WorkStealingDequeTakesAllocator)
+	{
+		MonotonicArena arena;
+		{
+			WorkStealingDeque<int*, ResourceAllocator<int*>> deque(2, &arena);
+			int items[100];
+			for (int& item : items)
+				deque.push(&item);
+
+			int* item = nullptr;
+			ASSERT_TRUE(deque.pop(item));
+			EXPECT_EQ(item, &items[99]);
+			EXPECT_EQ(deque.getAllocator().getResource(), &arena);
+		}
+		EXPECT_GT(arena.getSizeInBytes(), 0u);
+	}
+
+	TEST(WorkStealingDequeTest, WorkStealingDequeEveryItemTakenOnce)
+	{
+		const int itemCount = 200000;
+		const int thiefCount = 3;
+		WorkStealingDeque<int> deque(8);
+		std::vector<std::atomic<int>> taken(itemCount);
+		for (std::atomic<int>& count : taken)
+			count.store(0);
+		std::atomic<int> left(itemCount);
+
+		std::vector<std::thread> thieves;
+		for (int thief = 0; thief < thiefCount; thief++)
+		{
+			thieves.emplace_back([&]()
+			{
+				int item = 0;
+				while (left.load() > 0)
+				{
+					if (deque.steal(item))
+					{
+						taken[item].fetch_add(1);
+						left.fetch_sub(1);
+					}
+					else
+					{
+						std::this_thread::yield();
+					}
+				}
+			});
+		}
+
+		// The owner pushes in bursts and pops part of every burst itself, racing the thieves for the last items
+		int item = 0;
+		for (int next = 0; next < itemCount;)
+		{
+			const int burst = (next / 7) % 64 + 1;
+			for (int i = 0; i < burst && next < itemCount; i++)
+				deque.push(next++);
+			for (int i = 0; i < burst / 2 + 1; i++)
+			{
+				if (deque.pop(item))
+				{
+					taken[item].fetch_add(1);
+					left.fetch_sub(1);
+				}
+			}
+		}
+		while (deque.pop(item))
+		{
+			taken[item].fetch_add(1);
+			left.fetch_sub(1);
+		}
+
+		for (std::thread& thief : thieves)
+			thief.join();
+
+		EXPECT_TRUE(deque.isEmpty());
+		for (std::atomic<int>& count : taken)
+			ASSERT_EQ(count.load(), 1);
+	}
+}
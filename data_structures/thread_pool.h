@@ -0,0 +1,507 @@
+﻿/**
+ * @author Dreadblade- (https://github.com/Dreadblade-dev)
+ * Work-stealing thread pool
+ *
+ * A fork-join executor for the algorithms of the library. Work is split
+ * into tasks inside a TaskGroup: run() forks a task and wait() joins the
+ * group. Every worker thread owns a WorkStealingDeque; a task forked on a
+ * worker goes to the bottom of its deque and is run by it next, while
+ * idle workers steal the oldest tasks of the others. Tasks forked outside
+ * the pool go to a shared queue under a mutex. A thread in wait() does
+ * not block while its group has work left: it runs tasks itself, so
+ * groups nest freely and the calling thread is one more worker. Idle
+ * workers spin for a while and then park until a task is forked.
+ *
+ * parallelFor() and parallelReduce() cut a range into chunks of a given
+ * grain and fork them by halving the range of chunks, so a thief takes
+ * half of the remaining work at once. The chunks depend on the range and
+ * the grain only, and parallelReduce() combines the chunk results from
+ * left to right, so the result does not depend on the number of threads
+ * or the timing, even for operations that are not commutative. A pool of
+ * 0 workers runs everything on the calling thread.
+ *
+ * Time complexity (p - threads, t - time of one task):
+ * ┌───────────────┬───────────────┬───────────────────────┐
+ * │     Fork      │     Steal     │ parallelFor (n items) │
+ * ├───────────────┼───────────────┼───────────────────────┤
+ * │     O(1)      │     O(1)      │    O(n / p + log n)   │
+ * └───────────────┴───────────────┴───────────────────────┘
+ *
+ * Source: https://en.wikipedia.org/wiki/Work_stealing
+ */
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "queue.h"
+#include "parking.h"
+#include "work_stealing_deque.h"
+
+namespace thread_pool
+{
+	struct constants
+	{
+		static const unsigned spins_before_parking = 1000;
+	};
+
+	/**
+	 * Returns the number of workers that keeps every CPU busy together with the calling thread
+	 */
+	inline std::size_t defaultThreadCount() noexcept
+	{
+		const unsigned cpus = std::thread::hardware_concurrency();
+		return (cpus > 1) ? cpus - 1 : 0;
+	}
+}
+
+class ThreadPool
+{
+public:
+	class TaskGroup;
+private:
+	struct Task
+	{
+		void (*execute)(Task* task);
+		TaskGroup* group;
+	};
+
+	template <class Function>
+	struct FunctionTask : Task
+	{
+		Function function;
+
+		FunctionTask(Function&& function, TaskGroup* group) : function(std::move(function))
+		{
+			this->execute = &FunctionTask<Function>::run;
+			this->group = group;
+		}
+
+		static void run(Task* task)
+		{
+			FunctionTask<Function>* self = static_cast<FunctionTask<Function>*>(task);
+			TaskGroup* group = self->group;
+			try
+			{
+				self->function();
+			}
+			catch (...)
+			{
+				group->fail(std::current_exception());
+			}
+
+			delete self;
+			group->finish();
+		}
+	};
+
+	struct Worker
+	{
+		ThreadPool* pool;
+		std::size_t index;
+		WorkStealingDeque<Task*> deque;
+		std::thread thread;
+
+		Worker(ThreadPool* pool, std::size_t index) : pool(pool), index(index) {}
+	};
+
+	std::vector<std::unique_ptr<Worker>> m_workers;
+	Queue<Task*> m_injected;
+	std::mutex m_injectedMutex;
+	std::atomic<std::size_t> m_injectedCount;
+	std::atomic<bool> m_stopping;
+	parking::Event m_activity;
+
+	static Worker*& currentWorker() noexcept;
+	Worker* localWorker() const noexcept;
+	void fork(Task* task);
+	bool findTask(Worker* self, Task*& task);
+	void workerLoop(Worker* self);
+
+	template <class Index, class Function>
+	static void forChunks(TaskGroup& group, Index first, Index last, const Function& function);
+public:
+	class TaskGroup
+	{
+	private:
+		ThreadPool& m_pool;
+		std::atomic<std::size_t> m_pending;
+		std::atomic<bool> m_failed;
+		std::exception_ptr m_exception;
+
+		friend class ThreadPool;
+		void fail(std::exception_ptr exception) noexcept;
+		void finish() noexcept;
+		void join() noexcept;
+	public:
+		explicit TaskGroup(ThreadPool& pool) noexcept;
+		TaskGroup(const TaskGroup&) = delete;
+		TaskGroup& operator=(const TaskGroup&) = delete;
+		~TaskGroup();
+
+		template <class Function>
+		void run(Function&& function);
+		void wait();
+	};
+
+	explicit ThreadPool(std::size_t threadCount = thread_pool::defaultThreadCount());
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+	~ThreadPool();
+	std::size_t getThreadCount() const noexcept;
+
+	template <class Index, class Function>
+	void parallelFor(Index first, Index last, Index grain, Function function);
+	template <class Index, class T, class Map, class Combine>
+	T parallelReduce(Index first, Index last, Index grain, T identity, Map map, Combine combine);
+};
+
+/**
+ * Starts @threadCount workers, 0 runs every task on the thread that waits for it
+ */
+inline ThreadPool::ThreadPool(std::size_t threadCount)
+	: m_injectedCount(0), m_stopping(false)
+{
+	m_workers.reserve(threadCount);
+	for (std::size_t index = 0; index < threadCount; ++index)
+		m_workers.emplace_back(new Worker(this, index));
+
+	// All the deques exist before any worker looks for a task to steal
+	try
+	{
+		for (std::unique_ptr<Worker>& worker : m_workers)
+			worker->thread = std::thread(&ThreadPool::workerLoop, this, worker.get());
+	}
+	catch (...)
+	{
+		m_stopping.store(true, std::memory_order_release);
+		m_activity.notifyAll();
+		for (std::unique_ptr<Worker>& worker : m_workers)
+			if (worker->thread.joinable())
+				worker->thread.join();
+		throw;
+	}
+}
+
+/**
+ * Destructor, stops the workers once they are idle. Every task group must have been waited for
+ */
+inline ThreadPool::~ThreadPool()
+{
+	m_stopping.store(true, std::memory_order_release);
+	m_activity.notifyAll();
+
+	for (std::unique_ptr<Worker>& worker : m_workers)
+		worker->thread.join();
+}
+
+/**
+ * Returns the number of worker threads, the threads that wait for tasks come on top of them
+ */
+inline std::size_t ThreadPool::getThreadCount() const noexcept
+{
+	return m_workers.size();
+}
+
+/**
+ * The worker the calling thread is, of any pool
+ */
+inline ThreadPool::Worker*& ThreadPool::currentWorker() noexcept
+{
+	static thread_local Worker* worker = nullptr;
+	return worker;
+}
+
+/**
+ * Returns the worker of this pool the calling thread is, nullptr for other threads
+ */
+inline ThreadPool::Worker* ThreadPool::localWorker() const noexcept
+{
+	Worker* worker = currentWorker();
+	return (worker != nullptr && worker->pool == this) ? worker : nullptr;
+}
+
+/**
+ * Makes @task available to the pool and wakes the parked workers
+ */
+inline void ThreadPool::fork(Task* task)
+{
+	Worker* self = localWorker();
+	if (self != nullptr)
+	{
+		self->deque.push(task);
+	}
+	else
+	{
+		std::lock_guard<std::mutex> lock(m_injectedMutex);
+		m_injected.enqueue(task);
+		m_injectedCount.store(m_injected.getSize(), std::memory_order_release);
+	}
+
+	m_activity.notifyAll();
+}
+
+/**
+ * Looks for a task: the newest one of the own deque, then the shared queue,
+ * then the oldest one of another worker. @self is nullptr for outside threads
+ */
+inline bool ThreadPool::findTask(Worker* self, Task*& task)
+{
+	if (self != nullptr && self->deque.pop(task))
+		return true;
+
+	if (m_injectedCount.load(std::memory_order_acquire) > 0)
+	{
+		std::lock_guard<std::mutex> lock(m_injectedMutex);
+		if (!m_injected.isEmpty())
+		{
+			task = m_injected.dequeue();
+			m_injectedCount.store(m_injected.getSize(), std::memory_order_release);
+			return true;
+		}
+	}
+
+	// The victims are visited from the next worker on, so thieves spread over the deques
+	const std::size_t count = m_workers.size();
+	const std::size_t start = (self != nullptr) ? self->index + 1 : 0;
+	for (std::size_t offset = 0; offset < count; ++offset)
+	{
+		Worker* victim = m_workers[(start + offset) % count].get();
+		if (victim != self && victim->deque.steal(task))
+			return true;
+	}
+
+	return false;
+}
+
+/**
+ * Runs the tasks of the pool until it stops, parking while there are none
+ */
+inline void ThreadPool::workerLoop(Worker* self)
+{
+	currentWorker() = self;
+	const unsigned spins = parking::spinLimit(thread_pool::constants::spins_before_parking);
+	Task* task = nullptr;
+
+	for (;;)
+	{
+		bool found = findTask(self, task);
+		for (unsigned spin = 0; !found && spin < spins; ++spin)
+		{
+			parking::pause();
+			found = findTask(self, task);
+		}
+
+		if (!found)
+		{
+			const uint32_t token = m_activity.prepareWait();
+			found = findTask(self, task);
+			if (!found)
+			{
+				if (m_stopping.load(std::memory_order_acquire))
+					break;
+
+				m_activity.wait(token);
+				continue;
+			}
+		}
+
+		task->execute(task);
+	}
+
+	currentWorker() = nullptr;
+}
+
+/**
+ * Creates empty task group of @pool
+ */
+inline ThreadPool::TaskGroup::TaskGroup(ThreadPool& pool) noexcept
+	: m_pool(pool), m_pending(0), m_failed(false)
+{
+
+}
+
+/**
+ * Destructor, waits for the tasks still running. Their exceptions are dropped, call wait() to see them
+ */
+inline ThreadPool::TaskGroup::~TaskGroup()
+{
+	join();
+}
+
+/**
+ * Keeps the first exception thrown by a task of the group
+ */
+inline void ThreadPool::TaskGroup::fail(std::exception_ptr exception) noexcept
+{
+	if (!m_failed.exchange(true, std::memory_order_acq_rel))
+		m_exception = exception;
+}
+
+/**
+ * Counts a task of the group as done, the last one wakes the waiting threads
+ */
+inline void ThreadPool::TaskGroup::finish() noexcept
+{
+	// The pool outlives the group, the group may be gone as soon as the count drops to zero
+	ThreadPool& pool = m_pool;
+	if (m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		pool.m_activity.notifyAll();
+}
+
+/**
+ * Runs tasks of the pool until every task of the group is done
+ */
+inline void ThreadPool::TaskGroup::join() noexcept
+{
+	Worker* self = m_pool.localWorker();
+	const unsigned spins = parking::spinLimit(thread_pool::constants::spins_before_parking);
+	unsigned spin = 0;
+	Task* task = nullptr;
+
+	while (m_pending.load(std::memory_order_acquire) != 0)
+	{
+		if (m_pool.findTask(self, task))
+		{
+			task->execute(task);
+			spin = 0;
+			continue;
+		}
+
+		// The rest of the group runs on other threads
+		if (spin < spins)
+		{
+			++spin;
+			parking::pause();
+			continue;
+		}
+
+		const uint32_t token = m_pool.m_activity.prepareWait();
+		if (m_pending.load(std::memory_order_acquire) == 0)
+			break;
+		if (m_pool.findTask(self, task))
+		{
+			task->execute(task);
+			continue;
+		}
+		m_pool.m_activity.wait(token);
+	}
+}
+
+/**
+ * Forks a task that calls @function, which may run on any thread of the pool
+ */
+template <class Function>
+void ThreadPool::TaskGroup::run(Function&& function)
+{
+	using Stored = typename std::decay<Function>::type;
+	Task* task = new FunctionTask<Stored>(Stored(std::forward<Function>(function)), this);
+
+	m_pending.fetch_add(1, std::memory_order_relaxed);
+	m_pool.fork(task);
+}
+
+/**
+ * Waits until every task of the group is done, running tasks meanwhile.
+ * Rethrows the first exception of a task, the group can be reused afterwards
+ */
+inline void ThreadPool::TaskGroup::wait()
+{
+	join();
+
+	if (m_failed.load(std::memory_order_acquire))
+	{
+		std::exception_ptr exception = m_exception;
+		m_exception = nullptr;
+		m_failed.store(false, std::memory_order_relaxed);
+		std::rethrow_exception(exception);
+	}
+}
+
+/**
+ * Calls @function for the chunks from @first to @last. Forks the right half
+ * of the chunks while there is more than one and runs the last one itself
+ */
+template <class Index, class Function>
+void ThreadPool::forChunks(TaskGroup& group, Index first, Index last, const Function& function)
+{
+	while (last - first > 1)
+	{
+		const Index middle = first + (last - first) / 2;
+		group.run([&group, &function, middle, last]()
+		{
+			forChunks(group, middle, last, function);
+		});
+		last = middle;
+	}
+
+	function(first);
+}
+
+/**
+ * Calls @function(index) for every index from @first to @last (exclusive),
+ * in chunks of @grain consecutive indices. Returns once every call is done,
+ * rethrows the first exception of a call
+ */
+template <class Index, class Function>
+void ThreadPool::parallelFor(Index first, Index last, Index grain, Function function)
+{
+	if (!(first < last))
+		return;
+	if (grain < 1)
+		grain = 1;
+
+	const Index chunks = (last - first - 1) / grain + 1;
+	auto chunk = [first, last, grain, &function](Index index)
+	{
+		const Index begin = first + index * grain;
+		const Index end = (last - begin > grain) ? begin + grain : last;
+		for (Index current = begin; current < end; ++current)
+			function(current);
+	};
+
+	TaskGroup group(*this);
+	group.run([&group, &chunk, chunks]()
+	{
+		forChunks(group, Index(0), chunks, chunk);
+	});
+	group.wait();
+}
+
+/**
+ * Folds combine(..combine(combine(@identity, map(@first)), map(@first + 1)).., map(@last - 1))
+ * in parallel chunks of @grain indices. @combine must be associative and
+ * @identity neutral for it; the chunks are folded from @identity and their
+ * results combined from left to right, so the result is the same for any
+ * number of threads
+ */
+template <class Index, class T, class Map, class Combine>
+T ThreadPool::parallelReduce(Index first, Index last, Index grain, T identity, Map map, Combine combine)
+{
+	if (!(first < last))
+		return identity;
+	if (grain < 1)
+		grain = 1;
+
+	const Index chunks = (last - first - 1) / grain + 1;
+	std::vector<T> partials(static_cast<std::size_t>(chunks), identity);
+	parallelFor(Index(0), chunks, Index(1), [first, last, grain, &partials, &map, &combine](Index index)
+	{
+		const Index begin = first + index * grain;
+		const Index end = (last - begin > grain) ? begin + grain : last;
+		T& partial = partials[static_cast<std::size_t>(index)];
+		for (Index current = begin; current < end; ++current)
+			partial = combine(std::move(partial), map(current));
+	});
+
+	T result = std::move(identity);
+	for (T& partial : partials)
+		result = combine(std::move(result), std::move(partial));
+	return result;
+}
\ No newline at end of file
@@ -0,0 +1,290 @@
+﻿/**
+ * @author Dreadblade- (https://github.com/Dreadblade-dev)
+ * Work-stealing deque
+ *
+ * The deque of a worker thread in a work-stealing scheduler (Chase and
+ * Lev). The owner pushes and pops tasks at the bottom like a stack, so it
+ * works on the newest task, whose data is still in its cache. Idle
+ * threads steal from the top, the oldest task, which in divide and
+ * conquer is the largest piece of the remaining work. The owner touches
+ * only the bottom index and pays for a fence just when it pops, and
+ * the only compare-and-swap happens when the owner and a thief race for
+ * the last task or two thieves race for the same one.
+ *
+ * The items live in a ring of atomics that doubles when it is full. A
+ * thief may still read the old ring, so outgrown rings are kept until the
+ * deque is destroyed; together they take less memory than the last one.
+ * Items are read before their slot is claimed, so they must be trivially
+ * copyable, pointers to tasks as a rule.
+ *
+ * Time complexity (push is amortized):
+ * ┌───────────┬──────────┬──────────┐
+ * │   Push    │   Pop    │  Steal   │
+ * ├───────────┼──────────┼──────────┤
+ * │    O(1)   │   O(1)   │   O(1)   │
+ * └───────────┴──────────┴──────────┘
+ *
+ * Source: https://www.di.ens.fr/~zappa/readings/ppopp13.pdf
+ */
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include "stack.h"
+#include "memory_resource.h"
+
+namespace work_stealing_deque
+{
+	struct constants
+	{
+		static const std::size_t default_capacity = 64;
+		static const std::size_t cache_line = 64;
+	};
+}
+
+template <class T, class Allocator = std::allocator<T>>
+class WorkStealingDeque
+{
+	static_assert(std::is_trivially_copyable<T>::value, "WorkStealingDeque requires trivially copyable items");
+private:
+	struct Ring
+	{
+		std::atomic<T>* items;
+		std::size_t mask;
+		Ring* retired;
+
+		T get(int64_t index) const noexcept
+		{
+			return items[static_cast<std::size_t>(index) & mask].load(std::memory_order_relaxed);
+		}
+
+		void put(int64_t index, T item) noexcept
+		{
+			items[static_cast<std::size_t>(index) & mask].store(item, std::memory_order_relaxed);
+		}
+	};
+
+	using ItemAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<std::atomic<T>>;
+	using RingAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Ring>;
+
+	// Written by the owner only
+	std::atomic<int64_t> m_bottom;
+	std::atomic<Ring*> m_ring;
+	char m_ownerPadding[work_stealing_deque::constants::cache_line];
+
+	// Written by the thieves and by the owner taking the last item
+	std::atomic<int64_t> m_top;
+	char m_thiefPadding[work_stealing_deque::constants::cache_line];
+
+	ItemAllocator m_itemAllocator;
+	RingAllocator m_ringAllocator;
+
+	Ring* allocateRing(std::size_t capacity, Ring* retired);
+	Ring* grow(Ring* ring, int64_t top, int64_t bottom);
+public:
+	explicit WorkStealingDeque(std::size_t capacity = work_stealing_deque::constants::default_capacity,
+		const Allocator& allocator = Allocator());
+	WorkStealingDeque(const WorkStealingDeque<T, Allocator>&) = delete;
+	WorkStealingDeque<T, Allocator>& operator=(const WorkStealingDeque<T, Allocator>&) = delete;
+	~WorkStealingDeque();
+	bool isEmpty() const noexcept;
+	std::size_t getSize() const noexcept;
+	std::size_t getCapacity() const noexcept;
+	Allocator getAllocator() const noexcept;
+
+	// Owner side
+	void push(T item);
+	bool pop(T& item);
+
+	// Any thread
+	bool steal(T& item);
+};
+
+/**
+ * Creates deque for @capacity items (rounded up to a power of two) before it grows
+ */
+template <class T, class Allocator>
+WorkStealingDeque<T, Allocator>::WorkStealingDeque(std::size_t capacity, const Allocator& allocator)
+	: m_bottom(0), m_ring(nullptr), m_top(0), m_itemAllocator(allocator), m_ringAllocator(allocator)
+{
+	std::size_t ringCapacity = 1;
+	while (ringCapacity < capacity)
+		ringCapacity <<= 1;
+
+	m_ring.store(allocateRing(ringCapacity, nullptr), std::memory_order_relaxed);
+}
+
+/**
+ * Destructor, no thread may use the deque anymore. The items are trivial and are not destroyed
+ */
+template <class T, class Allocator>
+WorkStealingDeque<T, Allocator>::~WorkStealingDeque()
+{
+	Ring* ring = m_ring.load(std::memory_order_relaxed);
+	while (ring != nullptr)
+	{
+		Ring* retired = ring->retired;
+		stack::deallocate(m_itemAllocator, ring->items, ring->mask + 1);
+		stack::deallocate(m_ringAllocator, ring, 1);
+		ring = retired;
+	}
+}
+
+/**
+ * Allocates ring of @capacity items that keeps the outgrown @retired ring alive
+ */
+template <class T, class Allocator>
+typename WorkStealingDeque<T, Allocator>::Ring* WorkStealingDeque<T, Allocator>::allocateRing(std::size_t capacity, Ring* retired)
+{
+	Ring* ring = stack::allocate<Ring>(m_ringAllocator, 1);
+	try
+	{
+		ring->items = stack::allocate<std::atomic<T>>(m_itemAllocator, capacity);
+	}
+	catch (...)
+	{
+		stack::deallocate(m_ringAllocator, ring, 1);
+		throw;
+	}
+
+	for (std::size_t index = 0; index < capacity; ++index)
+		::new (static_cast<void*>(ring->items + index)) std::atomic<T>(T());
+	ring->mask = capacity - 1;
+	ring->retired = retired;
+	return ring;
+}
+
+/**
+ * Moves the items from @top to @bottom to a ring twice as large and publishes it
+ */
+template <class T, class Allocator>
+typename WorkStealingDeque<T, Allocator>::Ring* WorkStealingDeque<T, Allocator>::grow(Ring* ring, int64_t top, int64_t bottom)
+{
+	Ring* larger = allocateRing(2 * (ring->mask + 1), ring);
+	for (int64_t index = top; index < bottom; ++index)
+		larger->put(index, ring->get(index));
+
+	m_ring.store(larger, std::memory_order_release);
+	return larger;
+}
+
+/**
+ * Returns @true if the deque is empty at the moment of the call
+ */
+template <class T, class Allocator>
+bool WorkStealingDeque<T, Allocator>::isEmpty() const noexcept
+{
+	return getSize() == 0;
+}
+
+/**
+ * Returns the number of items at the moment of the call
+ */
+template <class T, class Allocator>
+std::size_t WorkStealingDeque<T, Allocator>::getSize() const noexcept
+{
+	const int64_t bottom = m_bottom.load(std::memory_order_acquire);
+	const int64_t top = m_top.load(std::memory_order_acquire);
+	return (bottom > top) ? static_cast<std::size_t>(bottom - top) : 0;
+}
+
+/**
+ * Returns the number of items that fit before the deque grows
+ */
+template <class T, class Allocator>
+std::size_t WorkStealingDeque<T, Allocator>::getCapacity() const noexcept
+{
+	return m_ring.load(std::memory_order_acquire)->mask + 1;
+}
+
+/**
+ * Returns the allocator of the deque
+ */
+template <class T, class Allocator>
+Allocator WorkStealingDeque<T, Allocator>::getAllocator() const noexcept
+{
+	return Allocator(m_itemAllocator);
+}
+
+/**
+ * Adds @item at the bottom, only the owner may call it
+ */
+template <class T, class Allocator>
+void WorkStealingDeque<T, Allocator>::push(T item)
+{
+	const int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+	const int64_t top = m_top.load(std::memory_order_acquire);
+	Ring* ring = m_ring.load(std::memory_order_relaxed);
+
+	if (bottom - top > static_cast<int64_t>(ring->mask))
+		ring = grow(ring, top, bottom);
+
+	ring->put(bottom, item);
+	m_bottom.store(bottom + 1, std::memory_order_release);
+}
+
+/**
+ * Moves the bottom item (the newest one) to @item and returns @true,
+ * returns @false if the deque is empty. Only the owner may call it
+ */
+template <class T, class Allocator>
+bool WorkStealingDeque<T, Allocator>::pop(T& item)
+{
+	const int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+	Ring* ring = m_ring.load(std::memory_order_relaxed);
+
+	// The thieves must see the bottom taken before the top is read
+	m_bottom.store(bottom, std::memory_order_seq_cst);
+	int64_t top = m_top.load(std::memory_order_seq_cst);
+
+	if (top > bottom)
+	{
+		m_bottom.store(bottom + 1, std::memory_order_relaxed);
+		return false;
+	}
+
+	const T popped = ring->get(bottom);
+	if (top < bottom)
+	{
+		item = popped;
+		return true;
+	}
+
+	// The last item, a thief may be taking it at the same time
+	const bool won = m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+	m_bottom.store(bottom + 1, std::memory_order_relaxed);
+	if (won)
+		item = popped;
+	return won;
+}
+
+/**
+ * Moves the top item (the oldest one) to @item and returns @true. Returns
+ * @false if the deque is empty or another thread took the item first
+ */
+template <class T, class Allocator>
+bool WorkStealingDeque<T, Allocator>::steal(T& item)
+{
+	int64_t top = m_top.load(std::memory_order_seq_cst);
+	const int64_t bottom = m_bottom.load(std::memory_order_seq_cst);
+	if (top >= bottom)
+		return false;
+
+	// The ring is read before the claim: a slot may be overwritten only after the top moves past it
+	const T stolen = m_ring.load(std::memory_order_acquire)->get(top);
+	if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		return false;
+
+	item = stolen;
+	return true;
+}
+
+#if DATA_STRUCTURES_PMR
+namespace pmr
+{
+	template <class T>
+	using WorkStealingDeque = ::WorkStealingDeque<T, std::pmr::polymorphic_allocator<T>>;
+}
+#endif
\ No newline at end of file
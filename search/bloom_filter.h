@@ -0,0 +1,391 @@
+﻿/**
+ * @author Dreadblade- (https://github.com/Dreadblade-dev)
+ * Blocked Bloom filter realization
+ *
+ * A Bloom filter answers "definitely not present" or "maybe present" for
+ * a set of keys with a few bits per key. The blocked variant hashes every
+ * key to one 64-byte block (a cache line) and sets all of its bits there,
+ * so a query costs a single cache miss instead of one per probed bit.
+ *
+ * The split-block variant uses 32-byte blocks of eight 32-bit words and
+ * sets exactly one bit in every word, the bit chosen by multiplying the
+ * hash with a per-word odd constant. All eight words are probed with one
+ * AVX2 multiply, shift and test.
+ *
+ * FilteredSortedArray and FilteredList put a filter in front of a sorted
+ * array or a list, so most misses are answered without searching.
+ *
+ * Time complexity:
+ * ┌──────────────────────┬──────────────────────┐
+ * │         Add          │     May contain      │
+ * ├──────────────────────┼──────────────────────┤
+ * │         O(1)         │         O(1)         │
+ * └──────────────────────┴──────────────────────┘
+ *
+ * Source: https://en.wikipedia.org/wiki/Bloom_filter
+ */
+
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "simd.h"
+
+namespace bloom_filter
+{
+	struct constants
+	{
+		static const std::size_t default_bits_per_key = 10;
+		static const std::size_t blocked_block_words = 8;
+		static const unsigned blocked_hash_count = 7;
+		static const std::size_t split_block_words = 8;
+	};
+
+	inline uint64_t mix(uint64_t hash) noexcept
+	{
+		hash ^= hash >> 30;
+		hash *= 0xbf58476d1ce4e5b9ULL;
+		hash ^= hash >> 27;
+		hash *= 0x94d049bb133111ebULL;
+		return hash ^ (hash >> 31);
+	}
+
+	/**
+	 * Returns the block of @hash from its high half
+	 */
+	inline std::size_t blockOf(uint64_t hash, std::size_t blockCount) noexcept
+	{
+		return static_cast<std::size_t>(((hash >> 32) * blockCount) >> 32);
+	}
+
+	/**
+	 * Odd constants that pick the bit of every split-block word
+	 */
+	inline const uint32_t* salts() noexcept
+	{
+		static const uint32_t values[constants::split_block_words] = {
+			0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+			0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+		};
+		return values;
+	}
+
+	/**
+	 * Tests whether a split block has the bits of @hash set
+	 */
+	template <SimdLevel LEVEL>
+	struct SplitBlockProbe
+	{
+		static bool test(const uint32_t* block, uint32_t hash) noexcept
+		{
+			for (std::size_t word = 0; word < constants::split_block_words; ++word)
+				if ((block[word] & (uint32_t(1) << ((hash * salts()[word]) >> 27))) == 0)
+					return false;
+
+			return true;
+		}
+	};
+
+#if SIMD_X86
+	template <>
+	struct SplitBlockProbe<SimdLevel::avx2>
+	{
+		SIMD_AVX2 static bool test(const uint32_t* block, uint32_t hash) noexcept
+		{
+			const __m256i salt = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(salts()));
+			const __m256i shifts = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int>(hash)), salt), 27);
+			const __m256i mask = _mm256_sllv_epi32(_mm256_set1_epi32(1), shifts);
+			const __m256i bits = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+
+			// Carry flag: every mask bit is set in the block
+			return _mm256_testc_si256(bits, mask) != 0;
+		}
+	};
+
+	template <>
+	struct SplitBlockProbe<SimdLevel::avx512> : SplitBlockProbe<SimdLevel::avx2>
+	{
+	};
+#endif
+
+	template <typename Ops>
+	struct SplitBlockTest
+	{
+		static bool run(const uint32_t* block, uint32_t hash) noexcept
+		{
+			return SplitBlockProbe<Ops::level>::test(block, hash);
+		}
+	};
+}
+
+template <class T, class Hash = std::hash<T>>
+class BlockedBloomFilter
+{
+private:
+	std::vector<uint64_t> m_words;
+	std::size_t m_blockCount;
+	Hash m_hash;
+
+	uint64_t hashOf(const T& key) const;
+public:
+	explicit BlockedBloomFilter(std::size_t expectedKeys,
+		std::size_t bitsPerKey = bloom_filter::constants::default_bits_per_key);
+	void add(const T& key);
+	bool mayContain(const T& key) const;
+	void clear() noexcept;
+	std::size_t getSizeInBytes() const noexcept;
+};
+
+/**
+ * Sizes the filter for @expectedKeys keys with @bitsPerKey bits each
+ */
+template <class T, class Hash>
+BlockedBloomFilter<T, Hash>::BlockedBloomFilter(std::size_t expectedKeys, std::size_t bitsPerKey)
+{
+	const std::size_t blockBits = bloom_filter::constants::blocked_block_words * 64;
+	m_blockCount = std::max<std::size_t>((expectedKeys * bitsPerKey + blockBits - 1) / blockBits, 1);
+	m_words.assign(m_blockCount * bloom_filter::constants::blocked_block_words, 0);
+}
+
+template <class T, class Hash>
+uint64_t BlockedBloomFilter<T, Hash>::hashOf(const T& key) const
+{
+	return bloom_filter::mix(static_cast<uint64_t>(m_hash(key)));
+}
+
+/**
+ * Adds @key to the filter
+ */
+template <class T, class Hash>
+void BlockedBloomFilter<T, Hash>::add(const T& key)
+{
+	const uint64_t hash = hashOf(key);
+	uint64_t* block = m_words.data() + bloom_filter::blockOf(hash, m_blockCount) * bloom_filter::constants::blocked_block_words;
+
+	// Seven 9-bit bit positions inside the 512-bit block from a second hash
+	uint64_t bits = bloom_filter::mix(hash);
+	for (unsigned i = 0; i < bloom_filter::constants::blocked_hash_count; ++i, bits >>= 9)
+		block[(bits & 511) / 64] |= uint64_t(1) << (bits % 64);
+}
+
+/**
+ * Returns @false if @key was definitely not added
+ */
+template <class T, class Hash>
+bool BlockedBloomFilter<T, Hash>::mayContain(const T& key) const
+{
+	const uint64_t hash = hashOf(key);
+	const uint64_t* block = m_words.data() + bloom_filter::blockOf(hash, m_blockCount) * bloom_filter::constants::blocked_block_words;
+
+	uint64_t bits = bloom_filter::mix(hash);
+	for (unsigned i = 0; i < bloom_filter::constants::blocked_hash_count; ++i, bits >>= 9)
+		if ((block[(bits & 511) / 64] & (uint64_t(1) << (bits % 64))) == 0)
+			return false;
+
+	return true;
+}
+
+template <class T, class Hash>
+void BlockedBloomFilter<T, Hash>::clear() noexcept
+{
+	std::fill(m_words.begin(), m_words.end(), 0);
+}
+
+template <class T, class Hash>
+std::size_t BlockedBloomFilter<T, Hash>::getSizeInBytes() const noexcept
+{
+	return sizeof(*this) + m_words.capacity() * sizeof(uint64_t);
+}
+
+template <class T, class Hash = std::hash<T>>
+class SplitBlockBloomFilter
+{
+private:
+	std::vector<uint32_t> m_words;
+	std::size_t m_blockCount;
+	Hash m_hash;
+
+	uint64_t hashOf(const T& key) const;
+public:
+	explicit SplitBlockBloomFilter(std::size_t expectedKeys,
+		std::size_t bitsPerKey = bloom_filter::constants::default_bits_per_key);
+	void add(const T& key);
+	bool mayContain(const T& key) const;
+	void clear() noexcept;
+	std::size_t getSizeInBytes() const noexcept;
+};
+
+/**
+ * Sizes the filter for @expectedKeys keys with @bitsPerKey bits each
+ */
+template <class T, class Hash>
+SplitBlockBloomFilter<T, Hash>::SplitBlockBloomFilter(std::size_t expectedKeys, std::size_t bitsPerKey)
+{
+	const std::size_t blockBits = bloom_filter::constants::split_block_words * 32;
+	m_blockCount = std::max<std::size_t>((expectedKeys * bitsPerKey + blockBits - 1) / blockBits, 1);
+	m_words.assign(m_blockCount * bloom_filter::constants::split_block_words, 0);
+}
+
+template <class T, class Hash>
+uint64_t SplitBlockBloomFilter<T, Hash>::hashOf(const T& key) const
+{
+	return bloom_filter::mix(static_cast<uint64_t>(m_hash(key)));
+}
+
+/**
+ * Adds @key to the filter
+ */
+template <class T, class Hash>
+void SplitBlockBloomFilter<T, Hash>::add(const T& key)
+{
+	const uint64_t hash = hashOf(key);
+	uint32_t* block = m_words.data() + bloom_filter::blockOf(hash, m_blockCount) * bloom_filter::constants::split_block_words;
+	const uint32_t low = static_cast<uint32_t>(hash);
+
+	for (std::size_t word = 0; word < bloom_filter::constants::split_block_words; ++word)
+		block[word] |= uint32_t(1) << ((low * bloom_filter::salts()[word]) >> 27);
+}
+
+/**
+ * Returns @false if @key was definitely not added
+ */
+template <class T, class Hash>
+bool SplitBlockBloomFilter<T, Hash>::mayContain(const T& key) const
+{
+	const uint64_t hash = hashOf(key);
+	const uint32_t* block = m_words.data() + bloom_filter::blockOf(hash, m_blockCount) * bloom_filter::constants::split_block_words;
+
+	return simd::dispatch<bloom_filter::SplitBlockTest, uint32_t>(block, static_cast<uint32_t>(hash));
+}
+
+template <class T, class Hash>
+void SplitBlockBloomFilter<T, Hash>::clear() noexcept
+{
+	std::fill(m_words.begin(), m_words.end(), 0);
+}
+
+template <class T, class Hash>
+std::size_t SplitBlockBloomFilter<T, Hash>::getSizeInBytes() const noexcept
+{
+	return sizeof(*this) + m_words.capacity() * sizeof(uint32_t);
+}
+
+/**
+ * A sorted array behind a Bloom filter. The array is not copied
+ * and has to outlive the wrapper
+ */
+template <class T, class Filter = SplitBlockBloomFilter<T>>
+class FilteredSortedArray
+{
+private:
+	const T* m_data;
+	std::size_t m_size;
+	Filter m_filter;
+public:
+	FilteredSortedArray(const T* sortedArray, std::size_t size);
+	int64_t find(const T& key) const;
+	bool contains(const T& key) const;
+	const Filter& getFilter() const noexcept;
+};
+
+template <class T, class Filter>
+FilteredSortedArray<T, Filter>::FilteredSortedArray(const T* sortedArray, std::size_t size)
+	: m_data(sortedArray), m_size(size), m_filter(size)
+{
+	for (std::size_t index = 0; index < size; ++index)
+		m_filter.add(sortedArray[index]);
+}
+
+/**
+ * Returns the position of @key or -1, a rejected key costs no search
+ */
+template <class T, class Filter>
+int64_t FilteredSortedArray<T, Filter>::find(const T& key) const
+{
+	if (!m_filter.mayContain(key))
+		return -1;
+
+	// binarySearch requires the key to be present, a false positive may not be
+	const T* position = std::lower_bound(m_data, m_data + m_size, key);
+	if (position == m_data + m_size || !(*position == key))
+		return -1;
+
+	return static_cast<int64_t>(position - m_data);
+}
+
+template <class T, class Filter>
+bool FilteredSortedArray<T, Filter>::contains(const T& key) const
+{
+	return find(key) >= 0;
+}
+
+template <class T, class Filter>
+const Filter& FilteredSortedArray<T, Filter>::getFilter() const noexcept
+{
+	return m_filter;
+}
+
+/**
+ * A list (SinglyLinkedList, DoublyLinkedList) behind a Bloom filter.
+ * Removed items stay in the filter, they only cost a full contains call
+ */
+template <class List, class T, class Filter = SplitBlockBloomFilter<T>>
+class FilteredList
+{
+private:
+	List m_list;
+	Filter m_filter;
+public:
+	explicit FilteredList(std::size_t expectedItems);
+	void insertAtStart(const T& item);
+	void insertAtEnd(const T& item);
+	void remove(const T& item);
+	bool contains(const T& item) const;
+	const List& getList() const noexcept;
+};
+
+/**
+ * Creates an empty list, the filter is sized for @expectedItems items
+ */
+template <class List, class T, class Filter>
+FilteredList<List, T, Filter>::FilteredList(std::size_t expectedItems) : m_filter(expectedItems)
+{
+
+}
+
+template <class List, class T, class Filter>
+void FilteredList<List, T, Filter>::insertAtStart(const T& item)
+{
+	m_filter.add(item);
+	m_list.insertAtStart(item);
+}
+
+template <class List, class T, class Filter>
+void FilteredList<List, T, Filter>::insertAtEnd(const T& item)
+{
+	m_filter.add(item);
+	m_list.insertAtEnd(item);
+}
+
+template <class List, class T, class Filter>
+void FilteredList<List, T, Filter>::remove(const T& item)
+{
+	m_list.remove(item);
+}
+
+/**
+ * Returns @true if the list contains @item, most misses return
+ * after one filter block instead of walking the list
+ */
+template <class List, class T, class Filter>
+bool FilteredList<List, T, Filter>::contains(const T& item) const
+{
+	return m_filter.mayContain(item) && m_list.contains(item);
+}
+
+template <class List, class T, class Filter>
+const List& FilteredList<List, T, Filter>::getList() const noexcept
+{
+	return m_list;
+}
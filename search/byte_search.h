@@ -0,0 +1,253 @@
+﻿/**
+ * @author Dreadblade- (https://github.com/Dreadblade-dev)
+ * Byte and substring search in byte arrays
+ *
+ * findByte is the vectorized linearSearch kernel on chars (memchr).
+ *
+ * findSubstring compares the first and the last byte of the pattern with
+ * a whole vector of text positions at once (the "generic SIMD" algorithm
+ * by Wojciech Muła): a position is a candidate only when both bytes
+ * match, and only candidates are compared with the rest of the pattern.
+ * On ordinary text that filters out nearly every position.
+ *
+ * Texts like "aaaa...a" with a pattern like "aa...aba" turn every position
+ * into a candidate that fails late, which would cost O(n m). When the
+ * verification work outgrows the scanned text, the search continues
+ * with the Two-Way algorithm, which is O(n + m) in the worst case and
+ * needs no extra memory.
+ *
+ * Time complexity (m - pattern length):
+ * ┌────────────────┬────────────────┬───────────────┐
+ * │   Worst-case   │  Average-case  │   Best-case   │
+ * ├────────────────┼────────────────┼───────────────┤
+ * │    O(n + m)    │      O(n)      │     O(m)      │
+ * └────────────────┴────────────────┴───────────────┘
+ *
+ * Source: http://0x80.pl/articles/simd-strfind.html
+ */
+
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include "linear_search.h"
+#include "simd.h"
+
+namespace byte_search
+{
+	struct constants
+	{
+		// Verified bytes allowed before switching to Two-Way, on top of four per scanned position
+		static const std::size_t two_way_budget = 1024;
+	};
+
+	/**
+	 * Splits @pattern into a left and a right half so that the Two-Way
+	 * search never shifts past an occurrence (critical factorization).
+	 * Returns the start of the right half and stores the period of the
+	 * longer maximal suffix in @period
+	 */
+	inline std::size_t criticalFactorization(const unsigned char* pattern, std::size_t size, std::size_t& period) noexcept
+	{
+		// Maximal suffix for the byte order and for the reversed order, the longer one is used
+		std::size_t suffixes[2];
+		std::size_t periods[2];
+
+		for (int reversed = 0; reversed < 2; ++reversed)
+		{
+			std::size_t suffix = SIZE_MAX;
+			std::size_t j = 0;
+			std::size_t k = 1;
+			std::size_t p = 1;
+
+			while (j + k < size)
+			{
+				const unsigned char a = pattern[j + k];
+				const unsigned char b = pattern[suffix + k];
+
+				if (reversed ? (a > b) : (a < b))
+				{
+					// The suffix is smaller, the period is everything seen so far
+					j += k;
+					k = 1;
+					p = j - suffix;
+				}
+				else if (a == b)
+				{
+					if (k != p)
+						++k;
+					else
+					{
+						j += p;
+						k = 1;
+					}
+				}
+				else
+				{
+					// The suffix is larger, start over from here
+					suffix = j++;
+					k = p = 1;
+				}
+			}
+
+			suffixes[reversed] = suffix;
+			periods[reversed] = p;
+		}
+
+		// Unsigned wrap-around: SIZE_MAX + 1 is 0
+		if (suffixes[1] + 1 < suffixes[0] + 1)
+		{
+			period = periods[0];
+			return suffixes[0] + 1;
+		}
+
+		period = periods[1];
+		return suffixes[1] + 1;
+	}
+
+	/**
+	 * Two-Way string matching. Returns the position of the first
+	 * occurrence of @pattern in @text or -1, @patternSize must not be 0
+	 */
+	inline int64_t twoWay(const char* textChars, std::size_t size, const char* patternChars, std::size_t patternSize) noexcept
+	{
+		if (patternSize > size)
+			return -1;
+
+		const unsigned char* text = reinterpret_cast<const unsigned char*>(textChars);
+		const unsigned char* pattern = reinterpret_cast<const unsigned char*>(patternChars);
+
+		std::size_t period;
+		const std::size_t suffix = criticalFactorization(pattern, patternSize, period);
+
+		if (std::memcmp(pattern, pattern + period, suffix) == 0)
+		{
+			// Periodic pattern: after a match of the right half the shift is one period,
+			// and the part of the pattern that overlaps the old window is already known to match
+			std::size_t memory = 0;
+
+			for (std::size_t j = 0; j <= size - patternSize;)
+			{
+				std::size_t i = (suffix > memory) ? suffix : memory;
+				while (i < patternSize && pattern[i] == text[i + j])
+					++i;
+
+				if (i < patternSize)
+				{
+					j += i - suffix + 1;
+					memory = 0;
+					continue;
+				}
+
+				i = suffix - 1;
+				while (memory < i + 1 && pattern[i] == text[i + j])
+					--i;
+				if (i + 1 < memory + 1)
+					return static_cast<int64_t>(j);
+
+				j += period;
+				memory = patternSize - period;
+			}
+		}
+		else
+		{
+			// The halves differ, a mismatch in the left half shifts past the longer half
+			period = ((suffix > patternSize - suffix) ? suffix : patternSize - suffix) + 1;
+
+			for (std::size_t j = 0; j <= size - patternSize;)
+			{
+				std::size_t i = suffix;
+				while (i < patternSize && pattern[i] == text[i + j])
+					++i;
+
+				if (i < patternSize)
+				{
+					j += i - suffix + 1;
+					continue;
+				}
+
+				i = suffix - 1;
+				while (i != SIZE_MAX && pattern[i] == text[i + j])
+					--i;
+				if (i == SIZE_MAX)
+					return static_cast<int64_t>(j);
+
+				j += period;
+			}
+		}
+
+		return -1;
+	}
+
+	/**
+	 * First/last byte filter over Ops::lanes positions per step,
+	 * @patternSize is at least 2
+	 */
+	template <typename Ops>
+	struct FirstLastFilter
+	{
+		static int64_t run(const char* text, std::size_t size, const char* pattern, std::size_t patternSize) noexcept
+		{
+			const std::size_t last = patternSize - 1;
+			// Candidate positions are [0, end)
+			const std::size_t end = size - last;
+			const Ops first(pattern[0]);
+			const Ops lastByte(pattern[last]);
+
+			std::size_t verified = 0;
+			std::size_t position = 0;
+
+			for (; position + Ops::lanes <= end; position += Ops::lanes)
+			{
+				uint64_t mask = first.match(text + position) & lastByte.match(text + position + last);
+
+				while (mask != 0)
+				{
+					const std::size_t candidate = position + simd::countTrailingZeros(mask) / Ops::laneBits;
+					if (std::memcmp(text + candidate + 1, pattern + 1, patternSize - 2) == 0)
+						return static_cast<int64_t>(candidate);
+
+					verified += patternSize;
+					mask &= mask - 1;
+				}
+
+				if (verified > constants::two_way_budget + 4 * position)
+				{
+					const std::size_t next = position + Ops::lanes;
+					const int64_t found = twoWay(text + next, size - next, pattern, patternSize);
+					return (found < 0) ? -1 : static_cast<int64_t>(next) + found;
+				}
+			}
+
+			for (; position < end; ++position)
+				if (text[position] == pattern[0] && text[position + last] == pattern[last] &&
+					std::memcmp(text + position + 1, pattern + 1, patternSize - 2) == 0)
+					return static_cast<int64_t>(position);
+
+			return -1;
+		}
+	};
+}
+
+/**
+ * Returns the position of the first @byte in @text or -1
+ */
+inline int64_t findByte(const char* text, std::size_t size, char byte) noexcept
+{
+	return linearSearch(text, size, byte);
+}
+
+/**
+ * Returns the position of the first occurrence of @pattern in @text or -1.
+ * An empty pattern is found at position 0
+ */
+inline int64_t findSubstring(const char* text, std::size_t size, const char* pattern, std::size_t patternSize) noexcept
+{
+	if (patternSize == 0)
+		return 0;
+	if (patternSize > size)
+		return -1;
+	if (patternSize == 1)
+		return findByte(text, size, pattern[0]);
+
+	return simd::dispatch<byte_search::FirstLastFilter, char>(text, size, pattern, patternSize);
+}
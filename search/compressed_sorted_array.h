@@ -0,0 +1,334 @@
+﻿/**
+ * @author Dreadblade- (https://github.com/Dreadblade-dev)
+ * Compressed searchable sorted integer array
+ *
+ * The sorted values are split into blocks of 128. Every block stores its
+ * first value (the frame of reference) in a separate skip index and the
+ * differences of all its values to that base bit-packed with just as many
+ * bits as the largest difference needs. Dense sorted IDs therefore take a
+ * few bits per value instead of 64.
+ *
+ * The packed bits of a block are interleaved over four 64-bit lanes
+ * (value j goes to lane j % 4), so four values are decoded at once with
+ * the same shift in every lane. A search binary-searches the skip index
+ * and decodes only the one block that can hold the key, counting the
+ * values below the key with vector compares.
+ *
+ * Time complexity:
+ * ┌──────────────┬────────────────┬───────────────┐
+ * │ Construction │     Search     │ Random access │
+ * ├──────────────┼────────────────┼───────────────┤
+ * │     O(n)     │    O(log n)    │     O(1)      │
+ * └──────────────┴────────────────┴───────────────┘
+ *
+ * Source: https://en.wikipedia.org/wiki/Delta_encoding
+ */
+
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include "simd.h"
+
+namespace compressed_sorted_array
+{
+	struct constants
+	{
+		static const std::size_t block_size = 128;
+		static const std::size_t lanes = 4;
+		static const std::size_t values_per_lane = block_size / lanes;
+	};
+
+	/**
+	 * Returns the number of 64-bit words of one lane for values of @width bits
+	 */
+	inline std::size_t laneWords(unsigned width) noexcept
+	{
+		return (constants::values_per_lane * width + 63) / 64;
+	}
+
+	inline uint64_t widthMask(unsigned width) noexcept
+	{
+		return (width == 64) ? ~uint64_t(0) : (uint64_t(1) << width) - 1;
+	}
+
+	/**
+	 * Returns the value at position @index of a lane, the lane words are
+	 * interleaved with the words of the three other lanes
+	 */
+	inline uint64_t unpack(const uint64_t* laneStart, unsigned width, std::size_t index) noexcept
+	{
+		if (width == 0)
+			return 0;
+
+		const std::size_t bit = index * width;
+		const std::size_t word = bit / 64;
+		const unsigned shift = static_cast<unsigned>(bit % 64);
+
+		uint64_t value = laneStart[word * constants::lanes] >> shift;
+		if (shift + width > 64)
+			value |= laneStart[(word + 1) * constants::lanes] << (64 - shift);
+
+		return value & widthMask(width);
+	}
+
+	/**
+	 * Counts the values of a block whose difference to the base is less
+	 * than @delta. The scalar version serves every instruction set without
+	 * 64-bit variable-width vector operations
+	 */
+	template <SimdLevel LEVEL>
+	struct BlockCounter
+	{
+		static std::size_t countLess(const uint64_t* words, unsigned width, uint64_t delta) noexcept
+		{
+			std::size_t count = 0;
+			for (std::size_t lane = 0; lane < constants::lanes; ++lane)
+				for (std::size_t index = 0; index < constants::values_per_lane; ++index)
+					count += (unpack(words + lane, width, index) < delta) ? 1 : 0;
+
+			return count;
+		}
+	};
+
+#if SIMD_X86
+	template <>
+	struct BlockCounter<SimdLevel::avx2>
+	{
+		SIMD_AVX2 static std::size_t countLess(const uint64_t* words, unsigned width, uint64_t delta) noexcept
+		{
+			if (width == 0)
+				return (delta > 0) ? constants::block_size : 0;
+
+			// Unsigned compare through the signed one by flipping the top bit
+			const __m256i sign = _mm256_set1_epi64x(static_cast<long long>(uint64_t(1) << 63));
+			const __m256i key = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<long long>(delta)), sign);
+			const __m256i mask = _mm256_set1_epi64x(static_cast<long long>(widthMask(width)));
+			std::size_t count = 0;
+
+			for (std::size_t index = 0; index < constants::values_per_lane; ++index)
+			{
+				const std::size_t bit = index * width;
+				const std::size_t word = bit / 64;
+				const unsigned shift = static_cast<unsigned>(bit % 64);
+
+				const __m256i* source = reinterpret_cast<const __m256i*>(words + word * constants::lanes);
+				__m256i values = _mm256_srl_epi64(_mm256_loadu_si256(source), _mm_cvtsi32_si128(static_cast<int>(shift)));
+				if (shift + width > 64)
+				{
+					const __m256i high = _mm256_sll_epi64(_mm256_loadu_si256(source + 1),
+						_mm_cvtsi32_si128(static_cast<int>(64 - shift)));
+					values = _mm256_or_si256(values, high);
+				}
+				values = _mm256_xor_si256(_mm256_and_si256(values, mask), sign);
+
+				const int less = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(key, values)));
+				count += simd::popCount(static_cast<uint64_t>(less));
+			}
+
+			return count;
+		}
+	};
+
+	// The four-lane layout is decoded with AVX2 on AVX-512 machines too
+	template <>
+	struct BlockCounter<SimdLevel::avx512> : BlockCounter<SimdLevel::avx2>
+	{
+	};
+#endif
+
+	template <typename Ops>
+	struct CountLess
+	{
+		static std::size_t run(const uint64_t* words, unsigned width, uint64_t delta) noexcept
+		{
+			return BlockCounter<Ops::level>::countLess(words, width, delta);
+		}
+	};
+}
+
+template <class T>
+class CompressedSortedArray
+{
+private:
+	// Skip index: the first value of every block
+	std::vector<T> m_bases;
+	std::vector<uint64_t> m_offsets;
+	std::vector<uint8_t> m_widths;
+	std::vector<uint64_t> m_words;
+	std::size_t m_size;
+
+	static uint64_t difference(const T& from, const T& to) noexcept;
+public:
+	CompressedSortedArray(const T* sortedArray, std::size_t size);
+	T get(std::size_t index) const noexcept;
+	T operator[](std::size_t index) const noexcept;
+	std::size_t lowerBound(const T& key) const noexcept;
+	bool contains(const T& key) const noexcept;
+	int64_t find(const T& key) const noexcept;
+	std::size_t getSize() const noexcept;
+	std::size_t getSizeInBytes() const noexcept;
+};
+
+/**
+ * Compresses @size values of @sortedArray
+ */
+template <class T>
+CompressedSortedArray<T>::CompressedSortedArray(const T* sortedArray, std::size_t size) : m_size(size)
+{
+	static_assert(std::is_integral<T>::value && sizeof(T) <= 8, "CompressedSortedArray requires integers");
+	using constants = compressed_sorted_array::constants;
+
+	const std::size_t blocks = (size + constants::block_size - 1) / constants::block_size;
+	m_bases.reserve(blocks);
+	m_offsets.reserve(blocks);
+	m_widths.reserve(blocks);
+
+	// The first pass chooses the bit width of every block, so the packed words are allocated once
+	std::size_t totalWords = 0;
+	for (std::size_t first = 0; first < size; first += constants::block_size)
+	{
+		const std::size_t count = std::min(std::size_t(constants::block_size), size - first);
+		const uint64_t largest = difference(sortedArray[first], sortedArray[first + count - 1]);
+
+		unsigned width = 0;
+		while (width < 64 && (largest >> width) != 0)
+			++width;
+
+		m_bases.push_back(sortedArray[first]);
+		m_offsets.push_back(totalWords);
+		m_widths.push_back(static_cast<uint8_t>(width));
+		totalWords += compressed_sorted_array::laneWords(width) * constants::lanes;
+	}
+
+	m_words.assign(totalWords, 0);
+
+	for (std::size_t block = 0; block < blocks; ++block)
+	{
+		const std::size_t first = block * constants::block_size;
+		const std::size_t count = std::min(std::size_t(constants::block_size), size - first);
+		const unsigned width = m_widths[block];
+		uint64_t* words = m_words.data() + m_offsets[block];
+
+		// The last block is padded with its largest value
+		for (std::size_t index = 0; index < constants::block_size && width > 0; ++index)
+		{
+			const uint64_t delta = difference(m_bases[block], sortedArray[first + std::min(index, count - 1)]);
+			const std::size_t lane = index % constants::lanes;
+			const std::size_t bit = (index / constants::lanes) * width;
+			const std::size_t word = bit / 64;
+			const unsigned shift = static_cast<unsigned>(bit % 64);
+
+			words[word * constants::lanes + lane] |= delta << shift;
+			if (shift + width > 64)
+				words[(word + 1) * constants::lanes + lane] |= delta >> (64 - shift);
+		}
+	}
+}
+
+/**
+ * Returns @to - @from for @from not greater than @to
+ */
+template <class T>
+uint64_t CompressedSortedArray<T>::difference(const T& from, const T& to) noexcept
+{
+	// Unsigned subtraction cannot overflow for signed values of opposite sign
+	return static_cast<uint64_t>(to) - static_cast<uint64_t>(from);
+}
+
+/**
+ * Returns the value at @index, decoding a single value
+ */
+template <class T>
+T CompressedSortedArray<T>::get(std::size_t index) const noexcept
+{
+	using constants = compressed_sorted_array::constants;
+
+	const std::size_t block = index / constants::block_size;
+	const std::size_t inBlock = index % constants::block_size;
+	const uint64_t* words = m_words.data() + m_offsets[block];
+
+	const uint64_t delta = compressed_sorted_array::unpack(words + inBlock % constants::lanes,
+		m_widths[block], inBlock / constants::lanes);
+
+	return static_cast<T>(static_cast<uint64_t>(m_bases[block]) + delta);
+}
+
+template <class T>
+T CompressedSortedArray<T>::operator[](std::size_t index) const noexcept
+{
+	return get(index);
+}
+
+/**
+ * Returns the position of the first value not less than @key
+ * (the array size if there is no such value)
+ */
+template <class T>
+std::size_t CompressedSortedArray<T>::lowerBound(const T& key) const noexcept
+{
+	using constants = compressed_sorted_array::constants;
+
+	// The first block starting at or after @key, the answer is in the block before it
+	const std::size_t next = static_cast<std::size_t>(
+		std::lower_bound(m_bases.begin(), m_bases.end(), key) - m_bases.begin());
+	if (next == 0)
+		return 0;
+
+	const std::size_t block = next - 1;
+	const std::size_t first = block * constants::block_size;
+	const std::size_t count = std::min(std::size_t(constants::block_size), m_size - first);
+	const unsigned width = m_widths[block];
+	const uint64_t delta = difference(m_bases[block], key);
+
+	if (width < 64 && (delta >> width) != 0)
+		return first + count;
+
+	const std::size_t less = simd::dispatch<compressed_sorted_array::CountLess, uint64_t>(
+		static_cast<const uint64_t*>(m_words.data() + m_offsets[block]), width, delta);
+
+	return first + std::min(less, count);
+}
+
+/**
+ * Returns @true if the array contains @key
+ */
+template <class T>
+bool CompressedSortedArray<T>::contains(const T& key) const noexcept
+{
+	return find(key) >= 0;
+}
+
+/**
+ * Returns the position of @key or -1
+ */
+template <class T>
+int64_t CompressedSortedArray<T>::find(const T& key) const noexcept
+{
+	const std::size_t position = lowerBound(key);
+
+	if (position < m_size && get(position) == key)
+		return static_cast<int64_t>(position);
+
+	return -1;
+}
+
+/**
+ * Returns the number of values
+ */
+template <class T>
+std::size_t CompressedSortedArray<T>::getSize() const noexcept
+{
+	return m_size;
+}
+
+/**
+ * Returns the memory used by the compressed array
+ */
+template <class T>
+std::size_t CompressedSortedArray<T>::getSizeInBytes() const noexcept
+{
+	return sizeof(*this) + m_bases.capacity() * sizeof(T) + m_offsets.capacity() * sizeof(uint64_t) +
+		m_widths.capacity() * sizeof(uint8_t) + m_words.capacity() * sizeof(uint64_t);
+}
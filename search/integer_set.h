@@ -0,0 +1,477 @@
+﻿/**
+ * @author Dreadblade- (https://github.com/Dreadblade-dev)
+ * Integer set with predecessor and successor queries (64-ary bitmap trie)
+ *
+ * Like a van Emde Boas tree the set splits the bits of a key into chunks
+ * and keeps one level per chunk, but every chunk is 6 bits wide, so a node
+ * has 64 children and knows which of them exist from a single 64-bit
+ * bitmap. The next present child below or above a digit is one masked
+ * tzcnt / lzcnt away, and children are stored densely, indexed by the
+ * popcount of the lower bitmap bits. A 32-bit key takes 6 levels and a
+ * 64-bit key 11, whatever the number of keys.
+ *
+ * Time complexity (w - key width in bits):
+ * ┌──────────────────────┬──────────────────────┬──────────────────────┐
+ * │   Insert / Erase     │       Contains       │ Predecessor / Succ.  │
+ * ├──────────────────────┼──────────────────────┼──────────────────────┤
+ * │       O(w / 6)       │       O(w / 6)       │       O(w / 6)       │
+ * └──────────────────────┴──────────────────────┴──────────────────────┘
+ *
+ * Source: https://en.wikipedia.org/wiki/Van_Emde_Boas_tree
+ */
+
+#pragma once
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include "simd.h"
+
+template <class T>
+class IntegerSet
+{
+private:
+	struct Node
+	{
+		uint64_t bitmap = 0;
+		// One child per set bitmap bit, in the order of the bits
+		std::vector<uint32_t> children;
+	};
+
+	struct constants
+	{
+		static const unsigned key_bits = 8 * sizeof(T);
+		static const unsigned digit_bits = 6;
+		static const unsigned levels = (key_bits + digit_bits - 1) / digit_bits;
+	};
+
+	// m_nodes[0] is the root, released nodes are reused
+	std::vector<Node> m_nodes;
+	std::vector<uint32_t> m_free;
+	std::size_t m_size;
+
+	static uint64_t toKey(const T& value) noexcept;
+	static T fromKey(uint64_t key) noexcept;
+	static unsigned shiftOf(unsigned level) noexcept;
+	static unsigned digitOf(uint64_t key, unsigned level) noexcept;
+	static uint64_t prefixAbove(uint64_t key, unsigned level) noexcept;
+
+	uint32_t childOf(uint32_t node, unsigned digit) const noexcept;
+	uint32_t allocate();
+	uint64_t minimumFrom(uint32_t node, unsigned level, uint64_t prefix) const noexcept;
+	uint64_t maximumFrom(uint32_t node, unsigned level, uint64_t prefix) const noexcept;
+	uint64_t found(uint32_t node, unsigned level, unsigned digit, uint64_t key, bool minimum) const noexcept;
+	bool ceiling(uint64_t key, uint64_t& result) const noexcept;
+	bool floor(uint64_t key, uint64_t& result) const noexcept;
+public:
+	IntegerSet();
+	bool insert(const T& value);
+	bool erase(const T& value);
+	bool contains(const T& value) const noexcept;
+	bool successor(const T& value, T& result) const noexcept;
+	bool predecessor(const T& value, T& result) const noexcept;
+	bool getMin(T& result) const noexcept;
+	bool getMax(T& result) const noexcept;
+	void clear();
+	std::size_t getSize() const noexcept;
+	std::size_t getSizeInBytes() const noexcept;
+};
+
+template <class T>
+IntegerSet<T>::IntegerSet() : m_nodes(1), m_size(0)
+{
+	static_assert(std::is_integral<T>::value && sizeof(T) <= 8, "IntegerSet requires integer keys");
+}
+
+/**
+ * Maps @value to an unsigned key with the same order
+ */
+template <class T>
+uint64_t IntegerSet<T>::toKey(const T& value) noexcept
+{
+	using Unsigned = typename std::make_unsigned<T>::type;
+	const Unsigned sign = std::is_signed<T>::value ? static_cast<Unsigned>(Unsigned(1) << (constants::key_bits - 1)) : 0;
+
+	return static_cast<uint64_t>(static_cast<Unsigned>(static_cast<Unsigned>(value) ^ sign));
+}
+
+template <class T>
+T IntegerSet<T>::fromKey(uint64_t key) noexcept
+{
+	using Unsigned = typename std::make_unsigned<T>::type;
+	const Unsigned sign = std::is_signed<T>::value ? static_cast<Unsigned>(Unsigned(1) << (constants::key_bits - 1)) : 0;
+
+	return static_cast<T>(static_cast<Unsigned>(static_cast<Unsigned>(key) ^ sign));
+}
+
+template <class T>
+unsigned IntegerSet<T>::shiftOf(unsigned level) noexcept
+{
+	return constants::digit_bits * (constants::levels - 1 - level);
+}
+
+template <class T>
+unsigned IntegerSet<T>::digitOf(uint64_t key, unsigned level) noexcept
+{
+	return static_cast<unsigned>((key >> shiftOf(level)) & 63);
+}
+
+/**
+ * Returns the digits of @key above @level
+ */
+template <class T>
+uint64_t IntegerSet<T>::prefixAbove(uint64_t key, unsigned level) noexcept
+{
+	if (level == 0)
+		return 0;
+
+	return key & ~((uint64_t(1) << shiftOf(level - 1)) - 1);
+}
+
+template <class T>
+uint32_t IntegerSet<T>::childOf(uint32_t node, unsigned digit) const noexcept
+{
+	const Node& parent = m_nodes[node];
+	return parent.children[simd::popCount(parent.bitmap & ((uint64_t(1) << digit) - 1))];
+}
+
+template <class T>
+uint32_t IntegerSet<T>::allocate()
+{
+	if (!m_free.empty())
+	{
+		const uint32_t node = m_free.back();
+		m_free.pop_back();
+		return node;
+	}
+
+	m_nodes.emplace_back();
+	return static_cast<uint32_t>(m_nodes.size() - 1);
+}
+
+/**
+ * Returns the smallest key below @node, the digits above @level are in @prefix
+ */
+template <class T>
+uint64_t IntegerSet<T>::minimumFrom(uint32_t node, unsigned level, uint64_t prefix) const noexcept
+{
+	for (;; ++level)
+	{
+		const unsigned digit = simd::countTrailingZeros(m_nodes[node].bitmap);
+		prefix |= static_cast<uint64_t>(digit) << shiftOf(level);
+
+		if (level == constants::levels - 1)
+			return prefix;
+
+		node = m_nodes[node].children.front();
+	}
+}
+
+template <class T>
+uint64_t IntegerSet<T>::maximumFrom(uint32_t node, unsigned level, uint64_t prefix) const noexcept
+{
+	for (;; ++level)
+	{
+		const unsigned digit = 63 - simd::countLeadingZeros(m_nodes[node].bitmap);
+		prefix |= static_cast<uint64_t>(digit) << shiftOf(level);
+
+		if (level == constants::levels - 1)
+			return prefix;
+
+		node = m_nodes[node].children.back();
+	}
+}
+
+/**
+ * Returns the smallest (or largest) key that shares the digits of @key
+ * above @level and has @digit at @level
+ */
+template <class T>
+uint64_t IntegerSet<T>::found(uint32_t node, unsigned level, unsigned digit, uint64_t key, bool minimum) const noexcept
+{
+	const uint64_t prefix = prefixAbove(key, level) | (static_cast<uint64_t>(digit) << shiftOf(level));
+
+	if (level == constants::levels - 1)
+		return prefix;
+
+	const uint32_t child = childOf(node, digit);
+	return minimum ? minimumFrom(child, level + 1, prefix) : maximumFrom(child, level + 1, prefix);
+}
+
+/**
+ * Finds the smallest key not less than @key
+ */
+template <class T>
+bool IntegerSet<T>::ceiling(uint64_t key, uint64_t& result) const noexcept
+{
+	uint32_t path[constants::levels];
+	uint32_t node = 0;
+	unsigned level = 0;
+
+	// Follow @key while its digits are present
+	for (;; ++level)
+	{
+		const unsigned digit = digitOf(key, level);
+		const uint64_t bitmap = m_nodes[node].bitmap;
+
+		if (level == constants::levels - 1 || ((bitmap >> digit) & 1) == 0)
+		{
+			const uint64_t notLess = bitmap & (~uint64_t(0) << digit);
+			if (notLess != 0)
+			{
+				result = found(node, level, simd::countTrailingZeros(notLess), key, true);
+				return true;
+			}
+			break;
+		}
+
+		path[level] = node;
+		node = childOf(node, digit);
+	}
+
+	// Nothing left in that subtree, take the next sibling of an ancestor
+	while (level-- > 0)
+	{
+		const unsigned digit = digitOf(key, level);
+		const uint64_t greater = (digit == 63) ? 0 : m_nodes[path[level]].bitmap & (~uint64_t(0) << (digit + 1));
+
+		if (greater != 0)
+		{
+			result = found(path[level], level, simd::countTrailingZeros(greater), key, true);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * Finds the largest key not greater than @key
+ */
+template <class T>
+bool IntegerSet<T>::floor(uint64_t key, uint64_t& result) const noexcept
+{
+	uint32_t path[constants::levels];
+	uint32_t node = 0;
+	unsigned level = 0;
+
+	for (;; ++level)
+	{
+		const unsigned digit = digitOf(key, level);
+		const uint64_t bitmap = m_nodes[node].bitmap;
+
+		if (level == constants::levels - 1 || ((bitmap >> digit) & 1) == 0)
+		{
+			const uint64_t notGreater = bitmap & ((digit == 63) ? ~uint64_t(0) : (uint64_t(2) << digit) - 1);
+			if (notGreater != 0)
+			{
+				result = found(node, level, 63 - simd::countLeadingZeros(notGreater), key, false);
+				return true;
+			}
+			break;
+		}
+
+		path[level] = node;
+		node = childOf(node, digit);
+	}
+
+	while (level-- > 0)
+	{
+		const unsigned digit = digitOf(key, level);
+		const uint64_t less = m_nodes[path[level]].bitmap & ((uint64_t(1) << digit) - 1);
+
+		if (less != 0)
+		{
+			result = found(path[level], level, 63 - simd::countLeadingZeros(less), key, false);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * Adds @value. Returns @false if it was already in the set
+ */
+template <class T>
+bool IntegerSet<T>::insert(const T& value)
+{
+	const uint64_t key = toKey(value);
+	uint32_t node = 0;
+
+	for (unsigned level = 0; level < constants::levels - 1; ++level)
+	{
+		const unsigned digit = digitOf(key, level);
+
+		if (((m_nodes[node].bitmap >> digit) & 1) == 0)
+		{
+			// allocate() may move the nodes, so nothing is referenced across it
+			const uint32_t child = allocate();
+			Node& parent = m_nodes[node];
+			const std::size_t rank = simd::popCount(parent.bitmap & ((uint64_t(1) << digit) - 1));
+
+			parent.children.insert(parent.children.begin() + static_cast<std::ptrdiff_t>(rank), child);
+			parent.bitmap |= uint64_t(1) << digit;
+			node = child;
+		}
+		else
+			node = childOf(node, digit);
+	}
+
+	const unsigned digit = digitOf(key, constants::levels - 1);
+	if ((m_nodes[node].bitmap >> digit) & 1)
+		return false;
+
+	m_nodes[node].bitmap |= uint64_t(1) << digit;
+	++m_size;
+	return true;
+}
+
+/**
+ * Removes @value. Returns @false if it was not in the set
+ */
+template <class T>
+bool IntegerSet<T>::erase(const T& value)
+{
+	const uint64_t key = toKey(value);
+	uint32_t path[constants::levels];
+	uint32_t node = 0;
+
+	for (unsigned level = 0; level < constants::levels; ++level)
+	{
+		if (((m_nodes[node].bitmap >> digitOf(key, level)) & 1) == 0)
+			return false;
+
+		path[level] = node;
+		if (level < constants::levels - 1)
+			node = childOf(node, digitOf(key, level));
+	}
+
+	m_nodes[node].bitmap &= ~(uint64_t(1) << digitOf(key, constants::levels - 1));
+
+	// Release the nodes that became empty
+	for (unsigned level = constants::levels - 1; level > 0 && m_nodes[path[level]].bitmap == 0; --level)
+	{
+		Node& parent = m_nodes[path[level - 1]];
+		const unsigned digit = digitOf(key, level - 1);
+		const std::size_t rank = simd::popCount(parent.bitmap & ((uint64_t(1) << digit) - 1));
+
+		parent.children.erase(parent.children.begin() + static_cast<std::ptrdiff_t>(rank));
+		parent.bitmap &= ~(uint64_t(1) << digit);
+
+		m_nodes[path[level]].children.clear();
+		m_free.push_back(path[level]);
+	}
+
+	--m_size;
+	return true;
+}
+
+/**
+ * Returns @true if @value is in the set
+ */
+template <class T>
+bool IntegerSet<T>::contains(const T& value) const noexcept
+{
+	const uint64_t key = toKey(value);
+	uint32_t node = 0;
+
+	for (unsigned level = 0; level < constants::levels; ++level)
+	{
+		const unsigned digit = digitOf(key, level);
+		if (((m_nodes[node].bitmap >> digit) & 1) == 0)
+			return false;
+
+		if (level < constants::levels - 1)
+			node = childOf(node, digit);
+	}
+
+	return true;
+}
+
+/**
+ * Finds the smallest value greater than @value.
+ * Returns @false if there is no such value
+ */
+template <class T>
+bool IntegerSet<T>::successor(const T& value, T& result) const noexcept
+{
+	const uint64_t key = toKey(value);
+	const uint64_t largest = (constants::key_bits == 64) ? ~uint64_t(0) : (uint64_t(1) << (constants::key_bits % 64)) - 1;
+	uint64_t next;
+
+	if (key == largest || !ceiling(key + 1, next))
+		return false;
+
+	result = fromKey(next);
+	return true;
+}
+
+/**
+ * Finds the largest value less than @value.
+ * Returns @false if there is no such value
+ */
+template <class T>
+bool IntegerSet<T>::predecessor(const T& value, T& result) const noexcept
+{
+	const uint64_t key = toKey(value);
+	uint64_t previous;
+
+	if (key == 0 || !floor(key - 1, previous))
+		return false;
+
+	result = fromKey(previous);
+	return true;
+}
+
+/**
+ * Finds the smallest value. Returns @false if the set is empty
+ */
+template <class T>
+bool IntegerSet<T>::getMin(T& result) const noexcept
+{
+	if (m_size == 0)
+		return false;
+
+	result = fromKey(minimumFrom(0, 0, 0));
+	return true;
+}
+
+/**
+ * Finds the largest value. Returns @false if the set is empty
+ */
+template <class T>
+bool IntegerSet<T>::getMax(T& result) const noexcept
+{
+	if (m_size == 0)
+		return false;
+
+	result = fromKey(maximumFrom(0, 0, 0));
+	return true;
+}
+
+template <class T>
+void IntegerSet<T>::clear()
+{
+	m_nodes.assign(1, Node());
+	m_free.clear();
+	m_size = 0;
+}
+
+template <class T>
+std::size_t IntegerSet<T>::getSize() const noexcept
+{
+	return m_size;
+}
+
+/**
+ * Returns the memory used by the nodes
+ */
+template <class T>
+std::size_t IntegerSet<T>::getSizeInBytes() const noexcept
+{
+	std::size_t bytes = sizeof(*this) + m_nodes.capacity() * sizeof(Node) + m_free.capacity() * sizeof(uint32_t);
+	for (const Node& node : m_nodes)
+		bytes += node.children.capacity() * sizeof(uint32_t);
+
+	return bytes;
+}
@@ -0,0 +1,311 @@
+﻿/**
+ * @author Dreadblade- (https://github.com/Dreadblade-dev)
+ * Learned index realization (PGM-style)
+ *
+ * A learned index replaces the upper levels of a search tree with a model
+ * that predicts the position of a key in a sorted array. Here the model is
+ * piecewise linear: every segment covers a run of keys and predicts their
+ * positions with an error of at most epsilon, so the final search only has
+ * to look at 2 * epsilon + 2 elements around the prediction.
+ *
+ * Segments are built greedily with the shrinking cone algorithm: a segment
+ * grows while some slope through its first point keeps every covered key
+ * within epsilon. The first keys of the segments are indexed the same way
+ * with a smaller epsilon, recursively, until a single segment remains.
+ *
+ * Time complexity (ε - error bound, L - number of levels):
+ * ┌──────────────┬──────────────────────┐
+ * │ Construction │        Search        │
+ * │──────────────┼──────────────────────│
+ * │     O(n)     │  O(L * log ε)        │
+ * └──────────────┴──────────────────────┘
+ *
+ * Source: https://en.wikipedia.org/wiki/Learned_index
+ */
+
+#pragma once
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+template <class T>
+class LearnedIndex
+{
+private:
+	struct Segment
+	{
+		T key;
+		double slope;
+		std::size_t intercept;
+	};
+
+	const T* m_data;
+	std::size_t m_size;
+	std::size_t m_epsilon;
+	// m_levels[0] indexes the data, every next level indexes the one below
+	std::vector<std::vector<Segment>> m_levels;
+
+	struct constants
+	{
+		static const std::size_t default_epsilon = 64;
+		static const std::size_t internal_epsilon = 4;
+	};
+
+	static double distance(const T& from, const T& to) noexcept;
+	template <class KeyAt>
+	static void buildSegments(KeyAt keyAt, std::size_t size, std::size_t epsilon, std::vector<Segment>& segments);
+	static std::size_t predict(const Segment& segment, const T& key, std::size_t size) noexcept;
+	template <bool UPPER, class KeyAt>
+	static std::size_t boundedSearch(KeyAt keyAt, std::size_t size, const T& key,
+		std::size_t prediction, std::size_t epsilon) noexcept;
+public:
+	LearnedIndex(const T* sortedArray, std::size_t size, std::size_t epsilon = constants::default_epsilon);
+	std::size_t lowerBound(const T& key) const noexcept;
+	int64_t find(const T& key) const noexcept;
+	std::size_t getSize() const noexcept;
+	std::size_t getEpsilon() const noexcept;
+	std::size_t getSegmentCount() const noexcept;
+	std::size_t getLevelCount() const noexcept;
+	std::size_t getSizeInBytes() const noexcept;
+};
+
+/**
+ * Builds the index over @sortedArray, the array is not copied and
+ * has to outlive the index
+ */
+template <class T>
+LearnedIndex<T>::LearnedIndex(const T* sortedArray, std::size_t size, std::size_t epsilon)
+	: m_data(sortedArray), m_size(size), m_epsilon(epsilon)
+{
+	static_assert(std::is_arithmetic<T>::value, "LearnedIndex requires arithmetic keys");
+
+	if (m_size == 0)
+		return;
+
+	m_levels.emplace_back();
+	buildSegments([this](std::size_t index) -> const T& { return m_data[index]; },
+		m_size, m_epsilon, m_levels.back());
+
+	while (m_levels.back().size() > 1)
+	{
+		const std::vector<Segment>& below = m_levels.back();
+		std::vector<Segment> level;
+		buildSegments([&below](std::size_t index) -> const T& { return below[index].key; },
+			below.size(), constants::internal_epsilon, level);
+		m_levels.push_back(std::move(level));
+	}
+}
+
+/**
+ * Returns the distance between two keys, @to must not be less than @from
+ */
+template <class T>
+double LearnedIndex<T>::distance(const T& from, const T& to) noexcept
+{
+	// Unsigned subtraction cannot overflow for signed keys of opposite sign
+	if (std::is_integral<T>::value)
+		return static_cast<double>(static_cast<uint64_t>(to) - static_cast<uint64_t>(from));
+
+	return static_cast<double>(to) - static_cast<double>(from);
+}
+
+/**
+ * Covers the points (keyAt(i), i) with segments whose prediction error
+ * is at most @epsilon. Duplicate keys are represented by their first position
+ */
+template <class T>
+template <class KeyAt>
+void LearnedIndex<T>::buildSegments(KeyAt keyAt, std::size_t size, std::size_t epsilon,
+	std::vector<Segment>& segments)
+{
+	const double error = static_cast<double>(epsilon);
+	const double infinity = std::numeric_limits<double>::infinity();
+
+	Segment current = { keyAt(0), 0.0, 0 };
+	double slopeLow = 0.0;
+	double slopeHigh = infinity;
+
+	for (std::size_t index = 1; index < size; ++index)
+	{
+		const T& key = keyAt(index);
+		if (key == keyAt(index - 1))
+			continue;
+
+		const double dx = distance(current.key, key);
+		const double dy = static_cast<double>(index - current.intercept);
+		const double low = (dy - error) / dx;
+		const double high = (dy + error) / dx;
+
+		if (dx == 0.0 || low > slopeHigh || high < slopeLow)
+		{
+			current.slope = (slopeHigh == infinity) ? 0.0 : (slopeLow + slopeHigh) / 2;
+			segments.push_back(current);
+
+			current = { key, 0.0, index };
+			slopeLow = 0.0;
+			slopeHigh = infinity;
+			continue;
+		}
+
+		if (low > slopeLow)
+			slopeLow = low;
+		if (high < slopeHigh)
+			slopeHigh = high;
+	}
+
+	current.slope = (slopeHigh == infinity) ? 0.0 : (slopeLow + slopeHigh) / 2;
+	segments.push_back(current);
+}
+
+/**
+ * Returns the position of @key predicted by @segment, clamped to the level size
+ */
+template <class T>
+std::size_t LearnedIndex<T>::predict(const Segment& segment, const T& key, std::size_t size) noexcept
+{
+	if (!(segment.key < key))
+		return segment.intercept;
+
+	const double position = static_cast<double>(segment.intercept) + segment.slope * distance(segment.key, key);
+	if (!(position < static_cast<double>(size - 1)))
+		return size - 1;
+
+	return static_cast<std::size_t>(position);
+}
+
+/**
+ * Binary search for the first position whose key is not less than @key
+ * (@UPPER: greater than @key) in the window of @epsilon around @prediction.
+ * If the answer lies outside the window (rounding or many duplicates),
+ * the window is grown exponentially in that direction.
+ */
+template <class T>
+template <bool UPPER, class KeyAt>
+std::size_t LearnedIndex<T>::boundedSearch(KeyAt keyAt, std::size_t size, const T& key,
+	std::size_t prediction, std::size_t epsilon) noexcept
+{
+	auto before = [&](std::size_t index) -> bool
+	{
+		return UPPER ? !(key < keyAt(index)) : (keyAt(index) < key);
+	};
+
+	std::size_t left = (prediction > epsilon) ? prediction - epsilon : 0;
+	std::size_t right = (size - prediction > epsilon + 2) ? prediction + epsilon + 2 : size;
+
+	for (std::size_t step = epsilon + 1; left > 0 && !before(left - 1); step *= 2)
+	{
+		right = left;
+		left = (left > step) ? left - step : 0;
+	}
+
+	for (std::size_t step = epsilon + 1; right < size && before(right); step *= 2)
+	{
+		left = right + 1;
+		right = (size - right > step) ? right + step : size;
+	}
+
+	while (left < right)
+	{
+		const std::size_t middle = left + (right - left) / 2;
+		if (before(middle))
+			left = middle + 1;
+		else
+			right = middle;
+	}
+
+	return left;
+}
+
+/**
+ * Returns the position of the first element not less than @key
+ * (the array size if there is no such element)
+ */
+template <class T>
+std::size_t LearnedIndex<T>::lowerBound(const T& key) const noexcept
+{
+	if (m_size == 0)
+		return 0;
+
+	std::size_t segment = 0;
+
+	for (std::size_t level = m_levels.size() - 1; level > 0; --level)
+	{
+		const std::vector<Segment>& below = m_levels[level - 1];
+		const std::size_t prediction = predict(m_levels[level][segment], key, below.size());
+		const std::size_t next = boundedSearch<true>(
+			[&below](std::size_t index) -> const T& { return below[index].key; },
+			below.size(), key, prediction, constants::internal_epsilon);
+
+		// The last segment starting at or before @key
+		segment = (next > 0) ? next - 1 : 0;
+	}
+
+	const std::size_t prediction = predict(m_levels[0][segment], key, m_size);
+	return boundedSearch<false>([this](std::size_t index) -> const T& { return m_data[index]; },
+		m_size, key, prediction, m_epsilon);
+}
+
+/**
+ * Returns the position of @key in the array or -1
+ */
+template <class T>
+int64_t LearnedIndex<T>::find(const T& key) const noexcept
+{
+	const std::size_t position = lowerBound(key);
+
+	if (position < m_size && m_data[position] == key)
+		return static_cast<int64_t>(position);
+
+	return -1;
+}
+
+/**
+ * Returns the number of indexed elements
+ */
+template <class T>
+std::size_t LearnedIndex<T>::getSize() const noexcept
+{
+	return m_size;
+}
+
+/**
+ * Returns the maximum prediction error on the data level
+ */
+template <class T>
+std::size_t LearnedIndex<T>::getEpsilon() const noexcept
+{
+	return m_epsilon;
+}
+
+/**
+ * Returns the number of segments over the data
+ */
+template <class T>
+std::size_t LearnedIndex<T>::getSegmentCount() const noexcept
+{
+	return m_levels.empty() ? 0 : m_levels[0].size();
+}
+
+/**
+ * Returns the number of model levels
+ */
+template <class T>
+std::size_t LearnedIndex<T>::getLevelCount() const noexcept
+{
+	return m_levels.size();
+}
+
+/**
+ * Returns the memory used by the model, not counting the indexed array
+ */
+template <class T>
+std::size_t LearnedIndex<T>::getSizeInBytes() const noexcept
+{
+	std::size_t bytes = sizeof(*this);
+	for (const auto& level : m_levels)
+		bytes += level.capacity() * sizeof(Segment);
+
+	return bytes;
+}
@@ -0,0 +1,337 @@
+﻿/**
+ * @author Dreadblade- (https://github.com/Dreadblade-dev)
+ *
+ * Linear scan kernels built on the same vector compare operations as
+ * linearSearch. Each of them reads the array exactly once:
+ *  • linearFindAll writes the indices of all matches into a caller buffer,
+ *  • linearCount returns the number of matches,
+ *  • linearFindAny returns the first index holding any key of a set.
+ *
+ * Time complexity (k - number of keys):
+ * ┌───────────────┬────────────────┬────────────────┬───────────────┐
+ * │               │   Worst-case   │  Average-case  │   Best-case   │
+ * ├───────────────┼────────────────┼────────────────┼───────────────┤
+ * │ linearFindAll │      O(n)      │      O(n)      │     O(1)      │
+ * ├───────────────┼────────────────┼────────────────┼───────────────┤
+ * │  linearCount  │      O(n)      │      O(n)      │     O(n)      │
+ * ├───────────────┼────────────────┼────────────────┼───────────────┤
+ * │ linearFindAny │     O(n*k)     │     O(n*k)     │     O(1)      │
+ * └───────────────┴────────────────┴────────────────┴───────────────┘
+ *
+ * Source: https://en.wikipedia.org/wiki/Linear_search
+ */
+
+#pragma once
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <vector>
+#include "linear_search.h"
+
+namespace simd
+{
+	struct scan_constants
+	{
+		// Keys compared against every vector while it is in registers
+		static const std::size_t any_keys_per_pass = 8;
+		// With more keys the array is processed in blocks that stay in L1
+		static const std::size_t any_block_bytes = 16 * 1024;
+	};
+
+	/**
+	 * Counts the elements equal to @key
+	 */
+	template <typename Ops>
+	struct CountMatches
+	{
+		template <typename T>
+		static int64_t run(const T* array, std::size_t size, T key) noexcept
+		{
+			std::size_t count = 0;
+			int64_t matches = 0;
+
+			for (const std::size_t head = alignedHead<Ops>(array, size); count < head; ++count)
+				if (array[count] == key)
+					++matches;
+
+			const Ops ops(key);
+
+			for (; count + 2 * Ops::lanes <= size; count += 2 * Ops::lanes)
+			{
+				const uint64_t mask0 = ops.match(array + count);
+				const uint64_t mask1 = ops.match(array + count + Ops::lanes);
+				matches += (popCount(mask0) + popCount(mask1)) / Ops::laneBits;
+			}
+
+			for (; count + Ops::lanes <= size; count += Ops::lanes)
+				matches += popCount(ops.match(array + count)) / Ops::laneBits;
+
+			for (; count < size; ++count)
+				if (array[count] == key)
+					++matches;
+
+			return matches;
+		}
+	};
+
+	/**
+	 * Writes the indices of the elements equal to @key into @indices,
+	 * stops when @capacity indices have been written
+	 */
+	template <typename Ops>
+	struct AllMatches
+	{
+		template <typename T>
+		static int64_t run(const T* array, std::size_t size, T key,
+			int64_t* indices, std::size_t capacity) noexcept
+		{
+			std::size_t count = 0;
+			std::size_t written = 0;
+
+			if (capacity == 0)
+				return 0;
+
+			for (const std::size_t head = alignedHead<Ops>(array, size); count < head; ++count)
+			{
+				if (array[count] == key)
+				{
+					indices[written++] = static_cast<int64_t>(count);
+					if (written == capacity)
+						return static_cast<int64_t>(written);
+				}
+			}
+
+			const Ops ops(key);
+			const uint64_t laneMask = (uint64_t(1) << Ops::laneBits) - 1;
+
+			for (; count + Ops::lanes <= size; count += Ops::lanes)
+			{
+				uint64_t mask = ops.match(array + count);
+				while (mask != 0)
+				{
+					const unsigned bit = countTrailingZeros(mask);
+					mask &= ~(laneMask << bit);
+
+					indices[written++] = static_cast<int64_t>(count + bit / Ops::laneBits);
+					if (written == capacity)
+						return static_cast<int64_t>(written);
+				}
+			}
+
+			for (; count < size; ++count)
+			{
+				if (array[count] == key)
+				{
+					indices[written++] = static_cast<int64_t>(count);
+					if (written == capacity)
+						break;
+				}
+			}
+
+			return static_cast<int64_t>(written);
+		}
+	};
+
+	/**
+	 * Finds the first index in [@from, @to) holding one of @keyCount
+	 * (at most any_keys_per_pass) keys, or -1
+	 */
+	template <typename Ops, typename T>
+	int64_t firstOfKeys(const T* array, std::size_t from, std::size_t to,
+		const T* keys, std::size_t keyCount) noexcept
+	{
+		std::size_t count = from;
+
+		for (const std::size_t head = from + alignedHead<Ops>(array + from, to - from); count < head; ++count)
+			for (std::size_t key = 0; key < keyCount; ++key)
+				if (array[count] == keys[key])
+					return static_cast<int64_t>(count);
+
+		alignas(64) unsigned char storage[scan_constants::any_keys_per_pass * sizeof(Ops)];
+		Ops* ops = reinterpret_cast<Ops*>(storage);
+		for (std::size_t key = 0; key < keyCount; ++key)
+			new (ops + key) Ops(keys[key]);
+
+		for (; count + Ops::lanes <= to; count += Ops::lanes)
+		{
+			uint64_t mask = 0;
+			for (std::size_t key = 0; key < keyCount; ++key)
+				mask |= ops[key].match(array + count);
+
+			if (mask != 0)
+				return static_cast<int64_t>(count + countTrailingZeros(mask) / Ops::laneBits);
+		}
+
+		for (; count < to; ++count)
+			for (std::size_t key = 0; key < keyCount; ++key)
+				if (array[count] == keys[key])
+					return static_cast<int64_t>(count);
+
+		return -1;
+	}
+
+	/**
+	 * Finds the first element equal to any of @keyCount @keys.
+	 *
+	 * Up to any_keys_per_pass keys are compared against every loaded
+	 * vector. Larger key sets are split into groups that all run over
+	 * the same L1-sized block before moving on, so main memory is still
+	 * read only once; later groups only scan up to the best match so far.
+	 */
+	template <typename Ops>
+	struct AnyMatch
+	{
+		template <typename T>
+		static int64_t run(const T* array, std::size_t size, const T* keys, std::size_t keyCount) noexcept
+		{
+			std::size_t blockSize = size;
+			if (keyCount > scan_constants::any_keys_per_pass)
+				blockSize = scan_constants::any_block_bytes / sizeof(T);
+
+			for (std::size_t blockStart = 0; blockStart < size; blockStart += blockSize)
+			{
+				std::size_t blockEnd = (size - blockStart < blockSize) ? size : blockStart + blockSize;
+				int64_t best = -1;
+
+				for (std::size_t group = 0; group < keyCount; group += scan_constants::any_keys_per_pass)
+				{
+					std::size_t groupSize = keyCount - group;
+					if (groupSize > scan_constants::any_keys_per_pass)
+						groupSize = scan_constants::any_keys_per_pass;
+
+					const int64_t index = firstOfKeys<Ops>(array, blockStart, blockEnd, keys + group, groupSize);
+					if (index >= 0)
+					{
+						best = index;
+						blockEnd = static_cast<std::size_t>(index);
+					}
+				}
+
+				if (best >= 0)
+					return best;
+			}
+
+			return -1;
+		}
+	};
+
+	template <typename T_ARRAY, typename T_SIZE, typename T_KEY>
+	int64_t scanCount(const T_ARRAY* array, const T_SIZE& size, const T_KEY& key, std::false_type)
+	{
+		int64_t matches = 0;
+		for (T_SIZE count = 0; count < size; ++count)
+			if (array[count] == key)
+				++matches;
+
+		return matches;
+	}
+
+	template <typename T_ARRAY, typename T_SIZE, typename T_KEY>
+	int64_t scanCount(const T_ARRAY* array, const T_SIZE& size, const T_KEY& key, std::true_type)
+	{
+		T_ARRAY lane;
+		if (!toLane(key, lane))
+			return scanCount(array, size, key, std::false_type());
+
+		return dispatch<CountMatches, T_ARRAY>(array, static_cast<std::size_t>(size), lane);
+	}
+
+	template <typename T_ARRAY, typename T_SIZE, typename T_KEY>
+	int64_t scanAll(const T_ARRAY* array, const T_SIZE& size, const T_KEY& key,
+		int64_t* indices, std::size_t capacity, std::false_type)
+	{
+		std::size_t written = 0;
+		for (T_SIZE count = 0; count < size && written < capacity; ++count)
+			if (array[count] == key)
+				indices[written++] = static_cast<int64_t>(count);
+
+		return static_cast<int64_t>(written);
+	}
+
+	template <typename T_ARRAY, typename T_SIZE, typename T_KEY>
+	int64_t scanAll(const T_ARRAY* array, const T_SIZE& size, const T_KEY& key,
+		int64_t* indices, std::size_t capacity, std::true_type)
+	{
+		T_ARRAY lane;
+		if (!toLane(key, lane))
+			return scanAll(array, size, key, indices, capacity, std::false_type());
+
+		return dispatch<AllMatches, T_ARRAY>(array, static_cast<std::size_t>(size), lane, indices, capacity);
+	}
+
+	template <typename T_ARRAY, typename T_SIZE, typename T_KEY>
+	int64_t scanAny(const T_ARRAY* array, const T_SIZE& size, const T_KEY* keys, std::size_t keyCount,
+		std::false_type)
+	{
+		for (T_SIZE count = 0; count < size; ++count)
+			for (std::size_t key = 0; key < keyCount; ++key)
+				if (array[count] == keys[key])
+					return static_cast<int64_t>(count);
+
+		return -1;
+	}
+
+	template <typename T_ARRAY, typename T_SIZE, typename T_KEY>
+	int64_t scanAny(const T_ARRAY* array, const T_SIZE& size, const T_KEY* keys, std::size_t keyCount,
+		std::true_type)
+	{
+		// Small key sets are converted on the stack, only large ones allocate
+		T_ARRAY fewLanes[scan_constants::any_keys_per_pass];
+		std::vector<T_ARRAY> manyLanes;
+		T_ARRAY* lanes = fewLanes;
+
+		if (keyCount > scan_constants::any_keys_per_pass)
+		{
+			manyLanes.resize(keyCount);
+			lanes = manyLanes.data();
+		}
+
+		for (std::size_t key = 0; key < keyCount; ++key)
+			if (!toLane(keys[key], lanes[key]))
+				return scanAny(array, size, keys, keyCount, std::false_type());
+
+		return dispatch<AnyMatch, T_ARRAY>(array, static_cast<std::size_t>(size),
+			static_cast<const T_ARRAY*>(lanes), keyCount);
+	}
+}
+
+/**
+ * Returns the number of elements of @array equal to @key
+ */
+template <typename T_ARRAY, typename T_SIZE, typename T_KEY>
+int64_t linearCount(const T_ARRAY* array, const T_SIZE& size, const T_KEY& key)
+{
+	if (!(size > 0))
+		return 0;
+
+	return simd::scanCount(array, size, key, simd::canVectorize<T_ARRAY, T_KEY>());
+}
+
+/**
+ * Writes the indices of the elements equal to @key into @indices in
+ * increasing order and returns how many were written. At most @capacity
+ * indices are written, a full buffer can be continued by searching again
+ * after the last returned index
+ */
+template <typename T_ARRAY, typename T_SIZE, typename T_KEY>
+int64_t linearFindAll(const T_ARRAY* array, const T_SIZE& size, const T_KEY& key,
+	int64_t* indices, std::size_t capacity)
+{
+	if (!(size > 0) || capacity == 0)
+		return 0;
+
+	return simd::scanAll(array, size, key, indices, capacity, simd::canVectorize<T_ARRAY, T_KEY>());
+}
+
+/**
+ * Returns the index of the first element equal to any of the @keyCount
+ * @keys or -1
+ */
+template <typename T_ARRAY, typename T_SIZE, typename T_KEY>
+int64_t linearFindAny(const T_ARRAY* array, const T_SIZE& size, const T_KEY* keys, std::size_t keyCount)
+{
+	if (!(size > 0) || keyCount == 0)
+		return -1;
+
+	return simd::scanAny(array, size, keys, keyCount, simd::canVectorize<T_ARRAY, T_KEY>());
+}
@@ -5,6 +5,11 @@
  * finding an element within a list. It sequentially checks each element
  * of the list until a match is found or the whole list has been searched
  *
+ * For arrays of arithmetic types the search compares a whole vector of
+ * elements per instruction (16 to 64 bytes with SSE2, AVX2 or AVX-512,
+ * chosen at run time) and extracts the first match with movemask + tzcnt.
+ * All other types are compared one element at a time.
+ *
  * Time complexity:
  * ┌────────────────┬────────────────┬───────────────┐
  * │   Worst-case   │  Average-case  │   Best-case   │
@@ -17,13 +22,164 @@
 
 #pragma once
 #include <cstdint>
+#include <type_traits>
+#include "simd.h"
+
+namespace simd
+{
+	/**
+	 * The vector kernels are used when the array holds a vectorizable
+	 * type and the key is arithmetic
+	 */
+	template <typename T_ARRAY, typename T_KEY>
+	struct canVectorize : std::integral_constant<bool,
+		isVectorizable<T_ARRAY>::value && std::is_arithmetic<T_KEY>::value>
+	{
+	};
+
+	/**
+	 * Converts @key to the element type of the array.
+	 * Returns @false when the conversion would change the result of
+	 * array[i] == key, the caller then has to compare element by element
+	 */
+	template <typename T_LANE, typename T_KEY>
+	typename std::enable_if<std::is_integral<T_LANE>::value && std::is_integral<T_KEY>::value, bool>::type
+	toLane(const T_KEY& key, T_LANE& lane) noexcept
+	{
+		// Compared with the usual arithmetic conversions of array[i] == key,
+		// a signed key for an unsigned lane (or the reverse) may still match
+		lane = static_cast<T_LANE>(key);
+		return lane == key;
+	}
+
+	template <typename T_LANE, typename T_KEY>
+	typename std::enable_if<std::is_floating_point<T_LANE>::value && std::is_integral<T_KEY>::value, bool>::type
+	toLane(const T_KEY& key, T_LANE& lane) noexcept
+	{
+		// An integral key is converted to the floating type before comparing anyway
+		lane = static_cast<T_LANE>(key);
+		return true;
+	}
+
+	template <typename T_LANE, typename T_KEY>
+	typename std::enable_if<std::is_floating_point<T_LANE>::value && std::is_floating_point<T_KEY>::value, bool>::type
+	toLane(const T_KEY& key, T_LANE& lane) noexcept
+	{
+		if (sizeof(T_KEY) > sizeof(T_LANE))
+			return false;
+
+		lane = static_cast<T_LANE>(key);
+		return true;
+	}
+
+	template <typename T_LANE, typename T_KEY>
+	typename std::enable_if<std::is_integral<T_LANE>::value && std::is_floating_point<T_KEY>::value, bool>::type
+	toLane(const T_KEY&, T_LANE&) noexcept
+	{
+		return false;
+	}
+
+	/**
+	 * Returns how many elements precede the first vector-aligned address,
+	 * those are checked one by one before the vector loop starts
+	 */
+	template <typename Ops, typename T>
+	std::size_t alignedHead(const T* array, std::size_t size) noexcept
+	{
+		const std::size_t vectorBytes = Ops::lanes * sizeof(T);
+		const std::size_t misalignment = reinterpret_cast<uintptr_t>(array) % vectorBytes;
+
+		if (misalignment == 0 || misalignment % sizeof(T) != 0)
+			return 0;
+
+		const std::size_t head = (vectorBytes - misalignment) / sizeof(T);
+		return (head < size) ? head : size;
+	}
+
+	/**
+	 * Finds the index of the first element equal to @key or -1.
+	 * The body compares four vectors per iteration, the tail that does
+	 * not fill a vector is checked one by one.
+	 */
+	template <typename Ops>
+	struct FirstMatch
+	{
+		template <typename T>
+		static int64_t run(const T* array, std::size_t size, T key) noexcept
+		{
+			std::size_t count = 0;
+
+			for (const std::size_t head = alignedHead<Ops>(array, size); count < head; ++count)
+				if (array[count] == key)
+					return static_cast<int64_t>(count);
+
+			const Ops ops(key);
+
+			for (; count + 4 * Ops::lanes <= size; count += 4 * Ops::lanes)
+			{
+				const uint64_t mask0 = ops.match(array + count);
+				const uint64_t mask1 = ops.match(array + count + Ops::lanes);
+				const uint64_t mask2 = ops.match(array + count + 2 * Ops::lanes);
+				const uint64_t mask3 = ops.match(array + count + 3 * Ops::lanes);
+
+				if ((mask0 | mask1 | mask2 | mask3) == 0)
+					continue;
+
+				if (mask0 != 0)
+					return static_cast<int64_t>(count + countTrailingZeros(mask0) / Ops::laneBits);
+				if (mask1 != 0)
+					return static_cast<int64_t>(count + Ops::lanes + countTrailingZeros(mask1) / Ops::laneBits);
+				if (mask2 != 0)
+					return static_cast<int64_t>(count + 2 * Ops::lanes + countTrailingZeros(mask2) / Ops::laneBits);
+				return static_cast<int64_t>(count + 3 * Ops::lanes + countTrailingZeros(mask3) / Ops::laneBits);
+			}
+
+			for (; count + Ops::lanes <= size; count += Ops::lanes)
+			{
+				const uint64_t mask = ops.match(array + count);
+				if (mask != 0)
+					return static_cast<int64_t>(count + countTrailingZeros(mask) / Ops::laneBits);
+			}
+
+			for (; count < size; ++count)
+				if (array[count] == key)
+					return static_cast<int64_t>(count);
+
+			return -1;
+		}
+	};
+}
 
 template <typename T_ARRAY, typename T_SIZE, typename T_KEY>
-int64_t linearSearch(const T_ARRAY* array, const T_SIZE& size, const T_KEY& key)
+typename std::enable_if<!simd::canVectorize<T_ARRAY, T_KEY>::value, int64_t>::type
+linearSearch(const T_ARRAY* array, const T_SIZE& size, const T_KEY& key)
 {
-	for (int count = 0; count < size; ++count)
+	for (T_SIZE count = 0; count < size; ++count)
 		if (array[count] == key)
-			return count;
+			return static_cast<int64_t>(count);
 
 	return -1;
-}
\ No newline at end of file
+}
+
+/**
+ * Vectorized version for arrays of arithmetic types
+ */
+template <typename T_ARRAY, typename T_SIZE, typename T_KEY>
+typename std::enable_if<simd::canVectorize<T_ARRAY, T_KEY>::value, int64_t>::type
+linearSearch(const T_ARRAY* array, const T_SIZE& size, const T_KEY& key)
+{
+	if (!(size > 0))
+		return -1;
+
+	T_ARRAY lane;
+	if (!simd::toLane(key, lane))
+	{
+		for (T_SIZE count = 0; count < size; ++count)
+			if (array[count] == key)
+				return static_cast<int64_t>(count);
+
+		return -1;
+	}
+
+	return simd::dispatch<simd::FirstMatch, T_ARRAY>(array, static_cast<std::size_t>(size), lane);
+}
@@ -0,0 +1,455 @@
+﻿/**
+ * @author Dreadblade- (https://github.com/Dreadblade-dev)
+ * Binary search over a memory-mapped sorted file
+ *
+ * The file holds fixed-width records sorted by a key stored at a fixed
+ * offset inside every record. The file is memory-mapped, so it can be
+ * larger than RAM and only the pages a lookup touches are read.
+ *
+ * A small in-RAM fence index keeps the key of the first record of every
+ * page-sized block. A lookup binary-searches the fences first and then
+ * only the records of one block, so it touches one page (two when a
+ * record crosses a page boundary) instead of log2(n) pages.
+ *
+ * The mapping is advised as random access (no readahead), prefetch()
+ * asks the kernel to read the whole file in the background.
+ *
+ * Time complexity (B - records per page):
+ * ┌──────────────┬────────────────┬───────────────┐
+ * │ Construction │     Search     │ Pages touched │
+ * │──────────────┼────────────────┼───────────────│
+ * │     O(n)     │    O(log n)    │    1 or 2     │
+ * └──────────────┴────────────────┴───────────────┘
+ *
+ * Source: https://en.wikipedia.org/wiki/Binary_search_algorithm
+ */
+
+#pragma once
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+template <class T_KEY>
+class MappedSortedFile
+{
+public:
+	struct Statistics
+	{
+		uint64_t queries;
+		// Pages spanned by the records the lookups binary-searched
+		uint64_t pagesTouched;
+		// Page faults taken by the lookups, counted only when enabled
+		uint64_t minorFaults;
+		uint64_t majorFaults;
+	};
+
+private:
+	const unsigned char* m_data;
+	std::size_t m_bytes;
+	std::size_t m_recordSize;
+	std::size_t m_keyOffset;
+	std::size_t m_size;
+	std::size_t m_pageSize;
+	std::size_t m_recordsPerBlock;
+	std::vector<T_KEY> m_fences;
+	bool m_countFaults;
+	Statistics m_statistics;
+#if defined(_WIN32)
+	HANDLE m_file = INVALID_HANDLE_VALUE;
+	HANDLE m_mapping = nullptr;
+#else
+	int m_file = -1;
+#endif
+
+	void map(const std::string& path);
+	void unmap() noexcept;
+	void advise(bool sequential) noexcept;
+	T_KEY keyAt(std::size_t index) const noexcept;
+	std::size_t pagesOf(std::size_t first, std::size_t last) const noexcept;
+	static void readFaults(uint64_t& minor, uint64_t& major) noexcept;
+public:
+	MappedSortedFile(const std::string& path, std::size_t recordSize = sizeof(T_KEY), std::size_t keyOffset = 0);
+	MappedSortedFile(const MappedSortedFile<T_KEY>&) = delete;
+	MappedSortedFile<T_KEY>& operator=(const MappedSortedFile<T_KEY>&) = delete;
+	~MappedSortedFile();
+	std::size_t lowerBound(const T_KEY& key) noexcept;
+	int64_t find(const T_KEY& key) noexcept;
+	const unsigned char* getRecord(std::size_t index) const noexcept;
+	void prefetch() noexcept;
+	void setFaultCounting(bool enabled) noexcept;
+	const Statistics& getStatistics() const noexcept;
+	void resetStatistics() noexcept;
+	std::size_t getSize() const noexcept;
+	std::size_t getFenceCount() const noexcept;
+};
+
+/**
+ * Maps the file at @path and builds the fence index. Every record has
+ * @recordSize bytes and stores its key at @keyOffset.
+ * Throws std::system_error if the file cannot be mapped and
+ * std::invalid_argument if the file is not made of whole records
+ */
+template <class T_KEY>
+MappedSortedFile<T_KEY>::MappedSortedFile(const std::string& path, std::size_t recordSize, std::size_t keyOffset)
+	: m_data(nullptr), m_bytes(0), m_recordSize(recordSize), m_keyOffset(keyOffset), m_size(0),
+	m_pageSize(4096), m_recordsPerBlock(1), m_countFaults(false), m_statistics()
+{
+	static_assert(std::is_arithmetic<T_KEY>::value, "MappedSortedFile requires arithmetic keys");
+
+	if (m_recordSize == 0 || m_keyOffset + sizeof(T_KEY) > m_recordSize)
+		throw std::invalid_argument("Key does not fit into the record");
+
+	map(path);
+
+	if (m_bytes % m_recordSize != 0)
+	{
+		unmap();
+		throw std::invalid_argument("File size is not a multiple of the record size");
+	}
+
+	m_size = m_bytes / m_recordSize;
+	m_recordsPerBlock = std::max<std::size_t>(1, m_pageSize / m_recordSize);
+
+	// One sequential pass reads the first key of every block
+	advise(true);
+	try
+	{
+		m_fences.reserve((m_size + m_recordsPerBlock - 1) / m_recordsPerBlock);
+		for (std::size_t index = 0; index < m_size; index += m_recordsPerBlock)
+			m_fences.push_back(keyAt(index));
+	}
+	catch (...)
+	{
+		// The destructor does not run for a throwing constructor
+		unmap();
+		throw;
+	}
+	advise(false);
+}
+
+#if defined(_WIN32)
+template <class T_KEY>
+void MappedSortedFile<T_KEY>::map(const std::string& path)
+{
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	m_pageSize = info.dwPageSize;
+
+	m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_FLAG_RANDOM_ACCESS, nullptr);
+	if (m_file == INVALID_HANDLE_VALUE)
+		throw std::system_error(static_cast<int>(GetLastError()), std::system_category(), "Cannot open " + path);
+
+	LARGE_INTEGER size;
+	GetFileSizeEx(m_file, &size);
+	m_bytes = static_cast<std::size_t>(size.QuadPart);
+
+	if (m_bytes == 0)
+		return;
+
+	m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_mapping != nullptr)
+		m_data = static_cast<const unsigned char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+
+	if (m_data == nullptr)
+	{
+		const int error = static_cast<int>(GetLastError());
+		unmap();
+		throw std::system_error(error, std::system_category(), "Cannot map " + path);
+	}
+}
+
+template <class T_KEY>
+void MappedSortedFile<T_KEY>::unmap() noexcept
+{
+	if (m_data != nullptr)
+		UnmapViewOfFile(m_data);
+	if (m_mapping != nullptr)
+		CloseHandle(m_mapping);
+	if (m_file != INVALID_HANDLE_VALUE)
+		CloseHandle(m_file);
+
+	m_data = nullptr;
+	m_mapping = nullptr;
+	m_file = INVALID_HANDLE_VALUE;
+}
+
+/**
+ * Windows has no per-mapping access hints, the random access flag is
+ * given when the file is opened
+ */
+template <class T_KEY>
+void MappedSortedFile<T_KEY>::advise(bool) noexcept
+{
+}
+
+template <class T_KEY>
+void MappedSortedFile<T_KEY>::prefetch() noexcept
+{
+	if (m_data == nullptr)
+		return;
+
+	WIN32_MEMORY_RANGE_ENTRY range;
+	range.VirtualAddress = const_cast<unsigned char*>(m_data);
+	range.NumberOfBytes = m_bytes;
+	PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+}
+
+/**
+ * Per-thread fault counters are not available on Windows
+ */
+template <class T_KEY>
+void MappedSortedFile<T_KEY>::readFaults(uint64_t& minor, uint64_t& major) noexcept
+{
+	minor = 0;
+	major = 0;
+}
+#else
+template <class T_KEY>
+void MappedSortedFile<T_KEY>::map(const std::string& path)
+{
+	m_pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+
+	m_file = open(path.c_str(), O_RDONLY);
+	if (m_file < 0)
+		throw std::system_error(errno, std::generic_category(), "Cannot open " + path);
+
+	struct stat status;
+	if (fstat(m_file, &status) != 0)
+	{
+		const int error = errno;
+		unmap();
+		throw std::system_error(error, std::generic_category(), "Cannot stat " + path);
+	}
+
+	m_bytes = static_cast<std::size_t>(status.st_size);
+	if (m_bytes == 0)
+		return;
+
+	void* data = mmap(nullptr, m_bytes, PROT_READ, MAP_SHARED, m_file, 0);
+	if (data == MAP_FAILED)
+	{
+		const int error = errno;
+		unmap();
+		throw std::system_error(error, std::generic_category(), "Cannot map " + path);
+	}
+
+	m_data = static_cast<const unsigned char*>(data);
+}
+
+template <class T_KEY>
+void MappedSortedFile<T_KEY>::unmap() noexcept
+{
+	if (m_data != nullptr)
+		munmap(const_cast<unsigned char*>(m_data), m_bytes);
+	if (m_file >= 0)
+		close(m_file);
+
+	m_data = nullptr;
+	m_file = -1;
+}
+
+/**
+ * Sequential access while the fences are built, random access (no
+ * readahead around a faulting page) for the lookups
+ */
+template <class T_KEY>
+void MappedSortedFile<T_KEY>::advise(bool sequential) noexcept
+{
+	if (m_data != nullptr)
+		madvise(const_cast<unsigned char*>(m_data), m_bytes, sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+}
+
+/**
+ * Asks the kernel to read the whole file into the page cache in the background
+ */
+template <class T_KEY>
+void MappedSortedFile<T_KEY>::prefetch() noexcept
+{
+	if (m_data != nullptr)
+		madvise(const_cast<unsigned char*>(m_data), m_bytes, MADV_WILLNEED);
+}
+
+template <class T_KEY>
+void MappedSortedFile<T_KEY>::readFaults(uint64_t& minor, uint64_t& major) noexcept
+{
+	struct rusage usage;
+#if defined(RUSAGE_THREAD)
+	getrusage(RUSAGE_THREAD, &usage);
+#else
+	getrusage(RUSAGE_SELF, &usage);
+#endif
+	minor = static_cast<uint64_t>(usage.ru_minflt);
+	major = static_cast<uint64_t>(usage.ru_majflt);
+}
+#endif
+
+/**
+ * Destructor
+ */
+template <class T_KEY>
+MappedSortedFile<T_KEY>::~MappedSortedFile()
+{
+	unmap();
+}
+
+/**
+ * Reads the key of the record at @index
+ */
+template <class T_KEY>
+T_KEY MappedSortedFile<T_KEY>::keyAt(std::size_t index) const noexcept
+{
+	T_KEY key;
+	std::memcpy(&key, m_data + index * m_recordSize + m_keyOffset, sizeof(T_KEY));
+	return key;
+}
+
+/**
+ * Returns the number of pages holding the records [@first, @last]
+ */
+template <class T_KEY>
+std::size_t MappedSortedFile<T_KEY>::pagesOf(std::size_t first, std::size_t last) const noexcept
+{
+	const std::size_t firstPage = (first * m_recordSize + m_keyOffset) / m_pageSize;
+	const std::size_t lastPage = (last * m_recordSize + m_keyOffset + sizeof(T_KEY) - 1) / m_pageSize;
+	return lastPage - firstPage + 1;
+}
+
+/**
+ * Returns the index of the first record whose key is not less than @key
+ * (the number of records if there is no such record)
+ */
+template <class T_KEY>
+std::size_t MappedSortedFile<T_KEY>::lowerBound(const T_KEY& key) noexcept
+{
+	uint64_t minorBefore = 0;
+	uint64_t majorBefore = 0;
+	if (m_countFaults)
+		readFaults(minorBefore, majorBefore);
+
+	++m_statistics.queries;
+
+	// The first block starting at or after @key, the answer is in the block before it
+	const std::size_t block = static_cast<std::size_t>(
+		std::lower_bound(m_fences.begin(), m_fences.end(), key) - m_fences.begin());
+
+	std::size_t result = 0;
+	if (block > 0)
+	{
+		std::size_t left = (block - 1) * m_recordsPerBlock;
+		std::size_t right = std::min(block * m_recordsPerBlock, m_size);
+		const std::size_t first = left;
+		const std::size_t last = right - 1;
+
+		while (left < right)
+		{
+			const std::size_t middle = left + (right - left) / 2;
+			if (keyAt(middle) < key)
+				left = middle + 1;
+			else
+				right = middle;
+		}
+
+		result = left;
+		m_statistics.pagesTouched += pagesOf(first, last);
+	}
+
+	if (m_countFaults)
+	{
+		uint64_t minorAfter = 0;
+		uint64_t majorAfter = 0;
+		readFaults(minorAfter, majorAfter);
+		m_statistics.minorFaults += minorAfter - minorBefore;
+		m_statistics.majorFaults += majorAfter - majorBefore;
+	}
+
+	return result;
+}
+
+/**
+ * Returns the index of a record with @key or -1
+ */
+template <class T_KEY>
+int64_t MappedSortedFile<T_KEY>::find(const T_KEY& key) noexcept
+{
+	const std::size_t index = lowerBound(key);
+
+	if (index < m_size && keyAt(index) == key)
+		return static_cast<int64_t>(index);
+
+	return -1;
+}
+
+/**
+ * Returns a pointer to the record at @index, valid while the file is mapped
+ */
+template <class T_KEY>
+const unsigned char* MappedSortedFile<T_KEY>::getRecord(std::size_t index) const noexcept
+{
+	return m_data + index * m_recordSize;
+}
+
+/**
+ * Enables counting of the page faults taken by every lookup.
+ * Costs two getrusage calls per lookup
+ */
+template <class T_KEY>
+void MappedSortedFile<T_KEY>::setFaultCounting(bool enabled) noexcept
+{
+	m_countFaults = enabled;
+}
+
+/**
+ * Returns lookup statistics, divide by @queries for per-query values
+ */
+template <class T_KEY>
+const typename MappedSortedFile<T_KEY>::Statistics& MappedSortedFile<T_KEY>::getStatistics() const noexcept
+{
+	return m_statistics;
+}
+
+/**
+ * Resets lookup statistics
+ */
+template <class T_KEY>
+void MappedSortedFile<T_KEY>::resetStatistics() noexcept
+{
+	m_statistics = Statistics();
+}
+
+/**
+ * Returns the number of records
+ */
+template <class T_KEY>
+std::size_t MappedSortedFile<T_KEY>::getSize() const noexcept
+{
+	return m_size;
+}
+
+/**
+ * Returns the number of keys in the in-RAM fence index
+ */
+template <class T_KEY>
+std::size_t MappedSortedFile<T_KEY>::getFenceCount() const noexcept
+{
+	return m_fences.size();
+}
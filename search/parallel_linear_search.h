@@ -0,0 +1,118 @@
+﻿/**
+ * @author Dreadblade- (https://github.com/Dreadblade-dev)
+ *
+ * Parallel linear search splits the array into fixed-size chunks that
+ * worker threads claim in increasing order. Every chunk is scanned with
+ * linearSearch, so arithmetic arrays use the vectorized kernels.
+ *
+ * The first worker that finds the key publishes its index in a shared
+ * atomic minimum. Chunks that start after that index are skipped, while
+ * chunks that start before it are still scanned, so the result is the
+ * lowest matching index, exactly as with linearSearch.
+ *
+ * Time complexity (p - number of threads):
+ * ┌────────────────┬────────────────┬───────────────┐
+ * │   Worst-case   │  Average-case  │   Best-case   │
+ * ├────────────────┼────────────────┼───────────────┤
+ * │     O(n/p)     │     O(n/p)     │     O(1)      │
+ * └────────────────┴────────────────┴───────────────┘
+ *
+ * Source: https://en.wikipedia.org/wiki/Linear_search
+ */
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include "linear_search.h"
+
+namespace parallel_search
+{
+	struct constants
+	{
+		// Small enough to stop soon after a match, large enough to amortize the atomics
+		static const std::size_t chunk_bytes = 256 * 1024;
+	};
+}
+
+/**
+ * Searches @key in @array using @threadCount threads (0 - one per hardware thread)
+ */
+template <typename T_ARRAY, typename T_SIZE, typename T_KEY>
+int64_t parallelLinearSearch(const T_ARRAY* array, const T_SIZE& size, const T_KEY& key,
+	std::size_t threadCount = 0)
+{
+	if (!(size > 0))
+		return -1;
+
+	const std::size_t total = static_cast<std::size_t>(size);
+	std::size_t chunkSize = parallel_search::constants::chunk_bytes / sizeof(T_ARRAY);
+	if (chunkSize == 0)
+		chunkSize = 1;
+	const std::size_t chunkCount = (total + chunkSize - 1) / chunkSize;
+
+	if (threadCount == 0)
+		threadCount = std::thread::hardware_concurrency();
+	if (threadCount > chunkCount)
+		threadCount = chunkCount;
+	if (threadCount <= 1)
+		return linearSearch(array, total, key);
+
+	const int64_t noMatch = std::numeric_limits<int64_t>::max();
+	std::atomic<std::size_t> nextChunk(0);
+	std::atomic<int64_t> found(noMatch);
+
+	auto worker = [&]()
+	{
+		for (;;)
+		{
+			const std::size_t chunk = nextChunk.fetch_add(1, std::memory_order_relaxed);
+			if (chunk >= chunkCount)
+				return;
+
+			// Chunks are claimed in order, so every later chunk starts after the match too
+			const std::size_t start = chunk * chunkSize;
+			if (static_cast<int64_t>(start) >= found.load(std::memory_order_relaxed))
+				return;
+
+			const std::size_t length = (total - start < chunkSize) ? total - start : chunkSize;
+			const int64_t index = linearSearch(array + start, length, key);
+
+			if (index >= 0)
+			{
+				const int64_t candidate = static_cast<int64_t>(start) + index;
+				int64_t current = found.load(std::memory_order_relaxed);
+				while (candidate < current &&
+					!found.compare_exchange_weak(current, candidate, std::memory_order_relaxed))
+				{
+				}
+				return;
+			}
+		}
+	};
+
+	std::vector<std::thread> workers;
+	workers.reserve(threadCount - 1);
+	for (std::size_t count = 1; count < threadCount; ++count)
+	{
+		// Chunks are claimed dynamically, so fewer threads still cover the whole array
+		try
+		{
+			workers.emplace_back(worker);
+		}
+		catch (const std::system_error&)
+		{
+			break;
+		}
+	}
+
+	worker();
+	for (auto& thread : workers)
+		thread.join();
+
+	const int64_t result = found.load(std::memory_order_relaxed);
+	return (result == noMatch) ? -1 : result;
+}
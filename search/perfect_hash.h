@@ -0,0 +1,318 @@
+﻿/**
+ * @author Dreadblade- (https://github.com/Dreadblade-dev)
+ * Static perfect hash index (PTHash-style minimal perfect hash)
+ *
+ * For a fixed array of distinct keys the index maps every key to its
+ * position with a single hash evaluation instead of a scan. The keys are
+ * hashed into buckets of four keys on average. Buckets are placed largest
+ * first: each one gets the smallest "pilot" value for which its keys,
+ * hashed together with the pilot, land on free slots of a table that is
+ * 2% larger than the key count. Slots past the key count are remapped to
+ * the free slots below it, which makes the hash minimal.
+ *
+ * A lookup reads one pilot, computes the slot, reads the stored position
+ * and compares that single element of the array with the key, so keys
+ * that are not in the array are rejected too. The pilots take 4 bits
+ * per key, the positions log2(n) bits per key.
+ *
+ * Time complexity:
+ * ┌──────────────────────┬──────────────────────┐
+ * │ Construction (exp.)  │        Search        │
+ * ├──────────────────────┼──────────────────────┤
+ * │         O(n)         │         O(1)         │
+ * └──────────────────────┴──────────────────────┘
+ *
+ * Source: https://en.wikipedia.org/wiki/Perfect_hash_function
+ */
+
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+namespace perfect_hash
+{
+	struct constants
+	{
+		static const std::size_t keys_per_bucket = 4;
+		// Table slots per 100 keys
+		static const std::size_t load_percent = 98;
+		static const uint32_t max_pilot = 0xffff;
+		static const unsigned max_attempts = 64;
+	};
+
+	inline uint64_t mix(uint64_t hash) noexcept
+	{
+		hash ^= hash >> 30;
+		hash *= 0xbf58476d1ce4e5b9ULL;
+		hash ^= hash >> 27;
+		hash *= 0x94d049bb133111ebULL;
+		return hash ^ (hash >> 31);
+	}
+
+	/**
+	 * Returns the bucket of @hash. Like in PTHash 60% of the keys go to 30%
+	 * of the buckets, those dense buckets are placed while the table is
+	 * still mostly empty
+	 */
+	inline uint64_t bucketOf(uint64_t hash, uint64_t bucketCount) noexcept
+	{
+		const uint64_t dense = bucketCount * 3 / 10;
+		const uint64_t high = hash >> 32;
+
+		if ((hash & 0xffffffffULL) < 0x99999999ULL)
+			return (high * dense) >> 32;
+		return dense + ((high * (bucketCount - dense)) >> 32);
+	}
+}
+
+template <class T, class Hash = std::hash<T>>
+class PerfectHashIndex
+{
+private:
+	const T* m_keys;
+	std::size_t m_size;
+	std::size_t m_tableSize;
+	uint64_t m_seed;
+	std::vector<uint16_t> m_pilots;
+	// Free slots below m_size for the slots past it
+	std::vector<uint32_t> m_remap;
+	// Array position of the key in every slot, bit-packed
+	std::vector<uint64_t> m_positions;
+	unsigned m_positionBits;
+	Hash m_hash;
+
+	uint64_t hashOf(const T& key) const;
+	std::size_t slotOf(uint64_t hash, uint16_t pilot) const noexcept;
+	std::size_t positionAt(std::size_t slot) const noexcept;
+	bool build(std::vector<uint32_t>& slotKeys);
+public:
+	PerfectHashIndex(const T* keys, std::size_t size);
+	int64_t find(const T& key) const;
+	bool contains(const T& key) const;
+	std::size_t getSize() const noexcept;
+	std::size_t getSizeInBytes() const noexcept;
+};
+
+/**
+ * Builds the index over @size distinct @keys, the array is not copied
+ * and has to outlive the index. Throws std::invalid_argument on duplicate keys
+ * and on distinct keys with equal std::hash values, no seed can separate them
+ */
+template <class T, class Hash>
+PerfectHashIndex<T, Hash>::PerfectHashIndex(const T* keys, std::size_t size)
+	: m_keys(keys), m_size(size), m_tableSize(0), m_seed(0), m_positionBits(1)
+{
+	if (size == 0)
+		return;
+	m_tableSize = std::max<std::size_t>(size * 100 / perfect_hash::constants::load_percent, size);
+	if (static_cast<uint64_t>(m_tableSize) >= (uint64_t(1) << 32))
+		throw std::invalid_argument("PerfectHashIndex supports less than 2^32 keys");
+	while (m_positionBits < 64 && (static_cast<uint64_t>(size - 1) >> m_positionBits) != 0)
+		++m_positionBits;
+
+	std::vector<uint32_t> slotKeys;
+	for (unsigned attempt = 0; !build(slotKeys); ++attempt)
+	{
+		if (attempt + 1 == perfect_hash::constants::max_attempts)
+			throw std::runtime_error("PerfectHashIndex construction failed");
+		m_seed = perfect_hash::mix(m_seed + attempt + 1);
+	}
+
+	// Move the keys placed past the end into the holes below it
+	std::size_t hole = 0;
+	m_remap.assign(m_tableSize - m_size, 0);
+	for (std::size_t slot = m_size; slot < m_tableSize; ++slot)
+	{
+		if (slotKeys[slot] == UINT32_MAX)
+			continue;
+
+		while (slotKeys[hole] != UINT32_MAX)
+			++hole;
+		slotKeys[hole] = slotKeys[slot];
+		m_remap[slot - m_size] = static_cast<uint32_t>(hole);
+	}
+
+	m_positions.assign((m_size * m_positionBits + 63) / 64, 0);
+	for (std::size_t slot = 0; slot < m_size; ++slot)
+	{
+		const uint64_t position = slotKeys[slot];
+		const std::size_t bit = slot * m_positionBits;
+		const unsigned shift = static_cast<unsigned>(bit % 64);
+
+		m_positions[bit / 64] |= position << shift;
+		if (shift + m_positionBits > 64)
+			m_positions[bit / 64 + 1] |= position >> (64 - shift);
+	}
+}
+
+template <class T, class Hash>
+uint64_t PerfectHashIndex<T, Hash>::hashOf(const T& key) const
+{
+	// mix is a bijection, so distinct std::hash values stay distinct for every seed
+	return perfect_hash::mix(static_cast<uint64_t>(m_hash(key)) ^ m_seed);
+}
+
+template <class T, class Hash>
+std::size_t PerfectHashIndex<T, Hash>::slotOf(uint64_t hash, uint16_t pilot) const noexcept
+{
+	// Multiply-shift instead of a 64-bit division, the table has less than 2^32 slots
+	const uint64_t mixed = perfect_hash::mix(hash ^ perfect_hash::mix(pilot + m_seed));
+	return static_cast<std::size_t>(((mixed >> 32) * m_tableSize) >> 32);
+}
+
+template <class T, class Hash>
+std::size_t PerfectHashIndex<T, Hash>::positionAt(std::size_t slot) const noexcept
+{
+	const std::size_t bit = slot * m_positionBits;
+	const unsigned shift = static_cast<unsigned>(bit % 64);
+
+	uint64_t position = m_positions[bit / 64] >> shift;
+	if (shift + m_positionBits > 64)
+		position |= m_positions[bit / 64 + 1] << (64 - shift);
+
+	return static_cast<std::size_t>(position & ((m_positionBits == 64) ? ~uint64_t(0) : (uint64_t(1) << m_positionBits) - 1));
+}
+
+/**
+ * Searches the pilots with the current seed and fills @slotKeys with the
+ * key position of every table slot. Returns @false if some bucket could
+ * not be placed, the caller then retries with another seed
+ */
+template <class T, class Hash>
+bool PerfectHashIndex<T, Hash>::build(std::vector<uint32_t>& slotKeys)
+{
+	const std::size_t bucketCount = (m_size + perfect_hash::constants::keys_per_bucket - 1) /
+		perfect_hash::constants::keys_per_bucket;
+
+	std::vector<uint64_t> hashes(m_size);
+	std::vector<uint32_t> bucketStart(bucketCount + 1, 0);
+	for (std::size_t index = 0; index < m_size; ++index)
+	{
+		hashes[index] = hashOf(m_keys[index]);
+		++bucketStart[perfect_hash::bucketOf(hashes[index], bucketCount) + 1];
+	}
+	for (std::size_t bucket = 0; bucket < bucketCount; ++bucket)
+		bucketStart[bucket + 1] += bucketStart[bucket];
+
+	// Keys grouped by bucket
+	std::vector<uint32_t> members(m_size);
+	{
+		std::vector<uint32_t> fill(bucketStart.begin(), bucketStart.end() - 1);
+		for (std::size_t index = 0; index < m_size; ++index)
+			members[fill[perfect_hash::bucketOf(hashes[index], bucketCount)]++] = static_cast<uint32_t>(index);
+	}
+
+	std::vector<uint32_t> order(bucketCount);
+	for (std::size_t bucket = 0; bucket < bucketCount; ++bucket)
+		order[bucket] = static_cast<uint32_t>(bucket);
+	std::stable_sort(order.begin(), order.end(), [&bucketStart](uint32_t a, uint32_t b)
+	{
+		return bucketStart[a + 1] - bucketStart[a] > bucketStart[b + 1] - bucketStart[b];
+	});
+
+	m_pilots.assign(bucketCount, 0);
+	slotKeys.assign(m_tableSize, UINT32_MAX);
+	// Occupied slots, small enough to stay in cache while the pilots are tried
+	std::vector<uint64_t> taken((m_tableSize + 63) / 64, 0);
+	std::vector<uint64_t> bucketHashes;
+	std::vector<std::size_t> slots;
+
+	for (uint32_t bucket : order)
+	{
+		const uint32_t first = bucketStart[bucket];
+		const uint32_t last = bucketStart[bucket + 1];
+		if (first == last)
+			break;
+
+		bucketHashes.clear();
+		for (uint32_t i = first; i < last; ++i)
+		{
+			for (uint32_t j = first; j < i; ++j)
+				if (hashes[members[i]] == hashes[members[j]])
+				{
+					// The seed is mixed in after @Hash, equal hashes collide for every seed
+					if (m_keys[members[i]] == m_keys[members[j]])
+						throw std::invalid_argument("PerfectHashIndex requires distinct keys");
+					throw std::invalid_argument("PerfectHashIndex requires distinct hash values, two keys collide");
+				}
+			bucketHashes.push_back(hashes[members[i]]);
+		}
+
+		uint32_t pilot = 0;
+		for (;; ++pilot)
+		{
+			if (pilot > perfect_hash::constants::max_pilot)
+				return false;
+
+			slots.clear();
+			bool free = true;
+			for (std::size_t i = 0; i < bucketHashes.size() && free; ++i)
+			{
+				const std::size_t slot = slotOf(bucketHashes[i], static_cast<uint16_t>(pilot));
+				free = ((taken[slot / 64] >> (slot % 64)) & 1) == 0 &&
+					std::find(slots.begin(), slots.end(), slot) == slots.end();
+				slots.push_back(slot);
+			}
+
+			if (free)
+				break;
+		}
+
+		m_pilots[bucket] = static_cast<uint16_t>(pilot);
+		for (uint32_t i = first; i < last; ++i)
+		{
+			const std::size_t slot = slots[i - first];
+			slotKeys[slot] = members[i];
+			taken[slot / 64] |= uint64_t(1) << (slot % 64);
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Returns the position of @key in the array or -1
+ */
+template <class T, class Hash>
+int64_t PerfectHashIndex<T, Hash>::find(const T& key) const
+{
+	if (m_size == 0)
+		return -1;
+
+	const uint64_t hash = hashOf(key);
+	const std::size_t bucketCount = m_pilots.size();
+	std::size_t slot = slotOf(hash, m_pilots[perfect_hash::bucketOf(hash, bucketCount)]);
+	if (slot >= m_size)
+		slot = m_remap[slot - m_size];
+
+	const std::size_t position = positionAt(slot);
+	return (m_keys[position] == key) ? static_cast<int64_t>(position) : -1;
+}
+
+/**
+ * Returns @true if @key is in the array
+ */
+template <class T, class Hash>
+bool PerfectHashIndex<T, Hash>::contains(const T& key) const
+{
+	return find(key) >= 0;
+}
+
+template <class T, class Hash>
+std::size_t PerfectHashIndex<T, Hash>::getSize() const noexcept
+{
+	return m_size;
+}
+
+/**
+ * Returns the memory used by the pilots, the remap table and the positions
+ */
+template <class T, class Hash>
+std::size_t PerfectHashIndex<T, Hash>::getSizeInBytes() const noexcept
+{
+	return sizeof(*this) + m_pilots.capacity() * sizeof(uint16_t) + m_remap.capacity() * sizeof(uint32_t) +
+		m_positions.capacity() * sizeof(uint64_t);
+}
@@ -0,0 +1,582 @@
+﻿/**
+ * @author Dreadblade- (https://github.com/Dreadblade-dev)
+ * SIMD helpers shared by the search kernels
+ *
+ * Provides runtime detection of the instruction set available on the
+ * current CPU (SSE2, AVX2 or AVX-512), bit-scan helpers and per-ISA
+ * compare operations that turn one vector of elements into a bitmask
+ * of matching lanes.
+ *
+ * Every kernel is compiled for all instruction sets and the widest one
+ * supported by the CPU is picked at run time, so the library does not
+ * need any special compiler flags. On non-x86 targets everything falls
+ * back to scalar code.
+ *
+ * Source: https://en.wikipedia.org/wiki/Single_instruction,_multiple_data
+ */
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#else
+#define SIMD_X86 0
+#endif
+
+/**
+ * GCC and Clang only allow AVX2/AVX-512 intrinsics in functions compiled
+ * for that target. Kernel entry points are additionally flattened so the
+ * per-ISA compare operations get inlined into the scanning loop.
+ * MSVC accepts the intrinsics everywhere, so the macros are empty there.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define SIMD_AVX2 __attribute__((target("avx2")))
+#define SIMD_AVX512 __attribute__((target("avx2,avx512f,avx512bw")))
+#define SIMD_AVX2_KERNEL __attribute__((target("avx2"), flatten))
+#define SIMD_AVX512_KERNEL __attribute__((target("avx2,avx512f,avx512bw"), flatten))
+#else
+#define SIMD_AVX2
+#define SIMD_AVX512
+#define SIMD_AVX2_KERNEL
+#define SIMD_AVX512_KERNEL
+#endif
+
+enum class SimdLevel
+{
+	scalar = 0,
+	sse2 = 1,
+	avx2 = 2,
+	avx512 = 3
+};
+
+namespace simd
+{
+	/**
+	 * Returns the widest instruction set supported by both the CPU and the OS
+	 */
+	inline SimdLevel detectLevel() noexcept
+	{
+#if SIMD_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+		int info[4];
+		__cpuid(info, 0);
+		const int maxLeaf = info[0];
+
+		__cpuid(info, 1);
+		const bool osxsave = (info[2] & (1 << 27)) != 0;
+		const bool avx = (info[2] & (1 << 28)) != 0;
+		if (!osxsave || !avx || maxLeaf < 7)
+			return SimdLevel::sse2;
+
+		const uint64_t xcr0 = _xgetbv(0);
+		if ((xcr0 & 0x6) != 0x6)
+			return SimdLevel::sse2;
+
+		__cpuidex(info, 7, 0);
+		const bool avx2 = (info[1] & (1 << 5)) != 0;
+		const bool avx512f = (info[1] & (1 << 16)) != 0;
+		const bool avx512bw = (info[1] & (1 << 30)) != 0;
+
+		if (avx2 && avx512f && avx512bw && (xcr0 & 0xE6) == 0xE6)
+			return SimdLevel::avx512;
+		if (avx2)
+			return SimdLevel::avx2;
+		return SimdLevel::sse2;
+#else
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+			return SimdLevel::avx512;
+		if (__builtin_cpu_supports("avx2"))
+			return SimdLevel::avx2;
+		return SimdLevel::sse2;
+#endif
+#else
+		return SimdLevel::scalar;
+#endif
+	}
+
+	inline std::atomic<int>& levelLimit() noexcept
+	{
+		static std::atomic<int> limit(static_cast<int>(SimdLevel::avx512));
+		return limit;
+	}
+
+	/**
+	 * Caps the instruction set used by the kernels at @level.
+	 * Useful to avoid AVX-512 frequency drops and to test every code path
+	 */
+	inline void limitLevel(SimdLevel level) noexcept
+	{
+		levelLimit().store(static_cast<int>(level), std::memory_order_relaxed);
+	}
+
+	/**
+	 * Returns the instruction set the kernels dispatch to
+	 */
+	inline SimdLevel activeLevel() noexcept
+	{
+		static const SimdLevel detected = detectLevel();
+		const int limit = levelLimit().load(std::memory_order_relaxed);
+
+		if (limit < static_cast<int>(detected))
+			return static_cast<SimdLevel>(limit);
+		return detected;
+	}
+
+	/**
+	 * Returns the index of the lowest set bit, @mask must not be zero
+	 */
+	inline unsigned countTrailingZeros(uint64_t mask) noexcept
+	{
+#if defined(_MSC_VER) && !defined(__clang__)
+		unsigned long index;
+		_BitScanForward64(&index, mask);
+		return static_cast<unsigned>(index);
+#else
+		return static_cast<unsigned>(__builtin_ctzll(mask));
+#endif
+	}
+
+	/**
+	 * Returns the number of leading zero bits, @mask must not be zero
+	 */
+	inline unsigned countLeadingZeros(uint64_t mask) noexcept
+	{
+#if defined(_MSC_VER) && !defined(__clang__)
+		unsigned long index;
+		_BitScanReverse64(&index, mask);
+		return 63 - static_cast<unsigned>(index);
+#else
+		return static_cast<unsigned>(__builtin_clzll(mask));
+#endif
+	}
+
+	/**
+	 * Returns the number of set bits in @mask
+	 */
+	inline unsigned popCount(uint64_t mask) noexcept
+	{
+#if defined(_MSC_VER) && !defined(__clang__)
+		mask = mask - ((mask >> 1) & 0x5555555555555555ULL);
+		mask = (mask & 0x3333333333333333ULL) + ((mask >> 2) & 0x3333333333333333ULL);
+		mask = (mask + (mask >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+		return static_cast<unsigned>((mask * 0x0101010101010101ULL) >> 56);
+#else
+		return static_cast<unsigned>(__builtin_popcountll(mask));
+#endif
+	}
+
+	/**
+	 * Element types the compare kernels can handle: every arithmetic type
+	 * of 1, 2, 4 or 8 bytes except bool
+	 */
+	template <typename T>
+	struct isVectorizable : std::integral_constant<bool,
+		std::is_arithmetic<T>::value && !std::is_same<T, bool>::value &&
+		(std::is_integral<T>::value
+			? (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8)
+			: (std::is_same<T, float>::value || std::is_same<T, double>::value))>
+	{
+	};
+
+	/**
+	 * Compare operations, one specialization per element kind.
+	 *
+	 * The constructor broadcasts the key, match() loads @lanes elements
+	 * starting at @p (no alignment required) and returns a mask with
+	 * @laneBits set bits for every element equal to the key. @level lets
+	 * kernels pick further operations for the same instruction set.
+	 *
+	 * ScalarOps compares a single element and is used where no vector
+	 * instruction set is available.
+	 */
+	template <typename T>
+	struct ScalarOps
+	{
+		static const std::size_t lanes = 1;
+		static const unsigned laneBits = 1;
+		static const SimdLevel level = SimdLevel::scalar;
+		T m_key;
+
+		explicit ScalarOps(T key) noexcept : m_key(key) {}
+
+		uint64_t match(const T* p) const noexcept
+		{
+			return (*p == m_key) ? 1 : 0;
+		}
+	};
+
+#if SIMD_X86
+	template <typename T, bool = std::is_floating_point<T>::value, std::size_t = sizeof(T)>
+	struct Sse2Ops;
+
+	template <typename T>
+	struct Sse2Ops<T, false, 1>
+	{
+		using Vec = __m128i;
+		static const std::size_t lanes = 16;
+		static const unsigned laneBits = 1;
+		static const SimdLevel level = SimdLevel::sse2;
+		Vec m_key;
+
+		explicit Sse2Ops(T key) noexcept : m_key(_mm_set1_epi8(static_cast<char>(key))) {}
+
+		uint64_t match(const T* p) const noexcept
+		{
+			const Vec v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+			return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, m_key)));
+		}
+	};
+
+	template <typename T>
+	struct Sse2Ops<T, false, 2>
+	{
+		using Vec = __m128i;
+		static const std::size_t lanes = 8;
+		static const unsigned laneBits = 2;
+		static const SimdLevel level = SimdLevel::sse2;
+		Vec m_key;
+
+		explicit Sse2Ops(T key) noexcept : m_key(_mm_set1_epi16(static_cast<short>(key))) {}
+
+		uint64_t match(const T* p) const noexcept
+		{
+			const Vec v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+			return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi16(v, m_key)));
+		}
+	};
+
+	template <typename T>
+	struct Sse2Ops<T, false, 4>
+	{
+		using Vec = __m128i;
+		static const std::size_t lanes = 4;
+		static const unsigned laneBits = 1;
+		static const SimdLevel level = SimdLevel::sse2;
+		Vec m_key;
+
+		explicit Sse2Ops(T key) noexcept : m_key(_mm_set1_epi32(static_cast<int>(key))) {}
+
+		uint64_t match(const T* p) const noexcept
+		{
+			const Vec v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+			return static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, m_key))));
+		}
+	};
+
+	template <typename T>
+	struct Sse2Ops<T, false, 8>
+	{
+		using Vec = __m128i;
+		static const std::size_t lanes = 2;
+		static const unsigned laneBits = 1;
+		static const SimdLevel level = SimdLevel::sse2;
+		Vec m_key;
+
+		explicit Sse2Ops(T key) noexcept : m_key(_mm_set1_epi64x(static_cast<long long>(key))) {}
+
+		uint64_t match(const T* p) const noexcept
+		{
+			// SSE2 has no 64-bit compare: both 32-bit halves have to match
+			const Vec v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+			const Vec eq = _mm_cmpeq_epi32(v, m_key);
+			const Vec both = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+			return static_cast<uint32_t>(_mm_movemask_pd(_mm_castsi128_pd(both)));
+		}
+	};
+
+	template <>
+	struct Sse2Ops<float, true, 4>
+	{
+		using Vec = __m128;
+		static const std::size_t lanes = 4;
+		static const unsigned laneBits = 1;
+		static const SimdLevel level = SimdLevel::sse2;
+		Vec m_key;
+
+		explicit Sse2Ops(float key) noexcept : m_key(_mm_set1_ps(key)) {}
+
+		uint64_t match(const float* p) const noexcept
+		{
+			return static_cast<uint32_t>(_mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(p), m_key)));
+		}
+	};
+
+	template <>
+	struct Sse2Ops<double, true, 8>
+	{
+		using Vec = __m128d;
+		static const std::size_t lanes = 2;
+		static const unsigned laneBits = 1;
+		static const SimdLevel level = SimdLevel::sse2;
+		Vec m_key;
+
+		explicit Sse2Ops(double key) noexcept : m_key(_mm_set1_pd(key)) {}
+
+		uint64_t match(const double* p) const noexcept
+		{
+			return static_cast<uint32_t>(_mm_movemask_pd(_mm_cmpeq_pd(_mm_loadu_pd(p), m_key)));
+		}
+	};
+
+	template <typename T, bool = std::is_floating_point<T>::value, std::size_t = sizeof(T)>
+	struct Avx2Ops;
+
+	template <typename T>
+	struct Avx2Ops<T, false, 1>
+	{
+		using Vec = __m256i;
+		static const std::size_t lanes = 32;
+		static const unsigned laneBits = 1;
+		static const SimdLevel level = SimdLevel::avx2;
+		Vec m_key;
+
+		SIMD_AVX2 explicit Avx2Ops(T key) noexcept : m_key(_mm256_set1_epi8(static_cast<char>(key))) {}
+
+		SIMD_AVX2 uint64_t match(const T* p) const noexcept
+		{
+			const Vec v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+			return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, m_key)));
+		}
+	};
+
+	template <typename T>
+	struct Avx2Ops<T, false, 2>
+	{
+		using Vec = __m256i;
+		static const std::size_t lanes = 16;
+		static const unsigned laneBits = 2;
+		static const SimdLevel level = SimdLevel::avx2;
+		Vec m_key;
+
+		SIMD_AVX2 explicit Avx2Ops(T key) noexcept : m_key(_mm256_set1_epi16(static_cast<short>(key))) {}
+
+		SIMD_AVX2 uint64_t match(const T* p) const noexcept
+		{
+			const Vec v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+			return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi16(v, m_key)));
+		}
+	};
+
+	template <typename T>
+	struct Avx2Ops<T, false, 4>
+	{
+		using Vec = __m256i;
+		static const std::size_t lanes = 8;
+		static const unsigned laneBits = 1;
+		static const SimdLevel level = SimdLevel::avx2;
+		Vec m_key;
+
+		SIMD_AVX2 explicit Avx2Ops(T key) noexcept : m_key(_mm256_set1_epi32(static_cast<int>(key))) {}
+
+		SIMD_AVX2 uint64_t match(const T* p) const noexcept
+		{
+			const Vec v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+			return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, m_key))));
+		}
+	};
+
+	template <typename T>
+	struct Avx2Ops<T, false, 8>
+	{
+		using Vec = __m256i;
+		static const std::size_t lanes = 4;
+		static const unsigned laneBits = 1;
+		static const SimdLevel level = SimdLevel::avx2;
+		Vec m_key;
+
+		SIMD_AVX2 explicit Avx2Ops(T key) noexcept : m_key(_mm256_set1_epi64x(static_cast<long long>(key))) {}
+
+		SIMD_AVX2 uint64_t match(const T* p) const noexcept
+		{
+			const Vec v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+			return static_cast<uint32_t>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(v, m_key))));
+		}
+	};
+
+	template <>
+	struct Avx2Ops<float, true, 4>
+	{
+		using Vec = __m256;
+		static const std::size_t lanes = 8;
+		static const unsigned laneBits = 1;
+		static const SimdLevel level = SimdLevel::avx2;
+		Vec m_key;
+
+		SIMD_AVX2 explicit Avx2Ops(float key) noexcept : m_key(_mm256_set1_ps(key)) {}
+
+		SIMD_AVX2 uint64_t match(const float* p) const noexcept
+		{
+			return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(p), m_key, _CMP_EQ_OQ)));
+		}
+	};
+
+	template <>
+	struct Avx2Ops<double, true, 8>
+	{
+		using Vec = __m256d;
+		static const std::size_t lanes = 4;
+		static const unsigned laneBits = 1;
+		static const SimdLevel level = SimdLevel::avx2;
+		Vec m_key;
+
+		SIMD_AVX2 explicit Avx2Ops(double key) noexcept : m_key(_mm256_set1_pd(key)) {}
+
+		SIMD_AVX2 uint64_t match(const double* p) const noexcept
+		{
+			return static_cast<uint32_t>(_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(p), m_key, _CMP_EQ_OQ)));
+		}
+	};
+
+	template <typename T, bool = std::is_floating_point<T>::value, std::size_t = sizeof(T)>
+	struct Avx512Ops;
+
+	template <typename T>
+	struct Avx512Ops<T, false, 1>
+	{
+		using Vec = __m512i;
+		static const std::size_t lanes = 64;
+		static const unsigned laneBits = 1;
+		static const SimdLevel level = SimdLevel::avx512;
+		Vec m_key;
+
+		SIMD_AVX512 explicit Avx512Ops(T key) noexcept : m_key(_mm512_set1_epi8(static_cast<char>(key))) {}
+
+		SIMD_AVX512 uint64_t match(const T* p) const noexcept
+		{
+			return _mm512_cmpeq_epi8_mask(_mm512_loadu_si512(p), m_key);
+		}
+	};
+
+	template <typename T>
+	struct Avx512Ops<T, false, 2>
+	{
+		using Vec = __m512i;
+		static const std::size_t lanes = 32;
+		static const unsigned laneBits = 1;
+		static const SimdLevel level = SimdLevel::avx512;
+		Vec m_key;
+
+		SIMD_AVX512 explicit Avx512Ops(T key) noexcept : m_key(_mm512_set1_epi16(static_cast<short>(key))) {}
+
+		SIMD_AVX512 uint64_t match(const T* p) const noexcept
+		{
+			return _mm512_cmpeq_epi16_mask(_mm512_loadu_si512(p), m_key);
+		}
+	};
+
+	template <typename T>
+	struct Avx512Ops<T, false, 4>
+	{
+		using Vec = __m512i;
+		static const std::size_t lanes = 16;
+		static const unsigned laneBits = 1;
+		static const SimdLevel level = SimdLevel::avx512;
+		Vec m_key;
+
+		SIMD_AVX512 explicit Avx512Ops(T key) noexcept : m_key(_mm512_set1_epi32(static_cast<int>(key))) {}
+
+		SIMD_AVX512 uint64_t match(const T* p) const noexcept
+		{
+			return _mm512_cmpeq_epi32_mask(_mm512_loadu_si512(p), m_key);
+		}
+	};
+
+	template <typename T>
+	struct Avx512Ops<T, false, 8>
+	{
+		using Vec = __m512i;
+		static const std::size_t lanes = 8;
+		static const unsigned laneBits = 1;
+		static const SimdLevel level = SimdLevel::avx512;
+		Vec m_key;
+
+		SIMD_AVX512 explicit Avx512Ops(T key) noexcept : m_key(_mm512_set1_epi64(static_cast<long long>(key))) {}
+
+		SIMD_AVX512 uint64_t match(const T* p) const noexcept
+		{
+			return _mm512_cmpeq_epi64_mask(_mm512_loadu_si512(p), m_key);
+		}
+	};
+
+	template <>
+	struct Avx512Ops<float, true, 4>
+	{
+		using Vec = __m512;
+		static const std::size_t lanes = 16;
+		static const unsigned laneBits = 1;
+		static const SimdLevel level = SimdLevel::avx512;
+		Vec m_key;
+
+		SIMD_AVX512 explicit Avx512Ops(float key) noexcept : m_key(_mm512_set1_ps(key)) {}
+
+		SIMD_AVX512 uint64_t match(const float* p) const noexcept
+		{
+			return _mm512_cmp_ps_mask(_mm512_loadu_ps(p), m_key, _CMP_EQ_OQ);
+		}
+	};
+
+	template <>
+	struct Avx512Ops<double, true, 8>
+	{
+		using Vec = __m512d;
+		static const std::size_t lanes = 8;
+		static const unsigned laneBits = 1;
+		static const SimdLevel level = SimdLevel::avx512;
+		Vec m_key;
+
+		SIMD_AVX512 explicit Avx512Ops(double key) noexcept : m_key(_mm512_set1_pd(key)) {}
+
+		SIMD_AVX512 uint64_t match(const double* p) const noexcept
+		{
+			return _mm512_cmp_pd_mask(_mm512_loadu_pd(p), m_key, _CMP_EQ_OQ);
+		}
+	};
+#endif
+
+	/**
+	 * Runs Kernel<Ops>::run(@args...) with the compare operations of the
+	 * widest available instruction set. Every kernel is written once
+	 * against the Ops interface and compiled for each instruction set
+	 */
+#if SIMD_X86
+	template <template <typename> class Kernel, typename T, typename... Args>
+	SIMD_AVX2_KERNEL auto runAvx2(Args... args) noexcept -> decltype(Kernel<ScalarOps<T>>::run(args...))
+	{
+		return Kernel<Avx2Ops<T>>::run(args...);
+	}
+
+	template <template <typename> class Kernel, typename T, typename... Args>
+	SIMD_AVX512_KERNEL auto runAvx512(Args... args) noexcept -> decltype(Kernel<ScalarOps<T>>::run(args...))
+	{
+		return Kernel<Avx512Ops<T>>::run(args...);
+	}
+#endif
+
+	template <template <typename> class Kernel, typename T, typename... Args>
+	auto dispatch(Args... args) noexcept -> decltype(Kernel<ScalarOps<T>>::run(args...))
+	{
+#if SIMD_X86
+		switch (activeLevel())
+		{
+		case SimdLevel::avx512:
+			return runAvx512<Kernel, T>(args...);
+		case SimdLevel::avx2:
+			return runAvx2<Kernel, T>(args...);
+		case SimdLevel::sse2:
+			return Kernel<Sse2Ops<T>>::run(args...);
+		default:
+			break;
+		}
+#endif
+		return Kernel<ScalarOps<T>>::run(args...);
+	}
+}
@@ -0,0 +1,541 @@
+﻿/**
+ * @author Dreadblade- (https://github.com/Dreadblade-dev)
+ * Log-structured sorted runs realization
+ *
+ * A sorted array answers searches in O(log n), but every insert has to
+ * move half of it. Log-structured storage keeps the new values in a small
+ * unsorted buffer instead. A full buffer is sorted and becomes a run at
+ * level 0, and two runs of one level are merged into a run of the next
+ * level, like the carry of a binary counter, so a run at level i holds
+ * at most buffer_size * 2^i values. Every value takes part in O(log n)
+ * merges.
+ *
+ * The merges are incremental: a merge is state kept in its level, and
+ * every insert does merge_step units of work on every running merge:
+ * clearing the filter of the output, moving values, destroying the moved
+ * inputs. A merge at level i is done long before the level receives its
+ * next run, so an insert never waits for a whole cascade; its work is
+ * bounded by the number of levels, not just amortized. While a merge
+ * runs, its inputs keep the values not moved yet and remain searchable.
+ *
+ * A search scans the buffer and binary-searches the runs. Every run has a
+ * Bloom filter, and a run whose filter rejects the key is not searched at
+ * all, so a lookup usually touches a single run.
+ *
+ * Time complexity (B - buffer size):
+ * ┌──────────────────────────┬──────────────────────────┐
+ * │  Insert (worst case)     │          Search          │
+ * ├──────────────────────────┼──────────────────────────┤
+ * │ O(B log B + log (n / B)) │  O(B + log^2 (n / B))    │
+ * └──────────────────────────┴──────────────────────────┘
+ *
+ * Source: https://en.wikipedia.org/wiki/Log-structured_merge-tree
+ */
+
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "linear_search.h"
+
+namespace sorted_runs
+{
+	struct constants
+	{
+		static const std::size_t buffer_size = 256;
+		// Values every running merge moves or destroys per insert, a merge of
+		// two runs of level i then ends within about buffer_size * 2^(i - 1)
+		// inserts, half the time until the level receives its next run
+		static const std::size_t merge_step = 8;
+		static const std::size_t filter_words_per_step = 8;
+		static const std::size_t bits_per_key = 10;
+		static const unsigned hash_count = 7;
+	};
+
+	/**
+	 * Spreads the bits of @hash, std::hash is the identity for integers
+	 */
+	inline uint64_t mix(uint64_t hash) noexcept
+	{
+		hash ^= hash >> 30;
+		hash *= 0xbf58476d1ce4e5b9ULL;
+		hash ^= hash >> 27;
+		hash *= 0x94d049bb133111ebULL;
+		return hash ^ (hash >> 31);
+	}
+
+	/**
+	 * Bloom filter of one run. The probed bits are derived from two halves
+	 * of a single 64-bit hash (double hashing)
+	 */
+	class RunFilter
+	{
+	private:
+		std::vector<uint64_t> m_bits;
+		uint64_t m_bitCount = 0;
+
+		static std::size_t wordsFor(std::size_t keyCount) noexcept
+		{
+			const std::size_t words = (keyCount * constants::bits_per_key + 63) / 64;
+			return words > 0 ? words : 1;
+		}
+	public:
+		RunFilter() = default;
+
+		explicit RunFilter(std::size_t keyCount)
+		{
+			m_bits.assign(wordsFor(keyCount), 0);
+			m_bitCount = m_bits.size() * 64;
+		}
+
+		/**
+		 * Allocates the bits for @keyCount keys without clearing them,
+		 * clearStep() has to clear them all before the first add()
+		 */
+		static RunFilter reserved(std::size_t keyCount)
+		{
+			RunFilter filter;
+			filter.m_bits.reserve(wordsFor(keyCount));
+			filter.m_bitCount = filter.m_bits.capacity() * 64;
+			return filter;
+		}
+
+		/**
+		 * Clears up to @words more words of a reserved filter, returns @true once all are clear
+		 */
+		bool clearStep(std::size_t words)
+		{
+			const std::size_t total = static_cast<std::size_t>(m_bitCount / 64);
+			m_bits.resize(std::min(total, m_bits.size() + std::min(words, total)), 0);
+			return m_bits.size() == total;
+		}
+
+		void add(uint64_t hash) noexcept
+		{
+			const uint64_t step = (hash >> 32) | 1;
+			for (unsigned i = 0; i < constants::hash_count; ++i, hash += step)
+			{
+				const uint64_t bit = (hash & 0xffffffffULL) % m_bitCount;
+				m_bits[bit / 64] |= uint64_t(1) << (bit % 64);
+			}
+		}
+
+		/**
+		 * Returns @false if no key with @hash was added
+		 */
+		bool mayContain(uint64_t hash) const noexcept
+		{
+			const uint64_t step = (hash >> 32) | 1;
+			for (unsigned i = 0; i < constants::hash_count; ++i, hash += step)
+			{
+				const uint64_t bit = (hash & 0xffffffffULL) % m_bitCount;
+				if ((m_bits[bit / 64] & (uint64_t(1) << (bit % 64))) == 0)
+					return false;
+			}
+
+			return true;
+		}
+
+		std::size_t getSizeInBytes() const noexcept
+		{
+			return m_bits.capacity() * sizeof(uint64_t);
+		}
+	};
+}
+
+template <class T, class Hash = std::hash<T>>
+class SortedRuns
+{
+private:
+	struct Run
+	{
+		std::vector<T> values;
+		sorted_runs::RunFilter filter;
+	};
+
+	// Two runs of a level being merged into a run of the next level. The
+	// values before leftIndex and rightIndex have been moved to the output,
+	// which holds no other values, so the filters of the inputs cover it
+	struct Merge
+	{
+		Run left;
+		Run right;
+		std::size_t leftIndex = 0;
+		std::size_t rightIndex = 0;
+		Run output;
+	};
+
+	struct Level
+	{
+		// Complete runs of at most buffer_size * 2^i values, oldest first
+		std::vector<Run> runs;
+		Merge merge;
+		bool merging = false;
+	};
+
+	using Iterator = typename std::vector<T>::const_iterator;
+
+	std::vector<T> m_buffer;
+	std::vector<Level> m_levels;
+	std::size_t m_size;
+	Hash m_hash;
+
+	uint64_t hashOf(const T& key) const;
+	Run makeRun(std::vector<T>&& values) const;
+	void addRun(std::size_t level, Run&& run);
+	void startMerge(std::size_t level);
+	void advanceMerge(std::size_t level, std::size_t steps);
+	void advanceMerges();
+	void flush();
+	template <class Visitor>
+	void forEachRange(const T& key, Visitor visitor) const;
+public:
+	SortedRuns();
+	void insert(const T& value);
+	void insert(T&& value);
+	bool contains(const T& key) const;
+	std::size_t count(const T& key) const;
+	void compact();
+	void clear() noexcept;
+	std::size_t getSize() const noexcept;
+	std::size_t getRunCount() const noexcept;
+	std::size_t getSizeInBytes() const noexcept;
+};
+
+template <class T, class Hash>
+SortedRuns<T, Hash>::SortedRuns() : m_size(0)
+{
+	m_buffer.reserve(sorted_runs::constants::buffer_size);
+}
+
+template <class T, class Hash>
+uint64_t SortedRuns<T, Hash>::hashOf(const T& key) const
+{
+	return sorted_runs::mix(static_cast<uint64_t>(m_hash(key)));
+}
+
+/**
+ * Builds the Bloom filter of sorted @values
+ */
+template <class T, class Hash>
+typename SortedRuns<T, Hash>::Run SortedRuns<T, Hash>::makeRun(std::vector<T>&& values) const
+{
+	Run run;
+	run.values = std::move(values);
+	run.filter = sorted_runs::RunFilter(run.values.size());
+
+	for (const T& value : run.values)
+		run.filter.add(hashOf(value));
+
+	return run;
+}
+
+/**
+ * Puts @run on @level and starts a merge there if two runs wait
+ */
+template <class T, class Hash>
+void SortedRuns<T, Hash>::addRun(std::size_t level, Run&& run)
+{
+	if (level == m_levels.size())
+		m_levels.emplace_back();
+
+	m_levels[level].runs.push_back(std::move(run));
+	startMerge(level);
+}
+
+/**
+ * Starts merging the two oldest runs of @level unless a merge is running there
+ */
+template <class T, class Hash>
+void SortedRuns<T, Hash>::startMerge(std::size_t level)
+{
+	Level& current = m_levels[level];
+	if (current.merging || current.runs.size() < 2)
+		return;
+
+	Merge& merge = current.merge;
+	merge.left = std::move(current.runs[0]);
+	merge.right = std::move(current.runs[1]);
+	current.runs.erase(current.runs.begin(), current.runs.begin() + 2);
+	merge.leftIndex = 0;
+	merge.rightIndex = 0;
+
+	const std::size_t total = merge.left.values.size() + merge.right.values.size();
+	merge.output.values.clear();
+	merge.output.values.reserve(total);
+	merge.output.filter = sorted_runs::RunFilter::reserved(total);
+	current.merging = true;
+}
+
+/**
+ * Does up to @steps units of work on the merge on @level: clears the
+ * filter of the output, moves values, destroys the moved-from inputs.
+ * A finished merge hands its run to the next level
+ */
+template <class T, class Hash>
+void SortedRuns<T, Hash>::advanceMerge(std::size_t level, std::size_t steps)
+{
+	Merge& merge = m_levels[level].merge;
+	std::vector<T>& left = merge.left.values;
+	std::vector<T>& right = merge.right.values;
+	std::vector<T>& output = merge.output.values;
+
+	if (!merge.output.filter.clearStep(steps * sorted_runs::constants::filter_words_per_step))
+		return;
+
+	for (; steps > 0 && (merge.leftIndex < left.size() || merge.rightIndex < right.size()); --steps)
+	{
+		const bool fromLeft = merge.rightIndex == right.size() ||
+			(merge.leftIndex < left.size() && !(right[merge.rightIndex] < left[merge.leftIndex]));
+		T& value = fromLeft ? left[merge.leftIndex++] : right[merge.rightIndex++];
+
+		merge.output.filter.add(hashOf(value));
+		output.push_back(std::move(value));
+	}
+
+	if (merge.leftIndex < left.size() || merge.rightIndex < right.size())
+		return;
+
+	if (std::is_trivially_destructible<T>::value)
+	{
+		left.clear();
+		right.clear();
+	}
+	for (; steps > 0 && !(left.empty() && right.empty()); --steps)
+		(left.empty() ? right : left).pop_back();
+
+	if (!(left.empty() && right.empty()))
+		return;
+
+	Run done = std::move(merge.output);
+	merge = Merge();
+	m_levels[level].merging = false;
+
+	addRun(level + 1, std::move(done));
+	startMerge(level);
+}
+
+/**
+ * Advances every running merge by merge_step values
+ */
+template <class T, class Hash>
+void SortedRuns<T, Hash>::advanceMerges()
+{
+	// A finished merge may add a level, which is advanced in the same pass
+	for (std::size_t level = 0; level < m_levels.size(); ++level)
+		if (m_levels[level].merging)
+			advanceMerge(level, sorted_runs::constants::merge_step);
+}
+
+/**
+ * Sorts the buffer into a run on level 0
+ */
+template <class T, class Hash>
+void SortedRuns<T, Hash>::flush()
+{
+	if (m_buffer.empty())
+		return;
+
+	std::vector<T> values;
+	values.reserve(sorted_runs::constants::buffer_size);
+	values.swap(m_buffer);
+	std::sort(values.begin(), values.end());
+
+	addRun(0, makeRun(std::move(values)));
+}
+
+/**
+ * Adds @value, equal values are kept
+ */
+template <class T, class Hash>
+void SortedRuns<T, Hash>::insert(const T& value)
+{
+	m_buffer.push_back(value);
+	++m_size;
+
+	if (m_buffer.size() == sorted_runs::constants::buffer_size)
+		flush();
+	advanceMerges();
+}
+
+template <class T, class Hash>
+void SortedRuns<T, Hash>::insert(T&& value)
+{
+	m_buffer.push_back(std::move(value));
+	++m_size;
+
+	if (m_buffer.size() == sorted_runs::constants::buffer_size)
+		flush();
+	advanceMerges();
+}
+
+/**
+ * Calls @visitor(first, last) for every sorted range that may hold @key:
+ * the runs and, for running merges, the output and what is left of the inputs
+ */
+template <class T, class Hash>
+template <class Visitor>
+void SortedRuns<T, Hash>::forEachRange(const T& key, Visitor visitor) const
+{
+	const uint64_t hash = hashOf(key);
+
+	// Newer values live on the lower levels
+	for (const Level& level : m_levels)
+	{
+		for (const Run& run : level.runs)
+			if (run.filter.mayContain(hash) && visitor(run.values.begin(), run.values.end()))
+				return;
+
+		if (!level.merging)
+			continue;
+
+		// The filter of the output is not complete yet, the key can only be there if an input may hold it
+		const Merge& merge = level.merge;
+		const bool inLeft = merge.left.filter.mayContain(hash);
+		const bool inRight = merge.right.filter.mayContain(hash);
+		if ((inLeft || inRight) && visitor(merge.output.values.begin(), merge.output.values.end()))
+			return;
+		if (inLeft && merge.leftIndex < merge.left.values.size() &&
+			visitor(merge.left.values.begin() + merge.leftIndex, merge.left.values.end()))
+			return;
+		if (inRight && merge.rightIndex < merge.right.values.size() &&
+			visitor(merge.right.values.begin() + merge.rightIndex, merge.right.values.end()))
+			return;
+	}
+}
+
+/**
+ * Returns @true if @key was inserted
+ */
+template <class T, class Hash>
+bool SortedRuns<T, Hash>::contains(const T& key) const
+{
+	if (linearSearch(m_buffer.data(), m_buffer.size(), key) >= 0)
+		return true;
+
+	bool found = false;
+	forEachRange(key, [&key, &found](Iterator first, Iterator last)
+	{
+		found = std::binary_search(first, last, key);
+		return found;
+	});
+
+	return found;
+}
+
+/**
+ * Returns how many times @key was inserted
+ */
+template <class T, class Hash>
+std::size_t SortedRuns<T, Hash>::count(const T& key) const
+{
+	std::size_t result = static_cast<std::size_t>(std::count(m_buffer.begin(), m_buffer.end(), key));
+
+	forEachRange(key, [&key, &result](Iterator first, Iterator last)
+	{
+		const auto range = std::equal_range(first, last, key);
+		result += static_cast<std::size_t>(range.second - range.first);
+		return false;
+	});
+
+	return result;
+}
+
+/**
+ * Merges the buffer and all runs into a single run, which is put on the
+ * lowest level whose runs may be as large
+ */
+template <class T, class Hash>
+void SortedRuns<T, Hash>::compact()
+{
+	flush();
+
+	std::vector<T> merged;
+	for (std::size_t level = 0; level < m_levels.size(); ++level)
+	{
+		// A finished merge may start the next one on the same level
+		while (m_levels[level].merging)
+			advanceMerge(level, m_size);
+
+		for (Run& run : m_levels[level].runs)
+		{
+			std::vector<T> next;
+			next.reserve(merged.size() + run.values.size());
+			std::merge(std::make_move_iterator(merged.begin()), std::make_move_iterator(merged.end()),
+				std::make_move_iterator(run.values.begin()), std::make_move_iterator(run.values.end()),
+				std::back_inserter(next));
+			merged.swap(next);
+		}
+		m_levels[level].runs.clear();
+	}
+
+	m_levels.clear();
+	if (merged.empty())
+		return;
+
+	std::size_t level = 0;
+	while ((sorted_runs::constants::buffer_size << level) < merged.size())
+		++level;
+
+	m_levels.resize(level);
+	addRun(level, makeRun(std::move(merged)));
+}
+
+template <class T, class Hash>
+void SortedRuns<T, Hash>::clear() noexcept
+{
+	m_buffer.clear();
+	m_levels.clear();
+	m_size = 0;
+}
+
+/**
+ * Returns the number of inserted values
+ */
+template <class T, class Hash>
+std::size_t SortedRuns<T, Hash>::getSize() const noexcept
+{
+	return m_size;
+}
+
+/**
+ * Returns the number of sorted runs a search may have to visit,
+ * a running merge counts as its output and both inputs
+ */
+template <class T, class Hash>
+std::size_t SortedRuns<T, Hash>::getRunCount() const noexcept
+{
+	std::size_t runs = 0;
+	for (const Level& level : m_levels)
+		runs += level.runs.size() + (level.merging ? 3 : 0);
+
+	return runs;
+}
+
+/**
+ * Returns the memory used by the values and the filters
+ */
+template <class T, class Hash>
+std::size_t SortedRuns<T, Hash>::getSizeInBytes() const noexcept
+{
+	auto runBytes = [](const Run& run)
+	{
+		return sizeof(Run) + run.values.capacity() * sizeof(T) + run.filter.getSizeInBytes();
+	};
+
+	std::size_t bytes = sizeof(*this) + m_buffer.capacity() * sizeof(T);
+	for (const Level& level : m_levels)
+	{
+		bytes += sizeof(Level);
+		for (const Run& run : level.runs)
+			bytes += runBytes(run);
+		if (level.merging)
+			bytes += runBytes(level.merge.left) + runBytes(level.merge.right) + runBytes(level.merge.output);
+	}
+
+	return bytes;
+}
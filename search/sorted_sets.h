@@ -0,0 +1,396 @@
+﻿/**
+ * @author Dreadblade- (https://github.com/Dreadblade-dev)
+ *
+ * Intersection and union of sorted sets (strictly increasing arrays such
+ * as posting lists). The result is written into a caller-provided buffer
+ * and the number of written elements is returned.
+ *
+ * The algorithm is chosen from the input sizes:
+ *  • galloping: when one list is much shorter, every element of the short
+ *    list is located in the long one with an exponential search starting
+ *    from the previous match; for the union the skipped runs are copied
+ *    in bulk,
+ *  • SIMD block compare: for 32- and 64-bit integers a block of one list
+ *    is compared against all rotations of a block of the other list and
+ *    the block with the smaller maximum is advanced,
+ *  • merge: the classic two-pointer merge for everything else.
+ *
+ * Time complexity (m ≤ n - sizes of the two lists):
+ * ┌──────────────┬────────────────┬────────────────┐
+ * │              │     Merge      │   Galloping    │
+ * ├──────────────┼────────────────┼────────────────┤
+ * │ Intersection │    O(m + n)    │ O(m log(n/m))  │
+ * ├──────────────┼────────────────┼────────────────┤
+ * │    Union     │    O(m + n)    │ O(m log(n/m))  │
+ * └──────────────┴────────────────┴────────────────┘
+ * (plus O(n) copying for the union)
+ *
+ * Source: https://en.wikipedia.org/wiki/Exponential_search
+ */
+
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include "simd.h"
+
+namespace sorted_sets
+{
+	struct constants
+	{
+		// Size ratio from which galloping beats a linear merge
+		static const std::size_t gallop_ratio = 32;
+	};
+
+	/**
+	 * Returns the first position in [@from, @size) whose element is not
+	 * less than @key, probing @from + 1, + 2, + 4, ... before a binary search
+	 */
+	template <typename T>
+	std::size_t gallop(const T* array, std::size_t from, std::size_t size, const T& key) noexcept
+	{
+		if (from >= size || !(array[from] < key))
+			return from;
+
+		std::size_t low = from;
+		std::size_t step = 1;
+		while (low + step < size && array[low + step] < key)
+		{
+			low += step;
+			step *= 2;
+		}
+
+		const std::size_t high = (low + step < size) ? low + step : size;
+		return static_cast<std::size_t>(std::lower_bound(array + low + 1, array + high, key) - array);
+	}
+
+	template <typename T>
+	std::size_t intersectMerge(const T* a, std::size_t aSize, const T* b, std::size_t bSize, T* out) noexcept
+	{
+		std::size_t i = 0;
+		std::size_t j = 0;
+		std::size_t written = 0;
+
+		while (i < aSize && j < bSize)
+		{
+			if (a[i] < b[j])
+				++i;
+			else if (b[j] < a[i])
+				++j;
+			else
+			{
+				out[written++] = a[i];
+				++i;
+				++j;
+			}
+		}
+
+		return written;
+	}
+
+	/**
+	 * Intersection of a short list @small with a much longer list @large
+	 */
+	template <typename T>
+	std::size_t intersectGallop(const T* small, std::size_t smallSize, const T* large, std::size_t largeSize,
+		T* out) noexcept
+	{
+		std::size_t position = 0;
+		std::size_t written = 0;
+
+		for (std::size_t i = 0; i < smallSize && position < largeSize; ++i)
+		{
+			position = gallop(large, position, largeSize, small[i]);
+			if (position < largeSize && !(small[i] < large[position]))
+				out[written++] = small[i];
+		}
+
+		return written;
+	}
+
+	template <typename T>
+	std::size_t unionMerge(const T* a, std::size_t aSize, const T* b, std::size_t bSize, T* out) noexcept
+	{
+		std::size_t i = 0;
+		std::size_t j = 0;
+		std::size_t written = 0;
+
+		while (i < aSize && j < bSize)
+		{
+			if (a[i] < b[j])
+				out[written++] = a[i++];
+			else if (b[j] < a[i])
+				out[written++] = b[j++];
+			else
+			{
+				out[written++] = a[i];
+				++i;
+				++j;
+			}
+		}
+
+		out = std::copy(a + i, a + aSize, out + written);
+		std::copy(b + j, b + bSize, out);
+		return written + (aSize - i) + (bSize - j);
+	}
+
+	/**
+	 * Union of a short list @small with a much longer list @large,
+	 * the runs of @large between two elements of @small are copied in bulk
+	 */
+	template <typename T>
+	std::size_t unionGallop(const T* small, std::size_t smallSize, const T* large, std::size_t largeSize,
+		T* out) noexcept
+	{
+		std::size_t position = 0;
+		T* end = out;
+
+		for (std::size_t i = 0; i < smallSize; ++i)
+		{
+			const std::size_t next = gallop(large, position, largeSize, small[i]);
+			end = std::copy(large + position, large + next, end);
+			position = next;
+
+			*end++ = small[i];
+			if (position < largeSize && !(small[i] < large[position]))
+				++position;
+		}
+
+		end = std::copy(large + position, large + largeSize, end);
+		return static_cast<std::size_t>(end - out);
+	}
+
+	/**
+	 * Block membership operations: members(a, b) returns a mask with bit k
+	 * set when a[k] occurs anywhere in b[0, lanes). All rotations of the
+	 * block of b are compared against the block of a.
+	 */
+	template <std::size_t SIZE, SimdLevel LEVEL>
+	struct IntersectBlock
+	{
+		static const bool available = false;
+		static const std::size_t lanes = 1;
+		static uint64_t members(const void*, const void*) noexcept { return 0; }
+	};
+
+#if SIMD_X86
+	template <>
+	struct IntersectBlock<4, SimdLevel::sse2>
+	{
+		static const bool available = true;
+		static const std::size_t lanes = 4;
+		static uint64_t members(const void* a, const void* b) noexcept
+		{
+			const __m128i va = _mm_loadu_si128(static_cast<const __m128i*>(a));
+			__m128i vb = _mm_loadu_si128(static_cast<const __m128i*>(b));
+			__m128i eq = _mm_cmpeq_epi32(va, vb);
+			for (int rotation = 1; rotation < 4; ++rotation)
+			{
+				vb = _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1));
+				eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, vb));
+			}
+			return static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(eq)));
+		}
+	};
+
+	template <>
+	struct IntersectBlock<8, SimdLevel::sse2>
+	{
+		static const bool available = true;
+		static const std::size_t lanes = 2;
+		static uint64_t members(const void* a, const void* b) noexcept
+		{
+			const __m128i va = _mm_loadu_si128(static_cast<const __m128i*>(a));
+			const __m128i vb = _mm_loadu_si128(static_cast<const __m128i*>(b));
+			const __m128i swapped = _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2));
+			// SSE2 has no 64-bit compare: both 32-bit halves have to match
+			__m128i eq = _mm_cmpeq_epi32(va, vb);
+			eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+			__m128i eqSwapped = _mm_cmpeq_epi32(va, swapped);
+			eqSwapped = _mm_and_si128(eqSwapped, _mm_shuffle_epi32(eqSwapped, _MM_SHUFFLE(2, 3, 0, 1)));
+			return static_cast<uint32_t>(_mm_movemask_pd(_mm_castsi128_pd(_mm_or_si128(eq, eqSwapped))));
+		}
+	};
+
+	template <>
+	struct IntersectBlock<4, SimdLevel::avx2>
+	{
+		static const bool available = true;
+		static const std::size_t lanes = 8;
+		SIMD_AVX2 static uint64_t members(const void* a, const void* b) noexcept
+		{
+			const __m256i va = _mm256_loadu_si256(static_cast<const __m256i*>(a));
+			__m256i vb = _mm256_loadu_si256(static_cast<const __m256i*>(b));
+			const __m256i rotate = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0);
+			__m256i eq = _mm256_cmpeq_epi32(va, vb);
+			for (int rotation = 1; rotation < 8; ++rotation)
+			{
+				vb = _mm256_permutevar8x32_epi32(vb, rotate);
+				eq = _mm256_or_si256(eq, _mm256_cmpeq_epi32(va, vb));
+			}
+			return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(eq)));
+		}
+	};
+
+	template <>
+	struct IntersectBlock<8, SimdLevel::avx2>
+	{
+		static const bool available = true;
+		static const std::size_t lanes = 4;
+		SIMD_AVX2 static uint64_t members(const void* a, const void* b) noexcept
+		{
+			const __m256i va = _mm256_loadu_si256(static_cast<const __m256i*>(a));
+			__m256i vb = _mm256_loadu_si256(static_cast<const __m256i*>(b));
+			__m256i eq = _mm256_cmpeq_epi64(va, vb);
+			for (int rotation = 1; rotation < 4; ++rotation)
+			{
+				vb = _mm256_permute4x64_epi64(vb, _MM_SHUFFLE(0, 3, 2, 1));
+				eq = _mm256_or_si256(eq, _mm256_cmpeq_epi64(va, vb));
+			}
+			return static_cast<uint32_t>(_mm256_movemask_pd(_mm256_castsi256_pd(eq)));
+		}
+	};
+
+	template <>
+	struct IntersectBlock<4, SimdLevel::avx512>
+	{
+		static const bool available = true;
+		static const std::size_t lanes = 16;
+		SIMD_AVX512 static uint64_t members(const void* a, const void* b) noexcept
+		{
+			const __m512i va = _mm512_loadu_si512(a);
+			__m512i vb = _mm512_loadu_si512(b);
+			__mmask16 eq = _mm512_cmpeq_epi32_mask(va, vb);
+			for (int rotation = 1; rotation < 16; ++rotation)
+			{
+				// The zero-masking form avoids a GCC 12 -Wmaybe-uninitialized false positive
+				vb = _mm512_maskz_alignr_epi32(0xFFFF, vb, vb, 1);
+				eq = static_cast<__mmask16>(eq | _mm512_cmpeq_epi32_mask(va, vb));
+			}
+			return eq;
+		}
+	};
+
+	template <>
+	struct IntersectBlock<8, SimdLevel::avx512>
+	{
+		static const bool available = true;
+		static const std::size_t lanes = 8;
+		SIMD_AVX512 static uint64_t members(const void* a, const void* b) noexcept
+		{
+			const __m512i va = _mm512_loadu_si512(a);
+			__m512i vb = _mm512_loadu_si512(b);
+			__mmask8 eq = _mm512_cmpeq_epi64_mask(va, vb);
+			for (int rotation = 1; rotation < 8; ++rotation)
+			{
+				vb = _mm512_maskz_alignr_epi64(0xFF, vb, vb, 1);
+				eq = static_cast<__mmask8>(eq | _mm512_cmpeq_epi64_mask(va, vb));
+			}
+			return eq;
+		}
+	};
+#endif
+
+	/**
+	 * Block-compare intersection for lists of similar size. Whenever the
+	 * two blocks are compared the one with the smaller maximum is
+	 * advanced (both if the maxima are equal), the rest is merged.
+	 */
+	template <typename Ops>
+	struct IntersectBlocks
+	{
+		template <typename T>
+		static std::size_t run(const T* a, std::size_t aSize, const T* b, std::size_t bSize, T* out) noexcept
+		{
+			using Block = IntersectBlock<sizeof(T), Ops::level>;
+			std::size_t i = 0;
+			std::size_t j = 0;
+			std::size_t written = 0;
+
+			if (Block::available)
+			{
+				while (i + Block::lanes <= aSize && j + Block::lanes <= bSize)
+				{
+					uint64_t mask = Block::members(a + i, b + j);
+					while (mask != 0)
+					{
+						out[written++] = a[i + simd::countTrailingZeros(mask)];
+						mask &= mask - 1;
+					}
+
+					const T aMax = a[i + Block::lanes - 1];
+					const T bMax = b[j + Block::lanes - 1];
+					if (!(bMax < aMax))
+						i += Block::lanes;
+					if (!(aMax < bMax))
+						j += Block::lanes;
+				}
+			}
+
+			return written + intersectMerge(a + i, aSize - i, b + j, bSize - j, out + written);
+		}
+	};
+
+	template <typename T>
+	struct hasBlockIntersect : std::integral_constant<bool,
+		std::is_integral<T>::value && (sizeof(T) == 4 || sizeof(T) == 8)>
+	{
+	};
+
+	template <typename T>
+	std::size_t intersectSimilar(const T* a, std::size_t aSize, const T* b, std::size_t bSize, T* out,
+		std::true_type) noexcept
+	{
+		return simd::dispatch<IntersectBlocks, T>(a, aSize, b, bSize, out);
+	}
+
+	template <typename T>
+	std::size_t intersectSimilar(const T* a, std::size_t aSize, const T* b, std::size_t bSize, T* out,
+		std::false_type) noexcept
+	{
+		return intersectMerge(a, aSize, b, bSize, out);
+	}
+}
+
+/**
+ * Writes the elements present in both sorted sets @a and @b into @out and
+ * returns their number. @out needs room for min(@aSize, @bSize) elements
+ */
+template <typename T>
+std::size_t intersectSorted(const T* a, std::size_t aSize, const T* b, std::size_t bSize, T* out)
+{
+	if (aSize > bSize)
+	{
+		std::swap(a, b);
+		std::swap(aSize, bSize);
+	}
+
+	if (aSize == 0)
+		return 0;
+
+	if (bSize / aSize >= sorted_sets::constants::gallop_ratio)
+		return sorted_sets::intersectGallop(a, aSize, b, bSize, out);
+
+	return sorted_sets::intersectSimilar(a, aSize, b, bSize, out, sorted_sets::hasBlockIntersect<T>());
+}
+
+/**
+ * Writes the elements present in either of the sorted sets @a and @b into
+ * @out in increasing order and returns their number. @out needs room for
+ * @aSize + @bSize elements
+ */
+template <typename T>
+std::size_t unionSorted(const T* a, std::size_t aSize, const T* b, std::size_t bSize, T* out)
+{
+	if (aSize > bSize)
+	{
+		std::swap(a, b);
+		std::swap(aSize, bSize);
+	}
+
+	if (aSize == 0 || bSize / aSize >= sorted_sets::constants::gallop_ratio)
+		return sorted_sets::unionGallop(a, aSize, b, bSize, out);
+
+	return sorted_sets::unionMerge(a, aSize, b, bSize, out);
+}
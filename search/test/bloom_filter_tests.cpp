@@ -0,0 +1,149 @@
+#include "../bloom_filter.h"
+#include "../../data_structures/doubly_linked_list.h"
+#include "../../data_structures/singly_linked_list.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace BloomFilterTest
+{
+	// The part of the list interface FilteredList uses
+	template <typename T>
+	struct VectorList
+	{
+		std::vector<T> items;
+
+		void insertAtStart(const T& item) { items.insert(items.begin(), item); }
+		void insertAtEnd(const T& item) { items.push_back(item); }
+		void remove(const T& item) { items.erase(std::find(items.begin(), items.end(), item)); }
+		bool contains(const T& item) const { return std::find(items.begin(), items.end(), item) != items.end(); }
+	};
+
+	template <typename Filter>
+	std::size_t countFalsePositives(const Filter& filter, uint64_t first, uint64_t last)
+	{
+		std::size_t falsePositives = 0;
+		for (uint64_t key = first; key < last; ++key)
+			falsePositives += filter.mayContain(key) ? 1 : 0;
+
+		return falsePositives;
+	}
+
+	TEST(BloomFilterTest, BlockedBloomFilterMainTest)
+	{
+		BlockedBloomFilter<uint64_t> filter(10000);
+
+		for (uint64_t key = 0; key < 10000; ++key)
+			filter.add(key * 7);
+
+		for (uint64_t key = 0; key < 10000; ++key)
+			ASSERT_TRUE(filter.mayContain(key * 7));
+
+		// About 1% for 10 bits per key, blocking costs a little
+		EXPECT_LT(countFalsePositives(filter, uint64_t(1) << 40, (uint64_t(1) << 40) + 100000), 3000u);
+
+		filter.clear();
+		EXPECT_FALSE(filter.mayContain(7));
+	}
+
+	TEST(BloomFilterTest, SplitBlockBloomFilterMainTest)
+	{
+		std::mt19937_64 random(17);
+		std::vector<uint64_t> keys(20000);
+		for (uint64_t& key : keys)
+			key = random() >> 1;
+
+		SplitBlockBloomFilter<uint64_t> filter(keys.size());
+		for (uint64_t key : keys)
+			filter.add(key);
+
+		const SimdLevel levels[] = { SimdLevel::scalar, SimdLevel::sse2, SimdLevel::avx2, SimdLevel::avx512 };
+		std::vector<std::size_t> falsePositives;
+
+		for (SimdLevel level : levels)
+		{
+			simd::limitLevel(level);
+
+			for (uint64_t key : keys)
+				ASSERT_TRUE(filter.mayContain(key));
+			falsePositives.push_back(countFalsePositives(filter, uint64_t(1) << 63, (uint64_t(1) << 63) + 100000));
+		}
+		simd::limitLevel(SimdLevel::avx512);
+
+		// Every instruction set probes the same bits
+		for (std::size_t count : falsePositives)
+			EXPECT_EQ(count, falsePositives.front());
+		EXPECT_LT(falsePositives.front(), 3000u);
+	}
+
+	TEST(BloomFilterTest, FilteredSortedArray)
+	{
+		std::vector<int64_t> array;
+		for (int64_t i = -500; i < 500; ++i)
+			array.push_back(i * 3);
+
+		FilteredSortedArray<int64_t> filtered(array.data(), array.size());
+		FilteredSortedArray<int64_t, BlockedBloomFilter<int64_t>> blocked(array.data(), array.size());
+
+		for (int64_t key = -2000; key < 2000; ++key)
+		{
+			const auto position = std::lower_bound(array.begin(), array.end(), key);
+			const int64_t expected = (position != array.end() && *position == key) ? position - array.begin() : -1;
+
+			ASSERT_EQ(filtered.find(key), expected) << "key " << key;
+			ASSERT_EQ(blocked.find(key), expected) << "key " << key;
+		}
+	}
+
+	TEST(BloomFilterTest, FilteredList)
+	{
+		FilteredList<VectorList<std::string>, std::string> list(100);
+
+		list.insertAtEnd("b");
+		list.insertAtStart("a");
+		list.insertAtEnd("c");
+
+		EXPECT_TRUE(list.contains("a"));
+		EXPECT_TRUE(list.contains("c"));
+		EXPECT_FALSE(list.contains("d"));
+
+		list.remove("a");
+		EXPECT_FALSE(list.contains("a"));
+		EXPECT_EQ(list.getList().items.size(), 2u);
+	}
+
+	template <typename List>
+	void checkFilteredLinkedList()
+	{
+		FilteredList<List, int64_t> list(1000);
+
+		for (int64_t i = 0; i < 500; ++i)
+		{
+			list.insertAtEnd(i * 2);
+			list.insertAtStart(-i * 2 - 2);
+		}
+
+		for (int64_t key = -1001; key < 1001; ++key)
+			ASSERT_EQ(list.contains(key), key % 2 == 0 && key >= -1000 && key < 1000) << "key " << key;
+
+		// Removed items stay in the filter, the list answers for them
+		list.remove(0);
+		list.remove(998);
+		list.remove(-1000);
+		EXPECT_FALSE(list.contains(0));
+		EXPECT_FALSE(list.contains(998));
+		EXPECT_FALSE(list.contains(-1000));
+		EXPECT_TRUE(list.contains(996));
+		EXPECT_TRUE(list.getList().contains(-998));
+		EXPECT_FALSE(list.getList().isEmpty());
+	}
+
+	TEST(BloomFilterTest, FilteredLinkedLists)
+	{
+		checkFilteredLinkedList<SinglyLinkedList<int64_t>>();
+		checkFilteredLinkedList<DoublyLinkedList<int64_t>>();
+	}
+}
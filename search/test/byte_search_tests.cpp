@@ -0,0 +1,105 @@
+#include "../byte_search.h"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <random>
+#include <string>
+
+namespace ByteSearchTest
+{
+	int64_t expected(const std::string& text, const std::string& pattern)
+	{
+		const std::size_t position = text.find(pattern);
+		return (position == std::string::npos) ? -1 : static_cast<int64_t>(position);
+	}
+
+	int64_t find(const std::string& text, const std::string& pattern)
+	{
+		return findSubstring(text.data(), text.size(), pattern.data(), pattern.size());
+	}
+
+	TEST(ByteSearchTest, FindByteTest)
+	{
+		const std::string text = "GET /index.html HTTP/1.1\r\nHost: example.com\r\n\r\n";
+
+		EXPECT_EQ(findByte(text.data(), text.size(), '\r'), 24);
+		EXPECT_EQ(findByte(text.data(), text.size(), 'G'), 0);
+		EXPECT_EQ(findByte(text.data(), text.size(), '#'), -1);
+		EXPECT_EQ(findByte(text.data(), 0, 'G'), -1);
+	}
+
+	TEST(ByteSearchTest, FindSubstringEdgeCasesTest)
+	{
+		EXPECT_EQ(find("abc", ""), 0);
+		EXPECT_EQ(find("", ""), 0);
+		EXPECT_EQ(find("", "a"), -1);
+		EXPECT_EQ(find("abc", "abcd"), -1);
+		EXPECT_EQ(find("abc", "abc"), 0);
+		EXPECT_EQ(find("abc", "c"), 2);
+		EXPECT_EQ(find("abc", "bc"), 1);
+
+		// Bytes above 0x7f must not be compared as negative numbers
+		const std::string text = "\x01\x80\xff\x7f\xff\x80";
+		EXPECT_EQ(find(text, "\xff\x80"), 4);
+		EXPECT_EQ(byte_search::twoWay(text.data(), text.size(), "\xff\x80", 2), 4);
+	}
+
+	TEST(ByteSearchTest, FindSubstringAllLevelsTest)
+	{
+		std::mt19937 random(39);
+		const SimdLevel levels[] = { SimdLevel::scalar, SimdLevel::sse2, SimdLevel::avx2, SimdLevel::avx512 };
+
+		for (SimdLevel level : levels)
+		{
+			simd::limitLevel(level);
+
+			for (int round = 0; round < 2000; ++round)
+			{
+				// A small alphabet makes partial matches frequent
+				const char alphabet = static_cast<char>('a' + 1 + random() % 4);
+				std::string text(random() % 300, 'a');
+				for (char& byte : text)
+					byte = static_cast<char>('a' + random() % (alphabet - 'a'));
+
+				std::string pattern;
+				if (!text.empty() && random() % 2 == 0)
+				{
+					const std::size_t first = random() % text.size();
+					pattern = text.substr(first, 1 + random() % 40);
+				}
+				else
+				{
+					pattern.resize(1 + random() % 8);
+					for (char& byte : pattern)
+						byte = static_cast<char>('a' + random() % (alphabet - 'a'));
+				}
+
+				ASSERT_EQ(find(text, pattern), expected(text, pattern)) << text << " / " << pattern;
+				ASSERT_EQ(byte_search::twoWay(text.data(), text.size(), pattern.data(), pattern.size()),
+					expected(text, pattern)) << text << " / " << pattern;
+			}
+		}
+		simd::limitLevel(SimdLevel::avx512);
+	}
+
+	TEST(ByteSearchTest, FindSubstringPathologicalTest)
+	{
+		// Every position matches the first and the last byte, the search switches to Two-Way
+		std::string text(100000, 'a');
+		std::string pattern(1000, 'a');
+		pattern[500] = 'b';
+
+		EXPECT_EQ(find(text, pattern), -1);
+
+		text.replace(70000, pattern.size(), pattern);
+		EXPECT_EQ(find(text, pattern), 70000);
+
+		const std::string periodic = std::string(300, 'a') + "b" + std::string(300, 'a');
+		std::string repeated;
+		for (int count = 0; count < 100; ++count)
+			repeated += std::string(300, 'a') + "b";
+		repeated += std::string(300, 'a');
+
+		EXPECT_EQ(find(repeated, periodic), expected(repeated, periodic));
+		EXPECT_EQ(find(repeated, "ab" + periodic), expected(repeated, "ab" + periodic));
+	}
+}
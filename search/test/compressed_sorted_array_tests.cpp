@@ -0,0 +1,104 @@
+#include "../compressed_sorted_array.h"
+#include "../binary_search.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace CompressedSortedArrayTest
+{
+	const SimdLevel levels[] = { SimdLevel::scalar, SimdLevel::sse2, SimdLevel::avx2, SimdLevel::avx512 };
+
+	template <typename T>
+	void checkAgainstLowerBound(const std::vector<T>& array, const std::vector<T>& queries)
+	{
+		CompressedSortedArray<T> compressed(array.data(), array.size());
+		ASSERT_EQ(compressed.getSize(), array.size());
+
+		for (std::size_t i = 0; i < array.size(); ++i)
+			ASSERT_EQ(compressed[i], array[i]);
+
+		for (SimdLevel level : levels)
+		{
+			simd::limitLevel(level);
+
+			for (const T& key : queries)
+			{
+				const auto expected = std::lower_bound(array.begin(), array.end(), key) - array.begin();
+				ASSERT_EQ(compressed.lowerBound(key), static_cast<std::size_t>(expected)) << "key " << key;
+				EXPECT_EQ(compressed.contains(key), std::binary_search(array.begin(), array.end(), key));
+			}
+		}
+
+		simd::limitLevel(SimdLevel::avx512);
+	}
+
+	TEST(CompressedSortedArrayTest, CompressedSortedArrayMainTest)
+	{
+		auto* array = new int64_t[33];
+		for (int64_t i = 0; i <= 32; ++i)
+			array[i] = i * i * i * i;
+
+		CompressedSortedArray<int64_t> compressed(array, 33);
+
+		// Same results as binarySearch
+		EXPECT_EQ(compressed.find(0), binarySearch(array, 0, 0, 33));
+		EXPECT_EQ(compressed.find(65536), binarySearch(array, 65536, 0, 33));
+		EXPECT_EQ(compressed.find(1048576), binarySearch(array, 1048576, 0, 33));
+		EXPECT_EQ(compressed.find(17), -1);
+
+		delete[] array;
+	}
+
+	TEST(CompressedSortedArrayTest, CompressedSortedArrayDenseIds)
+	{
+		std::mt19937_64 random(3);
+		std::vector<uint64_t> array;
+		uint64_t id = 1ULL << 40;
+		for (int i = 0; i < 100000; ++i)
+		{
+			id += 1 + random() % 16;
+			array.push_back(id);
+		}
+
+		std::vector<uint64_t> queries;
+		for (std::size_t i = 0; i < array.size(); i += 13)
+		{
+			queries.push_back(array[i]);
+			queries.push_back(array[i] + 1);
+			queries.push_back(array[i] - 1);
+		}
+		queries.push_back(0);
+		queries.push_back(UINT64_MAX);
+		checkAgainstLowerBound(array, queries);
+
+		CompressedSortedArray<uint64_t> compressed(array.data(), array.size());
+		EXPECT_LT(compressed.getSizeInBytes() * 5, array.size() * sizeof(uint64_t));
+	}
+
+	TEST(CompressedSortedArrayTest, CompressedSortedArrayWidthsAndDuplicates)
+	{
+		// Full 64-bit range, a run of duplicates, an all-equal block and a partial last block
+		std::vector<int64_t> array = { INT64_MIN, INT64_MIN + 1, -1000, 0, 0, 0, 5, INT64_MAX - 7, INT64_MAX };
+		array.insert(array.begin() + 4, 300, 0);
+		std::vector<int64_t> queries = array;
+		for (int64_t key : { INT64_MIN + 2, int64_t(-1), int64_t(1), int64_t(6), INT64_MAX - 1 })
+			queries.push_back(key);
+		checkAgainstLowerBound(array, queries);
+
+		std::vector<uint32_t> small;
+		for (uint32_t i = 0; i < 1000; ++i)
+			small.push_back(i * i);
+		std::vector<uint32_t> smallQueries;
+		for (uint32_t i = 0; i < 1001000; i += 331)
+			smallQueries.push_back(i);
+		checkAgainstLowerBound(small, smallQueries);
+	}
+
+	TEST(CompressedSortedArrayTest, CompressedSortedArrayEmpty)
+	{
+		CompressedSortedArray<uint64_t> compressed(nullptr, 0);
+		EXPECT_EQ(compressed.lowerBound(5), 0u);
+		EXPECT_FALSE(compressed.contains(5));
+	}
+}
@@ -0,0 +1,119 @@
+#include "../integer_set.h"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <set>
+
+namespace IntegerSetTest
+{
+	template <typename T>
+	void checkAgainstSet(const IntegerSet<T>& integers, const std::set<T>& expected, T key)
+	{
+		ASSERT_EQ(integers.contains(key), expected.count(key) == 1) << "key " << +key;
+
+		T result = 0;
+		auto next = expected.upper_bound(key);
+		ASSERT_EQ(integers.successor(key, result), next != expected.end()) << "key " << +key;
+		if (next != expected.end())
+		{
+			ASSERT_EQ(result, *next) << "key " << +key;
+		}
+
+		auto previous = expected.lower_bound(key);
+		ASSERT_EQ(integers.predecessor(key, result), previous != expected.begin()) << "key " << +key;
+		if (previous != expected.begin())
+		{
+			ASSERT_EQ(result, *--previous) << "key " << +key;
+		}
+	}
+
+	TEST(IntegerSetTest, IntegerSetMainTest)
+	{
+		IntegerSet<uint32_t> integers;
+		uint32_t result = 0;
+
+		EXPECT_FALSE(integers.getMin(result));
+		EXPECT_FALSE(integers.successor(0, result));
+
+		EXPECT_TRUE(integers.insert(10));
+		EXPECT_TRUE(integers.insert(1000000));
+		EXPECT_TRUE(integers.insert(4000000000u));
+		EXPECT_FALSE(integers.insert(10));
+		EXPECT_EQ(integers.getSize(), 3u);
+
+		EXPECT_TRUE(integers.successor(10, result));
+		EXPECT_EQ(result, 1000000u);
+		EXPECT_TRUE(integers.predecessor(4000000000u, result));
+		EXPECT_EQ(result, 1000000u);
+		EXPECT_FALSE(integers.predecessor(10, result));
+		EXPECT_FALSE(integers.successor(4000000000u, result));
+
+		EXPECT_TRUE(integers.getMin(result));
+		EXPECT_EQ(result, 10u);
+		EXPECT_TRUE(integers.getMax(result));
+		EXPECT_EQ(result, 4000000000u);
+
+		EXPECT_TRUE(integers.erase(1000000));
+		EXPECT_FALSE(integers.erase(1000000));
+		EXPECT_TRUE(integers.successor(10, result));
+		EXPECT_EQ(result, 4000000000u);
+	}
+
+	TEST(IntegerSetTest, IntegerSetAllBytes)
+	{
+		IntegerSet<int8_t> integers;
+		std::set<int8_t> expected;
+
+		for (int value = -128; value < 128; value += 3)
+		{
+			integers.insert(static_cast<int8_t>(value));
+			expected.insert(static_cast<int8_t>(value));
+		}
+
+		for (int key = -128; key < 128; ++key)
+			checkAgainstSet(integers, expected, static_cast<int8_t>(key));
+	}
+
+	TEST(IntegerSetTest, IntegerSetRandomOperations)
+	{
+		std::mt19937_64 random(11);
+		IntegerSet<int64_t> integers;
+		std::set<int64_t> expected;
+
+		const int64_t extremes[] = { std::numeric_limits<int64_t>::min(), -1, 0, 1, std::numeric_limits<int64_t>::max() };
+		for (int64_t value : extremes)
+		{
+			integers.insert(value);
+			expected.insert(value);
+		}
+
+		for (int i = 0; i < 200000; ++i)
+		{
+			// Clustered keys share the deep nodes, the others spread over the whole range
+			const int64_t value = (i % 2 == 0) ? static_cast<int64_t>(random() % 5000) : static_cast<int64_t>(random());
+
+			if (random() % 3 == 0)
+				ASSERT_EQ(integers.erase(value), expected.erase(value) == 1);
+			else
+				ASSERT_EQ(integers.insert(value), expected.insert(value).second);
+
+			if (i % 97 == 0)
+				checkAgainstSet(integers, expected, value);
+		}
+
+		EXPECT_EQ(integers.getSize(), expected.size());
+		for (int64_t key = -100; key < 6000; ++key)
+			checkAgainstSet(integers, expected, key);
+		for (int64_t value : extremes)
+			checkAgainstSet(integers, expected, value);
+
+		for (int64_t value : expected)
+			ASSERT_TRUE(integers.erase(value));
+		EXPECT_EQ(integers.getSize(), 0u);
+
+		int64_t result = 0;
+		EXPECT_FALSE(integers.getMax(result));
+		EXPECT_FALSE(integers.successor(std::numeric_limits<int64_t>::min(), result));
+	}
+}
@@ -0,0 +1,121 @@
+#include "../learned_index.h"
+#include "../binary_search.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace LearnedIndexTest
+{
+	template <typename T>
+	void checkAgainstLowerBound(const std::vector<T>& array, const std::vector<T>& queries, std::size_t epsilon)
+	{
+		LearnedIndex<T> index(array.data(), array.size(), epsilon);
+
+		for (const T& key : queries)
+		{
+			const auto expected = std::lower_bound(array.begin(), array.end(), key) - array.begin();
+			ASSERT_EQ(index.lowerBound(key), static_cast<std::size_t>(expected)) << "key " << key;
+		}
+	}
+
+	TEST(LearnedIndexTest, LearnedIndexMainTest)
+	{
+		auto* array = new int64_t[33];
+		for (int64_t i = 0; i <= 32; ++i)
+			array[i] = i * i * i * i;
+
+		LearnedIndex<int64_t> index(array, 33, 2);
+
+		// Same results as binarySearch
+		EXPECT_EQ(index.find(0), binarySearch(array, 0, 0, 33));
+		EXPECT_EQ(index.find(65536), binarySearch(array, 65536, 0, 33));
+		EXPECT_EQ(index.find(1048576), binarySearch(array, 1048576, 0, 33));
+		EXPECT_EQ(index.find(5), -1);
+		EXPECT_EQ(index.find(2000000), -1);
+
+		delete[] array;
+	}
+
+	TEST(LearnedIndexTest, LearnedIndexSmoothDistribution)
+	{
+		std::mt19937_64 random(42);
+		std::vector<uint64_t> array(200000);
+		for (auto& key : array)
+			key = random() >> 20;
+		std::sort(array.begin(), array.end());
+
+		std::vector<uint64_t> queries(array.begin(), array.begin() + 1000);
+		for (int i = 0; i < 20000; ++i)
+			queries.push_back(random() >> 20);
+		queries.push_back(0);
+		queries.push_back(UINT64_MAX);
+
+		for (std::size_t epsilon : { 0, 1, 8, 64, 256 })
+			checkAgainstLowerBound(array, queries, epsilon);
+
+		LearnedIndex<uint64_t> index(array.data(), array.size(), 64);
+		EXPECT_LT(index.getSizeInBytes(), array.size() * sizeof(uint64_t) / 50);
+		EXPECT_GT(index.getLevelCount(), 1u);
+
+		for (std::size_t i = 0; i < array.size(); i += 97)
+			EXPECT_EQ(array[index.find(array[i])], array[i]);
+	}
+
+	TEST(LearnedIndexTest, LearnedIndexDuplicatesAndSkew)
+	{
+		std::vector<int32_t> array;
+		for (int32_t i = -5000; i < 5000; ++i)
+		{
+			const int32_t key = (i < 0 ? -1 : 1) * (i / 10) * (i / 10);
+			array.push_back(key);
+		}
+		// A long run of one key
+		array.insert(array.end(), 10000, 30000000);
+		std::sort(array.begin(), array.end());
+
+		std::vector<int32_t> queries;
+		for (int32_t key = -260000; key <= 260000; key += 7)
+			queries.push_back(key);
+		queries.push_back(30000000);
+		queries.push_back(30000001);
+		queries.push_back(INT32_MIN);
+		queries.push_back(INT32_MAX);
+
+		for (std::size_t epsilon : { 1, 4, 32 })
+			checkAgainstLowerBound(array, queries, epsilon);
+	}
+
+	TEST(LearnedIndexTest, LearnedIndexExtremeAndFloatingKeys)
+	{
+		const std::vector<int64_t> extremes = { INT64_MIN, INT64_MIN + 1, -3, 0, 5, INT64_MAX - 1, INT64_MAX };
+		checkAgainstLowerBound(extremes, extremes, 1);
+		checkAgainstLowerBound(extremes, { -4, 1, 6, INT64_MAX - 2 }, 1);
+
+		std::vector<double> array;
+		for (int i = 0; i < 50000; ++i)
+			array.push_back(std::exp(i / 5000.0));
+
+		std::vector<double> queries(array.begin(), array.end());
+		queries.push_back(0.5);
+		queries.push_back(1e9);
+		queries.push_back(2.5);
+		checkAgainstLowerBound(array, queries, 16);
+	}
+
+	TEST(LearnedIndexTest, LearnedIndexEmptyAndSingle)
+	{
+		LearnedIndex<int> empty(nullptr, 0);
+		EXPECT_EQ(empty.lowerBound(5), 0u);
+		EXPECT_EQ(empty.find(5), -1);
+		EXPECT_EQ(empty.getSegmentCount(), 0u);
+
+		const int single[1] = { 7 };
+		LearnedIndex<int> index(single, 1);
+		EXPECT_EQ(index.find(7), 0);
+		EXPECT_EQ(index.lowerBound(8), 1u);
+		EXPECT_EQ(index.lowerBound(6), 0u);
+	}
+}
@@ -0,0 +1,160 @@
+#include "../linear_scan.h"
+#include <gtest/gtest.h>
+#include <string>
+
+namespace LinearScanTest
+{
+	const SimdLevel levels[] = { SimdLevel::scalar, SimdLevel::sse2, SimdLevel::avx2, SimdLevel::avx512 };
+
+	template <typename T>
+	void checkCountAndFindAll()
+	{
+		const int size = 500;
+		T array[size];
+		for (int i = 0; i < size; ++i)
+			array[i] = static_cast<T>(i % 7);
+
+		int64_t indices[size];
+
+		for (SimdLevel level : levels)
+		{
+			simd::limitLevel(level);
+
+			for (int offset = 0; offset < 5; ++offset)
+			{
+				for (int key = 0; key < 8; ++key)
+				{
+					int64_t expected = 0;
+					for (int i = offset; i < size; ++i)
+						if (i % 7 == key)
+							++expected;
+
+					EXPECT_EQ(linearCount(array + offset, size - offset, static_cast<T>(key)), expected);
+					ASSERT_EQ(linearFindAll(array + offset, size - offset, static_cast<T>(key), indices, size), expected);
+
+					for (int64_t i = 0; i < expected; ++i)
+						EXPECT_EQ(array[offset + indices[i]], static_cast<T>(key));
+					for (int64_t i = 1; i < expected; ++i)
+						EXPECT_EQ(indices[i] - indices[i - 1], 7);
+				}
+			}
+		}
+
+		simd::limitLevel(SimdLevel::avx512);
+	}
+
+	TEST(LinearScanTest, LinearCountAndFindAll)
+	{
+		checkCountAndFindAll<int8_t>();
+		checkCountAndFindAll<uint16_t>();
+		checkCountAndFindAll<int32_t>();
+		checkCountAndFindAll<int64_t>();
+		checkCountAndFindAll<float>();
+		checkCountAndFindAll<double>();
+	}
+
+	TEST(LinearScanTest, LinearFindAllCapacity)
+	{
+		int16_t array[100] = {};
+		int64_t indices[10];
+
+		EXPECT_EQ(linearFindAll(array, 100, 0, indices, 10), 10);
+		EXPECT_EQ(indices[9], 9);
+
+		// Continues after the last returned index
+		EXPECT_EQ(linearFindAll(array + 10, 90, 0, indices, 10), 10);
+		EXPECT_EQ(indices[0], 0);
+		EXPECT_EQ(linearFindAll(array, 100, 0, indices, 0), 0);
+	}
+
+	TEST(LinearScanTest, LinearFindAny)
+	{
+		const int size = 20000;
+		auto* array = new int32_t[size];
+		for (int i = 0; i < size; ++i)
+			array[i] = i;
+
+		int32_t keys[40];
+		for (int i = 0; i < 40; ++i)
+			keys[i] = 19999 - i * 300;
+
+		for (SimdLevel level : levels)
+		{
+			simd::limitLevel(level);
+
+			// Small key set, all keys compared in one pass
+			EXPECT_EQ(linearFindAny(array, size, keys, 4), 19999 - 3 * 300);
+			// Large key set, processed in key groups per block
+			EXPECT_EQ(linearFindAny(array, size, keys, 40), 19999 - 39 * 300);
+
+			const int64_t missing[3] = { -1, 20000, 1 << 30 };
+			EXPECT_EQ(linearFindAny(array, size, missing, 3), -1);
+			EXPECT_EQ(linearFindAny(array, size, keys, 0), -1);
+		}
+
+		simd::limitLevel(SimdLevel::avx512);
+		delete[] array;
+	}
+
+	template <typename T_ARRAY, typename T_KEY>
+	void checkMixedSignedness(T_ARRAY value, T_KEY key)
+	{
+		const int size = 200;
+		T_ARRAY array[size];
+		for (int i = 0; i < size; ++i)
+			array[i] = static_cast<T_ARRAY>(i % 3 == 0 ? value : i % 50);
+
+		int64_t expected = 0;
+		int64_t first = -1;
+		for (int i = 0; i < size; ++i)
+		{
+			if (array[i] == key)
+			{
+				++expected;
+				if (first < 0)
+					first = i;
+			}
+		}
+
+		const T_KEY keys[2] = { key, static_cast<T_KEY>(99) };
+		int64_t indices[size];
+
+		for (SimdLevel level : levels)
+		{
+			simd::limitLevel(level);
+
+			EXPECT_EQ(linearCount(array, size, key), expected);
+			ASSERT_EQ(linearFindAll(array, size, key, indices, size), expected);
+			if (expected > 0)
+				EXPECT_EQ(indices[0], first);
+			EXPECT_EQ(linearFindAny(array, size, keys, 2), first);
+		}
+
+		simd::limitLevel(SimdLevel::avx512);
+	}
+
+	TEST(LinearScanTest, LinearScanMixedSignedness)
+	{
+		// Promoted to int, the bit patterns match but the values do not
+		checkMixedSignedness<int8_t, uint8_t>(-56, 200);
+		checkMixedSignedness<uint8_t, int8_t>(200, -56);
+		checkMixedSignedness<uint16_t, int16_t>(65535, -1);
+		checkMixedSignedness<int16_t, uint16_t>(-1, 65535);
+
+		// Converted to unsigned, they do match
+		checkMixedSignedness<uint32_t, int32_t>(4294967295u, -1);
+		checkMixedSignedness<int32_t, uint32_t>(-1, 4294967295u);
+	}
+
+	TEST(LinearScanTest, LinearScanGenericType)
+	{
+		const std::string array[5] = { "a", "b", "a", "c", "a" };
+		const std::string keys[2] = { "c", "b" };
+		int64_t indices[5];
+
+		EXPECT_EQ(linearCount(array, 5, std::string("a")), 3);
+		EXPECT_EQ(linearFindAll(array, 5, std::string("a"), indices, 5), 3);
+		EXPECT_EQ(indices[2], 4);
+		EXPECT_EQ(linearFindAny(array, 5, keys, 2), 1);
+	}
+}
@@ -18,4 +18,140 @@ namespace LinearSearchTest
 		// 32^4 = 1048576
 		EXPECT_EQ(linearSearch(array, 33, 1048576), 32); 
 	}
-}
\ No newline at end of file
+}
+
+namespace LinearSearchTest
+{
+	template <typename T>
+	void checkEveryPosition(SimdLevel level)
+	{
+		simd::limitLevel(level);
+
+		const int size = 300;
+		T array[size];
+		for (int i = 0; i < size; ++i)
+			array[i] = static_cast<T>(i % 100 + 1);
+
+		// Every start offset checks the unaligned head, every size the tail
+		for (int offset = 0; offset < 8; ++offset)
+		{
+			for (int length = 0; length <= size - offset; length += 7)
+			{
+				for (int key = 0; key <= 101; ++key)
+				{
+					int64_t expected = -1;
+					for (int i = 0; i < length; ++i)
+					{
+						if (array[offset + i] == static_cast<T>(key))
+						{
+							expected = i;
+							break;
+						}
+					}
+					EXPECT_EQ(linearSearch(array + offset, length, static_cast<T>(key)), expected);
+				}
+			}
+		}
+
+		simd::limitLevel(SimdLevel::avx512);
+	}
+
+	template <typename T>
+	void checkAllLevels()
+	{
+		checkEveryPosition<T>(SimdLevel::scalar);
+		checkEveryPosition<T>(SimdLevel::sse2);
+		checkEveryPosition<T>(SimdLevel::avx2);
+		checkEveryPosition<T>(SimdLevel::avx512);
+	}
+
+	TEST(LinearSearchTest, LinearSearchVectorizedIntegers)
+	{
+		checkAllLevels<int8_t>();
+		checkAllLevels<uint8_t>();
+		checkAllLevels<int16_t>();
+		checkAllLevels<uint16_t>();
+		checkAllLevels<int32_t>();
+		checkAllLevels<uint32_t>();
+		checkAllLevels<int64_t>();
+		checkAllLevels<uint64_t>();
+	}
+
+	TEST(LinearSearchTest, LinearSearchVectorizedFloatingPoint)
+	{
+		checkAllLevels<float>();
+		checkAllLevels<double>();
+	}
+
+	TEST(LinearSearchTest, LinearSearchKeyConversion)
+	{
+		uint8_t bytes[64];
+		for (int i = 0; i < 64; ++i)
+			bytes[i] = static_cast<uint8_t>(200 + i % 50);
+
+		// -56 has the same bit pattern as 200 but must not match
+		EXPECT_EQ(linearSearch(bytes, 64, -56), -1);
+		EXPECT_EQ(linearSearch(bytes, 64, 200), 0);
+		EXPECT_EQ(linearSearch(bytes, 64, 456), -1);
+
+		float floats[64];
+		for (int i = 0; i < 64; ++i)
+			floats[i] = i * 0.5f;
+
+		EXPECT_EQ(linearSearch(floats, 64, 3), 6);
+		EXPECT_EQ(linearSearch(floats, 64, 0.1), -1);
+		EXPECT_EQ(linearSearch(floats, 64, 1.5), 3);
+		EXPECT_EQ(linearSearch(floats, 64, -0.0f), 0);
+
+		int32_t ints[64];
+		for (int i = 0; i < 64; ++i)
+			ints[i] = i;
+
+		EXPECT_EQ(linearSearch(ints, 64, 7.0), 7);
+		EXPECT_EQ(linearSearch(ints, 64, 7.5), -1);
+	}
+
+	template <typename T_ARRAY, typename T_KEY>
+	void checkMixedSignedness(T_ARRAY value, T_KEY key)
+	{
+		T_ARRAY array[100];
+		for (int i = 0; i < 100; ++i)
+			array[i] = static_cast<T_ARRAY>(i);
+		array[70] = value;
+
+		int64_t expected = -1;
+		for (int i = 0; i < 100 && expected < 0; ++i)
+			if (array[i] == key)
+				expected = i;
+
+		const SimdLevel levels[] = { SimdLevel::scalar, SimdLevel::sse2, SimdLevel::avx2, SimdLevel::avx512 };
+		for (SimdLevel level : levels)
+		{
+			simd::limitLevel(level);
+			EXPECT_EQ(linearSearch(array, 100, key), expected);
+		}
+		simd::limitLevel(SimdLevel::avx512);
+	}
+
+	TEST(LinearSearchTest, LinearSearchMixedSignedness)
+	{
+		// Promoted to int, the bit patterns match but the values do not
+		checkMixedSignedness<int8_t, uint8_t>(-56, 200);
+		checkMixedSignedness<uint8_t, int8_t>(200, -56);
+		checkMixedSignedness<uint16_t, int16_t>(65535, -1);
+		checkMixedSignedness<int16_t, uint16_t>(-1, 65535);
+
+		// Converted to unsigned, they do match
+		checkMixedSignedness<uint32_t, int32_t>(4294967295u, -1);
+		checkMixedSignedness<int32_t, uint32_t>(-1, 4294967295u);
+		checkMixedSignedness<uint64_t, int64_t>(~uint64_t(0), -1);
+		checkMixedSignedness<int64_t, uint64_t>(-1, ~uint64_t(0));
+	}
+
+	TEST(LinearSearchTest, LinearSearchEmptyArray)
+	{
+		int64_t array[1] = { 0 };
+		EXPECT_EQ(linearSearch(array, 0, 0), -1);
+		EXPECT_EQ(linearSearch(array, -1, 0), -1);
+	}
+}
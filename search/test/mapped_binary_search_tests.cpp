@@ -0,0 +1,108 @@
+#include "../mapped_binary_search.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+namespace MappedBinarySearchTest
+{
+	const char* const fileName = "mapped_binary_search_test.bin";
+
+	/**
+	 * Writes @count records of @recordSize bytes with the strictly
+	 * increasing key i * 3 / 2 at @keyOffset
+	 */
+	void writeRecords(std::size_t count, std::size_t recordSize, std::size_t keyOffset)
+	{
+		std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+		std::vector<char> record(recordSize, 'x');
+
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			const int64_t key = static_cast<int64_t>(i * 3 / 2);
+			std::memcpy(record.data() + keyOffset, &key, sizeof(key));
+			file.write(record.data(), static_cast<std::streamsize>(recordSize));
+		}
+	}
+
+	TEST(MappedBinarySearchTest, MappedBinarySearchMainTest)
+	{
+		const std::size_t count = 100000;
+		writeRecords(count, sizeof(int64_t), 0);
+
+		{
+			MappedSortedFile<int64_t> file(fileName);
+			EXPECT_EQ(file.getSize(), count);
+			EXPECT_LT(file.getFenceCount(), count / 100);
+
+			for (std::size_t i = 0; i < count; i += 37)
+			{
+				const int64_t key = static_cast<int64_t>(i * 3 / 2);
+				const int64_t index = file.find(key);
+				ASSERT_GE(index, 0);
+
+				int64_t found;
+				std::memcpy(&found, file.getRecord(static_cast<std::size_t>(index)), sizeof(found));
+				EXPECT_EQ(found, key);
+			}
+
+			EXPECT_EQ(file.find(-1), -1);
+			EXPECT_EQ(file.find(2), -1);
+			EXPECT_EQ(file.find(static_cast<int64_t>(count * 2)), -1);
+			EXPECT_EQ(file.lowerBound(2), 2u);
+			EXPECT_EQ(file.lowerBound(static_cast<int64_t>(count * 2)), count);
+
+			// Every lookup searches a single page
+			const auto& statistics = file.getStatistics();
+			EXPECT_LE(statistics.pagesTouched, statistics.queries);
+		}
+
+		std::remove(fileName);
+	}
+
+	TEST(MappedBinarySearchTest, MappedBinarySearchWideRecords)
+	{
+		// 12-byte records do not divide the page size, some cross page boundaries
+		const std::size_t count = 50000;
+		writeRecords(count, 12, 4);
+
+		{
+			MappedSortedFile<int64_t> file(fileName, 12, 4);
+			file.prefetch();
+			file.setFaultCounting(true);
+
+			for (std::size_t i = 0; i < count; i += 11)
+			{
+				const int64_t key = static_cast<int64_t>(i * 3 / 2);
+				EXPECT_EQ(file.lowerBound(key), i);
+			}
+
+			const auto& statistics = file.getStatistics();
+			EXPECT_LE(statistics.pagesTouched, 2 * statistics.queries);
+
+			file.resetStatistics();
+			EXPECT_EQ(file.getStatistics().queries, 0u);
+		}
+
+		std::remove(fileName);
+	}
+
+	TEST(MappedBinarySearchTest, MappedBinarySearchErrors)
+	{
+		EXPECT_THROW(MappedSortedFile<int64_t>("missing_file.bin"), std::system_error);
+
+		// 11 records of 12 bytes are not a whole number of 8-byte records
+		writeRecords(11, 12, 0);
+		EXPECT_THROW(MappedSortedFile<int64_t>(fileName, 8, 0), std::invalid_argument);
+		EXPECT_THROW(MappedSortedFile<int64_t>(fileName, 12, 8), std::invalid_argument);
+
+		writeRecords(0, 8, 0);
+		{
+			MappedSortedFile<int64_t> empty(fileName);
+			EXPECT_EQ(empty.getSize(), 0u);
+			EXPECT_EQ(empty.find(0), -1);
+		}
+
+		std::remove(fileName);
+	}
+}
@@ -0,0 +1,59 @@
+#include "../parallel_linear_search.h"
+#include <gtest/gtest.h>
+#include <string>
+
+namespace ParallelLinearSearchTest
+{
+	TEST(ParallelLinearSearchTest, ParallelLinearSearchMainTest)
+	{
+		const int64_t size = 1 << 20;
+		auto* array = new int32_t[size];
+		for (int64_t i = 0; i < size; ++i)
+			array[i] = static_cast<int32_t>(i % 1000);
+
+		for (std::size_t threads = 1; threads <= 8; ++threads)
+		{
+			EXPECT_EQ(parallelLinearSearch(array, size, 0, threads), 0);
+			EXPECT_EQ(parallelLinearSearch(array, size, 999, threads), 999);
+			EXPECT_EQ(parallelLinearSearch(array, size, 1000, threads), -1);
+		}
+
+		delete[] array;
+	}
+
+	TEST(ParallelLinearSearchTest, ParallelLinearSearchReturnsLowestIndex)
+	{
+		const int64_t size = 1 << 21;
+		auto* array = new int64_t[size]();
+
+		// Matches in several chunks, the lowest one has to win
+		array[size - 1] = 7;
+		array[size / 2] = 7;
+		array[size / 3] = 7;
+		array[size / 5 + 3] = 7;
+
+		for (std::size_t threads = 2; threads <= 16; threads *= 2)
+			EXPECT_EQ(parallelLinearSearch(array, size, 7, threads), size / 5 + 3);
+
+		delete[] array;
+	}
+
+	TEST(ParallelLinearSearchTest, ParallelLinearSearchGenericType)
+	{
+		const int size = 100000;
+		auto* array = new std::string[size];
+		for (int i = 0; i < size; ++i)
+			array[i] = std::to_string(i);
+
+		EXPECT_EQ(parallelLinearSearch(array, size, std::string("77777"), 4), 77777);
+		EXPECT_EQ(parallelLinearSearch(array, size, std::string("abc"), 4), -1);
+
+		delete[] array;
+	}
+
+	TEST(ParallelLinearSearchTest, ParallelLinearSearchEmptyArray)
+	{
+		int32_t array[1] = { 0 };
+		EXPECT_EQ(parallelLinearSearch(array, 0, 0, 4), -1);
+	}
+}
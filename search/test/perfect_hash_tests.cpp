@@ -0,0 +1,110 @@
+#include "../perfect_hash.h"
+#include "../linear_search.h"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace PerfectHashTest
+{
+	TEST(PerfectHashTest, PerfectHashMainTest)
+	{
+		auto* array = new int64_t[33];
+		for (int64_t i = 0; i <= 32; ++i)
+			array[i] = i * i * i * i;
+
+		PerfectHashIndex<int64_t> index(array, 33);
+
+		// Same results as linearSearch
+		for (int64_t key = -5; key <= 1048580; key += 7)
+			ASSERT_EQ(index.find(key), linearSearch(array, 33, key)) << "key " << key;
+		for (int64_t i = 0; i <= 32; ++i)
+			ASSERT_EQ(index.find(array[i]), i);
+
+		delete[] array;
+	}
+
+	TEST(PerfectHashTest, PerfectHashRandomKeys)
+	{
+		std::mt19937_64 random(7);
+		std::unordered_set<uint64_t> unique;
+		std::vector<uint64_t> keys;
+		while (keys.size() < 100000)
+		{
+			const uint64_t key = random();
+			if (unique.insert(key).second)
+				keys.push_back(key);
+		}
+
+		PerfectHashIndex<uint64_t> index(keys.data(), keys.size());
+		EXPECT_EQ(index.getSize(), keys.size());
+
+		for (std::size_t i = 0; i < keys.size(); ++i)
+			ASSERT_EQ(index.find(keys[i]), static_cast<int64_t>(i));
+
+		for (int i = 0; i < 100000; ++i)
+		{
+			const uint64_t key = random();
+			ASSERT_EQ(index.contains(key), unique.count(key) == 1);
+		}
+
+		// Pilots and packed positions, against 64 bits per key of the keys themselves
+		EXPECT_LT(index.getSizeInBytes() * 8, keys.size() * 24);
+	}
+
+	TEST(PerfectHashTest, PerfectHashStrings)
+	{
+		std::vector<std::string> keys;
+		for (int i = 0; i < 3000; ++i)
+			keys.push_back("option." + std::to_string(i));
+
+		PerfectHashIndex<std::string> index(keys.data(), keys.size());
+
+		for (std::size_t i = 0; i < keys.size(); ++i)
+			ASSERT_EQ(index.find(keys[i]), static_cast<int64_t>(i));
+		EXPECT_EQ(index.find("option.3000"), -1);
+		EXPECT_EQ(index.find(""), -1);
+	}
+
+	TEST(PerfectHashTest, PerfectHashEdgeCases)
+	{
+		PerfectHashIndex<int> empty(nullptr, 0);
+		EXPECT_EQ(empty.find(1), -1);
+
+		const int single[] = { 42 };
+		PerfectHashIndex<int> one(single, 1);
+		EXPECT_EQ(one.find(42), 0);
+		EXPECT_EQ(one.find(41), -1);
+
+		const int duplicates[] = { 1, 2, 3, 2 };
+		EXPECT_THROW(PerfectHashIndex<int>(duplicates, 4), std::invalid_argument);
+	}
+
+	// Maps 7 and 70 to the same hash
+	struct CollidingHash
+	{
+		std::size_t operator()(int key) const { return static_cast<std::size_t>(key % 63); }
+	};
+
+	TEST(PerfectHashTest, PerfectHashCollidingHashes)
+	{
+		const int keys[] = { 1, 7, 20, 70, 100 };
+		try
+		{
+			PerfectHashIndex<int, CollidingHash> index(keys, 5);
+			FAIL() << "equal hashes were accepted";
+		}
+		catch (const std::invalid_argument& error)
+		{
+			EXPECT_NE(std::string(error.what()).find("hash"), std::string::npos);
+		}
+
+		const int distinct[] = { 1, 7, 20, 100 };
+		PerfectHashIndex<int, CollidingHash> index(distinct, 4);
+		EXPECT_EQ(index.find(7), 1);
+		EXPECT_EQ(index.find(70), -1);
+	}
+}
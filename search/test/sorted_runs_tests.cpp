@@ -0,0 +1,166 @@
+#include "../sorted_runs.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <set>
+#include <string>
+
+namespace SortedRunsTest
+{
+	// Counts how often values are moved or copied, which is the work of the merges
+	struct Counted
+	{
+		static std::size_t moves;
+		int64_t value;
+
+		Counted(int64_t value = 0) : value(value) {}
+		Counted(const Counted& other) : value(other.value) { ++moves; }
+		Counted(Counted&& other) noexcept : value(other.value) { ++moves; }
+		Counted& operator=(const Counted& other) { value = other.value; ++moves; return *this; }
+		Counted& operator=(Counted&& other) noexcept { value = other.value; ++moves; return *this; }
+		bool operator<(const Counted& other) const { return value < other.value; }
+		bool operator==(const Counted& other) const { return value == other.value; }
+	};
+
+	std::size_t Counted::moves = 0;
+
+	struct CountedHash
+	{
+		std::size_t operator()(const Counted& counted) const { return std::hash<int64_t>()(counted.value); }
+	};
+
+	TEST(SortedRunsTest, SortedRunsMainTest)
+	{
+		SortedRuns<int64_t> runs;
+
+		for (int64_t i = 0; i < 10000; ++i)
+			runs.insert(i * 3);
+
+		EXPECT_EQ(runs.getSize(), 10000u);
+		for (int64_t i = 0; i < 30000; ++i)
+			ASSERT_EQ(runs.contains(i), i % 3 == 0) << "key " << i;
+
+		// 10000 = 39 full buffers + 16 buffered values, on 6 levels
+		EXPECT_GE(runs.getRunCount(), 4u);
+		EXPECT_LE(runs.getRunCount(), 18u);
+
+		runs.compact();
+		EXPECT_EQ(runs.getRunCount(), 1u);
+		EXPECT_TRUE(runs.contains(29997));
+		EXPECT_FALSE(runs.contains(29998));
+	}
+
+	TEST(SortedRunsTest, SortedRunsRandomMultiset)
+	{
+		std::mt19937_64 random(5);
+		std::multiset<uint32_t> expected;
+		SortedRuns<uint32_t> runs;
+
+		for (int i = 0; i < 50000; ++i)
+		{
+			const uint32_t value = static_cast<uint32_t>(random() % 20000);
+			expected.insert(value);
+			runs.insert(value);
+
+			if (i % 4999 == 0)
+			{
+				for (uint32_t key = 0; key < 20000; key += 97)
+					ASSERT_EQ(runs.count(key), expected.count(key)) << "key " << key;
+			}
+		}
+
+		for (uint32_t key = 0; key < 21000; ++key)
+			ASSERT_EQ(runs.count(key), expected.count(key)) << "key " << key;
+
+		runs.clear();
+		EXPECT_EQ(runs.getSize(), 0u);
+		EXPECT_FALSE(runs.contains(0));
+	}
+
+	TEST(SortedRunsTest, SortedRunsStrings)
+	{
+		SortedRuns<std::string> runs;
+
+		for (int i = 0; i < 1000; ++i)
+			runs.insert(std::to_string(i));
+
+		EXPECT_TRUE(runs.contains("0"));
+		EXPECT_TRUE(runs.contains("999"));
+		EXPECT_FALSE(runs.contains("1000"));
+		EXPECT_EQ(runs.count("500"), 1u);
+	}
+
+	TEST(SortedRunsTest, SortedRunsFilterFalsePositives)
+	{
+		sorted_runs::RunFilter filter(10000);
+
+		for (uint64_t i = 0; i < 10000; ++i)
+			filter.add(sorted_runs::mix(i));
+
+		for (uint64_t i = 0; i < 10000; ++i)
+			ASSERT_TRUE(filter.mayContain(sorted_runs::mix(i)));
+
+		// About 1% at 10 bits per key and 7 probes
+		std::size_t falsePositives = 0;
+		for (uint64_t i = 10000; i < 110000; ++i)
+			falsePositives += filter.mayContain(sorted_runs::mix(i)) ? 1 : 0;
+
+		EXPECT_LT(falsePositives, 2000u);
+	}
+
+	TEST(SortedRunsTest, SortedRunsBoundedInsertWork)
+	{
+		SortedRuns<Counted, CountedHash> runs;
+		const int64_t count = 1 << 16;
+		std::size_t largest = 0;
+
+		for (int64_t i = 0; i < count; ++i)
+		{
+			const std::size_t before = Counted::moves;
+			runs.insert(Counted((i * 7919) % count));
+			largest = std::max(largest, Counted::moves - before);
+
+			// Values stay visible while the merges that hold them run
+			if (i % 61 == 0)
+			{
+				ASSERT_TRUE(runs.contains(Counted((i * 7919) % count)));
+				ASSERT_TRUE(runs.contains(Counted(((i / 2) * 7919) % count)));
+			}
+		}
+
+		// A synchronous cascade would move all 65536 values in one insert,
+		// here the worst insert sorts a buffer and steps every merge a little
+		EXPECT_LT(largest, 6000u);
+		EXPECT_LE(runs.getRunCount(), 3u * 9u);
+
+		for (int64_t key = 0; key < count; ++key)
+			ASSERT_EQ(runs.count(Counted(key)), 1u) << "key " << key;
+	}
+
+	TEST(SortedRunsTest, SortedRunsCompactKeepsLevels)
+	{
+		SortedRuns<Counted, CountedHash> runs;
+		const int64_t count = 100000;
+		for (int64_t i = 0; i < count; ++i)
+			runs.insert(Counted(i));
+
+		runs.compact();
+		EXPECT_EQ(runs.getRunCount(), 1u);
+		EXPECT_EQ(runs.getSize(), static_cast<std::size_t>(count));
+
+		// The compacted run sits on the level of its size, so the next
+		// buffers are merged among themselves and not into it
+		const std::size_t before = Counted::moves;
+		for (int64_t i = 0; i < 16 * 256; ++i)
+			runs.insert(Counted(count + i));
+		EXPECT_LT(Counted::moves - before, static_cast<std::size_t>(count));
+
+		EXPECT_TRUE(runs.contains(Counted(0)));
+		EXPECT_TRUE(runs.contains(Counted(count - 1)));
+		EXPECT_TRUE(runs.contains(Counted(count + 16 * 256 - 1)));
+		EXPECT_FALSE(runs.contains(Counted(-1)));
+	}
+}
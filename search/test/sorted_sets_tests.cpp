@@ -0,0 +1,88 @@
+#include "../sorted_sets.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace SortedSetsTest
+{
+	template <typename T>
+	std::vector<T> randomSet(std::mt19937_64& random, std::size_t size, uint64_t range)
+	{
+		std::vector<T> set;
+		for (std::size_t i = 0; i < size; ++i)
+			set.push_back(static_cast<T>(random() % range));
+
+		std::sort(set.begin(), set.end());
+		set.erase(std::unique(set.begin(), set.end()), set.end());
+		return set;
+	}
+
+	template <typename T>
+	void checkAgainstStd(const std::vector<T>& a, const std::vector<T>& b)
+	{
+		std::vector<T> expected;
+		std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+
+		std::vector<T> out(std::min(a.size(), b.size()) + 1);
+		const std::size_t written = intersectSorted(a.data(), a.size(), b.data(), b.size(), out.data());
+		out.resize(written);
+		ASSERT_EQ(out, expected);
+
+		expected.clear();
+		std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+
+		out.assign(a.size() + b.size() + 1, T());
+		const std::size_t united = unionSorted(a.data(), a.size(), b.data(), b.size(), out.data());
+		out.resize(united);
+		ASSERT_EQ(out, expected);
+	}
+
+	template <typename T>
+	void checkSizes()
+	{
+		std::mt19937_64 random(7);
+		const std::size_t sizes[] = { 0, 1, 3, 17, 100, 1000, 5000 };
+
+		for (SimdLevel level : { SimdLevel::scalar, SimdLevel::sse2, SimdLevel::avx2, SimdLevel::avx512 })
+		{
+			simd::limitLevel(level);
+
+			for (std::size_t aSize : sizes)
+				for (std::size_t bSize : sizes)
+					for (uint64_t range : { 50, 3000, 1000000 })
+						checkAgainstStd(randomSet<T>(random, aSize, range), randomSet<T>(random, bSize, range));
+		}
+
+		simd::limitLevel(SimdLevel::avx512);
+	}
+
+	TEST(SortedSetsTest, SortedSetsIntegers)
+	{
+		checkSizes<int32_t>();
+		checkSizes<uint32_t>();
+		checkSizes<int64_t>();
+		checkSizes<uint64_t>();
+		checkSizes<int16_t>();
+	}
+
+	TEST(SortedSetsTest, SortedSetsSkewedSizes)
+	{
+		std::vector<int64_t> large;
+		for (int64_t i = 0; i < 100000; ++i)
+			large.push_back(i * 3);
+
+		const std::vector<int64_t> small = { -5, 0, 7, 9, 150000, 299997, 299998, 400000 };
+		checkAgainstStd(small, large);
+		checkAgainstStd(large, small);
+	}
+
+	TEST(SortedSetsTest, SortedSetsGenericType)
+	{
+		const std::vector<std::string> a = { "apple", "kiwi", "lemon", "plum" };
+		const std::vector<std::string> b = { "banana", "kiwi", "plum", "quince" };
+		checkAgainstStd(a, b);
+	}
+}
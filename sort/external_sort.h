@@ -0,0 +1,396 @@
+﻿/**
+ * @author Dreadblade- (https://github.com/Dreadblade-dev)
+ * External k-way merge sort realization
+ *
+ * Sorts a file of fixed-width records by a key stored at a fixed offset
+ * inside every record (the layout MappedSortedFile searches) when the
+ * file does not fit into memory.
+ *
+ * The input is read in chunks that fit into the memory budget, every
+ * chunk is sorted by its keys with sortAndIndex and written out as a
+ * sorted run. The runs are then merged k at a time. The next record of
+ * the merge is picked by a loser tree: every inner node keeps the loser
+ * of the match played there, so replacing the winner replays a single
+ * leaf-to-root path with log k comparisons. All reads and writes go
+ * through large buffers, so the disk only sees long sequential transfers.
+ * When there are more runs than buffers fit into memory, the runs are
+ * merged in several passes.
+ *
+ * Time complexity (M - records in memory, k - merge fan-in):
+ * ┌────────────────────────┬──────────────────────────────┐
+ * │        Sorting         │        Passes over data      │
+ * ├────────────────────────┼──────────────────────────────┤
+ * │      O(n log n)        │   1 + ceil(log_k (n / M))    │
+ * └────────────────────────┴──────────────────────────────┘
+ *
+ * Source: https://en.wikipedia.org/wiki/External_sorting
+ */
+
+#pragma once
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+#include "sort_and_index.h"
+
+namespace external_sort
+{
+	struct constants
+	{
+		static const std::size_t default_memory_bytes = 256 * 1024 * 1024;
+		static const std::size_t io_buffer_bytes = 4 * 1024 * 1024;
+		// Smaller merge buffers would turn the merge into random I/O, more passes are cheaper
+		static const std::size_t min_buffer_bytes = 64 * 1024;
+		static const std::size_t max_fan_in = 256;
+	};
+
+	struct Statistics
+	{
+		uint64_t records = 0;
+		std::size_t runs = 0;
+		std::size_t mergePasses = 0;
+	};
+
+	/**
+	 * Owns a C file, closes it on destruction
+	 */
+	class File
+	{
+	private:
+		std::FILE* m_file;
+		std::string m_path;
+	public:
+		File(const std::string& path, const char* mode) : m_file(std::fopen(path.c_str(), mode)), m_path(path)
+		{
+			if (m_file == nullptr)
+				throw std::system_error(errno, std::generic_category(), "Cannot open " + path);
+		}
+
+		File(const File&) = delete;
+		File& operator=(const File&) = delete;
+
+		~File()
+		{
+			if (m_file != nullptr)
+				std::fclose(m_file);
+		}
+
+		/**
+		 * Reads up to @size bytes. Returns the number of bytes read, less only at the end of the file
+		 */
+		std::size_t read(void* data, std::size_t size)
+		{
+			const std::size_t count = std::fread(data, 1, size, m_file);
+			if (count < size && std::ferror(m_file))
+				throw std::system_error(errno, std::generic_category(), "Cannot read " + m_path);
+			return count;
+		}
+
+		void write(const void* data, std::size_t size)
+		{
+			if (std::fwrite(data, 1, size, m_file) != size)
+				throw std::system_error(errno, std::generic_category(), "Cannot write " + m_path);
+		}
+
+		void close()
+		{
+			std::FILE* file = m_file;
+			m_file = nullptr;
+			if (std::fclose(file) != 0)
+				throw std::system_error(errno, std::generic_category(), "Cannot write " + m_path);
+		}
+	};
+
+	/**
+	 * Sequential record reader with its own buffer
+	 */
+	class RunReader
+	{
+	private:
+		File m_file;
+		std::vector<unsigned char> m_buffer;
+		std::size_t m_recordSize;
+		std::size_t m_position;
+		std::size_t m_filled;
+	public:
+		RunReader(const std::string& path, std::size_t recordSize, std::size_t bufferBytes)
+			: m_file(path, "rb"), m_buffer(std::max(bufferBytes / recordSize, std::size_t(1)) * recordSize),
+			m_recordSize(recordSize), m_position(0), m_filled(0)
+		{
+			m_filled = m_file.read(m_buffer.data(), m_buffer.size());
+		}
+
+		/**
+		 * Returns the current record or nullptr at the end of the run
+		 */
+		const unsigned char* current() const noexcept
+		{
+			return (m_position < m_filled) ? m_buffer.data() + m_position : nullptr;
+		}
+
+		void next()
+		{
+			m_position += m_recordSize;
+			if (m_position < m_filled)
+				return;
+
+			m_filled = m_file.read(m_buffer.data(), m_buffer.size());
+			m_position = 0;
+		}
+	};
+
+	/**
+	 * Sequential record writer with its own buffer
+	 */
+	class RunWriter
+	{
+	private:
+		File m_file;
+		std::vector<unsigned char> m_buffer;
+		std::size_t m_filled;
+	public:
+		RunWriter(const std::string& path, std::size_t bufferBytes) : m_file(path, "wb"), m_buffer(bufferBytes), m_filled(0)
+		{
+
+		}
+
+		void write(const unsigned char* record, std::size_t size)
+		{
+			if (m_filled + size > m_buffer.size())
+			{
+				m_file.write(m_buffer.data(), m_filled);
+				m_filled = 0;
+			}
+
+			if (size > m_buffer.size())
+				m_file.write(record, size);
+			else
+			{
+				std::memcpy(m_buffer.data() + m_filled, record, size);
+				m_filled += size;
+			}
+		}
+
+		void close()
+		{
+			m_file.write(m_buffer.data(), m_filled);
+			m_filled = 0;
+			m_file.close();
+		}
+	};
+
+	/**
+	 * Tournament tree over k sources that keeps the loser of every match
+	 * in the inner nodes and the overall winner in node 0. @Less compares
+	 * two sources and has to order exhausted sources last
+	 */
+	template <class Less>
+	class LoserTree
+	{
+	private:
+		std::vector<std::size_t> m_nodes;
+		std::size_t m_leaves;
+		Less m_less;
+	public:
+		LoserTree(std::size_t leaves, Less less) : m_nodes(leaves, 0), m_leaves(leaves), m_less(less)
+		{
+			// Play the whole tournament bottom-up: winners[node] won the subtree below node
+			std::vector<std::size_t> winners(2 * leaves);
+			for (std::size_t leaf = 0; leaf < leaves; ++leaf)
+				winners[leaves + leaf] = leaf;
+
+			for (std::size_t node = leaves - 1; node > 0; --node)
+			{
+				const std::size_t left = winners[2 * node];
+				const std::size_t right = winners[2 * node + 1];
+				const bool leftWins = !m_less(right, left);
+
+				winners[node] = leftWins ? left : right;
+				m_nodes[node] = leftWins ? right : left;
+			}
+
+			m_nodes[0] = (leaves > 1) ? winners[1] : 0;
+		}
+
+		std::size_t winner() const noexcept
+		{
+			return m_nodes[0];
+		}
+
+		/**
+		 * Replays the matches of the winner after its source advanced
+		 */
+		void replay()
+		{
+			std::size_t winner = m_nodes[0];
+
+			for (std::size_t node = (winner + m_leaves) / 2; node > 0; node /= 2)
+				if (m_less(m_nodes[node], winner))
+					std::swap(m_nodes[node], winner);
+
+			m_nodes[0] = winner;
+		}
+	};
+
+	template <typename T_KEY>
+	T_KEY keyOf(const unsigned char* record, std::size_t keyOffset) noexcept
+	{
+		T_KEY key;
+		std::memcpy(&key, record + keyOffset, sizeof(T_KEY));
+		return key;
+	}
+
+	/**
+	 * Merges the runs at @inputs into @output with @memoryBytes of buffers
+	 */
+	template <typename T_KEY>
+	void mergeRuns(const std::vector<std::string>& inputs, const std::string& output,
+		std::size_t recordSize, std::size_t keyOffset, std::size_t memoryBytes)
+	{
+		const std::size_t bufferBytes = std::min(std::size_t(constants::io_buffer_bytes), memoryBytes / (inputs.size() + 1));
+
+		std::vector<std::unique_ptr<RunReader>> readers;
+		for (const std::string& input : inputs)
+			readers.emplace_back(new RunReader(input, recordSize, bufferBytes));
+		RunWriter writer(output, std::max(bufferBytes, recordSize));
+
+		// Exhausted runs lose every match, equal keys are taken from the earlier run
+		auto less = [&readers, keyOffset](std::size_t left, std::size_t right)
+		{
+			const unsigned char* leftRecord = readers[left]->current();
+			const unsigned char* rightRecord = readers[right]->current();
+
+			if (leftRecord == nullptr || rightRecord == nullptr)
+				return rightRecord == nullptr && leftRecord != nullptr;
+
+			const T_KEY leftKey = keyOf<T_KEY>(leftRecord, keyOffset);
+			const T_KEY rightKey = keyOf<T_KEY>(rightRecord, keyOffset);
+			return leftKey < rightKey || (!(rightKey < leftKey) && left < right);
+		};
+
+		LoserTree<decltype(less)> tree(readers.size(), less);
+		for (const unsigned char* record = readers[tree.winner()]->current(); record != nullptr;
+			record = readers[tree.winner()]->current())
+		{
+			writer.write(record, recordSize);
+			readers[tree.winner()]->next();
+			tree.replay();
+		}
+
+		writer.close();
+	}
+}
+
+/**
+ * Sorts the fixed-width records of the file at @inputPath by the
+ * T_KEY stored at @keyOffset inside every record and writes them to
+ * @outputPath. At most about @memoryBytes of memory are used, temporary
+ * runs are written next to the output file. Records with equal keys keep
+ * their order. Throws std::invalid_argument for a malformed input and
+ * std::system_error when a file cannot be read or written
+ */
+template <typename T_KEY>
+external_sort::Statistics externalSort(const std::string& inputPath, const std::string& outputPath,
+	std::size_t recordSize = sizeof(T_KEY), std::size_t keyOffset = 0,
+	std::size_t memoryBytes = external_sort::constants::default_memory_bytes)
+{
+	using namespace external_sort;
+
+	if (keyOffset + sizeof(T_KEY) > recordSize)
+		throw std::invalid_argument("Key does not fit into the record");
+
+	// Memory for one record, its key and its position while the chunk is sorted
+	const std::size_t chunkRecords = std::max<std::size_t>(memoryBytes / (recordSize + sizeof(T_KEY) + sizeof(std::size_t)), 1);
+	std::vector<unsigned char> chunk(chunkRecords * recordSize);
+	std::vector<T_KEY> keys;
+	std::vector<std::string> runs;
+	Statistics statistics;
+
+	// Every temporary file ever created, removed at the end or on failure
+	std::vector<std::string> temporaries;
+	auto removeTemporaries = [&temporaries]()
+	{
+		for (const std::string& path : temporaries)
+			std::remove(path.c_str());
+	};
+
+	try
+	{
+		File input(inputPath, "rb");
+
+		for (;;)
+		{
+			const std::size_t bytes = input.read(chunk.data(), chunk.size());
+			if (bytes % recordSize != 0)
+				throw std::invalid_argument("File size is not a multiple of the record size");
+			if (bytes == 0)
+				break;
+
+			const std::size_t count = bytes / recordSize;
+			keys.resize(count);
+			for (std::size_t index = 0; index < count; ++index)
+				keys[index] = keyOf<T_KEY>(chunk.data() + index * recordSize, keyOffset);
+
+			const std::vector<std::size_t> order = sortAndIndex(keys.data(), count);
+
+			temporaries.push_back(outputPath + ".run" + std::to_string(runs.size()));
+			runs.push_back(temporaries.back());
+			RunWriter writer(runs.back(), std::min(std::size_t(constants::io_buffer_bytes), chunk.size()));
+			for (std::size_t position : order)
+				writer.write(chunk.data() + position * recordSize, recordSize);
+			writer.close();
+
+			statistics.records += count;
+			if (bytes < chunk.size())
+				break;
+		}
+
+		statistics.runs = runs.size();
+		chunk = std::vector<unsigned char>();
+		keys = std::vector<T_KEY>();
+
+		const std::size_t buffers = memoryBytes / std::max(std::size_t(constants::min_buffer_bytes), recordSize);
+		// One buffer is left for the output
+		const std::size_t fanIn = std::min(std::size_t(constants::max_fan_in), (buffers > 3) ? buffers - 1 : 2);
+
+		while (runs.size() > fanIn)
+		{
+			std::vector<std::string> merged;
+			for (std::size_t first = 0; first < runs.size(); first += fanIn)
+			{
+				const std::vector<std::string> group(runs.begin() + first, runs.begin() + std::min(first + fanIn, runs.size()));
+				temporaries.push_back(outputPath + ".merge" + std::to_string(statistics.mergePasses) + "_" + std::to_string(merged.size()));
+				merged.push_back(temporaries.back());
+				mergeRuns<T_KEY>(group, merged.back(), recordSize, keyOffset, memoryBytes);
+
+				for (const std::string& path : group)
+					std::remove(path.c_str());
+			}
+
+			runs.swap(merged);
+			++statistics.mergePasses;
+		}
+
+		if (runs.empty())
+			RunWriter(outputPath, recordSize).close();
+		else
+		{
+			mergeRuns<T_KEY>(runs, outputPath, recordSize, keyOffset, memoryBytes);
+			++statistics.mergePasses;
+		}
+	}
+	catch (...)
+	{
+		removeTemporaries();
+		throw;
+	}
+
+	removeTemporaries();
+	return statistics;
+}
@@ -0,0 +1,214 @@
+﻿/**
+ * @author Dreadblade- (https://github.com/Dreadblade-dev)
+ * Parallel merge sort realization
+ *
+ * The array is cut into one run per thread and every run is sorted with
+ * pdqSort. The runs are then merged pairwise, round after round, into a
+ * buffer of the same size and back.
+ *
+ * A single merge of two long runs would leave all but one thread idle
+ * in the last rounds, so every merge is split along its merge path: the
+ * k-th element of the output comes from a prefix of both inputs, and a
+ * binary search on the diagonal i + j = k finds how many elements each
+ * input contributes. Cutting the output into equal slices this way gives
+ * every thread an independent merge of the same length.
+ *
+ * Time complexity (p - number of threads):
+ * ┌────────────────────────────────┬───────────────┐
+ * │            Sorting             │    Memory     │
+ * ├────────────────────────────────┼───────────────┤
+ * │  O(n/p log (n/p) + n/p log p)  │     O(n)      │
+ * └────────────────────────────────┴───────────────┘
+ *
+ * Source: https://en.wikipedia.org/wiki/Merge_sort#Parallel_merge_sort
+ */
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <iterator>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include "pdq_sort.h"
+
+namespace parallel_merge_sort
+{
+	struct constants
+	{
+		// Fewer elements per thread are sorted by a single thread
+		static const std::size_t min_elements_per_thread = 1 << 14;
+	};
+
+	/**
+	 * Runs @task(0) ... @task(@taskCount - 1) on up to @threadCount threads,
+	 * the calling thread included
+	 */
+	template <typename Task>
+	void forEachTask(std::size_t taskCount, std::size_t threadCount, const Task& task)
+	{
+		std::atomic<std::size_t> nextTask(0);
+
+		auto worker = [&]()
+		{
+			for (std::size_t index = nextTask.fetch_add(1); index < taskCount; index = nextTask.fetch_add(1))
+				task(index);
+		};
+
+		std::vector<std::thread> workers;
+		workers.reserve(threadCount - 1);
+		for (std::size_t count = 1; count < threadCount && count < taskCount; ++count)
+		{
+			// Tasks are claimed dynamically, so fewer threads still run all of them
+			try
+			{
+				workers.emplace_back(worker);
+			}
+			catch (const std::system_error&)
+			{
+				break;
+			}
+		}
+
+		worker();
+		for (auto& thread : workers)
+			thread.join();
+	}
+
+	/**
+	 * Returns how many of the first @diagonal elements of the merge of
+	 * @a and @b come from @a. Equal elements are taken from @a first,
+	 * like std::merge does
+	 */
+	template <typename T, typename Compare>
+	std::size_t mergePathSplit(const T* a, std::size_t aSize, const T* b, std::size_t bSize,
+		std::size_t diagonal, Compare comp)
+	{
+		std::size_t low = (diagonal > bSize) ? diagonal - bSize : 0;
+		std::size_t high = (diagonal < aSize) ? diagonal : aSize;
+
+		while (low < high)
+		{
+			const std::size_t middle = low + (high - low) / 2;
+			if (comp(b[diagonal - middle - 1], a[middle]))
+				high = middle;
+			else
+				low = middle + 1;
+		}
+
+		return low;
+	}
+
+	/**
+	 * One slice of the output of merging two neighbouring runs
+	 */
+	struct MergeSlice
+	{
+		std::size_t first;
+		std::size_t middle;
+		std::size_t last;
+		std::size_t outputBegin;
+		std::size_t outputEnd;
+	};
+}
+
+/**
+ * Sorts @size elements of @array in the order defined by @comp using
+ * @threadCount threads (0 - one per hardware thread). Not stable
+ */
+template <typename T, typename Compare>
+void parallelMergeSort(T* array, std::size_t size, std::size_t threadCount, Compare comp)
+{
+	using namespace parallel_merge_sort;
+
+	if (threadCount == 0)
+		threadCount = std::thread::hardware_concurrency();
+	if (threadCount > size / constants::min_elements_per_thread)
+		threadCount = size / constants::min_elements_per_thread;
+	if (threadCount <= 1)
+	{
+		pdqSort(array, size, comp);
+		return;
+	}
+
+	std::vector<std::size_t> bounds;
+	for (std::size_t run = 0; run <= threadCount; ++run)
+		bounds.push_back(size / threadCount * run + std::min(run, size % threadCount));
+
+	forEachTask(threadCount, threadCount, [&](std::size_t run)
+	{
+		pdqSort(array + bounds[run], bounds[run + 1] - bounds[run], comp);
+	});
+
+	std::vector<T> buffer(size);
+	T* source = array;
+	T* target = buffer.data();
+	std::vector<MergeSlice> slices;
+
+	while (bounds.size() > 2)
+	{
+		std::vector<std::size_t> merged;
+		slices.clear();
+
+		for (std::size_t run = 0; run + 1 < bounds.size(); run += 2)
+		{
+			merged.push_back(bounds[run]);
+
+			// A run without a partner is copied as a merge with an empty run
+			const std::size_t first = bounds[run];
+			const std::size_t middle = bounds[run + 1];
+			const std::size_t last = (run + 2 < bounds.size()) ? bounds[run + 2] : middle;
+
+			// Slices proportional to the merge length keep the threads equally busy
+			const std::size_t length = last - first;
+			const std::size_t sliceCount = std::max<std::size_t>(1, threadCount * length / size);
+			for (std::size_t slice = 0; slice < sliceCount; ++slice)
+				slices.push_back({ first, middle, last,
+					first + length / sliceCount * slice + std::min(slice, length % sliceCount),
+					first + length / sliceCount * (slice + 1) + std::min(slice + 1, length % sliceCount) });
+		}
+		merged.push_back(size);
+
+		forEachTask(slices.size(), threadCount, [&](std::size_t index)
+		{
+			const MergeSlice& slice = slices[index];
+			const T* a = source + slice.first;
+			const T* b = source + slice.middle;
+			const std::size_t aSize = slice.middle - slice.first;
+			const std::size_t bSize = slice.last - slice.middle;
+
+			const std::size_t aBegin = mergePathSplit(a, aSize, b, bSize, slice.outputBegin - slice.first, comp);
+			const std::size_t aEnd = mergePathSplit(a, aSize, b, bSize, slice.outputEnd - slice.first, comp);
+			const std::size_t bBegin = slice.outputBegin - slice.first - aBegin;
+			const std::size_t bEnd = slice.outputEnd - slice.first - aEnd;
+
+			std::merge(std::make_move_iterator(source + slice.first + aBegin), std::make_move_iterator(source + slice.first + aEnd),
+				std::make_move_iterator(source + slice.middle + bBegin), std::make_move_iterator(source + slice.middle + bEnd),
+				target + slice.outputBegin, comp);
+		});
+
+		bounds.swap(merged);
+		std::swap(source, target);
+	}
+
+	if (source != array)
+	{
+		forEachTask(threadCount, threadCount, [&](std::size_t part)
+		{
+			const std::size_t begin = size / threadCount * part;
+			const std::size_t end = (part + 1 == threadCount) ? size : begin + size / threadCount;
+			std::move(source + begin, source + end, array + begin);
+		});
+	}
+}
+
+/**
+ * Sorts @size elements of @array in ascending order using
+ * @threadCount threads (0 - one per hardware thread). Not stable
+ */
+template <typename T>
+void parallelMergeSort(T* array, std::size_t size, std::size_t threadCount = 0)
+{
+	parallelMergeSort(array, size, threadCount, std::less<T>());
+}
@@ -0,0 +1,484 @@
+﻿/**
+ * @author Dreadblade- (https://github.com/Dreadblade-dev)
+ * Pattern-defeating quicksort realization
+ *
+ * Pattern-defeating quicksort is an introsort variant that keeps the
+ * O(n log n) worst case of heapsort and the speed of quicksort on random
+ * data while recognizing common patterns:
+ *  - the pivot is the median of 3 elements, or a ninther for large ranges;
+ *  - a partition that swapped nothing is finished with a bounded
+ *    insertion sort, so sorted and reverse sorted input take O(n);
+ *  - a pivot equal to the element before the range moves all equal
+ *    elements to the left at once, so many duplicates take O(n k);
+ *  - unbalanced partitions shuffle a few elements to break adversarial
+ *    patterns, after log n of them the range is heapsorted.
+ *
+ * Arithmetic types compared with std::less are partitioned without
+ * branches: element offsets are collected in blocks and swapped
+ * afterwards (BlockQuicksort), which avoids branch mispredictions.
+ *
+ * Time complexity:
+ * ┌────────────────┬────────────────┬───────────────┐
+ * │   Worst-case   │  Average-case  │   Best-case   │
+ * ├────────────────┼────────────────┼───────────────┤
+ * │   O(n log n)   │   O(n log n)   │     O(n)      │
+ * └────────────────┴────────────────┴───────────────┘
+ *
+ * Source: https://arxiv.org/abs/2106.05123
+ */
+
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+namespace pdq_sort
+{
+	struct constants
+	{
+		static const std::size_t insertion_sort_threshold = 24;
+		static const std::size_t ninther_threshold = 128;
+		static const std::size_t partial_insertion_sort_limit = 8;
+		static const std::size_t block_size = 64;
+	};
+
+	/**
+	 * Branchless partitioning pays off when the comparison is cheap and
+	 * cannot be predicted
+	 */
+	template <typename T, typename Compare>
+	struct isBranchless : std::integral_constant<bool, std::is_arithmetic<T>::value &&
+		(std::is_same<Compare, std::less<T>>::value || std::is_same<Compare, std::greater<T>>::value)>
+	{
+	};
+
+	template <typename T, typename Compare>
+	void insertionSort(T* begin, T* end, Compare comp)
+	{
+		if (begin == end)
+			return;
+
+		for (T* current = begin + 1; current != end; ++current)
+		{
+			T* sift = current;
+			T* siftPrevious = current - 1;
+
+			if (comp(*sift, *siftPrevious))
+			{
+				T value = std::move(*sift);
+				do
+				{
+					*sift-- = std::move(*siftPrevious);
+				} while (sift != begin && comp(value, *--siftPrevious));
+
+				*sift = std::move(value);
+			}
+		}
+	}
+
+	/**
+	 * Insertion sort for a range whose predecessor is not greater than
+	 * any of its elements, the predecessor stops the sift
+	 */
+	template <typename T, typename Compare>
+	void unguardedInsertionSort(T* begin, T* end, Compare comp)
+	{
+		if (begin == end)
+			return;
+
+		for (T* current = begin + 1; current != end; ++current)
+		{
+			T* sift = current;
+			T* siftPrevious = current - 1;
+
+			if (comp(*sift, *siftPrevious))
+			{
+				T value = std::move(*sift);
+				do
+				{
+					*sift-- = std::move(*siftPrevious);
+				} while (comp(value, *--siftPrevious));
+
+				*sift = std::move(value);
+			}
+		}
+	}
+
+	/**
+	 * Insertion sort that gives up after moving more than
+	 * partial_insertion_sort_limit elements. Returns @true if the range is sorted
+	 */
+	template <typename T, typename Compare>
+	bool partialInsertionSort(T* begin, T* end, Compare comp)
+	{
+		if (begin == end)
+			return true;
+
+		std::size_t moved = 0;
+		for (T* current = begin + 1; current != end; ++current)
+		{
+			T* sift = current;
+			T* siftPrevious = current - 1;
+
+			if (comp(*sift, *siftPrevious))
+			{
+				T value = std::move(*sift);
+				do
+				{
+					*sift-- = std::move(*siftPrevious);
+				} while (sift != begin && comp(value, *--siftPrevious));
+
+				*sift = std::move(value);
+				moved += static_cast<std::size_t>(current - sift);
+			}
+
+			if (moved > constants::partial_insertion_sort_limit)
+				return false;
+		}
+
+		return true;
+	}
+
+	template <typename T, typename Compare>
+	void sort2(T* a, T* b, Compare comp)
+	{
+		if (comp(*b, *a))
+			std::iter_swap(a, b);
+	}
+
+	template <typename T, typename Compare>
+	void sort3(T* a, T* b, T* c, Compare comp)
+	{
+		sort2(a, b, comp);
+		sort2(b, c, comp);
+		sort2(a, b, comp);
+	}
+
+	/**
+	 * Moves @count pairs of misplaced elements found by the block partition
+	 */
+	template <typename T>
+	void swapOffsets(T* first, T* last, const unsigned char* offsetsLeft, const unsigned char* offsetsRight,
+		std::size_t count, bool useSwaps)
+	{
+		if (useSwaps)
+		{
+			// Plain swaps keep descending input O(n)
+			for (std::size_t i = 0; i < count; ++i)
+				std::iter_swap(first + offsetsLeft[i], last - offsetsRight[i]);
+		}
+		else if (count > 0)
+		{
+			// A cyclic permutation needs one move instead of three per element
+			T* left = first + offsetsLeft[0];
+			T* right = last - offsetsRight[0];
+			T value = std::move(*left);
+			*left = std::move(*right);
+
+			for (std::size_t i = 1; i < count; ++i)
+			{
+				left = first + offsetsLeft[i];
+				*right = std::move(*left);
+				right = last - offsetsRight[i];
+				*left = std::move(*right);
+			}
+
+			*right = std::move(value);
+		}
+	}
+
+	/**
+	 * Partitions [@begin, @end) around *@begin, elements equal to the pivot
+	 * go to the right. Returns the pivot position and whether the range
+	 * was already partitioned
+	 */
+	template <typename T, typename Compare>
+	std::pair<T*, bool> partitionRight(T* begin, T* end, Compare comp)
+	{
+		T pivot = std::move(*begin);
+		T* first = begin;
+		T* last = end;
+
+		// The median-of-3 guarantees an element not less than the pivot on the right
+		while (comp(*++first, pivot));
+
+		// No such guarantee on the left when the first element was already in place
+		if (first - 1 == begin)
+			while (first < last && !comp(*--last, pivot));
+		else
+			while (!comp(*--last, pivot));
+
+		const bool alreadyPartitioned = first >= last;
+
+		while (first < last)
+		{
+			std::iter_swap(first, last);
+			while (comp(*++first, pivot));
+			while (!comp(*--last, pivot));
+		}
+
+		T* pivotPosition = first - 1;
+		*begin = std::move(*pivotPosition);
+		*pivotPosition = std::move(pivot);
+
+		return std::make_pair(pivotPosition, alreadyPartitioned);
+	}
+
+	/**
+	 * partitionRight without data-dependent branches in the inner loops
+	 */
+	template <typename T, typename Compare>
+	std::pair<T*, bool> partitionRightBranchless(T* begin, T* end, Compare comp)
+	{
+		T pivot = std::move(*begin);
+		T* first = begin;
+		T* last = end;
+
+		while (comp(*++first, pivot));
+
+		if (first - 1 == begin)
+			while (first < last && !comp(*--last, pivot));
+		else
+			while (!comp(*--last, pivot));
+
+		const bool alreadyPartitioned = first >= last;
+
+		if (!alreadyPartitioned)
+		{
+			std::iter_swap(first, last);
+			++first;
+
+			alignas(64) unsigned char offsetsLeft[constants::block_size];
+			alignas(64) unsigned char offsetsRight[constants::block_size];
+			T* leftBase = first;
+			T* rightBase = last;
+			std::size_t countLeft = 0;
+			std::size_t countRight = 0;
+			std::size_t startLeft = 0;
+			std::size_t startRight = 0;
+
+			while (first < last)
+			{
+				// Refill the offset blocks that have run empty, splitting the unknown elements between them
+				const std::size_t unknown = static_cast<std::size_t>(last - first);
+				const std::size_t leftSplit = (countLeft == 0) ? ((countRight == 0) ? unknown / 2 : unknown) : 0;
+				const std::size_t rightSplit = (countRight == 0) ? (unknown - leftSplit) : 0;
+
+				const std::size_t leftScan = (leftSplit < constants::block_size) ? leftSplit : constants::block_size;
+				for (std::size_t i = 0; i < leftScan; ++i)
+				{
+					offsetsLeft[countLeft] = static_cast<unsigned char>(i);
+					countLeft += !comp(*first, pivot);
+					++first;
+				}
+
+				const std::size_t rightScan = (rightSplit < constants::block_size) ? rightSplit : constants::block_size;
+				for (std::size_t i = 0; i < rightScan;)
+				{
+					offsetsRight[countRight] = static_cast<unsigned char>(++i);
+					countRight += comp(*--last, pivot);
+				}
+
+				const std::size_t count = std::min(countLeft, countRight);
+				swapOffsets(leftBase, rightBase, offsetsLeft + startLeft, offsetsRight + startRight,
+					count, countLeft == countRight);
+				countLeft -= count;
+				countRight -= count;
+				startLeft += count;
+				startRight += count;
+
+				if (countLeft == 0)
+				{
+					startLeft = 0;
+					leftBase = first;
+				}
+
+				if (countRight == 0)
+				{
+					startRight = 0;
+					rightBase = last;
+				}
+			}
+
+			// One side still has misplaced elements, move them next to the boundary
+			if (countLeft != 0)
+			{
+				const unsigned char* offsets = offsetsLeft + startLeft;
+				while (countLeft-- > 0)
+					std::iter_swap(leftBase + offsets[countLeft], --last);
+				first = last;
+			}
+
+			if (countRight != 0)
+			{
+				const unsigned char* offsets = offsetsRight + startRight;
+				while (countRight-- > 0)
+					std::iter_swap(rightBase - offsets[countRight], first++);
+			}
+		}
+
+		T* pivotPosition = first - 1;
+		*begin = std::move(*pivotPosition);
+		*pivotPosition = std::move(pivot);
+
+		return std::make_pair(pivotPosition, alreadyPartitioned);
+	}
+
+	/**
+	 * Partitions [@begin, @end) around *@begin with the elements equal to
+	 * the pivot on the left. Used when the pivot equals the element before
+	 * the range, then no element of the range is less than the pivot
+	 */
+	template <typename T, typename Compare>
+	T* partitionLeft(T* begin, T* end, Compare comp)
+	{
+		T pivot = std::move(*begin);
+		T* first = begin;
+		T* last = end;
+
+		while (comp(pivot, *--last));
+
+		if (last + 1 == end)
+			while (first < last && !comp(pivot, *++first));
+		else
+			while (!comp(pivot, *++first));
+
+		while (first < last)
+		{
+			std::iter_swap(first, last);
+			while (comp(pivot, *--last));
+			while (!comp(pivot, *++first));
+		}
+
+		T* pivotPosition = last;
+		*begin = std::move(*pivotPosition);
+		*pivotPosition = std::move(pivot);
+
+		return pivotPosition;
+	}
+
+	template <bool BRANCHLESS, typename T, typename Compare>
+	void sortLoop(T* begin, T* end, Compare comp, unsigned badAllowed, bool leftmost)
+	{
+		// The left part is sorted recursively, the right part by the next iteration
+		while (true)
+		{
+			const std::size_t size = static_cast<std::size_t>(end - begin);
+
+			if (size < constants::insertion_sort_threshold)
+			{
+				if (leftmost)
+					insertionSort(begin, end, comp);
+				else
+					unguardedInsertionSort(begin, end, comp);
+				return;
+			}
+
+			// The pivot ends up in *begin
+			const std::size_t half = size / 2;
+			if (size > constants::ninther_threshold)
+			{
+				sort3(begin, begin + half, end - 1, comp);
+				sort3(begin + 1, begin + (half - 1), end - 2, comp);
+				sort3(begin + 2, begin + (half + 1), end - 3, comp);
+				sort3(begin + (half - 1), begin + half, begin + (half + 1), comp);
+				std::iter_swap(begin, begin + half);
+			}
+			else
+				sort3(begin + half, begin, end - 1, comp);
+
+			// Equal to the element before the range: everything equal to the pivot is in place after partitionLeft
+			if (!leftmost && !comp(*(begin - 1), *begin))
+			{
+				begin = partitionLeft(begin, end, comp) + 1;
+				continue;
+			}
+
+			const std::pair<T*, bool> partition = BRANCHLESS ?
+				partitionRightBranchless(begin, end, comp) : partitionRight(begin, end, comp);
+			T* pivot = partition.first;
+
+			const std::size_t leftSize = static_cast<std::size_t>(pivot - begin);
+			const std::size_t rightSize = static_cast<std::size_t>(end - (pivot + 1));
+
+			if (leftSize < size / 8 || rightSize < size / 8)
+			{
+				if (--badAllowed == 0)
+				{
+					std::make_heap(begin, end, comp);
+					std::sort_heap(begin, end, comp);
+					return;
+				}
+
+				// Shuffle a few elements to break the pattern that caused the bad pivot
+				if (leftSize >= constants::insertion_sort_threshold)
+				{
+					std::iter_swap(begin, begin + leftSize / 4);
+					std::iter_swap(pivot - 1, pivot - leftSize / 4);
+
+					if (leftSize > constants::ninther_threshold)
+					{
+						std::iter_swap(begin + 1, begin + (leftSize / 4 + 1));
+						std::iter_swap(begin + 2, begin + (leftSize / 4 + 2));
+						std::iter_swap(pivot - 2, pivot - (leftSize / 4 + 1));
+						std::iter_swap(pivot - 3, pivot - (leftSize / 4 + 2));
+					}
+				}
+
+				if (rightSize >= constants::insertion_sort_threshold)
+				{
+					std::iter_swap(pivot + 1, pivot + (1 + rightSize / 4));
+					std::iter_swap(end - 1, end - rightSize / 4);
+
+					if (rightSize > constants::ninther_threshold)
+					{
+						std::iter_swap(pivot + 2, pivot + (2 + rightSize / 4));
+						std::iter_swap(pivot + 3, pivot + (3 + rightSize / 4));
+						std::iter_swap(end - 2, end - (1 + rightSize / 4));
+						std::iter_swap(end - 3, end - (2 + rightSize / 4));
+					}
+				}
+			}
+			else if (partition.second && partialInsertionSort(begin, pivot, comp) &&
+				partialInsertionSort(pivot + 1, end, comp))
+				return;
+
+			sortLoop<BRANCHLESS>(begin, pivot, comp, badAllowed, leftmost);
+			begin = pivot + 1;
+			leftmost = false;
+		}
+	}
+
+	template <typename T, typename Compare>
+	void sort(T* begin, T* end, Compare comp)
+	{
+		if (end - begin < 2)
+			return;
+
+		unsigned logSize = 0;
+		for (std::size_t size = static_cast<std::size_t>(end - begin); size > 1; size >>= 1)
+			++logSize;
+
+		sortLoop<isBranchless<T, Compare>::value>(begin, end, comp, logSize, true);
+	}
+}
+
+/**
+ * Sorts @size elements of @array in ascending order (not stable)
+ */
+template <typename T>
+void pdqSort(T* array, std::size_t size)
+{
+	pdq_sort::sort(array, array + size, std::less<T>());
+}
+
+/**
+ * Sorts @size elements of @array in the order defined by @comp (not stable)
+ */
+template <typename T, typename Compare>
+void pdqSort(T* array, std::size_t size, Compare comp)
+{
+	pdq_sort::sort(array, array + size, comp);
+}
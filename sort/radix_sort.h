@@ -0,0 +1,266 @@
+﻿/**
+ * @author Dreadblade- (https://github.com/Dreadblade-dev)
+ * LSD radix sort realization
+ *
+ * Least significant digit radix sort orders integer keys without
+ * comparing them: the keys are distributed by their lowest digit, then
+ * by the next one and so on, every pass keeping the order of the one
+ * before. Digits are 11 bits wide, so the 2048 counters of a histogram
+ * fit in L1 and 32-bit keys take 3 passes, 64-bit keys 6.
+ *
+ * The histograms of all digits are counted in one read pass before the
+ * first scatter, and a pass is skipped when all keys share its digit.
+ * Signed integers and floating point numbers are mapped to unsigned keys
+ * with the same order first: the sign bit of signed integers is flipped,
+ * negative floats have all bits flipped and positive ones the sign bit.
+ * Floats end up ordered as -NaN < -inf < ... < -0 < +0 < ... < +inf < +NaN.
+ *
+ * Time complexity (w - key width in bits):
+ * ┌────────────────┬────────────────┬───────────────┐
+ * │   Worst-case   │  Average-case  │    Memory     │
+ * ├────────────────┼────────────────┼───────────────┤
+ * │   O(n w / 11)  │   O(n w / 11)  │     O(n)      │
+ * └────────────────┴────────────────┴───────────────┘
+ *
+ * Source: https://en.wikipedia.org/wiki/Radix_sort
+ */
+
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace radix_sort
+{
+	struct constants
+	{
+		static const unsigned digit_bits = 11;
+		static const std::size_t buckets = std::size_t(1) << digit_bits;
+		// Shorter arrays are insertion sorted, the histograms would cost more than sorting
+		static const std::size_t insertion_sort_threshold = 64;
+	};
+
+	template <std::size_t SIZE>
+	struct UnsignedOf;
+
+	template <>
+	struct UnsignedOf<1> { typedef uint8_t type; };
+
+	template <>
+	struct UnsignedOf<2> { typedef uint16_t type; };
+
+	template <>
+	struct UnsignedOf<4> { typedef uint32_t type; };
+
+	template <>
+	struct UnsignedOf<8> { typedef uint64_t type; };
+
+	/**
+	 * Integers (except bool) and IEEE 754 floating point types of 1 to 8 bytes
+	 */
+	template <typename T>
+	struct isRadixSortable : std::integral_constant<bool,
+		(std::is_integral<T>::value && !std::is_same<T, bool>::value) ||
+		(std::is_floating_point<T>::value && std::numeric_limits<T>::is_iec559 && (sizeof(T) == 4 || sizeof(T) == 8))>
+	{
+	};
+
+	/**
+	 * Maps @value to an unsigned key with the same order
+	 */
+	template <typename T, typename U = typename UnsignedOf<sizeof(T)>::type>
+	typename std::enable_if<std::is_integral<T>::value, U>::type toRadix(const T& value) noexcept
+	{
+		const U sign = std::is_signed<T>::value ? static_cast<U>(U(1) << (8 * sizeof(T) - 1)) : 0;
+		return static_cast<U>(static_cast<U>(value) ^ sign);
+	}
+
+	template <typename T, typename U = typename UnsignedOf<sizeof(T)>::type>
+	typename std::enable_if<std::is_floating_point<T>::value, U>::type toRadix(const T& value) noexcept
+	{
+		const U sign = static_cast<U>(U(1) << (8 * sizeof(T) - 1));
+		U bits;
+		std::memcpy(&bits, &value, sizeof(T));
+
+		return (bits & sign) ? static_cast<U>(~bits) : static_cast<U>(bits | sign);
+	}
+
+	template <typename T, typename U = typename UnsignedOf<sizeof(T)>::type>
+	typename std::enable_if<std::is_integral<T>::value, T>::type fromRadix(const U& key) noexcept
+	{
+		const U sign = std::is_signed<T>::value ? static_cast<U>(U(1) << (8 * sizeof(T) - 1)) : 0;
+		return static_cast<T>(static_cast<U>(key ^ sign));
+	}
+
+	template <typename T, typename U = typename UnsignedOf<sizeof(T)>::type>
+	typename std::enable_if<std::is_floating_point<T>::value, T>::type fromRadix(const U& key) noexcept
+	{
+		const U sign = static_cast<U>(U(1) << (8 * sizeof(T) - 1));
+		const U bits = (key & sign) ? static_cast<U>(key ^ sign) : static_cast<U>(~key);
+
+		T value;
+		std::memcpy(&value, &bits, sizeof(T));
+		return value;
+	}
+
+	/**
+	 * Value type of the key-only sort, its value arrays are null and never touched
+	 */
+	struct NoValue
+	{
+	};
+
+	template <typename V>
+	struct hasValues : std::integral_constant<bool, !std::is_same<V, NoValue>::value>
+	{
+	};
+
+	template <typename U>
+	unsigned digitOf(U key, unsigned pass) noexcept
+	{
+		return static_cast<unsigned>((key >> (pass * constants::digit_bits)) & (constants::buckets - 1));
+	}
+
+	/**
+	 * Stable insertion sort of @keys, @values follow their keys
+	 */
+	template <typename U, typename V>
+	void insertionSort(U* keys, V* values, std::size_t size)
+	{
+		for (std::size_t current = 1; current < size; ++current)
+		{
+			const U key = keys[current];
+			V value = hasValues<V>::value ? std::move(values[current]) : V();
+			std::size_t sift = current;
+
+			for (; sift > 0 && key < keys[sift - 1]; --sift)
+			{
+				keys[sift] = keys[sift - 1];
+				if (hasValues<V>::value)
+					values[sift] = std::move(values[sift - 1]);
+			}
+
+			keys[sift] = key;
+			if (hasValues<V>::value)
+				values[sift] = std::move(value);
+		}
+	}
+
+	/**
+	 * Sorts @keys and moves @values along, ping-ponging with the buffers.
+	 * Returns @true if the result ended up in the buffers
+	 */
+	template <typename U, typename V>
+	bool sortPasses(U* keys, U* keysBuffer, V* values, V* valuesBuffer, std::size_t size)
+	{
+		const unsigned passes = (8 * sizeof(U) + constants::digit_bits - 1) / constants::digit_bits;
+		std::vector<std::size_t> histograms(passes * constants::buckets, 0);
+
+		for (std::size_t index = 0; index < size; ++index)
+		{
+			const U key = keys[index];
+			for (unsigned pass = 0; pass < passes; ++pass)
+				++histograms[pass * constants::buckets + digitOf(key, pass)];
+		}
+
+		bool swapped = false;
+		for (unsigned pass = 0; pass < passes; ++pass)
+		{
+			std::size_t* histogram = histograms.data() + pass * constants::buckets;
+			if (histogram[digitOf(keys[0], pass)] == size)
+				continue;
+
+			std::size_t offset = 0;
+			for (std::size_t bucket = 0; bucket < constants::buckets; ++bucket)
+			{
+				const std::size_t count = histogram[bucket];
+				histogram[bucket] = offset;
+				offset += count;
+			}
+
+			for (std::size_t index = 0; index < size; ++index)
+			{
+				const std::size_t target = histogram[digitOf(keys[index], pass)]++;
+				keysBuffer[target] = keys[index];
+				if (hasValues<V>::value)
+					valuesBuffer[target] = std::move(values[index]);
+			}
+
+			std::swap(keys, keysBuffer);
+			std::swap(values, valuesBuffer);
+			swapped = !swapped;
+		}
+
+		return swapped;
+	}
+}
+
+/**
+ * Sorts @size elements of @array in ascending order
+ */
+template <typename T>
+typename std::enable_if<radix_sort::isRadixSortable<T>::value>::type
+radixSort(T* array, std::size_t size)
+{
+	typedef typename radix_sort::UnsignedOf<sizeof(T)>::type U;
+
+	if (size < 2)
+		return;
+
+	std::vector<U> keys(size);
+	for (std::size_t index = 0; index < size; ++index)
+		keys[index] = radix_sort::toRadix(array[index]);
+
+	radix_sort::NoValue* values = nullptr;
+
+	if (size < radix_sort::constants::insertion_sort_threshold)
+		radix_sort::insertionSort(keys.data(), values, size);
+	else
+	{
+		std::vector<U> buffer(size);
+		if (radix_sort::sortPasses(keys.data(), buffer.data(), values, values, size))
+			keys.swap(buffer);
+	}
+
+	for (std::size_t index = 0; index < size; ++index)
+		array[index] = radix_sort::fromRadix<T>(keys[index]);
+}
+
+/**
+ * Sorts @size @keys in ascending order and permutes @values the same
+ * way. The sort is stable: equal keys keep the order of their values
+ */
+template <typename K, typename V>
+typename std::enable_if<radix_sort::isRadixSortable<K>::value>::type
+radixSortByKey(K* keys, V* values, std::size_t size)
+{
+	typedef typename radix_sort::UnsignedOf<sizeof(K)>::type U;
+
+	if (size < 2)
+		return;
+
+	std::vector<U> radixKeys(size);
+	for (std::size_t index = 0; index < size; ++index)
+		radixKeys[index] = radix_sort::toRadix(keys[index]);
+
+	if (size < radix_sort::constants::insertion_sort_threshold)
+		radix_sort::insertionSort(radixKeys.data(), values, size);
+	else
+	{
+		std::vector<U> keysBuffer(size);
+		std::vector<V> valuesBuffer(size);
+
+		if (radix_sort::sortPasses(radixKeys.data(), keysBuffer.data(), values, valuesBuffer.data(), size))
+		{
+			radixKeys.swap(keysBuffer);
+			for (std::size_t index = 0; index < size; ++index)
+				values[index] = std::move(valuesBuffer[index]);
+		}
+	}
+
+	for (std::size_t index = 0; index < size; ++index)
+		keys[index] = radix_sort::fromRadix<K>(radixKeys[index]);
+}
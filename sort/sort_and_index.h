@@ -0,0 +1,68 @@
+﻿/**
+ * @author Dreadblade- (https://github.com/Dreadblade-dev)
+ * Sorting with the original positions
+ *
+ * The search structures (binarySearch, LearnedIndex, CompressedSortedArray,
+ * PerfectHashIndex, ...) work on sorted arrays and return positions in
+ * that sorted array. sortAndIndex sorts an array in place and returns,
+ * for every sorted position, the position the element had before, so a
+ * search result maps straight back to the original record.
+ *
+ * Integer and floating point keys are sorted with the key-value radix
+ * sort, every other type by pattern-defeating quicksort on the indices.
+ * Equal elements keep their original order in both cases.
+ *
+ * Source: https://en.wikipedia.org/wiki/Sorting_algorithm
+ */
+
+#pragma once
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "pdq_sort.h"
+#include "radix_sort.h"
+
+namespace sort_and_index
+{
+	template <typename T>
+	void sortIndexed(T* array, std::vector<std::size_t>& positions, std::true_type)
+	{
+		radixSortByKey(array, positions.data(), positions.size());
+	}
+
+	template <typename T>
+	void sortIndexed(T* array, std::vector<std::size_t>& positions, std::false_type)
+	{
+		// Ties are broken by the position, which makes the unstable sort stable
+		pdqSort(positions.data(), positions.size(), [array](std::size_t left, std::size_t right)
+		{
+			return array[left] < array[right] || (!(array[right] < array[left]) && left < right);
+		});
+
+		std::vector<T> sorted;
+		sorted.reserve(positions.size());
+		for (std::size_t position : positions)
+			sorted.push_back(std::move(array[position]));
+
+		for (std::size_t index = 0; index < positions.size(); ++index)
+			array[index] = std::move(sorted[index]);
+	}
+}
+
+/**
+ * Sorts @size elements of @array in ascending order. Returns the
+ * original position of every element of the sorted array
+ */
+template <typename T>
+std::vector<std::size_t> sortAndIndex(T* array, std::size_t size)
+{
+	std::vector<std::size_t> positions(size);
+	for (std::size_t index = 0; index < size; ++index)
+		positions[index] = index;
+
+	sort_and_index::sortIndexed(array, positions,
+		std::integral_constant<bool, radix_sort::isRadixSortable<T>::value>());
+
+	return positions;
+}
@@ -0,0 +1,130 @@
+#include "../external_sort.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace ExternalSortTest
+{
+	struct Record
+	{
+		uint32_t sequence;
+		int64_t key;
+		char payload[4];
+	};
+
+	std::string temporaryPath(const std::string& name)
+	{
+		return testing::TempDir() + "external_sort_" + name;
+	}
+
+	void writeFile(const std::string& path, const void* data, std::size_t size)
+	{
+		std::FILE* file = std::fopen(path.c_str(), "wb");
+		ASSERT_NE(file, nullptr);
+		ASSERT_EQ(std::fwrite(data, 1, size, file), size);
+		std::fclose(file);
+	}
+
+	std::vector<unsigned char> readFile(const std::string& path)
+	{
+		std::vector<unsigned char> data;
+		std::FILE* file = std::fopen(path.c_str(), "rb");
+		if (file == nullptr)
+			return data;
+
+		unsigned char buffer[4096];
+		for (std::size_t count; (count = std::fread(buffer, 1, sizeof(buffer), file)) > 0;)
+			data.insert(data.end(), buffer, buffer + count);
+		std::fclose(file);
+		return data;
+	}
+
+	TEST(ExternalSortTest, ExternalSortMainTest)
+	{
+		const std::string input = temporaryPath("main_in");
+		const std::string output = temporaryPath("main_out");
+
+		std::mt19937_64 random(61);
+		std::vector<uint64_t> keys(100000);
+		for (auto& key : keys)
+			key = random();
+		writeFile(input, keys.data(), keys.size() * sizeof(uint64_t));
+
+		const external_sort::Statistics statistics = externalSort<uint64_t>(input, output);
+		EXPECT_EQ(statistics.records, keys.size());
+		EXPECT_EQ(statistics.runs, 1u);
+
+		std::sort(keys.begin(), keys.end());
+		const std::vector<unsigned char> sorted = readFile(output);
+		ASSERT_EQ(sorted.size(), keys.size() * sizeof(uint64_t));
+		EXPECT_EQ(std::memcmp(sorted.data(), keys.data(), sorted.size()), 0);
+
+		std::remove(input.c_str());
+		std::remove(output.c_str());
+	}
+
+	TEST(ExternalSortTest, ExternalSortMultiplePasses)
+	{
+		const std::string input = temporaryPath("records_in");
+		const std::string output = temporaryPath("records_out");
+
+		std::mt19937_64 random(67);
+		std::vector<Record> records(200000);
+		for (std::size_t i = 0; i < records.size(); ++i)
+		{
+			records[i].sequence = static_cast<uint32_t>(i);
+			records[i].key = static_cast<int64_t>(random() % 20000) - 10000;
+			std::memcpy(records[i].payload, "abcd", 4);
+		}
+		writeFile(input, records.data(), records.size() * sizeof(Record));
+
+		// 256 KiB of memory: about 40 runs merged with fan-in 3 takes several passes
+		const external_sort::Statistics statistics = externalSort<int64_t>(input, output,
+			sizeof(Record), offsetof(Record, key), 256 * 1024);
+		EXPECT_EQ(statistics.records, records.size());
+		EXPECT_GT(statistics.runs, 10u);
+		EXPECT_GT(statistics.mergePasses, 2u);
+
+		std::stable_sort(records.begin(), records.end(), [](const Record& a, const Record& b) { return a.key < b.key; });
+		const std::vector<unsigned char> sorted = readFile(output);
+		ASSERT_EQ(sorted.size(), records.size() * sizeof(Record));
+
+		// Equal keys keep the input order
+		EXPECT_EQ(std::memcmp(sorted.data(), records.data(), sorted.size()), 0);
+
+		// No temporary run is left behind
+		EXPECT_TRUE(readFile(output + ".run0").empty());
+		EXPECT_TRUE(readFile(output + ".merge0_0").empty());
+
+		std::remove(input.c_str());
+		std::remove(output.c_str());
+	}
+
+	TEST(ExternalSortTest, ExternalSortErrors)
+	{
+		const std::string input = temporaryPath("bad_in");
+		const std::string output = temporaryPath("bad_out");
+
+		EXPECT_THROW(externalSort<uint64_t>(temporaryPath("missing"), output), std::system_error);
+		EXPECT_THROW(externalSort<uint64_t>(input, output, 4), std::invalid_argument);
+
+		const char data[13] = {};
+		writeFile(input, data, sizeof(data));
+		EXPECT_THROW(externalSort<uint32_t>(input, output), std::invalid_argument);
+
+		writeFile(input, data, 0);
+		EXPECT_EQ(externalSort<uint32_t>(input, output).records, 0u);
+		EXPECT_TRUE(readFile(output).empty());
+
+		std::remove(input.c_str());
+		std::remove(output.c_str());
+	}
+}
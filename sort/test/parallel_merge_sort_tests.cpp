@@ -0,0 +1,78 @@
+#include "../parallel_merge_sort.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace ParallelMergeSortTest
+{
+	TEST(ParallelMergeSortTest, ParallelMergeSortMainTest)
+	{
+		int array[] = { 5, 3, 9, 1, 1, -4, 0, 12, 7 };
+		parallelMergeSort(array, 9, 4);
+
+		const int expected[] = { -4, 0, 1, 1, 3, 5, 7, 9, 12 };
+		for (int i = 0; i < 9; ++i)
+			EXPECT_EQ(array[i], expected[i]);
+	}
+
+	TEST(ParallelMergeSortTest, ParallelMergeSortThreadCounts)
+	{
+		std::mt19937_64 random(53);
+		std::vector<uint64_t> original(1000003);
+		for (auto& value : original)
+			value = random() % 100000;
+
+		std::vector<uint64_t> expected = original;
+		std::sort(expected.begin(), expected.end());
+
+		// Odd thread counts leave unpaired runs in the merge rounds
+		for (std::size_t threads : { 0u, 1u, 2u, 3u, 5u, 8u, 13u })
+		{
+			std::vector<uint64_t> array = original;
+			parallelMergeSort(array.data(), array.size(), threads);
+			ASSERT_EQ(array, expected) << threads << " threads";
+		}
+
+		std::vector<uint64_t> descending = original;
+		parallelMergeSort(descending.data(), descending.size(), 4, std::greater<uint64_t>());
+		EXPECT_TRUE(std::is_sorted(descending.begin(), descending.end(), std::greater<uint64_t>()));
+	}
+
+	TEST(ParallelMergeSortTest, ParallelMergeSortStrings)
+	{
+		std::mt19937 random(59);
+		std::vector<std::string> array(200000);
+		for (auto& value : array)
+			value = std::to_string(random() % 5000);
+
+		std::vector<std::string> expected = array;
+		std::sort(expected.begin(), expected.end());
+
+		parallelMergeSort(array.data(), array.size(), 6);
+		EXPECT_EQ(array, expected);
+	}
+
+	TEST(ParallelMergeSortTest, MergePathSplit)
+	{
+		const int a[] = { 1, 3, 3, 5, 7 };
+		const int b[] = { 2, 3, 4, 8 };
+		const int merged[] = { 1, 2, 3, 3, 3, 4, 5, 7, 8 };
+
+		// The first k merged elements are exactly a[0, split) and b[0, k - split)
+		for (std::size_t diagonal = 0; diagonal <= 9; ++diagonal)
+		{
+			const std::size_t split = parallel_merge_sort::mergePathSplit(a, 5, b, 4, diagonal, std::less<int>());
+			std::vector<int> prefix(a, a + split);
+			prefix.insert(prefix.end(), b, b + (diagonal - split));
+			std::sort(prefix.begin(), prefix.end());
+			EXPECT_TRUE(std::equal(prefix.begin(), prefix.end(), merged)) << "diagonal " << diagonal;
+		}
+
+		// Ties go to the first input
+		EXPECT_EQ(parallel_merge_sort::mergePathSplit(a, 5, b, 4, 4, std::less<int>()), 3u);
+	}
+}
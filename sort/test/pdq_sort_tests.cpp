@@ -0,0 +1,86 @@
+#include "../pdq_sort.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace PdqSortTest
+{
+	template <typename T, typename Compare = std::less<T>>
+	void checkSort(std::vector<T> array, Compare comp = Compare())
+	{
+		std::vector<T> expected = array;
+		std::sort(expected.begin(), expected.end(), comp);
+
+		pdqSort(array.data(), array.size(), comp);
+		ASSERT_EQ(array, expected);
+	}
+
+	TEST(PdqSortTest, PdqSortMainTest)
+	{
+		int array[] = { 5, 3, 9, 1, 1, -4, 0, 12, 7 };
+		pdqSort(array, 9);
+
+		const int expected[] = { -4, 0, 1, 1, 3, 5, 7, 9, 12 };
+		for (int i = 0; i < 9; ++i)
+			EXPECT_EQ(array[i], expected[i]);
+
+		pdqSort(array, 0);
+		pdqSort(array, 1);
+	}
+
+	TEST(PdqSortTest, PdqSortPatterns)
+	{
+		std::mt19937_64 random(23);
+
+		for (std::size_t size : { 2u, 23u, 24u, 129u, 1000u, 100000u })
+		{
+			std::vector<int64_t> array(size);
+
+			for (auto& value : array)
+				value = static_cast<int64_t>(random());
+			checkSort(array);
+			checkSort(array, std::greater<int64_t>());
+
+			// Sorted, reverse sorted, organ pipe, few distinct values, sawtooth
+			for (std::size_t i = 0; i < size; ++i)
+				array[i] = static_cast<int64_t>(i);
+			checkSort(array);
+			std::reverse(array.begin(), array.end());
+			checkSort(array);
+			for (std::size_t i = 0; i < size; ++i)
+				array[i] = static_cast<int64_t>(std::min(i, size - i));
+			checkSort(array);
+			for (auto& value : array)
+				value = static_cast<int64_t>(random() % 4);
+			checkSort(array);
+			for (std::size_t i = 0; i < size; ++i)
+				array[i] = static_cast<int64_t>(i % 37);
+			checkSort(array);
+		}
+	}
+
+	TEST(PdqSortTest, PdqSortStrings)
+	{
+		std::mt19937 random(29);
+		std::vector<std::string> array;
+		for (int i = 0; i < 5000; ++i)
+			array.push_back(std::to_string(random() % 1000));
+
+		checkSort(array);
+	}
+
+	TEST(PdqSortTest, PdqSortDoubles)
+	{
+		std::mt19937_64 random(31);
+		std::uniform_real_distribution<double> distribution(-1e6, 1e6);
+		std::vector<double> array(50000);
+		for (auto& value : array)
+			value = distribution(random);
+
+		checkSort(array);
+	}
+}
@@ -0,0 +1,129 @@
+#include "../radix_sort.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace RadixSortTest
+{
+	template <typename T>
+	void checkSort(std::vector<T> array)
+	{
+		std::vector<T> expected = array;
+		std::sort(expected.begin(), expected.end());
+
+		radixSort(array.data(), array.size());
+		ASSERT_EQ(array, expected);
+	}
+
+	TEST(RadixSortTest, RadixSortMainTest)
+	{
+		int array[] = { 5, 3, 9, 1, 1, -4, 0, 12, 7 };
+		radixSort(array, 9);
+
+		const int expected[] = { -4, 0, 1, 1, 3, 5, 7, 9, 12 };
+		for (int i = 0; i < 9; ++i)
+			EXPECT_EQ(array[i], expected[i]);
+	}
+
+	TEST(RadixSortTest, RadixSortIntegers)
+	{
+		std::mt19937_64 random(37);
+
+		for (std::size_t size : { 0u, 1u, 63u, 64u, 1000u, 200000u })
+		{
+			std::vector<uint64_t> u64(size);
+			std::vector<int64_t> i64(size);
+			std::vector<int32_t> i32(size);
+			std::vector<uint16_t> u16(size);
+			std::vector<int8_t> i8(size);
+
+			for (std::size_t i = 0; i < size; ++i)
+			{
+				const uint64_t value = random();
+				u64[i] = value;
+				i64[i] = static_cast<int64_t>(value);
+				i32[i] = static_cast<int32_t>(value);
+				u16[i] = static_cast<uint16_t>(value);
+				i8[i] = static_cast<int8_t>(value);
+			}
+
+			checkSort(u64);
+			checkSort(i64);
+			checkSort(i32);
+			checkSort(u16);
+			checkSort(i8);
+
+			// Keys that differ only in the upper digits
+			for (std::size_t i = 0; i < size; ++i)
+				u64[i] = (random() % 16) << 60;
+			checkSort(u64);
+		}
+
+		std::vector<int64_t> extremes = { std::numeric_limits<int64_t>::max(), 0, -1, std::numeric_limits<int64_t>::min(), 1 };
+		checkSort(extremes);
+	}
+
+	TEST(RadixSortTest, RadixSortFloatingPoint)
+	{
+		std::mt19937_64 random(41);
+		std::uniform_real_distribution<double> distribution(-1e9, 1e9);
+		std::vector<double> doubles(100000);
+		std::vector<float> floats(100000);
+		for (std::size_t i = 0; i < doubles.size(); ++i)
+		{
+			doubles[i] = distribution(random);
+			floats[i] = static_cast<float>(distribution(random));
+		}
+		doubles[0] = std::numeric_limits<double>::infinity();
+		doubles[1] = -std::numeric_limits<double>::infinity();
+		doubles[2] = std::numeric_limits<double>::denorm_min();
+		floats[0] = -std::numeric_limits<float>::max();
+
+		checkSort(doubles);
+		checkSort(floats);
+
+		// Negative zero before positive zero, NaN after infinity
+		double special[] = { 0.0, std::nan(""), -0.0, std::numeric_limits<double>::infinity(), -1.5 };
+		radixSort(special, 5);
+		EXPECT_EQ(special[0], -1.5);
+		EXPECT_TRUE(std::signbit(special[1]));
+		EXPECT_FALSE(std::signbit(special[2]));
+		EXPECT_EQ(special[3], std::numeric_limits<double>::infinity());
+		EXPECT_TRUE(std::isnan(special[4]));
+	}
+
+	TEST(RadixSortTest, RadixSortByKeyIsStable)
+	{
+		std::mt19937 random(43);
+
+		for (std::size_t size : { 50u, 100000u })
+		{
+			std::vector<int32_t> keys(size);
+			std::vector<std::string> values(size);
+			std::vector<std::pair<int32_t, std::string>> expected(size);
+
+			for (std::size_t i = 0; i < size; ++i)
+			{
+				keys[i] = static_cast<int32_t>(random() % 1000) - 500;
+				values[i] = std::to_string(i);
+				expected[i] = std::make_pair(keys[i], values[i]);
+			}
+
+			std::stable_sort(expected.begin(), expected.end(),
+				[](const std::pair<int32_t, std::string>& a, const std::pair<int32_t, std::string>& b) { return a.first < b.first; });
+
+			radixSortByKey(keys.data(), values.data(), size);
+			for (std::size_t i = 0; i < size; ++i)
+			{
+				ASSERT_EQ(keys[i], expected[i].first);
+				ASSERT_EQ(values[i], expected[i].second);
+			}
+		}
+	}
+}
@@ -0,0 +1,71 @@
+#include "../sort_and_index.h"
+#include "../../search/binary_search.h"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace SortAndIndexTest
+{
+	TEST(SortAndIndexTest, SortAndIndexMainTest)
+	{
+		int64_t records[] = { 40, 10, 30, 20, 10 };
+		int64_t keys[] = { 40, 10, 30, 20, 10 };
+
+		const std::vector<std::size_t> positions = sortAndIndex(keys, 5);
+
+		const int64_t sorted[] = { 10, 10, 20, 30, 40 };
+		const std::size_t expected[] = { 1, 4, 3, 2, 0 };
+		for (int i = 0; i < 5; ++i)
+		{
+			EXPECT_EQ(keys[i], sorted[i]);
+			EXPECT_EQ(positions[i], expected[i]);
+		}
+
+		// A search in the sorted keys finds the original record
+		const int64_t found = binarySearch(keys, int64_t(30), 0, 5);
+		EXPECT_EQ(records[positions[found]], 30);
+	}
+
+	TEST(SortAndIndexTest, SortAndIndexGeneric)
+	{
+		std::mt19937 random(47);
+
+		std::vector<std::string> strings(3000);
+		std::vector<double> doubles(3000);
+		for (std::size_t i = 0; i < strings.size(); ++i)
+		{
+			strings[i] = std::to_string(random() % 500);
+			doubles[i] = static_cast<double>(random() % 500) / 7.0;
+		}
+
+		const std::vector<std::string> originalStrings = strings;
+		const std::vector<double> originalDoubles = doubles;
+
+		const std::vector<std::size_t> stringPositions = sortAndIndex(strings.data(), strings.size());
+		const std::vector<std::size_t> doublePositions = sortAndIndex(doubles.data(), doubles.size());
+
+		for (std::size_t i = 0; i < strings.size(); ++i)
+		{
+			ASSERT_EQ(strings[i], originalStrings[stringPositions[i]]);
+			ASSERT_EQ(doubles[i], originalDoubles[doublePositions[i]]);
+
+			if (i > 0)
+			{
+				ASSERT_FALSE(strings[i] < strings[i - 1]);
+				ASSERT_FALSE(doubles[i] < doubles[i - 1]);
+
+				// Equal elements keep their original order
+				if (strings[i] == strings[i - 1])
+				{
+					ASSERT_LT(stringPositions[i - 1], stringPositions[i]);
+				}
+				if (doubles[i] == doubles[i - 1])
+				{
+					ASSERT_LT(doublePositions[i - 1], doublePositions[i]);
+				}
+			}
+		}
+	}
+}